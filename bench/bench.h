@@ -0,0 +1,42 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "common.h"
+#include <time.h>
+
+
+/*
+ * Small helpers shared by the benchmark targets in bench/
+ * Build with -DCMAKE_BUILD_TYPE=Release, Debug has ASan and -O0
+ */
+
+
+// monotonic wall clock in seconds
+static inline double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+
+// per-thread PRNG (xorshift64*), the global pcg32 state isn't thread-safe
+static inline u64 bench_rand(u64* state)
+{
+    u64 x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+
+// keep the compiler from optimizing away a result (empty asm that "uses" val)
+static inline void bench_sink(u64 val)
+{
+    __asm__ volatile("" : : "r"(val) : "memory");
+}
+
+
+#endif // BENCH_H
@@ -0,0 +1,164 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "gemm.h"
+#include "gemm_batch.h"
+#include "gemv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * gemv / gemv_t at every cpu level vs plain loops (-O3) on square A
+ * (L2 sized and memory sized), then the batched small gemm vs one
+ * gemm_f32 call per matrix and a plain triple loop per matrix.
+ */
+
+#define GEMV_FLOPS  (1ULL << 30) // flops per gemv measurement
+#define BATCH_FLOPS (1ULL << 30)
+
+
+__attribute__((noinline)) static void loop_gemv(u64 m, u64 n, const float* a, const float* x, float* y)
+{
+    for (u64 i = 0; i < m; i++) {
+        float sum = 0;
+        for (u64 j = 0; j < n; j++) { sum += a[(i * n) + j] * x[j]; }
+        y[i] = sum;
+    }
+}
+
+__attribute__((noinline)) static void loop_gemv_t(u64 m, u64 n, const float* a, const float* x, float* y)
+{
+    for (u64 j = 0; j < n; j++) { y[j] = 0; }
+    for (u64 i = 0; i < m; i++) {
+        for (u64 j = 0; j < n; j++) { y[j] += x[i] * a[(i * n) + j]; }
+    }
+}
+
+__attribute__((noinline)) static void loop_gemm(u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    for (u64 i = 0; i < m; i++) {
+        for (u64 j = 0; j < n; j++) {
+            float sum = 0;
+            for (u64 p = 0; p < k; p++) { sum += a[(i * k) + p] * b[(p * n) + j]; }
+            c[(i * n) + j] = sum;
+        }
+    }
+}
+
+static void fill(float* v, u64 n, u64* rng)
+{
+    for (u64 i = 0; i < n; i++) { v[i] = (float)(bench_rand(rng) % 2001) / 1000.0f - 1; }
+}
+
+
+// level < 0: plain loop
+static double run_gemv(int trans, int level, u64 n, const float* a, const float* x, float* y)
+{
+    u64    reps = GEMV_FLOPS / (2 * n * n) + 1;
+    double t0   = bench_now();
+    for (u64 r = 0; r < reps; r++) {
+        if (level < 0) {
+            if (trans) { loop_gemv_t(n, n, a, x, y); }
+            else { loop_gemv(n, n, a, x, y); }
+        } else {
+            if (trans) { gemv_t_f32(n, n, 1, a, n, x, 0, y); }
+            else { gemv_f32(n, n, 1, a, n, x, 0, y); }
+        }
+    }
+    double t = bench_now() - t0;
+
+    bench_sink((u64)y[n / 2]);
+    return (double)(2 * n * n * reps) / t / 1e9;
+}
+
+
+int main(void)
+{
+    u64       rng  = 12345;
+    cpu_level best = cpu_simd_level();
+
+    // ==== GEMV ====
+    u64    sizes[] = { 256, 512, 4096 }; // 256 KB, 1 MB, 64 MB of A
+    float* a       = malloc(sizeof(float) * 4096 * 4096);
+    float* x       = malloc(sizeof(float) * 4096);
+    float* y       = malloc(sizeof(float) * 4096);
+    CHECK_FATAL(!a || !x || !y, "malloc failed");
+    fill(a, 4096 * 4096, &rng);
+    fill(x, 4096, &rng);
+
+    for (int trans = 0; trans < 2; trans++) {
+        printf("%s (GFLOP/s)\n  %-8s", trans ? "gemv_t" : "gemv", "n");
+        for (u32 s = 0; s < 3; s++) { printf(" %8lu", sizes[s]); }
+        printf("\n");
+
+        for (int level = -1; level <= (int)best; level++) {
+            if (level >= 0) { cpu_set_max_level((cpu_level)level); }
+            printf("  %-8s", level < 0 ? "loop" : cpu_level_name((cpu_level)level));
+            for (u32 s = 0; s < 3; s++) { printf(" %8.2f", run_gemv(trans, level, sizes[s], a, x, y)); }
+            printf("\n");
+        }
+        cpu_set_max_level(best);
+    }
+    free(a);
+    free(x);
+    free(y);
+
+    // ==== BATCHED ====
+    u64 dims[]  = { 4, 8, 16, 32 };
+    u64 batch   = 4096;
+    printf("\nbatched square gemm, %lu matrices (GFLOP/s)\n", batch);
+    printf("  %-8s %10s %10s", "size", "loop", "gemm_f32");
+    for (int level = 0; level <= (int)best; level++) { printf(" %10s", cpu_level_name((cpu_level)level)); }
+    printf("\n");
+
+    for (u32 d = 0; d < 4; d++) {
+        u64    n     = dims[d];
+        u64    elems = n * n;
+        float* ma    = malloc(sizeof(float) * batch * elems);
+        float* mb    = malloc(sizeof(float) * batch * elems);
+        float* mc    = malloc(sizeof(float) * gemm_batch_size(batch, elems));
+        float* ia    = malloc(sizeof(float) * gemm_batch_size(batch, elems));
+        float* ib    = malloc(sizeof(float) * gemm_batch_size(batch, elems));
+        CHECK_FATAL(!ma || !mb || !mc || !ia || !ib, "malloc failed");
+        fill(ma, batch * elems, &rng);
+        fill(mb, batch * elems, &rng);
+        gemm_batch_interleave(ia, ma, batch, elems);
+        gemm_batch_interleave(ib, mb, batch, elems);
+
+        double flops = 2.0 * (double)(n * n * n * batch);
+        u64    reps  = BATCH_FLOPS / (u64)flops + 1;
+
+        printf("  %-8lu", n);
+        for (int mode = 0; mode < 2; mode++) {
+            double t0 = bench_now();
+            for (u64 r = 0; r < reps; r++) {
+                for (u64 t = 0; t < batch; t++) {
+                    const float* pa = ma + (t * elems);
+                    const float* pb = mb + (t * elems);
+                    float*       pc = mc + (t * elems);
+                    if (mode == 0) { loop_gemm(n, n, n, pa, pb, pc); }
+                    else { gemm_f32(n, n, n, 1, pa, n, pb, n, 0, pc, n); }
+                }
+            }
+            printf(" %10.2f", flops * (double)reps / (bench_now() - t0) / 1e9);
+        }
+        for (int level = 0; level <= (int)best; level++) {
+            cpu_set_max_level((cpu_level)level);
+            double t0 = bench_now();
+            for (u64 r = 0; r < reps; r++) { gemm_f32_batched(batch, n, n, n, ia, ib, mc); }
+            printf(" %10.2f", flops * (double)reps / (bench_now() - t0) / 1e9);
+        }
+        cpu_set_max_level(best);
+        printf("\n");
+
+        bench_sink((u64)mc[elems / 2]);
+        free(ma);
+        free(mb);
+        free(mc);
+        free(ia);
+        free(ib);
+    }
+
+    return 0;
+}
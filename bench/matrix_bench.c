@@ -0,0 +1,99 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "matrix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * Square float multiplies: the old 16x16 blocked ikj loop (what
+ * matrix_xply was), matrix_xply_2, and matrix_xply (packed GEMM) at every
+ * cpu level, in GFLOP/s (2 * n^3 flops per multiply).
+ */
+
+#define MAX_N 2048
+
+
+// the previous matrix_xply
+static void blocked_ikj(Matrix* out, const Matrix* a, const Matrix* b)
+{
+    const u64 m = a->m, k = a->n, n = b->n;
+    const u64 BLOCK_SIZE = 16;
+
+    memset(out->data, 0, sizeof(float) * m * n);
+
+    for (u64 i = 0; i < m; i += BLOCK_SIZE) {
+        for (u64 kb = 0; kb < k; kb += BLOCK_SIZE) {
+            for (u64 j = 0; j < n; j += BLOCK_SIZE) {
+                u64 i_max = i + BLOCK_SIZE < m ? i + BLOCK_SIZE : m;
+                u64 k_max = kb + BLOCK_SIZE < k ? kb + BLOCK_SIZE : k;
+                u64 j_max = j + BLOCK_SIZE < n ? j + BLOCK_SIZE : n;
+
+                for (u64 ii = i; ii < i_max; ii++) {
+                    for (u64 kk = kb; kk < k_max; kk++) {
+                        float a_val = a->data[IDX(a, ii, kk)];
+                        for (u64 jj = j; jj < j_max; jj++) {
+                            out->data[IDX(out, ii, jj)] += a_val * b->data[IDX(b, kk, jj)];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+typedef void (*xply_fn)(Matrix*, const Matrix*, const Matrix*);
+
+static void report(const char* name, xply_fn fn, Matrix* out, const Matrix* a, const Matrix* b)
+{
+    u64 n    = a->n;
+    int reps = n <= 256 ? 20 : n <= 512 ? 4 : 1;
+
+    fn(out, a, b); // warm up
+
+    double t = bench_now();
+    for (int r = 0; r < reps; r++) { fn(out, a, b); }
+    t = (bench_now() - t) / reps;
+
+    bench_sink((u64)out->data[n + 1]);
+    printf("  %-14s %8.2f GFLOP/s  %9.2f ms\n", name, 2.0 * (double)(n * n * n) / t / 1e9, t * 1e3);
+}
+
+
+int main(int argc, char** argv)
+{
+    u64 max_n = argc > 1 ? strtoull(argv[1], NULL, 10) : MAX_N;
+    u64 rng   = 12345;
+
+    cpu_level best = cpu_simd_level();
+
+    for (u64 n = 128; n <= max_n; n *= 2) {
+        Matrix* a   = matrix_create(n, n);
+        Matrix* b   = matrix_create(n, n);
+        Matrix* out = matrix_create(n, n);
+
+        for (u64 i = 0; i < n * n; i++) {
+            a->data[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+            b->data[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+        }
+
+        printf("%lu x %lu:\n", n, n);
+        if (n <= 1024) {
+            report("blocked ikj", blocked_ikj, out, a, b);
+            report("xply_2", matrix_xply_2, out, a, b);
+        }
+
+        for (int level = CPU_SCALAR; level <= (int)best; level++) {
+            cpu_set_max_level((cpu_level)level);
+            report(cpu_level_name((cpu_level)level), matrix_xply, out, a, b);
+        }
+        cpu_set_max_level(best);
+
+        matrix_destroy(a);
+        matrix_destroy(b);
+        matrix_destroy(out);
+    }
+
+    return 0;
+}
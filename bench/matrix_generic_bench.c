@@ -0,0 +1,207 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "matrix_generic.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * The generic matrices' multiplies: the 16x16 blocked ikj loop every
+ * instantiation used before vs the kernel it dispatches to now, at every
+ * cpu level, in G(FL)OP/s (2 * n^3 per multiply).
+ *
+ *   double        matrix_xply_double          gemm_f64
+ *   i32           matrix_xply_i32             gemm_i32
+ *   i8 -> i32     matrix_xply_acc_i8_i32      gemm_i8
+ *   float -> f64  matrix_xply_acc_float_double gemm_f32_f64
+ *
+ * Then float dot products summed in float vs vec_f32_dot_f64.
+ */
+
+#define MAX_N 1024
+
+INSTANTIATE_MATRIX(float, "%f");
+INSTANTIATE_MATRIX(double, "%lf");
+INSTANTIATE_MATRIX(i32, "%d");
+INSTANTIATE_MATRIX(i8, "%d");
+
+INSTANTIATE_MATRIX_ACC(i8, i32)
+INSTANTIATE_MATRIX_ACC(float, double)
+
+
+// the previous MATRIX_XPLY body, with the product taken in TACC
+#define BLOCKED_IKJ(T, TACC)                                                                       \
+    __attribute__((noinline)) static void blocked_ikj_##T(Matrix_##TACC* out, const Matrix_##T* a, \
+                                                          const Matrix_##T* b)                     \
+    {                                                                                              \
+        const u64 m = a->m, k = a->n, n = b->n;                                                    \
+        const u64 BLOCK_SIZE = 16;                                                                 \
+                                                                                                   \
+        memset(out->data, 0, sizeof(TACC) * m * n);                                                \
+                                                                                                   \
+        for (u64 i = 0; i < m; i += BLOCK_SIZE) {                                                  \
+            for (u64 kb = 0; kb < k; kb += BLOCK_SIZE) {                                           \
+                for (u64 j = 0; j < n; j += BLOCK_SIZE) {                                          \
+                    u64 i_max = i + BLOCK_SIZE < m ? i + BLOCK_SIZE : m;                           \
+                    u64 k_max = kb + BLOCK_SIZE < k ? kb + BLOCK_SIZE : k;                         \
+                    u64 j_max = j + BLOCK_SIZE < n ? j + BLOCK_SIZE : n;                           \
+                                                                                                   \
+                    for (u64 ii = i; ii < i_max; ii++) {                                           \
+                        for (u64 kk = kb; kk < k_max; kk++) {                                      \
+                            TACC a_val = (TACC)a->data[IDX(a, ii, kk)];                            \
+                            for (u64 jj = j; jj < j_max; jj++) {                                   \
+                                out->data[IDX(out, ii, jj)] +=                                     \
+                                    a_val * (TACC)b->data[IDX(b, kk, jj)];                         \
+                            }                                                                      \
+                        }                                                                          \
+                    }                                                                              \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+    }
+
+BLOCKED_IKJ(double, double)
+BLOCKED_IKJ(i32, i32)
+BLOCKED_IKJ(i8, i32)
+BLOCKED_IKJ(float, double)
+
+typedef struct {
+    Matrix_double *ad, *bd, *cd;
+    Matrix_i32    *ai, *bi, *ci;
+    Matrix_i8     *a8, *b8;
+    Matrix_float  *af, *bf;
+} operands;
+
+// kind: 0 double, 1 i32, 2 i8 -> i32, 3 float -> double
+static void xply(int kind, b8 loop, operands* o)
+{
+    switch (kind) {
+        case 0:
+            if (loop) { blocked_ikj_double(o->cd, o->ad, o->bd); }
+            else { matrix_xply_double(o->cd, o->ad, o->bd); }
+            break;
+        case 1:
+            if (loop) { blocked_ikj_i32(o->ci, o->ai, o->bi); }
+            else { matrix_xply_i32(o->ci, o->ai, o->bi); }
+            break;
+        case 2:
+            if (loop) { blocked_ikj_i8(o->ci, o->a8, o->b8); }
+            else { matrix_xply_acc_i8_i32(o->ci, o->a8, o->b8); }
+            break;
+        default:
+            if (loop) { blocked_ikj_float(o->cd, o->af, o->bf); }
+            else { matrix_xply_acc_float_double(o->cd, o->af, o->bf); }
+            break;
+    }
+}
+
+static void report(const char* name, int kind, b8 loop, operands* o, u64 n)
+{
+    int reps = n <= 256 ? 20 : n <= 512 ? 4 : 1;
+
+    xply(kind, loop, o); // warm up
+
+    double t = bench_now();
+    for (int r = 0; r < reps; r++) { xply(kind, loop, o); }
+    t = (bench_now() - t) / reps;
+
+    bench_sink((u64)o->cd->data[n + 1] + (u64)o->ci->data[n + 1]);
+    printf("  %-14s %8.2f GOP/s  %9.2f ms\n", name, 2.0 * (double)(n * n * n) / t / 1e9, t * 1e3);
+}
+
+
+int main(int argc, char** argv)
+{
+    u64 max_n = argc > 1 ? strtoull(argv[1], NULL, 10) : MAX_N;
+    u64 rng   = 12345;
+
+    cpu_level   best    = cpu_simd_level();
+    const char* kinds[] = { "double", "i32", "i8 -> i32", "float -> double" };
+
+    for (u64 n = 128; n <= max_n; n *= 2) {
+        operands o = {
+            matrix_create_double(n, n), matrix_create_double(n, n), matrix_create_double(n, n),
+            matrix_create_i32(n, n),    matrix_create_i32(n, n),    matrix_create_i32(n, n),
+            matrix_create_i8(n, n),     matrix_create_i8(n, n),     matrix_create_float(n, n),
+            matrix_create_float(n, n),
+        };
+
+        for (u64 i = 0; i < n * n; i++) {
+            o.ad->data[i] = (double)(bench_rand(&rng) % 1000) / 1000.0;
+            o.bd->data[i] = (double)(bench_rand(&rng) % 1000) / 1000.0;
+            o.ai->data[i] = (i32)(bench_rand(&rng) % 2001) - 1000;
+            o.bi->data[i] = (i32)(bench_rand(&rng) % 2001) - 1000;
+            o.a8->data[i] = (i8)(bench_rand(&rng) % 256);
+            o.b8->data[i] = (i8)(bench_rand(&rng) % 256);
+            o.af->data[i] = (float)o.ad->data[i];
+            o.bf->data[i] = (float)o.bd->data[i];
+        }
+
+        for (int kind = 0; kind < 4; kind++) {
+            printf("%s %lu x %lu:\n", kinds[kind], n, n);
+            if (n <= 512) {
+                report("blocked ikj", kind, true, &o, n);
+            }
+
+            for (int level = CPU_SCALAR; level <= (int)best; level++) {
+                cpu_set_max_level((cpu_level)level);
+                report(cpu_level_name((cpu_level)level), kind, false, &o, n);
+            }
+            cpu_set_max_level(best);
+        }
+
+        matrix_destroy_double(o.ad);
+        matrix_destroy_double(o.bd);
+        matrix_destroy_double(o.cd);
+        matrix_destroy_i32(o.ai);
+        matrix_destroy_i32(o.bi);
+        matrix_destroy_i32(o.ci);
+        matrix_destroy_i8(o.a8);
+        matrix_destroy_i8(o.b8);
+        matrix_destroy_float(o.af);
+        matrix_destroy_float(o.bf);
+    }
+
+    // dot products of 1M floats: float sums vs double sums, and their error
+    u64    len = 1 << 20;
+    float* x   = malloc(sizeof(float) * len);
+    float* y   = malloc(sizeof(float) * len);
+    CHECK_FATAL(!x || !y, "malloc failed");
+
+    double exact = 0;
+    for (u64 i = 0; i < len; i++) {
+        x[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+        y[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+        exact += (double)x[i] * y[i];
+    }
+
+    printf("dot, %lu floats:\n", len);
+    for (int level = -1; level <= (int)best; level++) {
+        cpu_set_max_level(level < 0 ? best : (cpu_level)level);
+
+        double sum = 0;
+        double t   = bench_now();
+        for (int r = 0; r < 50; r++) {
+            if (level < 0) {
+                float s = 0;
+                for (u64 i = 0; i < len; i++) { s += x[i] * y[i]; }
+                sum = s;
+            } else {
+                sum = vec_f32_dot_f64(x, y, len);
+            }
+            bench_sink((u64)sum);
+        }
+        t = (bench_now() - t) / 50;
+
+        const char* name = level < 0 ? "float loop" : cpu_level_name((cpu_level)level);
+        printf("  %-14s %8.2f Gelem/s  rel err %.1e\n", name, (double)len / t / 1e9,
+               fabs(sum - exact) / exact);
+    }
+    cpu_set_max_level(best);
+
+    free(x);
+    free(y);
+    return 0;
+}
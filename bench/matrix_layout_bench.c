@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "matrix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * Packed rows (matrix_create, ld == n) vs 64 byte aligned, padded rows
+ * (matrix_create_aligned) on odd widths, where packed rows start in the
+ * middle of a cache line: gemv, gemv_T, transpose, add and xply.
+ * Best of 5, the two layouts interleaved.
+ */
+
+#define BENCH_FLOPS (1ULL << 29) // flops (or elements) per measurement
+#define TRIES       5
+
+enum { OP_GEMV, OP_GEMV_T, OP_T, OP_ADD, OP_XPLY, N_OPS };
+
+
+// m x n matrices of one layout
+typedef struct {
+    Matrix* a;
+    Matrix* b;
+    Matrix* c;
+    Matrix* t;
+    Matrix* sq; // n x n
+    Matrix* out;
+} layout;
+
+static layout make(u64 m, u64 n, b8 aligned, u64* rng)
+{
+    Matrix* (*create)(u64, u64) = aligned ? matrix_create_aligned : matrix_create;
+
+    layout l = { create(m, n), create(m, n), create(m, n), create(n, m), create(n, n), create(m, n) };
+    for (u64 i = 0; i < m; i++) {
+        for (u64 j = 0; j < n; j++) {
+            MATRIX_AT(l.a, i, j) = (float)(bench_rand(rng) % 1000) / 1000.0f;
+            MATRIX_AT(l.b, i, j) = (float)(bench_rand(rng) % 1000) / 1000.0f;
+        }
+    }
+    for (u64 i = 0; i < n; i++) {
+        for (u64 j = 0; j < n; j++) { MATRIX_AT(l.sq, i, j) = (float)(bench_rand(rng) % 1000) / 1000.0f; }
+    }
+    return l;
+}
+
+static void drop(layout* l)
+{
+    matrix_destroy(l->a);
+    matrix_destroy(l->b);
+    matrix_destroy(l->c);
+    matrix_destroy(l->t);
+    matrix_destroy(l->sq);
+    matrix_destroy(l->out);
+}
+
+// Gflop/s for the products, Gelem/s for T and add
+static double run(int op, layout* l, const float* x, float* y)
+{
+    u64 m = l->a->m, n = l->a->n;
+    u64 work = op == OP_XPLY ? 2 * m * n * n : op <= OP_GEMV_T ? 2 * m * n : m * n;
+    u64 reps = BENCH_FLOPS / work + 1;
+
+    double t0 = bench_now();
+    for (u64 r = 0; r < reps; r++) {
+        switch (op) {
+            case OP_GEMV:   matrix_gemv(y, 1, l->a, x, 0); break;
+            case OP_GEMV_T: matrix_gemv_T(y, 1, l->a, x, 0); break;
+            case OP_T:      matrix_T(l->t, l->a); break;
+            case OP_ADD:    matrix_add(l->c, l->a, l->b); break;
+            default:        matrix_xply(l->out, l->a, l->sq); break;
+        }
+    }
+    double t = bench_now() - t0;
+
+    bench_sink((u64)y[0] + (u64)MATRIX_AT(l->c, 0, 0) + (u64)MATRIX_AT(l->out, 0, 0));
+    return (double)(work * reps) / t / 1e9;
+}
+
+
+int main(void)
+{
+    u64         rng     = 12345;
+    u64         sizes[] = { 101, 250, 1001, 2001 };
+    const char* ops[]   = { "gemv", "gemv_T", "T", "add", "xply" };
+
+    printf("packed / aligned rows, square n x n (GFLOP/s, Gelem/s for T and add)\n");
+    printf("  %-8s", "n");
+    for (u32 s = 0; s < 4; s++) { printf(" %17lu", sizes[s]); }
+    printf("\n");
+
+    double res[N_OPS][4][2] = { { { 0 } } };
+
+    for (u32 s = 0; s < 4; s++) {
+        u64    n  = sizes[s];
+        float* x  = malloc(sizeof(float) * n);
+        float* y  = malloc(sizeof(float) * n);
+        CHECK_FATAL(!x || !y, "malloc failed");
+        for (u64 i = 0; i < n; i++) { x[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f; }
+
+        layout l[2] = { make(n, n, false, &rng), make(n, n, true, &rng) };
+
+        for (u32 t = 0; t < TRIES; t++) {
+            for (int op = 0; op < N_OPS; op++) {
+                for (int al = 0; al < 2; al++) {
+                    double r = run(op, &l[al], x, y);
+                    if (r > res[op][s][al]) { res[op][s][al] = r; }
+                }
+            }
+        }
+
+        drop(&l[0]);
+        drop(&l[1]);
+        free(x);
+        free(y);
+    }
+
+    for (int op = 0; op < N_OPS; op++) {
+        printf("  %-8s", ops[op]);
+        for (u32 s = 0; s < 4; s++) { printf("   %6.2f / %6.2f", res[op][s][0], res[op][s][1]); }
+        printf("\n");
+    }
+
+    return 0;
+}
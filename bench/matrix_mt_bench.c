@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "matrix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+/*
+ * matrix_xply_mt speedup from 1 to N threads (N = online cpus, at least
+ * 4 so the tiling runs on small machines too), one pool per thread count,
+ * created before the timing.
+ *
+ *   matrix_mt_bench [max n]
+ */
+
+#define MAX_N 2048
+
+
+int main(int argc, char** argv)
+{
+    u64 max_n = argc > 1 ? strtoull(argv[1], NULL, 10) : MAX_N;
+    u64 rng   = 12345;
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    u32  max  = ncpu < 4 ? 4 : (u32)ncpu;
+    printf("%ld cpus online\n", ncpu);
+
+    for (u64 n = 256; n <= max_n; n *= 2) {
+        Matrix* a   = matrix_create(n, n);
+        Matrix* b   = matrix_create(n, n);
+        Matrix* out = matrix_create(n, n);
+
+        for (u64 i = 0; i < n * n; i++) {
+            a->data[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+            b->data[i] = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+        }
+
+        printf("%lu x %lu:\n", n, n);
+        double base = 0;
+        int    reps = n <= 512 ? 10 : 2;
+
+        for (u32 t = 1; t <= max; t = t * 2 > max && t < max ? max : t * 2) {
+            thread_pool* pool = thread_pool_create(t);
+            matrix_xply_mt(out, a, b, pool); // warm up
+
+            double start = bench_now();
+            for (int r = 0; r < reps; r++) { matrix_xply_mt(out, a, b, pool); }
+            double secs = (bench_now() - start) / reps;
+
+            if (t == 1) {
+                base = secs;
+            }
+            bench_sink((u64)out->data[n + 1]);
+            printf("  %2u threads %8.2f GFLOP/s  x%.2f\n", t, 2.0 * (double)(n * n * n) / secs / 1e9,
+                   base / secs);
+
+            thread_pool_destroy(pool);
+        }
+
+        matrix_destroy(a);
+        matrix_destroy(b);
+        matrix_destroy(out);
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "vec_f32.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * The elementwise matrix kernels (vec_f32.h) at every cpu level vs the
+ * plain loops matrix.c used before, as compiled here (-O3, autovectorized
+ * for the baseline target). Sizes fit L1, L2 and main memory.
+ *
+ *   div   the old loop divides per element, the kernel scales by 1 / val
+ *   axpy  the old way is two passes: scale x in place, then add y
+ */
+
+#define TOTAL_ELEMS (1ULL << 26) // elements processed per measurement
+#define TRIES       5           // best of, interleaved across levels
+
+
+__attribute__((noinline)) static void loop_add(float* out, const float* a, const float* b, u64 n)
+{
+    for (u64 i = 0; i < n; i++) { out[i] = a[i] + b[i]; }
+}
+
+__attribute__((noinline)) static void loop_scale(float* x, float s, u64 n)
+{
+    for (u64 i = 0; i < n; i++) { x[i] *= s; }
+}
+
+__attribute__((noinline)) static void loop_div(float* x, float s, u64 n)
+{
+    for (u64 i = 0; i < n; i++) { x[i] /= s; }
+}
+
+// op: 0 add, 1 scale, 2 div, 3 axpy; level < 0 is the plain loop
+static double run(int op, int level, u64 n, float* x, float* y, float* out)
+{
+    u64 reps = TOTAL_ELEMS / n;
+
+    double t0 = bench_now();
+    for (u64 r = 0; r < reps; r++) {
+        switch (op) {
+            case 0:
+                if (level < 0) { loop_add(out, x, y, n); }
+                else { vec_f32_add(out, x, y, n); }
+                break;
+            case 1:
+                if (level < 0) { loop_scale(x, 1.0001f, n); }
+                else { vec_f32_scale(x, x, 1.0001f, n); }
+                break;
+            case 2:
+                if (level < 0) { loop_div(x, 1.0001f, n); }
+                else { vec_f32_scale(x, x, 1.0f / 1.0001f, n); }
+                break;
+            default:
+                if (level < 0) {
+                    loop_scale(x, 0.5f, n);
+                    loop_add(out, x, y, n);
+                } else {
+                    vec_f32_axpy(out, 0.5f, x, y, n);
+                }
+                break;
+        }
+    }
+    double t = bench_now() - t0;
+
+    bench_sink((u64)out[n / 2] + (u64)x[n / 3]);
+    return (double)(reps * n) / t / 1e9;
+}
+
+
+int main(void)
+{
+    u64 sizes[] = { 2048, 32 * 1024, 4 * 1024 * 1024 }; // 8 KB, 128 KB, 16 MB per array
+
+    u64    max = sizes[2];
+    float* x   = malloc(sizeof(float) * max);
+    float* y   = malloc(sizeof(float) * max);
+    float* out = malloc(sizeof(float) * max);
+    CHECK_FATAL(!x || !y || !out, "malloc failed");
+
+    u64 rng = 12345;
+    for (u64 i = 0; i < max; i++) {
+        x[i]   = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+        y[i]   = (float)(bench_rand(&rng) % 1000) / 1000.0f;
+        out[i] = 0;
+    }
+
+    const char* ops[] = { "add", "scale", "div", "axpy" };
+    cpu_level   best  = cpu_simd_level();
+
+    for (int op = 0; op < 4; op++) {
+        printf("%s (Gelem/s):\n", ops[op]);
+        printf("  %-8s", "n");
+        for (u32 s = 0; s < 3; s++) { printf(" %10lu", sizes[s]); }
+        printf("\n");
+
+        // level -1 is the plain loop; tries interleave the levels so a
+        // slow stretch of the machine doesn't land on one row
+        double rate[CPU_AVX2 + 2][3] = { { 0 } };
+        for (u32 s = 0; s < 3; s++) {
+            for (int t = 0; t < TRIES; t++) {
+                for (int level = -1; level <= (int)best; level++) {
+                    cpu_set_max_level(level < 0 ? best : (cpu_level)level);
+                    // div / scale drift x: refill so it stays in the normal range
+                    for (u64 i = 0; i < sizes[s]; i++) { x[i] = y[i]; }
+
+                    double r = run(op, level, sizes[s], x, y, out);
+                    if (r > rate[level + 1][s]) { rate[level + 1][s] = r; }
+                }
+            }
+        }
+        cpu_set_max_level(best);
+
+        for (int level = -1; level <= (int)best; level++) {
+            printf("  %-8s", level < 0 ? "loop" : cpu_level_name((cpu_level)level));
+            for (u32 s = 0; s < 3; s++) { printf(" %10.2f", rate[level + 1][s]); }
+            printf("\n");
+        }
+    }
+
+    free(x);
+    free(y);
+    free(out);
+    return 0;
+}
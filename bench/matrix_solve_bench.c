@@ -0,0 +1,131 @@
+#include "bench.h"
+#include "matrix.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * Pivoted recursive LU (matrix_LU, GEMM updates) vs the unpivoted
+ * Doolittle matrix_LU_Decomp, plus matrix_solve (one right hand side)
+ * and matrix_inv, on random dense matrices.
+ * Doolittle is skipped past 1024, it is O(n^3) dot products.
+ */
+
+
+static double best_of(int reps, double (*fn)(void*), void* arg)
+{
+    double best = 1e30;
+    for (int r = 0; r < reps; r++) {
+        double t = fn(arg);
+        best     = t < best ? t : best;
+    }
+    return best;
+}
+
+typedef struct {
+    Matrix* a;
+    Matrix* lu;
+    Matrix* l;
+    Matrix* u;
+    Matrix* b;
+    Matrix* x;
+    Matrix* inv;
+    u64*    perm;
+} bench_ctx;
+
+static double run_doolittle(void* p)
+{
+    bench_ctx* c  = p;
+    double     t0 = bench_now();
+    matrix_LU_Decomp(c->l, c->u, c->a);
+    return bench_now() - t0;
+}
+
+static double run_lu(void* p)
+{
+    bench_ctx* c  = p;
+    double     t0 = bench_now();
+    matrix_LU(c->lu, c->perm, c->a);
+    return bench_now() - t0;
+}
+
+static double run_solve(void* p)
+{
+    bench_ctx* c  = p;
+    double     t0 = bench_now();
+    matrix_solve(c->x, c->a, c->b);
+    return bench_now() - t0;
+}
+
+static double run_inv(void* p)
+{
+    bench_ctx* c  = p;
+    double     t0 = bench_now();
+    matrix_inv(c->inv, c->a);
+    return bench_now() - t0;
+}
+
+
+int main(void)
+{
+    u64 sizes[] = { 256, 512, 1024, 2048 };
+    u64 rng     = 12345;
+
+    printf("%6s %12s %12s %12s %12s %10s\n", "n", "doolittle", "LU", "solve", "inv", "residual");
+    printf("%6s %12s %12s %12s %12s\n", "", "GFLOP/s", "GFLOP/s", "ms", "GFLOP/s");
+
+    for (u32 s = 0; s < 4; s++) {
+        u64       n = sizes[s];
+        bench_ctx c = {
+            .a    = matrix_create(n, n),
+            .lu   = matrix_create(n, n),
+            .l    = matrix_create(n, n),
+            .u    = matrix_create(n, n),
+            .b    = matrix_create(n, 1),
+            .x    = matrix_create(n, 1),
+            .inv  = matrix_create(n, n),
+            .perm = malloc(sizeof(u64) * n),
+        };
+
+        for (u64 i = 0; i < n * n; i++) { c.a->data[i] = (float)(bench_rand(&rng) % 2001) / 1000.0f - 1; }
+        for (u64 i = 0; i < n; i++) { c.b->data[i] = (float)(bench_rand(&rng) % 2001) / 1000.0f - 1; }
+
+        double lu_flops = 2.0 * (double)n * n * n / 3;
+        int    reps     = n <= 512 ? 5 : 2;
+
+        double t_dl  = n <= 1024 ? best_of(1, run_doolittle, &c) : 0;
+        double t_lu  = best_of(reps, run_lu, &c);
+        double t_sol = best_of(reps, run_solve, &c);
+        double t_inv = best_of(reps, run_inv, &c);
+
+        // max |a x - b| of the solve
+        double res = 0;
+        for (u64 i = 0; i < n; i++) {
+            double sum = 0;
+            for (u64 j = 0; j < n; j++) { sum += (double)MATRIX_AT(c.a, i, j) * c.x->data[j]; }
+            double e = fabs(sum - c.b->data[i]);
+            res      = e > res ? e : res;
+        }
+
+        if (t_dl > 0) {
+            printf("%6lu %12.2f", n, lu_flops / t_dl / 1e9);
+        } else {
+            printf("%6lu %12s", n, "-");
+        }
+        printf(" %12.2f %12.2f %12.2f %10.1e\n", lu_flops / t_lu / 1e9, t_sol * 1e3,
+               2.0 * (double)n * n * n / t_inv / 1e9, res);
+
+        matrix_destroy(c.a);
+        matrix_destroy(c.lu);
+        matrix_destroy(c.l);
+        matrix_destroy(c.u);
+        matrix_destroy(c.b);
+        matrix_destroy(c.x);
+        matrix_destroy(c.inv);
+        free(c.perm);
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "bench.h"
+#include "hashmap.h"
+#include "shardmap.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+
+/*
+ * Scalability of shardmap vs one hashmap behind a global mutex
+ * (what worker threads did before shardmap existed).
+ *
+ * Every thread runs OPS_PER_THREAD operations on a shared u64 -> u64 map:
+ * READ_PCT % lookups, the rest inserts/updates, keys uniform in KEY_SPACE.
+ */
+
+#define KEY_SPACE      (1 << 16)
+#define OPS_PER_THREAD 400000
+#define READ_PCT       90
+#define MAX_THREADS    16
+
+
+typedef struct {
+    shardmap*        smap;
+    hashmap*         map;
+    pthread_mutex_t* mutex;
+    u64              seed;
+    u64              hits;
+} worker_arg;
+
+
+static void* shardmap_worker(void* p)
+{
+    worker_arg* arg  = p;
+    u64         rng  = arg->seed;
+    u64         hits = 0;
+
+    for (u64 i = 0; i < OPS_PER_THREAD; i++) {
+        u64 r   = bench_rand(&rng);
+        u64 key = r % KEY_SPACE;
+
+        if ((r >> 32) % 100 < READ_PCT) {
+            u64 val;
+            hits += shardmap_get(arg->smap, cast(key), cast(val));
+        } else {
+            shardmap_put(arg->smap, cast(key), cast(i));
+        }
+    }
+
+    arg->hits = hits;
+    return NULL;
+}
+
+
+static void* mutex_worker(void* p)
+{
+    worker_arg* arg  = p;
+    u64         rng  = arg->seed;
+    u64         hits = 0;
+
+    for (u64 i = 0; i < OPS_PER_THREAD; i++) {
+        u64 r   = bench_rand(&rng);
+        u64 key = r % KEY_SPACE;
+
+        pthread_mutex_lock(arg->mutex);
+        if ((r >> 32) % 100 < READ_PCT) {
+            u64 val;
+            hits += hashmap_get(arg->map, cast(key), cast(val));
+        } else {
+            hashmap_put(arg->map, cast(key), cast(i));
+        }
+        pthread_mutex_unlock(arg->mutex);
+    }
+
+    arg->hits = hits;
+    return NULL;
+}
+
+
+static double run(void* (*worker)(void*), worker_arg* proto, u32 n_threads)
+{
+    pthread_t  threads[MAX_THREADS];
+    worker_arg args[MAX_THREADS];
+
+    double start = bench_now();
+
+    for (u32 t = 0; t < n_threads; t++) {
+        args[t]      = *proto;
+        args[t].seed = 0x9E3779B97F4A7C15ULL * (t + 1);
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+
+    u64 hits = 0;
+    for (u32 t = 0; t < n_threads; t++) {
+        pthread_join(threads[t], NULL);
+        hits += args[t].hits;
+    }
+    bench_sink(hits);
+
+    double secs = bench_now() - start;
+    return ((double)n_threads * OPS_PER_THREAD) / secs / 1e6; // Mops/s
+}
+
+
+// pre-fill so reads mostly hit
+static void prefill(shardmap* smap, hashmap* map)
+{
+    for (u64 k = 0; k < KEY_SPACE; k += 2) {
+        shardmap_put(smap, cast(k), cast(k));
+        hashmap_put(map, cast(k), cast(k));
+    }
+}
+
+
+int main(void)
+{
+    const u32 thread_counts[] = { 1, 2, 4, 8, 16 };
+
+    printf("shardmap vs mutex+hashmap, %d%% reads, %d keys, %d ops/thread\n",
+           READ_PCT, KEY_SPACE, OPS_PER_THREAD);
+    printf("%8s %16s %16s %10s\n", "threads", "mutex (Mops/s)", "shardmap (Mops/s)", "speedup");
+
+    for (u64 i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        u32 n = thread_counts[i];
+
+        shardmap*       smap  = shardmap_create(0, sizeof(u64), sizeof(u64), NULL, NULL,
+                                                NULL, NULL, NULL, NULL, NULL, NULL);
+        hashmap*        map   = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL,
+                                               NULL, NULL, NULL, NULL, NULL, NULL);
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+        prefill(smap, map);
+
+        worker_arg proto = { .smap = smap, .map = map, .mutex = &mutex };
+
+        double mutex_mops = run(mutex_worker, &proto, n);
+        double shard_mops = run(shardmap_worker, &proto, n);
+
+        printf("%8u %16.2f %16.2f %9.2fx\n", n, mutex_mops, shard_mops, shard_mops / mutex_mops);
+
+        shardmap_destroy(smap);
+        hashmap_destroy(map);
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "bench.h"
+#include "String.h"
+#include "str_num.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Numbers into / out of a String:
+ * snprintf into a temp + string_append_cstr (what callers did before)
+ * vs string_append_u64 / string_append_f64, and strtoull / strtod on
+ * '\0' terminated copies vs string_parse_* on the buffer.
+ */
+
+#define N (2 * 1000 * 1000)
+
+
+static void report(const char* name, double secs)
+{
+    printf("  %-26s %8.2f M/s\n", name, N / secs / 1e6);
+}
+
+
+int main(void)
+{
+    u64*    ints = malloc(N * sizeof(u64));
+    double* dbls = malloc(N * sizeof(double));
+    CHECK_FATAL(!ints || !dbls, "malloc failed");
+
+    u64 rng = 12345;
+    for (u64 i = 0; i < N; i++) {
+        ints[i] = bench_rand(&rng) >> (bench_rand(&rng) % 64);
+        dbls[i] = (double)(bench_rand(&rng) % 100000000) / 1000.0; // log-style values
+    }
+
+    char   tmp[64];
+    double t;
+
+    printf("format %d numbers:\n", N);
+
+    String* a = string_create();
+    t = bench_now();
+    for (u64 i = 0; i < N; i++) {
+        snprintf(tmp, sizeof(tmp), "%lu", ints[i]);
+        string_append_cstr(a, tmp);
+        string_append_char(a, ' ');
+    }
+    report("u64 snprintf + append", bench_now() - t);
+
+    String* b = string_create();
+    t = bench_now();
+    for (u64 i = 0; i < N; i++) {
+        string_append_u64(b, ints[i]);
+        string_append_char(b, ' ');
+    }
+    report("string_append_u64", bench_now() - t);
+    printf("  same text: %d\n", string_equals(a, b));
+
+    String* c = string_create();
+    t = bench_now();
+    for (u64 i = 0; i < N; i++) {
+        snprintf(tmp, sizeof(tmp), "%.17g", dbls[i]); // %g needs 17 to round trip
+        string_append_cstr(c, tmp);
+        string_append_char(c, ' ');
+    }
+    report("f64 snprintf %.17g", bench_now() - t);
+
+    String* d = string_create();
+    t = bench_now();
+    for (u64 i = 0; i < N; i++) {
+        string_append_f64(d, dbls[i]);
+        string_append_char(d, ' ');
+    }
+    report("string_append_f64", bench_now() - t);
+    printf("  bytes: %lu (%%.17g) vs %lu (shortest)\n", string_len(c), string_len(d));
+
+
+    printf("parse them back:\n");
+
+    u64 sum = 0;
+    t = bench_now();
+    {
+        char* cstr = string_to_cstr(b); // strtoull needs the terminator
+        char* p    = cstr;
+        for (u64 i = 0; i < N; i++) {
+            sum += strtoull(p, &p, 10);
+            p++;
+        }
+        free(cstr);
+    }
+    report("strtoull", bench_now() - t);
+
+    u64 sum2 = 0;
+    u64 pos  = 0;
+    t = bench_now();
+    for (u64 i = 0; i < N; i++) {
+        u64 v;
+        pos += string_parse_u64(b, pos, &v) + 1;
+        sum2 += v;
+    }
+    report("string_parse_u64", bench_now() - t);
+    printf("  same sum: %d\n", sum == sum2);
+
+    double dsum = 0;
+    t = bench_now();
+    {
+        char* cstr = string_to_cstr(d);
+        char* p    = cstr;
+        for (u64 i = 0; i < N; i++) {
+            dsum += strtod(p, &p);
+            p++;
+        }
+        free(cstr);
+    }
+    report("strtod", bench_now() - t);
+
+    double dsum2 = 0;
+    pos          = 0;
+    t            = bench_now();
+    for (u64 i = 0; i < N; i++) {
+        double v;
+        pos += string_parse_f64(d, pos, &v) + 1;
+        dsum2 += v;
+    }
+    report("string_parse_f64", bench_now() - t);
+    printf("  same sum: %d\n", dsum == dsum2);
+
+    bench_sink(sum + (u64)dsum);
+
+    string_destroy(a);
+    string_destroy(b);
+    string_destroy(c);
+    string_destroy(d);
+    free(ints);
+    free(dbls);
+    return 0;
+}
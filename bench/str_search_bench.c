@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "str_search.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * str_search kernels at every cpu level vs the loops String used before
+ * (byte loop for find_char, memcmp at every offset for find_cstr).
+ *
+ * Haystack: HAY_SIZE bytes of random lowercase "words", the needle only
+ * occurs once, at the very end, so every search scans the whole buffer.
+ */
+
+#define HAY_SIZE (8 * 1024 * 1024)
+#define REPS     20
+
+
+static u64 old_find_char(const char* s, u64 n, char c)
+{
+    for (u64 i = 0; i < n; i++) {
+        if (s[i] == c) {
+            return i;
+        }
+    }
+    return STR_NPOS;
+}
+
+static u64 old_find(const char* s, u64 n, const char* needle, u64 m)
+{
+    for (u64 i = 0; i + m <= n; i++) {
+        if (memcmp(s + i, needle, m) == 0) {
+            return i;
+        }
+    }
+    return STR_NPOS;
+}
+
+
+static void report(const char* name, double secs, u64 result)
+{
+    double gbs = ((double)HAY_SIZE * REPS) / secs / 1e9;
+    printf("  %-22s %8.2f GB/s   (result %lu)\n", name, gbs, result);
+}
+
+
+int main(void)
+{
+    char* hay = malloc(HAY_SIZE);
+    CHECK_FATAL(!hay, "malloc failed");
+
+    u64 rng = 12345;
+    for (u64 i = 0; i < HAY_SIZE; i++) {
+        u64 r  = bench_rand(&rng) % 32;
+        hay[i] = r < 26 ? (char)('a' + r) : ' ';
+    }
+
+    const char* needle = "needle_in_the_haystack";
+    u64         m      = strlen(needle);
+    memcpy(hay + HAY_SIZE - m, needle, m);
+
+    double t;
+    u64    r = 0;
+
+    printf("haystack %d MB, %d reps\n", HAY_SIZE >> 20, REPS);
+
+    t = bench_now();
+    for (int k = 0; k < REPS; k++) { r += old_find_char(hay, HAY_SIZE, '_'); }
+    report("old find_char", bench_now() - t, r);
+
+    t = bench_now();
+    r = 0;
+    for (int k = 0; k < REPS; k++) { r += old_find(hay, HAY_SIZE, needle, m); }
+    report("old find (memcmp)", bench_now() - t, r);
+
+    cpu_level best = cpu_simd_level();
+
+    for (int level = CPU_SCALAR; level <= (int)best; level++) {
+        cpu_set_max_level((cpu_level)level);
+        printf("%s:\n", cpu_level_name((cpu_level)level));
+
+        t = bench_now();
+        r = 0;
+        for (int k = 0; k < REPS; k++) { r += str_find_char(hay, HAY_SIZE, '_'); }
+        report("find_char", bench_now() - t, r);
+
+        t = bench_now();
+        r = 0;
+        for (int k = 0; k < REPS; k++) { r += str_count_char(hay, HAY_SIZE, 'e'); }
+        report("count_char", bench_now() - t, r);
+
+        t = bench_now();
+        r = 0;
+        for (int k = 0; k < REPS; k++) { r += str_find(hay, HAY_SIZE, needle, m); }
+        report("find", bench_now() - t, r);
+    }
+
+    bench_sink(r);
+    free(hay);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "str_transform.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Lowercasing, stripping digits + punctuation, and token normalization
+ * (lowercase, keep letters only) at every cpu level vs the <ctype.h>
+ * loops they replace, on English-like text (words, spaces, some
+ * punctuation, digits and capitals).
+ */
+
+#define TEXT_SIZE (16 * 1024 * 1024)
+#define REPS      10
+
+
+static void fill(char* buf, u64 n, u64* rng)
+{
+    for (u64 i = 0; i < n; i++) {
+        u64 r  = bench_rand(rng) % 100;
+        buf[i] = r < 15 ? ' '
+               : r < 18 ? ",.;'!"[r % 5]
+               : r < 20 ? (char)('0' + r % 10)
+               : r < 24 ? (char)('A' + bench_rand(rng) % 26)
+                        : (char)('a' + bench_rand(rng) % 26);
+    }
+}
+
+static u64 ctype_lower(char* s, u64 n)
+{
+    for (u64 i = 0; i < n; i++) { s[i] = (char)tolower((u8)s[i]); }
+    return n;
+}
+
+static u64 ctype_filter(char* s, u64 n)
+{
+    u64 o = 0;
+    for (u64 i = 0; i < n; i++) {
+        if (!isdigit((u8)s[i]) && !ispunct((u8)s[i])) { s[o++] = s[i]; }
+    }
+    return o;
+}
+
+static u64 ctype_normalize(const char* s, u64 n, char* out)
+{
+    u64 o = 0;
+    for (u64 i = 0; i < n; i++) {
+        if (isalpha((u8)s[i])) { out[o++] = (char)tolower((u8)s[i]); }
+    }
+    return o;
+}
+
+static void report(const char* name, double t)
+{
+    printf("  %-16s %8.2f GB/s\n", name, (double)TEXT_SIZE * REPS / t / 1e9);
+}
+
+// op: 0 lower, 1 filter, 2 normalize; level < 0 is the ctype loop
+static double run(int op, int level, const char* text, char* work, char* out)
+{
+    u64    r = 0;
+    double t = 0;
+
+    for (int k = 0; k < REPS; k++) {
+        memcpy(work, text, TEXT_SIZE);
+
+        double t0 = bench_now();
+        switch (op) {
+            case 0:
+                if (level < 0) { r += ctype_lower(work, TEXT_SIZE); }
+                else { str_to_lower(work, TEXT_SIZE); r += (u8)work[k]; }
+                break;
+            case 1:
+                r += level < 0 ? ctype_filter(work, TEXT_SIZE)
+                               : str_filter(work, TEXT_SIZE, STR_CLASS_DIGIT | STR_CLASS_PUNCT);
+                break;
+            default:
+                r += level < 0 ? ctype_normalize(work, TEXT_SIZE, out)
+                               : str_normalize(work, TEXT_SIZE, out, 0);
+                break;
+        }
+        t += bench_now() - t0;
+    }
+
+    bench_sink(r);
+    return t;
+}
+
+
+int main(void)
+{
+    char* text = malloc(TEXT_SIZE);
+    char* work = malloc(TEXT_SIZE);
+    char* out  = malloc(TEXT_SIZE);
+    CHECK_FATAL(!text || !work || !out, "malloc failed");
+
+    u64 rng = 12345;
+    fill(text, TEXT_SIZE, &rng);
+
+    const char* ops[] = { "to_lower", "filter digit+punct", "normalize" };
+    cpu_level   best  = cpu_simd_level();
+
+    for (int op = 0; op < 3; op++) {
+        printf("%s:\n", ops[op]);
+        report("ctype", run(op, -1, text, work, out));
+
+        for (int level = CPU_SCALAR; level <= (int)best; level++) {
+            cpu_set_max_level((cpu_level)level);
+            report(cpu_level_name((cpu_level)level), run(op, level, text, work, out));
+        }
+        cpu_set_max_level(best);
+    }
+
+    free(text);
+    free(work);
+    free(out);
+    return 0;
+}
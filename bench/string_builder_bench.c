@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "rope.h"
+#include "string_builder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/*
+ * 1. assemble a large output from many small pieces:
+ *    String appends vs str_builder (heap chunks and arena chunks)
+ * 2. editor-style inserts at random positions of a large text:
+ *    string_insert_cstr (moves the tail) vs rope_insert
+ */
+
+#define PIECES      (2 * 1000 * 1000)
+#define TEXT_SIZE   (4 * 1024 * 1024)
+#define EDITS       20000
+
+
+static const char* pieces[] = { "<td>", "42", "</td>", "\n", "some longer cell contents ", "," };
+#define NPIECES (sizeof(pieces) / sizeof(pieces[0]))
+
+
+int main(void)
+{
+    double t;
+    u64    rng = 12345;
+
+    printf("append %d pieces:\n", PIECES);
+
+    t = bench_now();
+    String* s = string_create();
+    for (u64 i = 0; i < PIECES; i++) {
+        string_append_cstr(s, pieces[i % NPIECES]);
+    }
+    printf("  %-22s %8.2f ms  (len %lu)\n", "String append", (bench_now() - t) * 1e3, string_len(s));
+    string_destroy(s);
+
+    t = bench_now();
+    str_builder sb;
+    sb_init(&sb, NULL);
+    for (u64 i = 0; i < PIECES; i++) {
+        sb_append_cstr(&sb, pieces[i % NPIECES]);
+    }
+    s = sb_build(&sb);
+    printf("  %-22s %8.2f ms  (len %lu)\n", "str_builder + build", (bench_now() - t) * 1e3, string_len(s));
+    string_destroy(s);
+    sb_destroy(&sb);
+
+    Arena* arena = arena_create(nMB(32));
+    t = bench_now();
+    sb_init(&sb, arena);
+    for (u64 i = 0; i < PIECES; i++) {
+        sb_append_cstr(&sb, pieces[i % NPIECES]);
+    }
+    s = sb_build(&sb);
+    printf("  %-22s %8.2f ms  (len %lu)\n", "str_builder (arena)", (bench_now() - t) * 1e3, string_len(s));
+    string_destroy(s);
+    sb_destroy(&sb);
+    arena_release(arena);
+
+
+    printf("%d random inserts into %d MB:\n", EDITS, TEXT_SIZE >> 20);
+
+    String text;
+    string_create_stk(&text, NULL);
+    string_reserve_char(&text, TEXT_SIZE, 'x');
+
+    rope* r = rope_from_view(string_view(&text));
+
+    u64 seed = rng;
+    t = bench_now();
+    for (int k = 0; k < EDITS; k++) {
+        u64 at = bench_rand(&rng) % (string_len(&text) + 1);
+        string_insert_cstr(&text, at, "abc");
+    }
+    printf("  %-22s %8.2f ms\n", "string_insert_cstr", (bench_now() - t) * 1e3);
+
+    rng = seed;
+    t = bench_now();
+    for (int k = 0; k < EDITS; k++) {
+        u64 at = bench_rand(&rng) % (rope_len(r) + 1);
+        rope_insert_cstr(r, at, "abc");
+    }
+    printf("  %-22s %8.2f ms\n", "rope_insert_cstr", (bench_now() - t) * 1e3);
+
+    String* back = rope_to_string(r);
+    printf("  same text: %d\n", string_equals(back, &text));
+    bench_sink(string_len(back));
+
+    string_destroy(back);
+    string_destroy_stk(&text);
+    rope_destroy(r);
+
+    return 0;
+}
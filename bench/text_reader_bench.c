@@ -0,0 +1,116 @@
+#include "bench.h"
+#include "text_reader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Lines and tokens of a generated text file: fgets into a fixed buffer
+ * (+ strtok) vs text_reader, buffered and mapped.
+ * The file is written to the current directory and removed at the end.
+ */
+
+#define FILE_SIZE (64 * 1024 * 1024)
+#define BENCH_PATH "text_reader_bench.tmp"
+
+
+static void write_file(void)
+{
+    FILE* f = fopen(BENCH_PATH, "wb");
+    CHECK_FATAL(!f, "can't create " BENCH_PATH);
+
+    u64   rng = 0x9E3779B97F4A7C15ULL;
+    char* buf = malloc(FILE_SIZE);
+    CHECK_FATAL(!buf, "malloc failed");
+
+    u64 col = 0;
+    for (u64 i = 0; i < FILE_SIZE; i++) {
+        u64 r = bench_rand(&rng) % 64;
+        if (col > 20 && r == 0) {
+            buf[i] = '\n'; // ~80 char lines
+            col    = 0;
+        } else {
+            buf[i] = r < 10 ? ' ' : (char)('a' + r % 26);
+            col++;
+        }
+    }
+    fwrite(buf, 1, FILE_SIZE, f);
+    fclose(f);
+    free(buf);
+}
+
+static void report(const char* name, double t, u64 count)
+{
+    printf("  %-18s %8.2f GB/s  (%lu)\n", name, (double)FILE_SIZE / t / 1e9, count);
+}
+
+static void bench_lines(void)
+{
+    printf("lines:\n");
+
+    char  line[1024];
+    FILE* f = fopen(BENCH_PATH, "rb");
+    u64   n = 0;
+    double t = bench_now();
+    while (fgets(line, sizeof(line), f)) { n += strlen(line); }
+    report("fgets", bench_now() - t, n);
+    fclose(f);
+
+    StringView sv;
+    text_reader* r = reader_open(BENCH_PATH, 0);
+    n = 0;
+    t = bench_now();
+    while (reader_next_line(r, &sv)) { n += sv.len; }
+    report("reader", bench_now() - t, n);
+    reader_close(r);
+
+    r = reader_open_mmap(BENCH_PATH);
+    n = 0;
+    t = bench_now();
+    while (reader_next_line(r, &sv)) { n += sv.len; }
+    report("reader (mmap)", bench_now() - t, n);
+    reader_close(r);
+}
+
+static void bench_tokens(void)
+{
+    printf("tokens:\n");
+
+    char  line[1024];
+    FILE* f = fopen(BENCH_PATH, "rb");
+    u64   n = 0;
+    double t = bench_now();
+    while (fgets(line, sizeof(line), f)) {
+        for (char* tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) { n++; }
+    }
+    report("fgets + strtok", bench_now() - t, n);
+    fclose(f);
+
+    StringView sv;
+    text_reader* r = reader_open(BENCH_PATH, 0);
+    n = 0;
+    t = bench_now();
+    while (reader_next_token(r, &sv)) { n++; }
+    report("reader", bench_now() - t, n);
+    reader_close(r);
+
+    r = reader_open_mmap(BENCH_PATH);
+    n = 0;
+    t = bench_now();
+    while (reader_next_token(r, &sv)) { n++; }
+    report("reader (mmap)", bench_now() - t, n);
+    reader_close(r);
+}
+
+int main(void)
+{
+    write_file();
+
+    bench_lines();
+    bench_tokens();
+
+    remove(BENCH_PATH);
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "transpose.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Square float transposes (GB/s = bytes read + bytes written) from L2
+ * sized to memory sized: the old 16 x 16 blocked loop, transpose_f32 at
+ * every cpu level, the in-place square version, and memcpy of the same
+ * bytes as the bandwidth ceiling. Best of 5, tries interleaved.
+ */
+
+#define BENCH_BYTES (1ULL << 31) // bytes moved per measurement
+#define TRIES       5
+
+
+__attribute__((noinline)) static void blocked16(u64 m, u64 n, const float* src, float* dst)
+{
+    for (u64 i = 0; i < m; i += 16) {
+        for (u64 j = 0; j < n; j += 16) {
+            u64 i_max = (i + 16 < m) ? i + 16 : m;
+            u64 j_max = (j + 16 < n) ? j + 16 : n;
+            for (u64 ii = i; ii < i_max; ii++) {
+                for (u64 jj = j; jj < j_max; jj++) { dst[(jj * m) + ii] = src[(ii * n) + jj]; }
+            }
+        }
+    }
+}
+
+enum { MODE_MEMCPY, MODE_LOOP, MODE_INPLACE, MODE_LEVEL }; // MODE_LEVEL + level
+
+static double run(int mode, u64 n, float* src, float* dst)
+{
+    u64    bytes = 2 * sizeof(float) * n * n;
+    u64    reps  = BENCH_BYTES / bytes + 1;
+    double t0    = bench_now();
+    for (u64 r = 0; r < reps; r++) {
+        switch (mode) {
+            case MODE_MEMCPY:  memcpy(dst, src, sizeof(float) * n * n); break;
+            case MODE_LOOP:    blocked16(n, n, src, dst); break;
+            case MODE_INPLACE: transpose_square_f32(n, src, n); break;
+            default:           transpose_f32(n, n, src, n, dst, n); break;
+        }
+    }
+    double t = bench_now() - t0;
+
+    bench_sink((u64)dst[n / 2] + (u64)src[n / 3]);
+    return (double)(bytes * reps) / t / 1e9;
+}
+
+
+int main(void)
+{
+    u64       rng  = 12345;
+    cpu_level best = cpu_simd_level();
+
+    u64    sizes[] = { 256, 1024, 2048, 4096, 8192 }; // 256 KB .. 256 MB per matrix
+    u64    max     = 8192;
+    float* src     = malloc(sizeof(float) * max * max);
+    float* dst     = malloc(sizeof(float) * max * max);
+    CHECK_FATAL(!src || !dst, "malloc failed");
+    for (u64 i = 0; i < max * max; i++) { src[i] = (float)(bench_rand(&rng) % 1000); dst[i] = 0; }
+
+    int    n_modes = MODE_LEVEL + (int)best + 1;
+    double res[8][5] = { { 0 } };
+
+    for (u32 t = 0; t < TRIES; t++) {
+        for (int mode = 0; mode < n_modes; mode++) {
+            if (mode >= MODE_LEVEL) { cpu_set_max_level((cpu_level)(mode - MODE_LEVEL)); }
+            for (u32 s = 0; s < 5; s++) {
+                double g = run(mode, sizes[s], src, dst);
+                if (g > res[mode][s]) { res[mode][s] = g; }
+            }
+            cpu_set_max_level(best);
+        }
+    }
+
+    printf("square transpose (GB/s, read + write)\n  %-10s", "n");
+    for (u32 s = 0; s < 5; s++) { printf(" %8lu", sizes[s]); }
+    printf("\n");
+    for (int mode = 0; mode < n_modes; mode++) {
+        const char* name = mode == MODE_MEMCPY    ? "memcpy"
+                           : mode == MODE_LOOP    ? "block16"
+                           : mode == MODE_INPLACE ? "in place"
+                                                  : cpu_level_name((cpu_level)(mode - MODE_LEVEL));
+        printf("  %-10s", name);
+        for (u32 s = 0; s < 5; s++) { printf(" %8.2f", res[mode][s]); }
+        printf("\n");
+    }
+
+    // rectangular in place: cycle following
+    u64    rm = 3000, rn = 1000;
+    double t0 = bench_now();
+    transpose_inplace_f32(rm, rn, src);
+    printf("\nin place %lux%lu (cycles): %.2f GB/s\n", rm, rn,
+           (double)(2 * sizeof(float) * rm * rn) / (bench_now() - t0) / 1e9);
+
+    free(src);
+    free(dst);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "bench.h"
+#include "cpu_features.h"
+#include "utf8.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * utf8_valid / utf8_count at every cpu level vs a plain decode loop,
+ * on pure ASCII and on mixed text (~1/3 of the code points multi byte).
+ */
+
+#define TEXT_SIZE (16 * 1024 * 1024)
+#define REPS      10
+
+
+// decode every code point, the usual hand written check
+static b8 naive_valid(const u8* s, u64 n)
+{
+    u64 i = 0;
+    while (i < n) {
+        u32 cp;
+        u32 len = utf8_decode((const char*)s + i, n - i, &cp);
+        if (cp == UTF8_REPLACEMENT && !(len == 3 && s[i] == 0xEF)) {
+            return 0;
+        }
+        i += len;
+    }
+    return 1;
+}
+
+static void fill(char* buf, u64 n, u32 multibyte_per_8, u64* rng)
+{
+    u64 i = 0;
+    while (i + UTF8_MAX_BYTES <= n) {
+        u32 r  = (u32)(bench_rand(rng) % 8);
+        u32 cp = r < multibyte_per_8 ? 0xA0 + (u32)(bench_rand(rng) % 0x2000) // é .. ₂, 2-3 bytes
+                                     : 'a' + (u32)(bench_rand(rng) % 26);
+        if (cp >= 0xD800 && cp <= 0xDFFF) {
+            cp = 'x';
+        }
+        i += utf8_encode(cp, buf + i);
+    }
+    while (i < n) {
+        buf[i++] = ' ';
+    }
+}
+
+static void run(const char* name, const char* text)
+{
+    printf("%s:\n", name);
+
+    double t = bench_now();
+    u64    r = 0;
+    for (int k = 0; k < REPS; k++) { r += naive_valid((const u8*)text, TEXT_SIZE); }
+    printf("  %-16s %8.2f GB/s  (%lu)\n", "decode loop", (double)TEXT_SIZE * REPS / (bench_now() - t) / 1e9, r);
+
+    cpu_level best = cpu_simd_level();
+
+    for (int level = CPU_SCALAR; level <= (int)best; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        t = bench_now();
+        r = 0;
+        for (int k = 0; k < REPS; k++) { r += utf8_valid(text, TEXT_SIZE); }
+        double valid_s = bench_now() - t;
+
+        t = bench_now();
+        u64 c = 0;
+        for (int k = 0; k < REPS; k++) { c += utf8_count(text, TEXT_SIZE); }
+        double count_s = bench_now() - t;
+
+        printf("  %-16s %8.2f GB/s  (%lu)   count %8.2f GB/s (%lu)\n", cpu_level_name((cpu_level)level),
+               (double)TEXT_SIZE * REPS / valid_s / 1e9, r, (double)TEXT_SIZE * REPS / count_s / 1e9,
+               c / REPS);
+        bench_sink(c);
+    }
+
+    cpu_set_max_level(best);
+}
+
+
+int main(void)
+{
+    char* text = malloc(TEXT_SIZE);
+    CHECK_FATAL(!text, "malloc failed");
+
+    u64 rng = 12345;
+
+    fill(text, TEXT_SIZE, 0, &rng);
+    run("ascii", text);
+
+    fill(text, TEXT_SIZE, 3, &rng);
+    run("mixed", text);
+
+    free(text);
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include "bench.h"
+#include "text_reader.h"
+#include "../examples/parse.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+
+/*
+ * Word frequencies of a corpus: the single threaded fgets + strtok count
+ * from examples/parse.h vs a parallel pipeline.
+ *
+ * The parallel version maps the file, cuts it into one chunk per thread
+ * (each cut moved forward past the next delimiter so no word is split),
+ * tokenizes each chunk with a text_reader over the mapped bytes, counts
+ * into a thread local hashmap and merges the maps into the first one.
+ *
+ *   wordfreq_bench [corpus.txt]
+ *
+ * Without a path a ~64 MB corpus is generated (and removed afterwards).
+ * Counts are checked against the naive ones; fgets cuts lines longer than
+ * 511 bytes (and the words on the cut), so a corpus with such lines shows
+ * MISMATCH.
+ */
+
+#define CORPUS_SIZE (64 * 1024 * 1024)
+#define CORPUS_PATH "wordfreq_bench.tmp"
+#define VOCAB_SIZE  50000
+#define MAX_THREADS 16
+#define WORD_DELIMS " \n\t\r"
+
+
+typedef struct {
+    StringView text;
+    hashmap*   map;
+    u64        words;
+} worker_arg;
+
+
+// random lowercase words, used with a skewed (Zipf like) pick
+static char vocab[VOCAB_SIZE][16];
+
+static void write_corpus(void)
+{
+    u64 rng = 0x9E3779B97F4A7C15ULL;
+
+    for (u64 w = 0; w < VOCAB_SIZE; w++) {
+        u64 len = 2 + (bench_rand(&rng) % 10);
+        for (u64 i = 0; i < len; i++) {
+            vocab[w][i] = (char)('a' + (bench_rand(&rng) % 26));
+        }
+        vocab[w][len] = '\0';
+    }
+
+    FILE* f = fopen(CORPUS_PATH, "wb");
+    CHECK_FATAL(!f, "can't create " CORPUS_PATH);
+
+    u64 written = 0;
+    u64 col     = 0;
+    while (written < CORPUS_SIZE) {
+        u64    r = bench_rand(&rng);
+        double u = (double)(r >> 11) / (double)(1ULL << 53);
+        u64    w = (u64)(u * u * u * VOCAB_SIZE); // small ids are common
+
+        char word[32];
+        int  len = snprintf(word, sizeof(word), "%s", vocab[w]);
+
+        switch (r % 16) {
+            case 0: word[0] = (char)(word[0] - 'a' + 'A'); break;        // Capital
+            case 1: len += snprintf(word + len, 8, "'s"); break;         // possessive
+            case 2: len += snprintf(word + len, 8, ","); break;          // punctuation
+            case 3: len = snprintf(word, sizeof(word), "%lu", r % 1000); // number, dropped
+                break;
+            default: break;
+        }
+
+        col += (u64)len + 1;
+        b8 eol = col > 72;
+        if (eol) {
+            col = 0;
+        }
+
+        fwrite(word, 1, (u64)len, f);
+        fputc(eol ? '\n' : ' ', f);
+        written += (u64)len + 1;
+    }
+
+    fclose(f);
+}
+
+
+static void* count_worker(void* p)
+{
+    worker_arg*  arg = p;
+    text_reader* r   = reader_from_view(arg->text);
+    reader_set_delims(r, WORD_DELIMS);
+
+    char       cleaned[256];
+    StringView tok;
+    u64        words = 0;
+
+    while (reader_next_token(r, &tok)) {
+        if (clean_word(tok.data, tok.len, cleaned, sizeof(cleaned))) {
+            StringView word  = { cleaned, strlen(cleaned) };
+            int*       count = (int*)hashmap_find_or_insert(arg->map, murmurhash3_view(word), &word,
+                                                            str_view_eq, str_view_make, NULL);
+            (*count)++;
+            words++;
+        }
+    }
+
+    reader_close(r);
+    arg->words = words;
+    return NULL;
+}
+
+
+// add the counts of src into dst
+static void merge_into(hashmap* dst, const hashmap* src)
+{
+    hashmap_iter it = hashmap_iter_begin(src);
+    const u8*    key;
+    u8*          val;
+
+    while (hashmap_iter_next(&it, &key, &val)) {
+        StringView word  = string_view((const String*)key);
+        int*       count = (int*)hashmap_find_or_insert(dst, murmurhash3_view(word), &word,
+                                                        str_view_eq, str_view_make, NULL);
+        *count += *(const int*)val;
+    }
+}
+
+
+// @return total words, the merged counts are left in *out (caller destroys)
+static u64 count_parallel(StringView text, u32 nthreads, hashmap** out)
+{
+    pthread_t  threads[MAX_THREADS];
+    worker_arg args[MAX_THREADS];
+
+    u64 start = 0;
+    for (u32 t = 0; t < nthreads; t++) {
+        u64 end = t + 1 == nthreads ? text.len : text.len / nthreads * (t + 1);
+        if (end < start) {
+            end = start;
+        }
+        while (end < text.len && !strchr(WORD_DELIMS, text.data[end])) {
+            end++;
+        }
+
+        args[t] = (worker_arg){ { text.data + start, end - start }, word_map_create(), 0 };
+        start   = end;
+
+        CHECK_FATAL(pthread_create(&threads[t], NULL, count_worker, &args[t]) != 0,
+                    "pthread_create failed");
+    }
+
+    u64 words = 0;
+    for (u32 t = 0; t < nthreads; t++) {
+        pthread_join(threads[t], NULL);
+        words += args[t].words;
+    }
+
+    for (u32 t = 1; t < nthreads; t++) {
+        merge_into(args[0].map, args[t].map);
+        hashmap_destroy(args[t].map);
+    }
+
+    *out = args[0].map;
+    return words;
+}
+
+
+// every naive count must match
+static u64 count_mismatches(const hashmap* naive, const hashmap* par)
+{
+    u64 fails = hashmap_size(naive) != hashmap_size(par);
+
+    hashmap_iter it = hashmap_iter_begin(naive);
+    const u8*    key;
+    u8*          val;
+
+    while (hashmap_iter_next(&it, &key, &val)) {
+        StringView word  = string_view((const String*)key);
+        const int* count = (const int*)hashmap_get_hashed(par, murmurhash3_view(word), &word,
+                                                          str_view_eq);
+        fails += !count || *count != *(const int*)val;
+    }
+
+    return fails;
+}
+
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 ? argv[1] : CORPUS_PATH;
+    if (argc <= 1) {
+        write_corpus();
+    }
+
+    // naive: parse.h
+    FILE* f = fopen(path, "re");
+    CHECK_FATAL(!f, "can't open corpus");
+
+    hashmap* naive = word_map_create();
+    double   t     = bench_now();
+    u64      total = count_words(f, naive);
+    double   base  = bench_now() - t;
+    fclose(f);
+
+    printf("%lu words, %lu unique, %ld cpus online\n", total, hashmap_size(naive),
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  %-22s %8.1f M words/s\n", "fgets + strtok (1)", (double)total / base / 1e6);
+
+    text_reader* r = reader_open_mmap(path);
+    CHECK_FATAL(!r, "can't map corpus");
+    StringView text = { r->buf, r->end };
+
+    // at least 4 threads, so the split / merge runs even on a small machine
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    u32  max  = ncpu < 4 ? 4 : ncpu > MAX_THREADS ? MAX_THREADS : (u32)ncpu;
+
+    for (u32 nthreads = 1; nthreads <= max; nthreads = nthreads * 2 > max && nthreads < max ? max : nthreads * 2) {
+        hashmap* par;
+        t            = bench_now();
+        u64 words    = count_parallel(text, nthreads, &par);
+        double  secs = bench_now() - t;
+
+        u64 fails = (words != total) + count_mismatches(naive, par);
+        hashmap_destroy(par);
+
+        char name[32];
+        snprintf(name, sizeof(name), "mmap + reader (%u)", nthreads);
+        printf("  %-22s %8.1f M words/s  x%.1f%s\n", name, (double)words / secs / 1e6, base / secs,
+               fails ? "  MISMATCH" : "");
+    }
+
+    reader_close(r);
+    hashmap_destroy(naive);
+
+    if (argc <= 1) {
+        remove(CORPUS_PATH);
+    }
+    return 0;
+}
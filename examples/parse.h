@@ -5,6 +5,9 @@
 #include "hashmap.h"
 #include "String.h"
 #include "str_setup.h"
+#include "str_search.h"
+#include "str_transform.h"
+#include "utf8.h"
 
 #include <ctype.h>
 #include <stdbool.h>
@@ -12,11 +15,36 @@
 #include <string.h>
 
 
+// width in bytes of an apostrophe at token[i]: ASCII ' or U+2019 (right single
+// quote, curly), 0 if there is none
+static u32 apostrophe_at(const char* token, u64 len, u64 i)
+{
+    if (token[i] == '\'') {
+        return 1;
+    }
+    if ((u8)token[i] != 0xE2) { // not the lead byte of U+2019
+        return 0;
+    }
+
+    u32 cp;
+    u32 width = utf8_decode(token + i, len - i, &cp);
+    return cp == 0x2019 ? width : 0;
+}
+
+
 // Helper function to clean and normalize a word - removes numbers and handles contractions
-char* clean_word(const char* token, char* output, u32 output_size) {
+// token is len bytes (no '\0' needed), output is '\0' terminated
+static char* clean_word(const char* token, u64 len, char* output, u32 output_size) {
     if (!token || !output || output_size == 0) { return NULL; }
+
+    // no apostrophe (' or the lead byte of U+2019): the word is just its
+    // letters, lowercased - one SIMD pass
+    if (len < output_size && str_find_any(token, len, "'\xE2", 2) == STR_NPOS) {
+        u64 n = str_normalize(token, len, output, 0);
+        output[n] = '\0';
+        return n > 0 ? output : NULL;
+    }
     
-    u64 len = strlen(token);
     u32 out_idx = 0;
     bool has_letters = false;
     
@@ -29,23 +57,18 @@ char* clean_word(const char* token, char* output, u32 output_size) {
         }
         
         // Handle apostrophes (both ASCII ' and UTF-8 curly quotes)
-        // UTF-8 right single quote is E2 80 99
-        if (c == '\'' || (c == 0xE2 && i + 2 < len && 
-                          (unsigned char)token[i+1] == 0x80 && 
-                          (unsigned char)token[i+2] == 0x99)) {
+        u32 width = apostrophe_at(token, len, i);
+        if (width != 0) {
             
-            // If it's a UTF-8 curly quote, skip the 3-byte sequence
-            u64 next_pos = i + 1;
-            if (c == 0xE2) {
-                i += 2; // Skip the remaining bytes of UTF-8 sequence
-                next_pos = i + 1;
-            }
+            // skip the whole sequence (3 bytes for the curly quote)
+            u64 next_pos = i + width;
+            i += width - 1;
             
             // Check what comes after the apostrophe
             bool has_letter_after = false;
             bool is_possessive = false;
             
-            for (u32 j = next_pos; j < len; j++) {
+            for (u64 j = next_pos; j < len; j++) {
                 unsigned char next = (unsigned char)token[j];
                 if (isalpha(next)) {
                     has_letter_after = true;
@@ -66,9 +89,11 @@ char* clean_word(const char* token, char* output, u32 output_size) {
                     break;
                 }
                 // Skip over more apostrophes/quotes
-                if (next != '\'' && next != 0xE2) {
+                u32 w = apostrophe_at(token, len, j);
+                if (w == 0) {
                     break;
                 }
+                j += w - 1;
             }
             
             // Keep apostrophe if we have letters before AND after, but NOT if it's possessive
@@ -93,69 +118,86 @@ char* clean_word(const char* token, char* output, u32 output_size) {
 }
 
 
-int parse(void)
+// stored keys are String by value
+static void word_del(u8* elm)
 {
-    hashmap* map = hashmap_create(sizeof(String), sizeof(int), 
-                                 murmurhash3_string, string_custom_delete, 
-                                 NULL, string_custom_compare);
+    string_destroy_stk((String*)elm);
+}
 
+static int word_cmp(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    return string_compare((const String*)a, (const String*)b);
+}
+
+
+static hashmap* word_map_create(void)
+{
+    return hashmap_create(sizeof(String), sizeof(int), murmurhash3_str, word_cmp,
+                          NULL, NULL, NULL, NULL, word_del, NULL);
+}
+
+
+// single threaded word count: fgets + strtok + clean_word, the baseline
+// for bench/wordfreq_bench.c. @return total words counted into map
+static u64 count_words(FILE* f, hashmap* map)
+{
     // Basic delimiters - we'll handle punctuation more carefully
     const char* delim = " \n\t\r";
-    
-    FILE* f = fopen("../shakespeare.txt", "re");
-    if (!f) {
-        printf("error opening file\n");
-        hashmap_destroy(map);
-        return -1;
-    }
 
     char line[512];
     char cleaned[256];
-    u32 total_words = 0;
+    u64 total_words = 0;
     
     while (fgets(line, sizeof(line), f)) {
         char* token = strtok(line, delim);
         while (token) {
-            if (strlen(token) > 0) {
-                // Clean and normalize the word
-                if (clean_word(token, cleaned, sizeof(cleaned))) 
-                {
-                    printf("%s\t", cleaned);
-                    String str;
-                    string_create_onstk(&str, cleaned);
-                    int count;
-                    if (hashmap_get(map, (u8*)&str, (u8*)&count) == 0) {
-                        count++;
-                    }
-                    else {
-                        count = 1;
-                    }
-                    hashmap_put(map, (u8*)&str, (u8*)&count);
-                    //hashmap now owns the string buffer so don't delete
-                                        
-                    total_words++;
-                }
+            // Clean and normalize the word
+            if (clean_word(token, strlen(token), cleaned, sizeof(cleaned))) 
+            {
+                // hash once, one probe; a String is only built for new words
+                StringView word = { cleaned, strlen(cleaned) };
+                int* count = (int*)hashmap_find_or_insert(map, murmurhash3_view(word), &word,
+                                                          str_view_eq, str_view_make, NULL);
+                (*count)++; // new entries start at 0
+                                    
+                total_words++;
             }
             token = strtok(NULL, delim);
         }
     }
-    
+
+    return total_words;
+}
+
+
+int parse(void)
+{
+    hashmap* map = word_map_create();
+
+    FILE* f = fopen("../shakespeare.txt", "re");
+    if (!f) {
+        printf("error opening file\n");
+        hashmap_destroy(map);
+        return -1;
+    }
+
+    u64 total_words = count_words(f, map);
 
     // Print summary
     printf("\nTotal words processed: %lu\n", total_words);
-    printf("Unique words: %lu\n\n", map->size);
+    printf("Unique words: %lu\n\n", hashmap_size(map));
 
-    String str;
-    string_create_onstk(&str, "gay");
-    int count;
-    if (hashmap_get(map, (u8*)&str, (u8*)&count) == 0) {
-        printf("Count of %s : %d", string_to_cstr(&str), count);
+    StringView query = { "gay", 3 };
+    const int* count = (const int*)hashmap_get_hashed(map, murmurhash3_view(query), &query,
+                                                      str_view_eq);
+    if (count) {
+        printf("Count of %.*s : %d", (int)query.len, query.data, *count);
     }
     else {
         printf("not found\n");
     }
 
-    string_destroy_fromstk(&str);
     hashmap_destroy(map);    
     printf("\n");
     return fclose(f);
@@ -2,33 +2,71 @@
 #define STRING_H
 
 
+#include "common.h"
 #include "gen_vector.h"
+#include "serialize.h"
 
 
 // ===== STRING =====
-// the string is just a genVec of char type (length based string - not cstr)
-typedef genVec String;
+// length based string (not cstr) with small string optimization:
+// up to STRING_SSO_CAP chars are stored inside the struct itself,
+// longer strings spill to a heap buffer.
+// Note: the inline buffer moves with the struct, so string_data_ptr
+// is only valid while the String itself stays where it is.
+
+#define STRING_SSO_CAP 23 // max chars stored inline
+
+#ifndef STRING_GROWTH
+#define STRING_GROWTH 1.5F // heap capacity multiplier
+#endif
+
+typedef struct {
+    union {
+        struct {
+            char* data;
+            u64   size;
+            u64   capacity;
+        } heap;
+        struct {
+            char data[STRING_SSO_CAP];
+            u8   size;
+        } sso;
+    };
+    u8 is_heap;
+} String;
 // ==================
 
+// non-owning view of chars (not null terminated)
+typedef struct {
+    const char* data;
+    u64         len;
+} StringView;
+
 
 // Construction/Destruction
 
 // create string on the heap
 String* string_create(void);
 
-// create string with struct on the stack and data on heap
+// create string with struct on the stack (data inline or on heap)
 void string_create_stk(String* str, const char* cstr);
 
+// create string with struct on the stack from a view (len bytes are copied)
+void string_create_stk_view(String* str, StringView sv);
+
 // create string on heap from a cstr
 String* string_from_cstr(const char* cstr);
 
+// create string on heap from a view
+String* string_from_view(StringView sv);
+
 // get copy of a string (heap allocated)
 String* string_from_string(const String* other);
 
-// reserve a capacity for a string (must be greater than current cap)
+// reserve a capacity for a string (no op if not greater than current cap)
 void string_reserve(String* str, u64 capacity);
 
-// reserve a capacity with a char
+// grow to capacity chars, filling the new chars with c (len = capacity)
 void string_reserve_char(String* str, u64 capacity, char c);
 
 // destroy the heap allocated string
@@ -47,7 +85,7 @@ void string_copy(String* dest, const String* src);
 // get cstr as COPY ('\0' present)
 // cstr is MALLOCED and must be freed by user
 char* string_to_cstr(const String* str);
-// get ptr to the cstr buffer
+// get ptr to the chars (inline or heap buffer)
 // Note: NO NULL TERMINATOR
 char* string_data_ptr(const String* str);
 
@@ -81,6 +119,14 @@ void string_insert_cstr(String* str, u64 i, const char* cstr);
 // insert a string "str" at index i
 void string_insert_string(String* str, u64 i, const String* other);
 
+// append the decimal text of a number, written straight into the buffer
+// (see str_num.h)
+void string_append_u64(String* str, u64 val);
+void string_append_i64(String* str, i64 val);
+
+// shortest text that parses back to the same double (1.0, 0.1, 1e-05)
+void string_append_f64(String* str, double val);
+
 // remove char from end of a string
 char string_pop_char(String* str);
 
@@ -124,16 +170,64 @@ u64 string_find_char(const String* str, char c);
 // return index of cstr "substr" (UINT_MAX otherwise)
 u64 string_find_cstr(const String* str, const char* substr);
 
+// number of occurrences of c
+u64 string_count_char(const String* str, char c);
+
+// append the index (u64) of every (overlapping) match of substr to out
+// return number of matches
+u64 string_find_all(const String* str, const char* substr, genVec* out);
+
+// (search is SIMD accelerated, see str_search.h)
+
 // Set a heap allocated string of a substring starting at index "start", upto length
 String* string_substr(const String* str, u64 start, u64 length);
 
-// TODO: pass a buffer version of substr??
+// same substring as a view into str, nothing allocated (see string_view.h)
+StringView string_substr_view(const String* str, u64 start, u64 length);
+
+// UTF-8 (see utf8.h, the chars themselves are plain bytes)
+
+// true if the chars are valid UTF-8 (SIMD)
+b8 string_is_utf8(const String* str);
+
+// number of code points (str must be valid UTF-8)
+u64 string_utf8_len(const String* str);
+
+// append code point cp encoded as UTF-8
+void string_append_utf8(String* str, u32 cp);
+
+// Case / character classes (ASCII, SIMD, see str_transform.h)
+
+void string_to_lower(String* str);
+void string_to_upper(String* str);
+
+// remove the chars whose str_class is in drop, e.g. STR_CLASS_DIGIT
+void string_filter(String* str, u32 drop);
+
+// Parsing
+
+// parse the number starting at index i into out, no whitespace skipped
+// return number of chars read, 0 if there is no number at i (or it overflows)
+u64 string_parse_u64(const String* str, u64 i, u64* out);
+u64 string_parse_i64(const String* str, u64 i, i64* out);
+u64 string_parse_f64(const String* str, u64 i, double* out);
 
 // I/O
 
 // print the content of str
 void string_print(const String* str);
 
+// write str to f (header + length + bytes)
+b8 string_write(const String* str, FILE* f);
+
+// read a string written by string_write and APPEND it to str
+b8 string_read(String* str, FILE* f);
+
+// element callbacks for containers that store String by value
+// (length + bytes, no header). read constructs a new String in elm
+b8 string_ser_write(FILE* f, const u8* elm);
+b8 string_ser_read(FILE* f, u8* elm);
+
 // Basic properties
 
 // get the current length of the string
@@ -141,13 +235,13 @@ static inline u64 string_len(const String* str)
 {
     CHECK_FATAL(!str, "str is null");
 
-    return str->size;
+    return str->is_heap ? str->heap.size : str->sso.size;
 }
 
-// get the capacity of the genVec container of string
+// get the capacity (STRING_SSO_CAP while stored inline)
 static inline u64 string_capacity(const String* str)
 {
-    return str->capacity;
+    return str->is_heap ? str->heap.capacity : STRING_SSO_CAP;
 }
 
 // return true if str is empty
@@ -156,6 +250,18 @@ static inline b8 string_empty(const String* str)
     return string_len(str) == 0;
 }
 
+// return true if chars are stored inside the struct
+static inline b8 string_is_inline(const String* str)
+{
+    return !str->is_heap;
+}
+
+// view of the current chars (invalidated by any modification of str)
+static inline StringView string_view(const String* str)
+{
+    return (StringView){ string_data_ptr(str), string_len(str) };
+}
+
 // TODO: test
 /*
  macro to create a temporary cstr for read ops
@@ -171,57 +277,27 @@ TEMP_CSTR_READ(s)
     for (u8 _once = 0; (_once == 0) && (string_append_char((str), '\0'), 1); _once++, string_pop_char((str)))
 
 
-// TODO: Remove genVec dependency ?
-// TODO: string view?
 /* TODO: 
- 
-// Split string by delimiter
-String** string_split(const String* str, char delim, u32* out_count);
+ (split / trim / starts_with / ends_with: use the views in string_view.h)
 
 // Join array of strings
 String* string_join(String** strings, u32 count, const char* sep);
 
-// Trim whitespace
-void string_trim(String* str);
-void string_trim_left(String* str);
-void string_trim_right(String* str);
-
-// Case conversion
-void string_to_upper(String* str);
-void string_to_lower(String* str);
-
 // Replace substring
 u32 string_replace(String* str, const char* old, const char* new);
 
-// Format string (like sprintf)
+// Format string (like sprintf, numbers: string_append_u64/i64/f64)
 void string_format(String* str, const char* fmt, ...);
 String* string_format_new(const char* fmt, ...);
 
 // Reverse string
 void string_reverse(String* str);
 
-// Check if starts/ends with
-b8 string_starts_with(const String* str, const char* prefix);
-b8 string_ends_with(const String* str, const char* suffix);
-
 // Contains substring
 b8 string_contains(const String* str, const char* substr);
 
-// Count occurrences
-u32 string_count_char(const String* str, char c);
-
 // Repeat string
 String* string_repeat(const String* str, u32 times);
 */
 
-/*
-string view:
-
-typedef struct {
-    const char* data;
-    u64 len;
-} StringView;
-
-*/
-
 #endif // STRING_H
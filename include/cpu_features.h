@@ -0,0 +1,54 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Runtime CPU feature detection for the SIMD kernels.
+ * The library is built for the baseline target (no -mavx2); kernels for
+ * newer instruction sets are compiled per function with
+ * __attribute__((target(...))) and picked at runtime from cpu_simd_level().
+ *
+ * cpu_set_max_level caps the level, so tests and benchmarks can run
+ * every path on the same machine.
+ */
+
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+
+typedef enum {
+    CPU_SCALAR = 0,
+    CPU_SSE2   = 1,
+    CPU_AVX2   = 2, // AVX2 + FMA
+} cpu_level;
+
+
+typedef struct {
+    b8 sse2;
+    b8 sse42;
+    b8 avx;
+    b8 avx2;
+    b8 fma;
+    b8 avx512f;
+} cpu_features;
+
+
+// detected once, cached (safe to call from any thread)
+const cpu_features* cpu_get_features(void);
+
+// best usable level, min(detected, max level set by cpu_set_max_level)
+cpu_level cpu_simd_level(void);
+
+// cap the level used by all kernels (CPU_AVX2 = no cap)
+void cpu_set_max_level(cpu_level level);
+
+const char* cpu_level_name(cpu_level level);
+
+
+#endif // CPU_FEATURES_H
@@ -0,0 +1,78 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "common.h"
+#include "thread_pool.h"
+
+
+/*          TLDR
+ * Single precision GEMM on raw row major buffers, used by matrix_xply:
+ *
+ *   C = alpha * A * B + beta * C       A: m x k, B: k x n, C: m x n
+ *
+ * Structured like BLIS / GotoBLAS. The loops around the micro-kernel cut
+ * B into GEMM_KC x GEMM_NC blocks (packed once, reused from L3) and A
+ * into GEMM_MC x GEMM_KC blocks (packed, reused from L2). The packed
+ * panels are read contiguously by a micro-kernel that keeps an MR x NR
+ * tile of C in registers for the whole GEMM_KC loop:
+ *
+ *   AVX2 + FMA  6 x 16  (12 ymm accumulators)
+ *   SSE2        6 x 8   (12 xmm accumulators)
+ *   scalar      6 x 8
+ *
+ * Edge tiles run the same kernel into a scratch tile. Small products
+ * (below GEMM_SMALL flops) skip packing and use a blocked ikj loop.
+ * The level comes from cpu_simd_level() (cpu_features.h).
+ *
+ * gemm_f32_mt runs the same loops over a thread_pool: for every packed
+ * B block the threads first pack B and the slice of A together, then
+ * each takes tiles of C (an A row block x a column chunk, about
+ * GEMM_MT_TASKS tiles per thread) from the shared packed panels.
+ * Tiles don't overlap, so C needs no locking.
+ */
+
+
+// blocking parameters (floats), tuned for 32 KB L1d / 256 KB+ L2
+#ifndef GEMM_KC
+#define GEMM_KC 256 // depth: a 16 wide B micro-panel is 16 KB (L1)
+#endif
+#ifndef GEMM_MC
+#define GEMM_MC 144 // rows of packed A: 144 KB (L2), a multiple of 6
+#endif
+#ifndef GEMM_NC
+#define GEMM_NC 4080 // cols of packed B: ~4 MB (L3), a multiple of 16
+#endif
+
+#define GEMM_SMALL (32 * 32 * 32) // m * n * k below this: no packing
+
+#ifndef GEMM_MT_MIN
+#define GEMM_MT_MIN (128 * 128 * 128) // m * n * k below this: one thread
+#endif
+#define GEMM_MT_TASKS 4 // tiles per thread, for load balance
+
+
+/**
+ * C = alpha * A * B + beta * C, row major with leading dimensions
+ * (lda >= k, ldb >= n, ldc >= n). With beta == 0, C is only written
+ * (it may hold NaNs). C may NOT alias A or B.
+ */
+void gemm_f32(u64 m, u64 n, u64 k, float alpha, const float* a, u64 lda, const float* b,
+              u64 ldb, float beta, float* c, u64 ldc);
+
+/**
+ * gemm_f32 with A and B read through (row stride, col stride):
+ * A(i, p) = a[i * rsa + p * csa], B(p, j) = b[p * rsb + j * csb]
+ * A transposed operand is the same buffer with the strides swapped.
+ */
+void gemm_f32_strided(u64 m, u64 n, u64 k, float alpha, const float* a, u64 rsa, u64 csa,
+                      const float* b, u64 rsb, u64 csb, float beta, float* c, u64 ldc);
+
+/**
+ * gemm_f32 split over the threads of pool
+ * Runs on the calling thread alone below GEMM_MT_MIN or with a pool of 1
+ */
+void gemm_f32_mt(u64 m, u64 n, u64 k, float alpha, const float* a, u64 lda, const float* b,
+                 u64 ldb, float beta, float* c, u64 ldc, thread_pool* pool);
+
+
+#endif // GEMM_H
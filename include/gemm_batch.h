@@ -0,0 +1,61 @@
+#ifndef GEMM_BATCH_H
+#define GEMM_BATCH_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Many small products at once (4x4 .. 32x32, thousands of them):
+ *
+ *   c_t = a_t * b_t      for t in [0, batch)
+ *
+ * Packing and micro-kernels (gemm.h) don't pay off at these sizes, and
+ * one matrix is too small to fill a vector register well. Instead the
+ * matrices are stored interleaved in packs of GEMM_BATCH_LANES: element
+ * e of the 8 matrices of a pack is one contiguous vector,
+ *
+ *   data[(t / 8) * elems * 8 + e * 8 + t % 8]      e = i * cols + j
+ *
+ * so each SIMD lane works on its own matrix and every load is a full
+ * vector. A pack of 32x32 matrices is 32 KB, read front to back.
+ * (Interleaving the whole batch instead puts the elements batch floats
+ * apart: with a power of 2 batch they all fall in the same L1 sets.)
+ * The AVX2 kernel keeps a 2 x 4 tile of c for the 8 matrices in
+ * registers, SSE2 the same tile for each half of the pack.
+ *
+ * The last pack is padded up to 8 matrices, see gemm_batch_size.
+ * gemm_batch_interleave / gemm_batch_deinterleave convert from and to
+ * the usual layout (matrix after matrix, each row major).
+ */
+
+
+#define GEMM_BATCH_LANES 8 // matrices per pack
+
+// element e of matrix t in an interleaved buffer of elems-float matrices
+#define GEMM_BATCH_AT(data, elems, e, t)                                                    \
+    ((data)[(((t) / GEMM_BATCH_LANES) * (elems) * GEMM_BATCH_LANES) + ((e) * GEMM_BATCH_LANES) + \
+            ((t) % GEMM_BATCH_LANES)])
+
+
+// floats in an interleaved buffer of batch matrices of elems floats (padded)
+static inline u64 gemm_batch_size(u64 batch, u64 elems)
+{
+    return (batch + GEMM_BATCH_LANES - 1) / GEMM_BATCH_LANES * GEMM_BATCH_LANES * elems;
+}
+
+/**
+ * c_t = a_t * b_t for every t, all three interleaved (gemm_batch_size floats)
+ * a: m x k, b: k x n, c: m x n (per matrix), c may NOT alias a or b
+ * The padding lanes of the last pack are computed too (garbage in, garbage out)
+ */
+void gemm_f32_batched(u64 batch, u64 m, u64 n, u64 k, const float* a, const float* b, float* c);
+
+// src: batch matrices of elems floats one after another -> dst interleaved
+// (the padding lanes of dst are set to 0)
+void gemm_batch_interleave(float* dst, const float* src, u64 batch, u64 elems);
+
+// dst: batch matrices of elems floats one after another <- src interleaved
+void gemm_batch_deinterleave(float* dst, const float* src, u64 batch, u64 elems);
+
+
+#endif // GEMM_BATCH_H
@@ -0,0 +1,63 @@
+#ifndef GEMM_F64_H
+#define GEMM_F64_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Double precision GEMM on raw row major buffers, used by the double
+ * matrices of matrix_generic.h and by lu.h:
+ *
+ *   C = alpha * A * B + beta * C       A: m x k, B: k x n, C: m x n
+ *
+ * The same loops as gemm.h (packed B blocks in L3, packed A blocks in
+ * L2, an MR x NR tile of C in registers), with half as many doubles per
+ * vector:
+ *
+ *   AVX2 + FMA  6 x 8  (12 ymm accumulators)
+ *   SSE2        6 x 4  (12 xmm accumulators)
+ *   scalar      6 x 4
+ *
+ * gemm_f32_f64 takes float A and B and accumulates into a double C: the
+ * floats are widened while packing, so the products are exact and only
+ * the sums round (in double). For accuracy critical float products.
+ */
+
+
+// blocking parameters (doubles), same byte budgets as GEMM_KC / MC / NC
+#ifndef GEMM_F64_KC
+#define GEMM_F64_KC 256 // depth: an 8 wide B micro-panel is 16 KB (L1)
+#endif
+#ifndef GEMM_F64_MC
+#define GEMM_F64_MC 72 // rows of packed A: 144 KB (L2), a multiple of 6
+#endif
+#ifndef GEMM_F64_NC
+#define GEMM_F64_NC 2040 // cols of packed B: ~4 MB (L3), a multiple of 8
+#endif
+
+#define GEMM_F64_SMALL (32 * 32 * 32) // m * n * k below this: no packing
+
+
+/**
+ * C = alpha * A * B + beta * C, row major with leading dimensions
+ * (lda >= k, ldb >= n, ldc >= n). With beta == 0, C is only written
+ * (it may hold NaNs). C may NOT alias A or B.
+ */
+void gemm_f64(u64 m, u64 n, u64 k, double alpha, const double* a, u64 lda, const double* b,
+              u64 ldb, double beta, double* c, u64 ldc);
+
+/**
+ * gemm_f64 with A and B read through (row stride, col stride):
+ * A(i, p) = a[i * rsa + p * csa], B(p, j) = b[p * rsb + j * csb]
+ */
+void gemm_f64_strided(u64 m, u64 n, u64 k, double alpha, const double* a, u64 rsa, u64 csa,
+                      const double* b, u64 rsb, u64 csb, double beta, double* c, u64 ldc);
+
+/**
+ * C = alpha * A * B + beta * C with float A and B, accumulated in double
+ */
+void gemm_f32_f64(u64 m, u64 n, u64 k, double alpha, const float* a, u64 lda, const float* b,
+                  u64 ldb, double beta, double* c, u64 ldc);
+
+
+#endif // GEMM_F64_H
@@ -0,0 +1,55 @@
+#ifndef GEMM_INT_H
+#define GEMM_INT_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Integer GEMM with int32 accumulation on raw row major buffers, for
+ * quantized workloads and the integer matrices of matrix_generic.h:
+ *
+ *   gemm_i8   C = A * B     A, B int8,  C int32
+ *   gemm_i32  C = A * B     A, B int32, C int32
+ *
+ * The same loops as gemm.h, packed into 32 bit words either way:
+ *
+ *   int8   a word holds two consecutive k of a row / column as int16,
+ *          so one madd_epi16 does two multiply-adds per lane
+ *            AVX2  6 x 16 (12 ymm accumulators)
+ *            SSE2  6 x 8  (12 xmm accumulators)
+ *   int32  one k per word, mullo_epi32 + add on AVX2, SSE2 builds the
+ *          low half of the products from two mul_epu32
+ *
+ * A scalar 6 x 8 kernel covers the rest. The int32 sums wrap on
+ * overflow (int8: only past ~131k terms of -128 * -128), never trap.
+ */
+
+
+// blocking parameters, in packed words (4 bytes) like GEMM_KC / MC / NC
+#ifndef GEMM_INT_KC
+#define GEMM_INT_KC 256 // depth in words (512 k for int8): 16 KB B micro-panel
+#endif
+#ifndef GEMM_INT_MC
+#define GEMM_INT_MC 144 // rows of packed A, a multiple of 6
+#endif
+#ifndef GEMM_INT_NC
+#define GEMM_INT_NC 4080 // cols of packed B, a multiple of 16
+#endif
+
+#define GEMM_INT_SMALL (32 * 32 * 32) // m * n * k below this: no packing
+
+
+/**
+ * C = A * B, int8 inputs accumulated in int32, row major with leading
+ * dimensions (lda >= k, ldb >= n, ldc >= n). C is only written.
+ */
+void gemm_i8(u64 m, u64 n, u64 k, const i8* a, u64 lda, const i8* b, u64 ldb, i32* c, u64 ldc);
+
+/**
+ * C = A * B in int32 (wrapping), same layout rules as gemm_i8
+ */
+void gemm_i32(u64 m, u64 n, u64 k, const i32* a, u64 lda, const i32* b, u64 ldb, i32* c,
+              u64 ldc);
+
+
+#endif // GEMM_INT_H
@@ -0,0 +1,33 @@
+#ifndef GEMV_H
+#define GEMV_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Single precision matrix-vector products on a row major A (m x n):
+ *
+ *   gemv_f32     y = alpha * A   * x + beta * y    x: n, y: m
+ *   gemv_t_f32   y = alpha * A^T * x + beta * y    x: m, y: n
+ *
+ * Both walk A once, row by row, 4 rows at a time:
+ *   plain       4 dot products share every load of x, the 4 sums are
+ *               reduced together at the end of the rows
+ *   transposed  y += (alpha * x[i]) * A[i] for 4 rows per load and
+ *               store of y (axpy style, no strided reads of A)
+ *
+ * AVX2 uses FMA on 8 floats, SSE2 4 floats, picked at runtime from
+ * cpu_simd_level() (cpu_features.h).
+ * With beta == 0, y is only written (it may hold NaNs).
+ * y may NOT alias A or x.
+ */
+
+
+void gemv_f32(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x, float beta,
+              float* y);
+
+void gemv_t_f32(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x, float beta,
+                float* y);
+
+
+#endif // GEMV_H
@@ -2,6 +2,7 @@
 #define GEN_VECTOR_H
 
 #include "common.h"
+#include "serialize.h"
 
 
 /*          TLDR
@@ -169,6 +170,19 @@ void genVec_copy(genVec* dest, const genVec* src);
 void genVec_move(genVec* dest, genVec** src);
 
 
+// Serialization (format in serialize.h)
+// ===========================
+
+// Write vec to f. POD elements (write_fn NULL) go out as one bulk block,
+// otherwise write_fn is called on every element
+b8 genVec_write(const genVec* vec, FILE* f, ser_write_fn write_fn);
+
+// Read a vec written by genVec_write and APPEND its elements to vec.
+// vec must already be inited with the same data_size (and its own callbacks).
+// POD elements (read_fn NULL) are read with one bulk fread
+b8 genVec_read(genVec* vec, FILE* f, ser_read_fn read_fn);
+
+
 // Get number of elements in vector
 static inline u64 genVec_size(const genVec* vec)
 {
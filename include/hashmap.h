@@ -1,7 +1,9 @@
 #ifndef HASHMAP_H
 #define HASHMAP_H
 
+#include "gen_vector.h"
 #include "map_setup.h"
+#include "serialize.h"
 
 
 typedef struct {
@@ -20,6 +22,23 @@ typedef struct {
     delete_fn       val_del_fn;
 } hashmap;
 
+
+/*
+ * Iterator over the filled slots (no allocation, lives on the stack)
+ *
+ *   hashmap_iter it = hashmap_iter_begin(map);
+ *   const u8* k; u8* v;
+ *   while (hashmap_iter_next(&it, &k, &v)) { ... }
+ *
+ * The map must not be modified (put/del/resize) while iterating.
+ * Writing through v is fine.
+ */
+typedef struct {
+    const hashmap* map;
+    u64            index; // next slot to look at
+    u64            left;  // filled slots not visited yet
+} hashmap_iter;
+
 /**
  * Create a new hashmap
  */
@@ -30,6 +49,12 @@ hashmap* hashmap_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn,
 
 void hashmap_destroy(hashmap* map);
 
+/**
+ * Deep copy of map (keys/vals copied with the map's copy functions)
+ * The bucket layout is copied as is: same capacity, same slots
+ */
+hashmap* hashmap_clone(const hashmap* map);
+
 /**
  * Insert or update key-value pair (COPY semantics)
  * Both key and val are passed as const u8*
@@ -63,6 +88,26 @@ b8 hashmap_get(const hashmap* map, const u8* key, u8* val);
  */
 u8* hashmap_get_ptr(hashmap* map, const u8* key);
 
+/**
+ * Heterogeneous lookup with a precomputed hash
+ * hash must be what map->hash_fn returns for the matching stored key.
+ * key_view is any caller type, eq_fn compares it with stored keys
+ * (NULL: cmp_fn on key_size bytes, key_view is then a real key)
+ * @return pointer to value or NULL (invalidated by put/del)
+ */
+u8* hashmap_get_hashed(const hashmap* map, u64 hash, const void* key_view, key_eq_fn eq_fn);
+
+/**
+ * Find key_view or insert it, with a single probe
+ * On insert, the key is built in place with make_fn(key, key_view)
+ * (NULL: key_view is copied as key_size bytes) and the value is
+ * zero-initialized. Nothing is allocated if the key is present.
+ * inserted (optional) is set to 1 if a new entry was created
+ * @return pointer to the value slot (invalidated by put/del)
+ */
+u8* hashmap_find_or_insert(hashmap* map, u64 hash, const void* key_view, key_eq_fn eq_fn,
+                           key_make_fn make_fn, b8* inserted);
+
 /**
  * Delete key-value pair
  * If out is provided, value is copied to it before deletion
@@ -81,6 +126,47 @@ b8 hashmap_has(const hashmap* map, const u8* key);
  */
 void hashmap_print(const hashmap* map, print_fn key_print, print_fn val_print);
 
+/**
+ * Start iterating map (see hashmap_iter)
+ */
+hashmap_iter hashmap_iter_begin(const hashmap* map);
+
+/**
+ * Advance to the next entry
+ * key / val may be NULL if not needed
+ * @return 1 and sets key/val, 0 when all entries were visited
+ */
+b8 hashmap_iter_next(hashmap_iter* it, const u8** key, u8** val);
+
+/**
+ * Append a copy of every key (val) to out, in slot order, in one pass
+ * out must have data_size == key_size (val_size), the copies are made
+ * with out's copy_fn. out is reserved once up front.
+ */
+void hashmap_keys(const hashmap* map, genVec* out);
+void hashmap_values(const hashmap* map, genVec* out);
+
+/**
+ * Grow capacity so that n entries fit without any rehashing
+ * (never shrinks)
+ */
+void hashmap_reserve(hashmap* map, u64 n);
+
+/**
+ * Write all entries to f (format in serialize.h)
+ * key_write / val_write may be NULL for POD keys / vals (raw bytes)
+ */
+b8 hashmap_write(const hashmap* map, FILE* f, ser_write_fn key_write, ser_write_fn val_write);
+
+/**
+ * Read entries written by hashmap_write into map
+ * map is created by the caller with matching key/val sizes (and its own
+ * hash/cmp/copy/del functions). It is presized to the stored count, so
+ * loading never rehashes. Existing keys get their val overwritten.
+ * key_read / val_read may be NULL for POD keys / vals
+ */
+b8 hashmap_read(hashmap* map, FILE* f, ser_read_fn key_read, ser_read_fn val_read);
+
 
 
 static inline u64 hashmap_size(const hashmap* map)
@@ -108,8 +194,6 @@ void hashmap_clear(hashmap* map);  // Remove all, keep capacity
 void hashmap_reset(hashmap* map);  // Remove all, reset to initial capacity
 // Update value in-place if key exists, return false if key doesn't exist
 b8 hashmap_update(hashmap* map, const u8* key, const u8* val);
-genVec* hashmap_keys(const hashmap* map);
-genVec* hashmap_values(const hashmap* map);
 */
 
 #endif // HASHMAP_H
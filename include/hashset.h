@@ -2,6 +2,7 @@
 #define HASHSET_H
 
 #include "map_setup.h"
+#include "serialize.h"
 
 
 typedef struct {
@@ -17,6 +18,22 @@ typedef struct {
 } hashset;
 
 
+/*
+ * Iterator over the elements (no allocation, lives on the stack)
+ *
+ *   hashset_iter it = hashset_iter_begin(set);
+ *   const u8* e;
+ *   while (hashset_iter_next(&it, &e)) { ... }
+ *
+ * The set must not be modified while iterating.
+ */
+typedef struct {
+    const hashset* set;
+    u64            index; // next slot to look at
+    u64            left;  // filled slots not visited yet
+} hashset_iter;
+
+
 
 /**
  * Create a new hashset
@@ -57,6 +74,26 @@ b8 hashset_insert_move(hashset* set, u8** elm);
  */
 b8 hashset_has(const hashset* set, const u8* elm);
 
+/**
+ * Heterogeneous lookup with a precomputed hash
+ * hash must be what set->hash_fn returns for the matching element.
+ * view is any caller type, eq_fn compares it with stored elements
+ * (NULL: cmp_fn on elm_size bytes, view is then a real element)
+ * @return pointer to the stored element or NULL
+ */
+const u8* hashset_get_hashed(const hashset* set, u64 hash, const void* view, key_eq_fn eq_fn);
+
+/**
+ * Find view or insert it, with a single probe
+ * On insert the element is built in place with make_fn(elm, view)
+ * (NULL: view is copied as elm_size bytes)
+ * inserted (optional) is set to 1 if a new element was created
+ * @return pointer to the stored element (valid until it is removed)
+ * The element must not be modified in a way that changes its hash
+ */
+u8* hashset_find_or_insert(hashset* set, u64 hash, const void* view, key_eq_fn eq_fn,
+                           key_make_fn make_fn, b8* inserted);
+
 /**
  * Delete elm from hashset
  * 
@@ -69,6 +106,17 @@ b8 hashset_remove(hashset* set, const u8* elm);
  */
 void hashset_print(const hashset* set, print_fn print_fn);
 
+/**
+ * Start iterating set (see hashset_iter)
+ */
+hashset_iter hashset_iter_begin(const hashset* set);
+
+/**
+ * Advance to the next element
+ * @return 1 and sets elm, 0 when all elements were visited
+ */
+b8 hashset_iter_next(hashset_iter* it, const u8** elm);
+
 /**
  * Clear all elements from set but keep capacity
  */
@@ -79,6 +127,26 @@ void hashset_clear(hashset* set);
  */
 void hashset_reset(hashset* set);
 
+/**
+ * Grow capacity so that n elements fit without any rehashing
+ * (never shrinks)
+ */
+void hashset_reserve(hashset* set, u64 n);
+
+/**
+ * Write all elements to f (format in serialize.h)
+ * write_fn may be NULL for POD elements (raw bytes)
+ */
+b8 hashset_write(const hashset* set, FILE* f, ser_write_fn write_fn);
+
+/**
+ * Read elements written by hashset_write into set
+ * set is created by the caller with matching elm_size (and its own
+ * hash/cmp/copy/del functions). It is presized to the stored count.
+ * read_fn may be NULL for POD elements
+ */
+b8 hashset_read(hashset* set, FILE* f, ser_read_fn read_fn);
+
 // Inline utility functions
 static inline u64 hashset_size(const hashset* set)
 {
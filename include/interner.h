@@ -0,0 +1,89 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include "arena.h"
+#include "gen_vector.h"
+#include "hashset.h"
+#include "str_setup.h"
+
+
+/*          TLDR
+ * interner maps byte sequences to stable u32 ids and one canonical copy
+ * of the bytes. Every distinct string is stored once, '\0' terminated,
+ * in a chain of arenas that is never moved or freed before the interner,
+ * so canonical pointers stay valid for its whole lifetime.
+ *
+ * Two interned strings are equal iff their ids are equal.
+ * The murmurhash3 of the bytes is computed once on intern and kept
+ * in the entry, so rehashing the table never touches the bytes again.
+ */
+
+
+#ifndef INTERNER_BLOCK_SIZE
+#define INTERNER_BLOCK_SIZE (nKB(64)) // bytes per arena block
+#endif
+
+#define INTERNER_INVALID_ID ((u32)-1)
+
+
+// element of the hashset (by value)
+typedef struct {
+    const char* str;  // canonical bytes (in an arena)
+    u32         len;
+    u32         id;
+    u64         hash; // murmurhash3_view of the bytes
+} intern_entry;
+
+
+typedef struct {
+    hashset* set;        // intern_entry, hashed by entry->hash
+    genVec*  strs;       // StringView, indexed by id
+    genVec*  blocks;     // Arena*, the last one is filled
+    u64      block_size;
+} interner;
+
+
+/**
+ * Create an interner
+ * block_size is the arena block size (0 -> INTERNER_BLOCK_SIZE)
+ * strings longer than a block get a block of their own
+ */
+interner* interner_create(u64 block_size);
+
+// free the table and all the bytes, invalidates every canonical pointer
+void interner_destroy(interner* in);
+
+/**
+ * Get the id of sv, interning a copy of it if it is new
+ */
+u32 interner_intern(interner* in, StringView sv);
+
+// same, sv hashed by the caller with murmurhash3_view (hashed once)
+u32 interner_intern_hashed(interner* in, StringView sv, u64 hash);
+
+u32 interner_intern_cstr(interner* in, const char* cstr);
+
+/**
+ * Look up sv without interning it
+ * @return id, or INTERNER_INVALID_ID if sv was never interned
+ */
+u32 interner_find(const interner* in, StringView sv);
+
+/**
+ * Canonical bytes of id (pointer stable until interner_destroy)
+ */
+StringView interner_get(const interner* in, u32 id);
+
+// canonical '\0' terminated string of id
+const char* interner_cstr(const interner* in, u32 id);
+
+
+// number of distinct strings (ids are 0 .. size-1)
+static inline u32 interner_size(const interner* in)
+{
+    CHECK_FATAL(!in, "interner is null");
+    return (u32)genVec_size(in->strs);
+}
+
+
+#endif // INTERNER_H
@@ -0,0 +1,61 @@
+#ifndef LU_H
+#define LU_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Pivoted LU on raw row major buffers, float and double from one body
+ * (src/lu.c). Used by matrix_LU / matrix_solve / matrix_inv / matrix_det
+ * (matrix.h, f32) and the generic matrices' det and solve
+ * (matrix_generic.h, f64):
+ *
+ *   P * A = L * U     L unit lower, U upper, both stored in A
+ *
+ * Recursive, like LAPACK's getrf2: factor the left half of the columns,
+ * solve for the top right block, update the bottom right block with one
+ * gemm and recurse. Triangular solves recurse the same way and go
+ * unblocked (vec axpy rows) below LU_BLOCK.
+ *
+ * perm[i] is the original row that ended up in row i.
+ */
+
+
+// triangular solves run unblocked below this many rows
+#ifndef LU_BLOCK
+#define LU_BLOCK 16
+#endif
+
+
+/**
+ * Factor the n x n matrix a (rows lda apart) in place.
+ * Writes perm (n entries) and the number of row swaps (optional).
+ * Returns false on an exact zero (or NaN) pivot, a is then partly factored.
+ */
+b8 lu_f32_factor(float* a, u64 lda, u64 n, u64* perm, u64* swaps);
+b8 lu_f64_factor(double* a, u64 lda, u64 n, u64* perm, u64* swaps);
+
+/**
+ * x = A^-1 b from the factors, b and x n x r.
+ * x may not alias b.
+ */
+void lu_f32_solve(const float* lu, u64 ldl, const u64* perm, u64 n, const float* b, u64 ldb,
+                  float* x, u64 ldx, u64 r);
+void lu_f64_solve(const double* lu, u64 ldl, const u64* perm, u64 n, const double* b, u64 ldb,
+                  double* x, u64 ldx, u64 r);
+
+/**
+ * Same, with x already holding P b (row permuted), solved in place
+ */
+void lu_f32_solve_in_place(const float* lu, u64 ldl, u64 n, float* x, u64 ldx, u64 r);
+void lu_f64_solve_in_place(const double* lu, u64 ldl, u64 n, double* x, u64 ldx, u64 r);
+
+/**
+ * det(A) from the factors: the product of U's diagonal (in double),
+ * signed by swaps
+ */
+double lu_f32_det(const float* lu, u64 ldl, u64 n, u64 swaps);
+double lu_f64_det(const double* lu, u64 ldl, u64 n, u64 swaps);
+
+
+#endif // LU_H
@@ -14,11 +14,18 @@ typedef enum {
 
 typedef u64 (*custom_hash_fn)(const u8* key, u64 size);
 
+// heterogeneous lookup (hashmap_get_hashed, hashmap_find_or_insert)
+// compare a stored key with a caller defined view of a key, 0 if equal
+typedef int (*key_eq_fn)(const u8* key, const void* view);
+// construct a stored key in place from a view (only called on insert)
+typedef void (*key_make_fn)(u8* key, const void* view);
+
 
 
 #define LOAD_FACTOR_GROW      0.70
 #define LOAD_FACTOR_SHRINK    0.20
 #define HASHMAP_INIT_CAPACITY 17 //prime no (index = hash % capacity)
+#define MAP_RESERVE_MAX       (1ULL << 40) // *_reserve clamps n to this
 
 
 /*
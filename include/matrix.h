@@ -1,32 +1,61 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include "arena.h"
 #include "common.h"
+#include "thread_pool.h"
 #include <string.h>
 
 
 
 // ROW MAJOR 2D MATRIX
+// element (i, j) is data[i * ld + j], ld >= n (ld == n: packed rows)
 typedef struct {
     float* data;
-    u64    m; // rows
-    u64    n; // cols
+    u64    m;  // rows
+    u64    n;  // cols
+    u64    ld; // leading dimension: floats from one row to the next
 } Matrix;
 
 
+// STRIDED VIEW INTO MATRIX DATA (no ownership)
+// element (i, j) is data[i * rs + j * cs]
+typedef struct {
+    float* data;
+    u64    m;  // rows
+    u64    n;  // cols
+    u64    rs; // row stride (elements)
+    u64    cs; // col stride (elements)
+} MatrixView;
+
+
 // CREATION AND DESTRUCTION
 // ============================================================================
 
-// create heap matrix with m rows and n cols
+// rows of aligned matrices start on a MATRIX_ALIGN byte boundary
+#ifndef MATRIX_ALIGN
+#define MATRIX_ALIGN 64 // a cache line, a multiple of every vector width
+#endif
+
+// leading dimension of an aligned matrix with n cols (n rounded up to the alignment)
+#define MATRIX_LD_ALIGNED(n) \
+    (((n) + (MATRIX_ALIGN / sizeof(float)) - 1) & ~((u64)(MATRIX_ALIGN / sizeof(float)) - 1))
+
+// create heap matrix with m rows and n cols (packed rows, ld == n)
 Matrix* matrix_create(u64 m, u64 n);
 
+// create heap matrix with MATRIX_ALIGN aligned rows: ld = MATRIX_LD_ALIGNED(n)
+// The padding is zeroed. Element wise ops then run over whole rows
+// (no row tails) and SIMD loads never split a cache line
+Matrix* matrix_create_aligned(u64 m, u64 n);
+
 // create heap matrix with m rows and n cols and an array of size m x n
 Matrix* matrix_create_arr(u64 m, u64 n, const float* arr);
 
-// create matrix with everything on the stack
+// create matrix with everything on the stack (packed rows, ld == n)
 void matrix_create_stk(Matrix* mat, u64 m, u64 n, float* data);
 
-// destroy the matrix created with matrix_create or matrix_create_arr
+// destroy the matrix created with matrix_create, matrix_create_arr or matrix_create_aligned
 // DO NOT use on stack-allocated matrices (created with matrix_create_stk)
 void matrix_destroy(Matrix* mat);
 
@@ -37,6 +66,7 @@ void matrix_destroy(Matrix* mat);
 /* Preferred method for setting values from arrays
    For direct arrays (float[len]){...} ROW MAJOR or (float[row][col]){{...},{...}} MORE EXPLICIT
    
+   arr is packed (n floats per row) whatever the leading dimension of mat
    Usage:
        matrix_set_val_arr(mat, 9, (float*)(float[3][3]){
            {1, 2, 3},
@@ -64,10 +94,15 @@ void matrix_add(Matrix* out, const Matrix* a, const Matrix* b);
 // out may alias a and/or b (safe to do: matrix_sub(a, a, b))
 void matrix_sub(Matrix* out, const Matrix* a, const Matrix* b);
 
+// Fused scale and add: out = alpha * x + y, one pass over memory
+// out may alias x and/or y (safe to do: matrix_axpy(y, alpha, x, y))
+void matrix_axpy(Matrix* out, float alpha, const Matrix* x, const Matrix* y);
+
 // Scalar multiplication: mat = mat * val
 void matrix_scale(Matrix* mat, float val);
 
 // Element wise divistion
+// multiplies by 1 / val: may differ from a true division in the last bit
 void matrix_div(Matrix* mat, float val);
 
 // Matrix copy: dest = src
@@ -80,22 +115,37 @@ void matrix_copy(Matrix* dest, const Matrix* src);
 // Matrix multiplication: out = a × b
 // (m×k) * (k×n) = (m×n)
 // out may NOT alias a or b
-// Uses blocked ikj multiplication for cache efficiency (good for small-medium matrices)
+// Packed GEMM with an AVX2/FMA (or SSE2) micro-kernel, see gemm.h
 void matrix_xply(Matrix* out, const Matrix* a, const Matrix* b);
 
+// matrix_xply over the threads of pool (thread_pool.h), out is cut into
+// tiles. Stays on the calling thread below GEMM_MT_MIN (m * n * k)
+// Create the pool once and reuse it: thread_pool_create(0) = all cpus
+void matrix_xply_mt(Matrix* out, const Matrix* a, const Matrix* b, thread_pool* pool);
+
 // Matrix multiplication variant 2: out = a × b
-// Transposes b internally for better cache locality
-// Takes more memory but can be faster for large matrices
+// Transposes b into a heap buffer, then multiplies with matrix_xply_bt
 // out may NOT alias a or b
 void matrix_xply_2(Matrix* out, const Matrix* a, const Matrix* b);
 
+// matrix_xply_2 with the transposed b taken from scratch instead of the heap
+// (needs n * k floats, the arena is reset to where it was on return)
+void matrix_xply_2_arena(Matrix* out, const Matrix* a, const Matrix* b, Arena* scratch);
 
-/* TODO: 
-    vec * mat => (1 x n) * (m * n)T => (1 x n) * (n x m) => (1 x m)
-OR  vec * mat => (1 x m) * (m * n) => (1 x n)
-OR  vec * mat => (m x 1) * (1 x n) => (m x n) - this doesnot fit here ?
-*/
-u8* matrix_xply_vec(const Matrix* a, const u8* arr, u32 data_size, u64 size);
+// Multiplication by a transposed matrix: out = a × bt^T
+// (m×k) * (n×k)^T = (m×n), bt is read in place (no copy)
+// Keep b transposed and call this when multiplying by it repeatedly
+void matrix_xply_bt(Matrix* out, const Matrix* a, const Matrix* bt);
+
+// Matrix-vector product: y = alpha × a × x + beta × y
+// x: n floats, y: m floats (gemv.h), y may NOT alias x
+void matrix_gemv(float* y, float alpha, const Matrix* a, const float* x, float beta);
+
+// Transposed matrix-vector product: y = alpha × a^T × x + beta × y
+// x: m floats, y: n floats (same as the row vector x^T × a)
+void matrix_gemv_T(float* y, float alpha, const Matrix* a, const float* x, float beta);
+
+// many small products in one call: see gemm_batch.h (batch-interleaved layout)
 
 
 
@@ -106,20 +156,94 @@ u8* matrix_xply_vec(const Matrix* a, const u8* arr, u32 data_size, u64 size);
 // out may NOT alias mat
 void matrix_T(Matrix* out, const Matrix* mat);
 
-// LU Decomposition: mat = L × U
+// Transpose in place: mat becomes n x m
+// Square matrices swap tiles (ld is kept), others follow the permutation
+// cycles (slower) and come back packed: ld = the new n
+void matrix_T_inplace(Matrix* mat);
+
+// LU Decomposition without pivoting: mat = L × U (Doolittle)
 // Decomposes square matrix into Lower and Upper triangular matrices
-void matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat);
+// Warns and returns false on a zero pivot; matrix_LU pivots instead
+b8 matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat);
 
-// Calculate determinant using LU decomposition
+// LU with partial pivoting: P × mat = L × U
+// L (unit diagonal, not stored) and U are packed into lu, which may be mat
+// perm (n entries): row i of P × mat is row perm[i] of mat
+// Returns false if mat is singular (an exact zero pivot)
+b8 matrix_LU(Matrix* lu, u64* perm, const Matrix* mat);
+
+// Solve mat × x = b from a successful matrix_LU (b: n×r, x: n×r)
+// x may NOT alias b
+void matrix_LU_solve(Matrix* x, const Matrix* lu, const u64* perm, const Matrix* b);
+
+// Solve a × x = b (b: n×r right hand sides, x: n×r)
+// Warns and returns false if a is singular; x may NOT alias b
+b8 matrix_solve(Matrix* x, const Matrix* a, const Matrix* b);
+
+// Calculate matrix inverse: out = mat^(-1)
+// Warns and returns false if mat is singular; out may alias mat
+b8 matrix_inv(Matrix* out, const Matrix* mat);
+
+// Calculate determinant using the pivoted LU (product accumulated in double)
+// 0 for a singular matrix, the LU lives on the heap
 float matrix_det(const Matrix* mat);
 
+// matrix_det with the LU taken from scratch (n * n floats + n u64)
+float matrix_det_arena(const Matrix* mat, Arena* scratch);
+
 // Calculate adjugate (adjoint) matrix
 // TODO: NOT IMPLEMENTED
 void matrix_adj(Matrix* out, const Matrix* mat);
 
-// Calculate matrix inverse: out = mat^(-1)
-// TODO: NOT IMPLEMENTED
-void matrix_inv(Matrix* out, const Matrix* mat);
+
+// MATRIX VIEWS
+// ============================================================================
+
+/*
+Views are small structs passed by value. Slicing and transposing only
+change the pointer and the strides, nothing is copied:
+
+    MatrixView v = matrix_view(mat);
+    MatrixView s = matrix_view_slice(v, 1, 2, 3, 3); // rows 1..3, cols 2..4
+    MatrixView t = matrix_view_T(s);                 // s^T, a stride swap
+    MATRIX_VIEW_AT(t, 0, 1) == MATRIX_AT(mat, 2, 2)
+
+The view ops pick a kernel from the layout: rows with cs == 1 go through
+the SIMD row kernels (one call when the data is contiguous), all
+column-contiguous views (rs == 1, e.g. transposed) run as their
+transpose, anything else falls back to a strided loop.
+Writing through a view writes into the viewed matrix.
+*/
+
+#define MATRIX_VIEW_AT(v, i, j) ((v).data[((i) * (v).rs) + ((j) * (v).cs)])
+
+// the whole matrix, row major (rs = ld, cs = 1)
+MatrixView matrix_view(const Matrix* mat);
+
+// the m×n block of v starting at (i, j)
+MatrixView matrix_view_slice(MatrixView v, u64 i, u64 j, u64 m, u64 n);
+
+// v^T: swaps the dims and the strides
+MatrixView matrix_view_T(MatrixView v);
+
+// dst = src (same dims), dst may NOT overlap src
+void matrix_view_copy(MatrixView dst, MatrixView src);
+
+// out = a + b, out may be the same view as a and/or b
+void matrix_view_add(MatrixView out, MatrixView a, MatrixView b);
+
+// out = a - b, out may be the same view as a and/or b
+void matrix_view_sub(MatrixView out, MatrixView a, MatrixView b);
+
+// out = alpha * x + y, out may be the same view as x and/or y
+void matrix_view_axpy(MatrixView out, float alpha, MatrixView x, MatrixView y);
+
+// v *= val
+void matrix_view_scale(MatrixView v, float val);
+
+// out = a × b through the packed GEMM, any strides on a and b
+// out may NOT alias a or b; outputs with no unit stride go through a temporary
+void matrix_view_xply(MatrixView out, MatrixView a, MatrixView b);
 
 
 // UTILITIES
@@ -129,9 +253,9 @@ void matrix_inv(Matrix* out, const Matrix* mat);
 void matrix_print(const Matrix* mat);
 
 
-#define MATRIX_TOTAL(mat)    ((u64)((mat)->n * (mat)->m))
-#define IDX(mat, i, j)       (((i) * (mat)->n) + (j))
-#define MATRIX_AT(mat, i, j) ((mat)->data[((i) * (mat)->n) + (j)])
+#define MATRIX_TOTAL(mat)    ((u64)((mat)->n * (mat)->m)) // elements, padding not counted
+#define IDX(mat, i, j)       (((i) * (mat)->ld) + (j))
+#define MATRIX_AT(mat, i, j) ((mat)->data[((i) * (mat)->ld) + (j)])
 
 #define ZEROS_1D(n)    ((float[n]){0})
 #define ZEROS_2D(m, n) ((float[m][n]){0})
@@ -140,7 +264,6 @@ void matrix_print(const Matrix* mat);
 
 // ARENA-BASED MATRIX ALLOCATION MACROS
 // ============================================================================
-#include "arena.h"
 
 /*
 Create a matrix allocated from arena (heap-style)
@@ -157,8 +280,9 @@ static inline Matrix* matrix_arena_alloc(Arena* arena, u64 m, u64 n)
     Matrix* mat = ARENA_ALLOC(arena, Matrix);
     CHECK_FATAL(!mat, "matrix arena allocation failed");
 
-    mat->m = m;
-    mat->n = n;
+    mat->m  = m;
+    mat->n  = n;
+    mat->ld = n;
 
     mat->data = ARENA_ALLOC_N(arena, float, (u64)(m * n));
     CHECK_FATAL(!mat->data, "matrix data arena allocation failed");
@@ -166,6 +290,31 @@ static inline Matrix* matrix_arena_alloc(Arena* arena, u64 m, u64 n)
     return mat;
 }
 
+/*
+matrix_arena_alloc with MATRIX_ALIGN aligned, padded rows (see matrix_create_aligned)
+All of the data is zeroed, padding included
+
+Usage:
+    Matrix* mat = matrix_arena_alloc_aligned(arena, 3, 3); // ld = 16
+*/
+static inline Matrix* matrix_arena_alloc_aligned(Arena* arena, u64 m, u64 n)
+{
+    CHECK_FATAL(m == 0 && n == 0, "n == m == 0");
+
+    Matrix* mat = ARENA_ALLOC(arena, Matrix);
+    CHECK_FATAL(!mat, "matrix arena allocation failed");
+
+    mat->m  = m;
+    mat->n  = n;
+    mat->ld = MATRIX_LD_ALIGNED(n);
+
+    mat->data = (float*)arena_alloc_aligned(arena, sizeof(float) * m * mat->ld, MATRIX_ALIGN);
+    CHECK_FATAL(!mat->data, "matrix data arena allocation failed");
+    memset(mat->data, 0, sizeof(float) * m * mat->ld);
+
+    return mat;
+}
+
 /*
 Create a matrix allocated from arena with initial values
 Matrix struct and data allocated from arena
@@ -194,32 +343,18 @@ static inline Matrix* matrix_arena_arr_alloc(Arena* arena, u64 m, u64 n, const f
     - Compile-time type safety
     
  2. SIMD optimization
-    - Vectorized operations for add, sub, multiply
-    - Platform-specific optimizations (SSE, AVX, NEON)
-    
- 3. Matrix views (zero-copy slicing)
-    typedef struct {
-        int* data;
-        u64  n, m;
-        u64  stride;    // for non-contiguous access
-        u64  offset;    // starting position
-    } MatrixView;
-    
-    - Slicing without copying
-    - Transpose views without data movement
-    - SIMD-friendly kernels with custom strides
+    - NEON (add, sub, scale, axpy and xply have SSE2 / AVX2 kernels)
     
- 4. Identity matrix creation
+ 3. Identity matrix creation
     Matrix* matrix_iden(u64 n, u64 m);
     
- 5. Additional operations
+ 4. Additional operations
     - Power operations
     - Trace
     - Rank calculation
     - Eigenvalues/eigenvectors
     
- 6. Numerical stability improvements
-    - Pivoting for LU decomposition
+ 5. Numerical stability improvements
     - Condition number checks
     - Iterative refinement
 */
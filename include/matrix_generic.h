@@ -2,6 +2,12 @@
 #define MATRIX_GENERIC_H
 
 #include "common.h"
+#include "gemm.h"
+#include "gemm_f64.h"
+#include "gemm_int.h"
+#include "lu.h"
+#include "vec_f32.h"
+#include "vec_f64.h"
 
 #include <limits.h>
 #include <stdarg.h>
@@ -10,27 +16,117 @@
 #include <string.h>
 
 
+/*          TLDR
+ * INSTANTIATE_MATRIX(T, fmt) generates Matrix_T and its functions for
+ * any arithmetic T. Element types with a kernel skip the loops:
+ *
+ *   add / sub / scale / div   float, double     vec_f32.h, vec_f64.h
+ *   xply / xply_2             float, double     gemm.h, gemm_f64.h
+ *                             i32 (wraps)       gemm_int.h
+ *   det / solve               every T, in double through lu.h (pivoted)
+ *
+ * The choice is a MATRIX_KERNEL_<OP>_<T> table entry found by token
+ * pasting, so it folds at compile time; any other T keeps the plain loops.
+ *
+ * INSTANTIATE_MATRIX_ACC(T, TACC) adds matrix_xply_acc_T_TACC: out = a * b
+ * with a, b Matrix_T and the sums kept in TACC (both types instantiated):
+ *
+ *   i8 -> i32       gemm_i8 (int8 quantized products)
+ *   float -> double gemm_f32_f64 (exact products, sums rounded in double)
+ *   anything else   loops accumulating in TACC
+ */
+
+
 // ============================================================================
 // GENERIC MATRIX MACRO DEFINITIONS
 // ============================================================================
 
 // Define a matrix type for a specific data type
-#define MATRIX_TYPE(T)    \
-    typedef struct {      \
-        T*  data;         \
-        u64 m; /* rows */ \
-        u64 n; /* cols */ \
+// ld is always n here (rows are packed); it is kept so the helper
+// macros below are the same as matrix.h's and both headers can be used
+// in one translation unit
+#define MATRIX_TYPE(T)                 \
+    typedef struct {                   \
+        T*  data;                      \
+        u64 m;  /* rows */             \
+        u64 n;  /* cols */             \
+        u64 ld; /* row stride, == n */ \
     } Matrix_##T
 
 
 // Helper macros (type-agnostic)
 #define MATRIX_TOTAL(mat)    ((u64)((mat)->n * (mat)->m))
-#define IDX(mat, i, j)       (((i) * (mat)->n) + (j))
-#define MATRIX_AT(mat, i, j) ((mat)->data[((i) * (mat)->n) + (j)])
+#define IDX(mat, i, j)       (((i) * (mat)->ld) + (j))
+#define MATRIX_AT(mat, i, j) ((mat)->data[((i) * (mat)->ld) + (j)])
+
+// Zero initialization helpers (typed, matrix.h's ZEROS_1D/2D are float)
+#define ZEROS_1D_T(T, n)    ((T[n]){0})
+#define ZEROS_2D_T(T, m, n) ((T[m][n]){0})
+
+// ============================================================================
+// KERNEL DISPATCH
+// ============================================================================
 
-// Zero initialization helpers
-#define ZEROS_1D(T, n)    (((T)[n]){0})
-#define ZEROS_2D(T, m, n) (((T)[m][n]){0})
+// gemm adapters with one signature: c = a * b, all packed (ld = cols)
+static inline void matrix_gemm_f32(u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    gemm_f32(m, n, k, 1, a, k, b, n, 0, c, n);
+}
+
+static inline void matrix_gemm_f64(u64 m, u64 n, u64 k, const double* a, const double* b,
+                                   double* c)
+{
+    gemm_f64(m, n, k, 1, a, k, b, n, 0, c, n);
+}
+
+static inline void matrix_gemm_i32(u64 m, u64 n, u64 k, const i32* a, const i32* b, i32* c)
+{
+    gemm_i32(m, n, k, a, k, b, n, c, n);
+}
+
+static inline void matrix_gemm_i8_i32(u64 m, u64 n, u64 k, const i8* a, const i8* b, i32* c)
+{
+    gemm_i8(m, n, k, a, k, b, n, c, n);
+}
+
+static inline void matrix_gemm_f32_f64(u64 m, u64 n, u64 k, const float* a, const float* b,
+                                       double* c)
+{
+    gemm_f32_f64(m, n, k, 1, a, k, b, n, 0, c, n);
+}
+
+// the kernel for element type T, NULL where the loops stay: an entry
+// expands to "~, kernel" and shifts it into the slot NULL holds otherwise
+#define MATRIX_KERNEL_PICK_(a, b, ...) b
+#define MATRIX_KERNEL_PICK(...)        MATRIX_KERNEL_PICK_(__VA_ARGS__)
+#define MATRIX_KERNEL(OP, T)           MATRIX_KERNEL_PICK(MATRIX_KERNEL_##OP##_##T, NULL, ~)
+
+#define MATRIX_KERNEL_VEC_ADD_float    ~, vec_f32_add
+#define MATRIX_KERNEL_VEC_ADD_double   ~, vec_f64_add
+#define MATRIX_KERNEL_VEC_SUB_float    ~, vec_f32_sub
+#define MATRIX_KERNEL_VEC_SUB_double   ~, vec_f64_sub
+#define MATRIX_KERNEL_VEC_SCALE_float  ~, vec_f32_scale
+#define MATRIX_KERNEL_VEC_SCALE_double ~, vec_f64_scale
+
+#define MATRIX_KERNEL_GEMM_float  ~, matrix_gemm_f32
+#define MATRIX_KERNEL_GEMM_double ~, matrix_gemm_f64
+#define MATRIX_KERNEL_GEMM_i32    ~, matrix_gemm_i32
+#if INT_MAX == INT32_MAX
+#define MATRIX_KERNEL_GEMM_int ~, matrix_gemm_i32
+#endif
+
+// keyed on T_TACC
+#define MATRIX_KERNEL_GEMM_ACC_i8_i32       ~, matrix_gemm_i8_i32
+#define MATRIX_KERNEL_GEMM_ACC_float_double ~, matrix_gemm_f32_f64
+
+// perm (n u64) followed by count doubles, one heap block freed through perm
+static inline double* matrix_lu_workspace(u64 n, u64 count, u64** perm)
+{
+    *perm = (u64*)malloc((sizeof(u64) * n) + (sizeof(double) * count));
+    CHECK_FATAL(!*perm, "LU workspace malloc failed");
+
+    return (double*)(*perm + n);
+}
 
 // ============================================================================
 // MATRIX CREATION/DESTRUCTION
@@ -44,6 +140,7 @@
         CHECK_FATAL(!mat, "matrix malloc failed");                 \
         mat->m    = m;                                             \
         mat->n    = n;                                             \
+        mat->ld   = n;                                             \
         mat->data = (T*)malloc(sizeof(T) * n * m);                 \
         CHECK_FATAL(!mat->data, "matrix data malloc failed");      \
         return mat;                                                \
@@ -66,6 +163,7 @@
         mat->data = data;                                              \
         mat->m    = m;                                                 \
         mat->n    = n;                                                 \
+        mat->ld   = n;                                                 \
     }
 
 #define MATRIX_DESTROY(T)                    \
@@ -130,57 +228,82 @@
 // MATRIX OPERATIONS
 // ============================================================================
 
-#define MATRIX_ADD(T)                                                 \
-    void matrix_add_##T(Matrix_##T* out, const Matrix_##T* a,         \
-                        const Matrix_##T* b)                          \
-    {                                                                 \
-        CHECK_FATAL(!out, "out matrix is null");                      \
-        CHECK_FATAL(!a, "a matrix is null");                          \
-        CHECK_FATAL(!b, "b matrix is null");                          \
-        CHECK_FATAL(a->m != b->m || a->n != b->n || a->m != out->m || \
-                        a->n != out->n,                               \
-                    "a, b, out mat dimensions don't match");          \
-        u64 total = MATRIX_TOTAL(a);                                  \
-        for (u64 i = 0; i < total; i++) {                             \
-            out->data[i] = a->data[i] + b->data[i];                   \
-        }                                                             \
+#define MATRIX_ADD(T)                                                    \
+    void matrix_add_##T(Matrix_##T* out, const Matrix_##T* a,            \
+                        const Matrix_##T* b)                             \
+    {                                                                    \
+        CHECK_FATAL(!out, "out matrix is null");                         \
+        CHECK_FATAL(!a, "a matrix is null");                             \
+        CHECK_FATAL(!b, "b matrix is null");                             \
+        CHECK_FATAL(a->m != b->m || a->n != b->n || a->m != out->m ||    \
+                        a->n != out->n,                                  \
+                    "a, b, out mat dimensions don't match");             \
+        u64 total = MATRIX_TOTAL(a);                                     \
+        void (*kernel)(T*, const T*, const T*, u64) =                    \
+            MATRIX_KERNEL(VEC_ADD, T);                                   \
+        if (kernel) {                                                    \
+            kernel(out->data, a->data, b->data, total);                  \
+            return;                                                      \
+        }                                                                \
+        for (u64 i = 0; i < total; i++) {                                \
+            out->data[i] = a->data[i] + b->data[i];                      \
+        }                                                                \
     }
 
-#define MATRIX_SUB(T)                                                 \
-    void matrix_sub_##T(Matrix_##T* out, const Matrix_##T* a,         \
-                        const Matrix_##T* b)                          \
-    {                                                                 \
-        CHECK_FATAL(!out, "out matrix is null");                      \
-        CHECK_FATAL(!a, "a matrix is null");                          \
-        CHECK_FATAL(!b, "b matrix is null");                          \
-        CHECK_FATAL(a->m != b->m || a->n != b->n || a->m != out->m || \
-                        a->n != out->n,                               \
-                    "a, b, out mat dimensions don't match");          \
-        u64 total = MATRIX_TOTAL(a);                                  \
-        for (u64 i = 0; i < total; i++) {                             \
-            out->data[i] = a->data[i] - b->data[i];                   \
-        }                                                             \
+#define MATRIX_SUB(T)                                                    \
+    void matrix_sub_##T(Matrix_##T* out, const Matrix_##T* a,            \
+                        const Matrix_##T* b)                             \
+    {                                                                    \
+        CHECK_FATAL(!out, "out matrix is null");                         \
+        CHECK_FATAL(!a, "a matrix is null");                             \
+        CHECK_FATAL(!b, "b matrix is null");                             \
+        CHECK_FATAL(a->m != b->m || a->n != b->n || a->m != out->m ||    \
+                        a->n != out->n,                                  \
+                    "a, b, out mat dimensions don't match");             \
+        u64 total = MATRIX_TOTAL(a);                                     \
+        void (*kernel)(T*, const T*, const T*, u64) =                    \
+            MATRIX_KERNEL(VEC_SUB, T);                                   \
+        if (kernel) {                                                    \
+            kernel(out->data, a->data, b->data, total);                  \
+            return;                                                      \
+        }                                                                \
+        for (u64 i = 0; i < total; i++) {                                \
+            out->data[i] = a->data[i] - b->data[i];                      \
+        }                                                                \
     }
 
-#define MATRIX_SCALE(T)                                          \
-    void matrix_scale_##T(Matrix_##T* mat, T val)                \
-    {                                                            \
-        CHECK_FATAL(!mat, "matrix is null");                     \
-        u64 total = MATRIX_TOTAL(mat);                           \
-        for (u64 i = 0; i < total; i++) { mat->data[i] *= val; } \
+#define MATRIX_SCALE(T)                                             \
+    void matrix_scale_##T(Matrix_##T* mat, T val)                   \
+    {                                                               \
+        CHECK_FATAL(!mat, "matrix is null");                        \
+        u64 total = MATRIX_TOTAL(mat);                              \
+        void (*kernel)(T*, const T*, T, u64) =                      \
+            MATRIX_KERNEL(VEC_SCALE, T);                            \
+        if (kernel) {                                               \
+            kernel(mat->data, mat->data, val, total);               \
+            return;                                                 \
+        }                                                           \
+        for (u64 i = 0; i < total; i++) { mat->data[i] *= val; }    \
     }
 
-#define MATRIX_DIV(T)                                            \
-    void matrix_div_##T(Matrix_##T* mat, T val)                          \
-    {                                                            \
-        CHECK_FATAL(!mat, "mat is null");                        \
-        CHECK_FATAL(val == 0, "division by zero!");              \
-        u64 total = MATRIX_TOTAL(mat);                           \
-        for (u64 i = 0; i < total; i++) { mat->data[i] /= val; } \
+#define MATRIX_DIV(T)                                               \
+    void matrix_div_##T(Matrix_##T* mat, T val)                     \
+    {                                                               \
+        CHECK_FATAL(!mat, "mat is null");                           \
+        CHECK_FATAL(val == 0, "division by zero!");                 \
+        u64 total = MATRIX_TOTAL(mat);                              \
+        /* floating point: one division, then a multiply each */    \
+        void (*kernel)(T*, const T*, T, u64) =                      \
+            MATRIX_KERNEL(VEC_SCALE, T);                            \
+        if (kernel) {                                               \
+            kernel(mat->data, mat->data, (T)1 / val, total);        \
+            return;                                                 \
+        }                                                           \
+        for (u64 i = 0; i < total; i++) { mat->data[i] /= val; }    \
     }
 
 // ============================================================================
-// MATRIX MULTIPLICATION (Blocked ikj)
+// MATRIX MULTIPLICATION (gemm kernel, else blocked ikj)
 // ============================================================================
 
 #define MATRIX_XPLY(T)                                                         \
@@ -199,6 +322,13 @@
         u64 k = a->n;                                                          \
         u64 n = b->n;                                                          \
                                                                                \
+        void (*gemm)(u64, u64, u64, const T*, const T*, T*) =                  \
+            MATRIX_KERNEL(GEMM, T);                                            \
+        if (gemm) {                                                            \
+            gemm(m, n, k, a->data, b->data, out->data);                        \
+            return;                                                            \
+        }                                                                      \
+                                                                               \
         memset(out->data, 0, sizeof(T) * m * n);                               \
                                                                                \
         const u64 BLOCK_SIZE = 16;                                             \
@@ -231,46 +361,54 @@
 
 // This function transposes b for cache-friendly access
 // Takes more memory, good for large size matrices
-#define MATRIX_XPLY_2(T)                                               \
-    void matrix_xply_2_##T(Matrix_##T* out, const Matrix_##T* a,       \
-                           const Matrix_##T* b)                        \
-    {                                                                  \
-        CHECK_FATAL(!out, "out matrix is null");                       \
-        CHECK_FATAL(!a, "a matrix is null");                           \
-        CHECK_FATAL(!b, "b matrix is null");                           \
-        CHECK_FATAL(a->n != b->m, "incompatible matrix dimensions");   \
-        CHECK_FATAL(out->m != a->m || out->n != b->n,                  \
-                    "output matrix has wrong dimensions");             \
-                                                                       \
-        u64 m = a->m;                                                  \
-        u64 k = a->n;                                                  \
-        u64 n = b->n;                                                  \
-                                                                       \
-        Matrix_##T* b_T = matrix_create_##T(n, k);                     \
-        matrix_T_##T(b_T, b);                                          \
-                                                                       \
-        memset(out->data, 0, sizeof(T) * m * n);                       \
-                                                                       \
-        const u64 BLOCK_SIZE = 16;                                     \
-                                                                       \
-        for (u64 i = 0; i < m; i += BLOCK_SIZE) {                      \
-            for (u64 j = 0; j < n; j += BLOCK_SIZE) {                  \
-                u64 i_max = (i + BLOCK_SIZE < m) ? i + BLOCK_SIZE : m; \
-                u64 j_max = (j + BLOCK_SIZE < n) ? j + BLOCK_SIZE : n; \
-                                                                       \
-                for (u64 ii = i; ii < i_max; ii++) {                   \
-                    for (u64 jj = j; jj < j_max; jj++) {               \
-                        T sum = 0;                                     \
-                        for (u64 kk = 0; kk < k; kk++) {               \
-                            sum += a->data[IDX(a, ii, kk)] *           \
-                                   b_T->data[IDX(b_T, jj, kk)];        \
-                        }                                              \
-                        out->data[IDX(out, ii, jj)] = sum;             \
-                    }                                                  \
-                }                                                      \
-            }                                                          \
-        }                                                              \
-        matrix_destroy_##T(b_T);                                       \
+#define MATRIX_XPLY_2(T)                                                      \
+    void matrix_xply_2_##T(Matrix_##T* out, const Matrix_##T* a,              \
+                           const Matrix_##T* b)                               \
+    {                                                                         \
+        CHECK_FATAL(!out, "out matrix is null");                              \
+        CHECK_FATAL(!a, "a matrix is null");                                  \
+        CHECK_FATAL(!b, "b matrix is null");                                  \
+        CHECK_FATAL(a->n != b->m, "incompatible matrix dimensions");          \
+        CHECK_FATAL(out->m != a->m || out->n != b->n,                         \
+                    "output matrix has wrong dimensions");                    \
+                                                                              \
+        u64 m = a->m;                                                         \
+        u64 k = a->n;                                                         \
+        u64 n = b->n;                                                         \
+                                                                              \
+        /* the packed gemm kernels need no transposed copy */                 \
+        void (*gemm)(u64, u64, u64, const T*, const T*, T*) =                 \
+            MATRIX_KERNEL(GEMM, T);                                           \
+        if (gemm) {                                                           \
+            gemm(m, n, k, a->data, b->data, out->data);                       \
+            return;                                                           \
+        }                                                                     \
+                                                                              \
+        Matrix_##T* b_T = matrix_create_##T(n, k);                            \
+        matrix_T_##T(b_T, b);                                                 \
+                                                                              \
+        memset(out->data, 0, sizeof(T) * m * n);                              \
+                                                                              \
+        const u64 BLOCK_SIZE = 16;                                            \
+                                                                              \
+        for (u64 i = 0; i < m; i += BLOCK_SIZE) {                             \
+            for (u64 j = 0; j < n; j += BLOCK_SIZE) {                         \
+                u64 i_max = (i + BLOCK_SIZE < m) ? i + BLOCK_SIZE : m;        \
+                u64 j_max = (j + BLOCK_SIZE < n) ? j + BLOCK_SIZE : n;        \
+                                                                              \
+                for (u64 ii = i; ii < i_max; ii++) {                          \
+                    for (u64 jj = j; jj < j_max; jj++) {                      \
+                        T sum = 0;                                            \
+                        for (u64 kk = 0; kk < k; kk++) {                      \
+                            sum += a->data[IDX(a, ii, kk)] *                  \
+                                   b_T->data[IDX(b_T, jj, kk)];               \
+                        }                                                     \
+                        out->data[IDX(out, ii, jj)] = sum;                    \
+                    }                                                         \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+        matrix_destroy_##T(b_T);                                              \
     }
 
 // ============================================================================
@@ -371,29 +509,113 @@
     }
 
 // ============================================================================
-// DETERMINANT (via LU decomposition, works for all types)
+// DETERMINANT (pivoted LU in double, works for all types)
 // ============================================================================
 
-#define MATRIX_DET(T)                                                         \
-    double matrix_det_##T(const Matrix_##T* mat)                              \
-    {                                                                         \
-        CHECK_FATAL(!mat, "mat matrix is null");                              \
-        CHECK_FATAL(mat->m != mat->n,                                         \
-                    "only square matrices have determinant");                 \
-                                                                              \
-        u64         n = mat->n;                                               \
-        Matrix_##T* L = matrix_create_##T(n, n);                              \
-        Matrix_##T* U = matrix_create_##T(n, n);                              \
-                                                                              \
-        matrix_LU_Decomp_##T(L, U, mat);                                      \
-                                                                              \
-        double det = 1.0;                                                     \
-        for (u64 i = 0; i < n; i++) { det *= (double)U->data[IDX(U, i, i)]; } \
-                                                                              \
-        matrix_destroy_##T(L);                                                \
-        matrix_destroy_##T(U);                                                \
-                                                                              \
-        return det;                                                           \
+// 0 for a singular matrix
+#define MATRIX_DET(T)                                                     \
+    double matrix_det_##T(const Matrix_##T* mat)                          \
+    {                                                                     \
+        CHECK_FATAL(!mat, "mat matrix is null");                          \
+        CHECK_FATAL(mat->m != mat->n,                                     \
+                    "only square matrices have determinant");             \
+                                                                          \
+        u64     n = mat->n;                                               \
+        u64*    perm;                                                     \
+        double* lu = matrix_lu_workspace(n, n * n, &perm);                \
+                                                                          \
+        for (u64 i = 0; i < n * n; i++) { lu[i] = (double)mat->data[i]; } \
+                                                                          \
+        u64    swaps;                                                     \
+        double det = lu_f64_factor(lu, n, n, perm, &swaps)                \
+                         ? lu_f64_det(lu, n, n, swaps)                    \
+                         : 0;                                             \
+                                                                          \
+        free(perm);                                                       \
+        return det;                                                       \
+    }
+
+// ============================================================================
+// LINEAR SOLVE (pivoted LU in double, works for all types)
+// ============================================================================
+
+// Solve a * x = b (a: n×n, b and x: n×r), the result cast back to T
+// (integer types truncate). Warns and returns false if a is singular
+#define MATRIX_SOLVE(T)                                                    \
+    b8 matrix_solve_##T(Matrix_##T* x, const Matrix_##T* a,                \
+                        const Matrix_##T* b)                               \
+    {                                                                      \
+        CHECK_FATAL(!x, "x mat is null");                                  \
+        CHECK_FATAL(!a, "a mat is null");                                  \
+        CHECK_FATAL(!b, "b mat is null");                                  \
+        CHECK_FATAL(a->m != a->n, "a is not a square matrix");             \
+        CHECK_FATAL(b->m != a->n || x->m != b->m || x->n != b->n,          \
+                    "incompatible matrix dimensions");                     \
+                                                                           \
+        u64 n = a->n;                                                      \
+        u64 r = b->n;                                                      \
+                                                                           \
+        /* lu (n×n), then b and x (n×r) in double */                       \
+        u64*    perm;                                                      \
+        double* lu = matrix_lu_workspace(n, (n * n) + (2 * n * r), &perm); \
+        double* bd = lu + (n * n);                                         \
+        double* xd = bd + (n * r);                                         \
+                                                                           \
+        for (u64 i = 0; i < n * n; i++) { lu[i] = (double)a->data[i]; }    \
+        for (u64 i = 0; i < n * r; i++) { bd[i] = (double)b->data[i]; }    \
+                                                                           \
+        b8 ok = lu_f64_factor(lu, n, n, perm, NULL);                       \
+        if (ok) {                                                          \
+            lu_f64_solve(lu, n, perm, n, bd, r, xd, r, r);                 \
+            for (u64 i = 0; i < n * r; i++) { x->data[i] = (T)xd[i]; }     \
+        } else {                                                           \
+            WARN("matrix is singular, no solution");                       \
+        }                                                                  \
+                                                                           \
+        free(perm);                                                        \
+        return ok;                                                         \
+    }
+
+// ============================================================================
+// MULTIPLICATION WITH A WIDER ACCUMULATOR
+// ============================================================================
+
+// out = a * b with the sums in TACC: out is Matrix_TACC, a and b Matrix_T
+#define MATRIX_XPLY_ACC(T, TACC)                                               \
+    void matrix_xply_acc_##T##_##TACC(Matrix_##TACC* out, const Matrix_##T* a, \
+                                      const Matrix_##T* b)                     \
+    {                                                                          \
+        CHECK_FATAL(!out, "out matrix is null");                               \
+        CHECK_FATAL(!a, "a matrix is null");                                   \
+        CHECK_FATAL(!b, "b matrix is null");                                   \
+        CHECK_FATAL(a->n != b->m,                                              \
+                    "incompatible matrix dimensions for multiplication");      \
+        CHECK_FATAL(out->m != a->m || out->n != b->n,                          \
+                    "output matrix has wrong dimensions");                     \
+                                                                               \
+        u64 m = a->m;                                                          \
+        u64 k = a->n;                                                          \
+        u64 n = b->n;                                                          \
+                                                                               \
+        void (*gemm)(u64, u64, u64, const T*, const T*, TACC*) =               \
+            MATRIX_KERNEL(GEMM_ACC, T##_##TACC);                               \
+        if (gemm) {                                                            \
+            gemm(m, n, k, a->data, b->data, out->data);                        \
+            return;                                                            \
+        }                                                                      \
+                                                                               \
+        memset(out->data, 0, sizeof(TACC) * m * n);                            \
+                                                                               \
+        for (u64 i = 0; i < m; i++) {                                          \
+            TACC* out_row = out->data + (i * n);                               \
+            for (u64 kk = 0; kk < k; kk++) {                                   \
+                TACC     a_val = (TACC)a->data[IDX(a, i, kk)];                 \
+                const T* b_row = b->data + (kk * n);                           \
+                for (u64 j = 0; j < n; j++) {                                  \
+                    out_row[j] += a_val * (TACC)b_row[j];                      \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
     }
 
 // ============================================================================
@@ -445,7 +667,11 @@
     MATRIX_XPLY_2(T)               \
     MATRIX_LU_DECOMP(T)            \
     MATRIX_DET(T)                  \
+    MATRIX_SOLVE(T)                \
     MATRIX_PRINT(T, fmt)
 
+// matrix_xply_acc_T_TACC, after INSTANTIATE_MATRIX for both T and TACC
+#define INSTANTIATE_MATRIX_ACC(T, TACC) MATRIX_XPLY_ACC(T, TACC)
+
 
 #endif // MATRIX_GENERIC_H
@@ -0,0 +1,117 @@
+#ifndef RCUMAP_H
+#define RCUMAP_H
+
+#include "gen_vector.h"
+#include "hashmap.h"
+#include <pthread.h>
+
+
+/*          TLDR
+ * rcumap is a read-mostly map for tables that are read all the time and
+ * updated rarely (config, routing ...).
+ *
+ * The published table is an ordinary, immutable hashmap behind an atomic
+ * pointer. Readers never lock: they announce the current epoch in their
+ * own slot and load the pointer. Writers clone the table, modify the
+ * clone and publish it with one atomic store. The old table is retired
+ * and freed once every reader that could still see it has left its
+ * read section (epoch-based reclamation).
+ *
+ * Lookups on a snapshot use the normal hashmap functions (hashmap_get,
+ * hashmap_has ...). A snapshot must NOT be modified.
+ */
+
+
+#ifndef RCUMAP_MAX_READERS
+#define RCUMAP_MAX_READERS 64
+#endif
+
+
+// per reader thread, padded to a cache line so readers don't share lines
+typedef struct {
+    u64 epoch; // 0 = not in a read section, else global epoch at entry
+    u32 used;  // slot claimed by a reader thread
+} __attribute__((aligned(64))) rcu_reader;
+
+
+typedef struct {
+    hashmap*        current;      // published table (atomic)
+    u64             global_epoch; // atomic, starts at 1
+    rcu_reader      readers[RCUMAP_MAX_READERS];
+    pthread_mutex_t write_lock;   // serializes writers
+    genVec*         retired;      // rcu_retired, writer side only
+} rcumap;
+
+
+/**
+ * Create an rcumap publishing map (rcumap takes ownership)
+ */
+rcumap* rcumap_create(hashmap* map);
+
+/**
+ * Destroy rcumap, current and all retired tables
+ * No reader or writer may be active
+ */
+void rcumap_destroy(rcumap* map);
+
+
+// READERS
+// ===========================
+
+/**
+ * Claim a reader slot for the calling thread
+ * @return reader id to pass to read_lock/read_unlock
+ */
+u32 rcumap_reader_register(rcumap* map);
+
+// release a reader slot (must be outside a read section)
+void rcumap_reader_unregister(rcumap* map, u32 reader);
+
+/**
+ * Enter a read section and get the current snapshot
+ * The snapshot stays valid until rcumap_read_unlock. No nesting.
+ */
+const hashmap* rcumap_read_lock(rcumap* map, u32 reader);
+
+// leave the read section, the snapshot must not be used after this
+void rcumap_read_unlock(rcumap* map, u32 reader);
+
+/**
+ * Lookup in one call (read_lock + hashmap_get + read_unlock)
+ */
+b8 rcumap_get(rcumap* map, u32 reader, const u8* key, u8* val);
+
+
+// WRITERS
+// ===========================
+
+/**
+ * Start an update: takes the writer lock and returns a private clone
+ * of the current table to modify with the normal hashmap functions
+ */
+hashmap* rcumap_write_begin(rcumap* map);
+
+/**
+ * Publish next (from rcumap_write_begin), retire the old table,
+ * free retired tables that no reader can see anymore, release the lock
+ */
+void rcumap_write_commit(rcumap* map, hashmap* next);
+
+// Drop the clone and release the writer lock without publishing
+void rcumap_write_abort(rcumap* map, hashmap* next);
+
+/**
+ * Single put/del: a full clone + publish each
+ * Batch many changes with write_begin/commit instead
+ */
+b8 rcumap_put(rcumap* map, const u8* key, const u8* val);
+b8 rcumap_del(rcumap* map, const u8* key);
+
+/**
+ * Block until every retired table is freed
+ * (waits for readers that are inside a read section to leave it)
+ */
+void rcumap_synchronize(rcumap* map);
+
+
+#endif // RCUMAP_H
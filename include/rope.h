@@ -0,0 +1,86 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#include "String.h"
+
+
+/*          TLDR
+ * rope is a string stored as a balanced tree of small text leaves,
+ * for editor-style use: insert / remove anywhere in O(log n) expected
+ * instead of moving the whole tail like string_insert_* does.
+ *
+ * The tree is an implicit treap: in-order leaves spell the text, every
+ * node keeps the byte count of its subtree, so a position is found by
+ * walking down, and random priorities keep the depth O(log n).
+ * Each leaf holds up to ROPE_LEAF_MAX bytes inline; small edits that
+ * fit in the leaf they hit are done in place (no split / merge).
+ */
+
+
+#ifndef ROPE_LEAF_MAX
+#define ROPE_LEAF_MAX 256 // max bytes per leaf
+#endif
+
+
+typedef struct rope_node {
+    struct rope_node* left;
+    struct rope_node* right;
+    u64               size; // bytes in this subtree
+    u32               prio; // treap heap key (max at the root)
+    u32               len;  // bytes in data
+    char              data[ROPE_LEAF_MAX];
+} rope_node;
+
+typedef struct {
+    rope_node* root;
+    u64        seed; // priority generator state
+} rope;
+
+
+// create an empty rope
+rope* rope_create(void);
+
+// create a rope holding a copy of sv
+rope* rope_from_view(StringView sv);
+
+void rope_destroy(rope* r);
+
+static inline u64 rope_len(const rope* r)
+{
+    CHECK_FATAL(!r, "rope is null");
+    return r->root ? r->root->size : 0;
+}
+
+
+// Editing (i <= len)
+// ===========================
+
+void rope_insert(rope* r, u64 i, StringView text);
+void rope_insert_cstr(rope* r, u64 i, const char* cstr);
+
+void rope_append(rope* r, StringView text);
+
+// remove n chars starting at i (clamped to the end)
+void rope_remove(rope* r, u64 i, u64 n);
+
+
+// Access
+// ===========================
+
+char rope_char_at(const rope* r, u64 i);
+
+// copy n chars starting at i into out, returns chars copied (clamped)
+u64 rope_copy(const rope* r, u64 i, u64 n, char* out);
+
+// heap String of the whole text
+String* rope_to_string(const rope* r);
+
+// heap String of n chars from i (clamped)
+String* rope_substr(const rope* r, u64 i, u64 n);
+
+// call fn on every leaf in order (views are invalidated by edits)
+typedef void (*rope_chunk_fn)(StringView chunk, void* ctx);
+void rope_for_each_chunk(const rope* r, rope_chunk_fn fn, void* ctx);
+
+
+#endif // ROPE_H
@@ -0,0 +1,70 @@
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Compact, versioned binary format shared by all containers.
+ *
+ *   header : magic (u32) | version (u16) | kind (u16)
+ *   body   : container specific (see X_write in each module)
+ *
+ * Integers are written in host byte order (little endian on every
+ * target we build for). POD elements (no callback given) are written
+ * as raw bytes, in one bulk block where the container is contiguous.
+ * Elements that own resources are written/read through callbacks.
+ *
+ * All functions return true on success, false on I/O or format error.
+ */
+
+
+#define SER_MAGIC   0x44534357U // "WCSD"
+#define SER_VERSION 1
+
+// elements presized from a stored count when f can't seek
+#ifndef SER_RESERVE_MAX
+#define SER_RESERVE_MAX (1 << 20)
+#endif
+
+
+typedef enum {
+    SER_GENVEC  = 1,
+    SER_STRING  = 2,
+    SER_HASHMAP = 3,
+    SER_HASHSET = 4
+} SER_KIND;
+
+
+// Element callbacks for non-POD data
+// write: serialize the element pointed to by elm
+// read:  construct a NEW element in (uninitialized) memory at elm
+//        on failure, nothing must be left for the caller to clean up
+typedef b8 (*ser_write_fn)(FILE* f, const u8* elm);
+typedef b8 (*ser_read_fn)(FILE* f, u8* elm);
+
+
+// write the common header for a container of type kind
+b8 ser_write_header(FILE* f, SER_KIND kind);
+
+// read and validate the common header (magic, version, kind)
+b8 ser_read_header(FILE* f, SER_KIND kind);
+
+b8 ser_write_u32(FILE* f, u32 val);
+b8 ser_read_u32(FILE* f, u32* val);
+
+b8 ser_write_u64(FILE* f, u64 val);
+b8 ser_read_u64(FILE* f, u64* val);
+
+// raw byte block (size may be 0)
+b8 ser_write_bytes(FILE* f, const u8* data, u64 size);
+b8 ser_read_bytes(FILE* f, u8* data, u64 size);
+
+// how many of count stored elements to presize for: count capped by the
+// bytes left in f (min_size bytes per element, at least 1), or by
+// SER_RESERVE_MAX if f can't seek. A corrupt count can't over-allocate,
+// readers grow past the hint and fail when the stream runs out.
+u64 ser_reserve_hint(FILE* f, u64 count, u64 min_size);
+
+
+#endif // SERIALIZE_H
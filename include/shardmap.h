@@ -0,0 +1,107 @@
+#ifndef SHARDMAP_H
+#define SHARDMAP_H
+
+#include "hashmap.h"
+#include <pthread.h>
+
+
+/*          TLDR
+ * shardmap is a thread-safe hashmap for many concurrent writers.
+ * Keys are spread over N independent hashmaps (shards), picked by the
+ * high bits of the (mixed) key hash. Every shard has its own
+ * reader-writer lock, so lookups run in parallel and writers only
+ * contend when they hit the same shard.
+ *
+ * Copy/move/delete semantics are exactly those of hashmap.
+ * There is no get_ptr: a pointer into a shard is not safe to use
+ * after the lock is dropped. Use shardmap_get (copy out) or
+ * shardmap_update (modify in place under the lock) instead.
+ */
+
+
+#ifndef SHARDMAP_DEFAULT_SHARDS
+#define SHARDMAP_DEFAULT_SHARDS 64
+#endif
+
+#define SHARDMAP_CACHE_LINE 64
+
+
+// one lock + map per shard, cache line aligned to avoid false sharing
+typedef struct {
+    hashmap*         map;
+    pthread_rwlock_t lock;
+} __attribute__((aligned(SHARDMAP_CACHE_LINE))) shard;
+
+
+typedef struct {
+    shard*         shards;
+    u32            n_shards;   // always a power of 2
+    u32            shard_bits; // log2(n_shards)
+    u32            key_size;
+    custom_hash_fn hash_fn;
+} shardmap;
+
+
+// called with the shard's write lock held, val points into the map
+typedef void (*shardmap_update_fn)(u8* val, void* ctx);
+
+
+/**
+ * Create a new shardmap
+ * n_shards is rounded up to a power of 2 (0 -> SHARDMAP_DEFAULT_SHARDS)
+ * Rest of the arguments are the same as hashmap_create
+ */
+shardmap* shardmap_create(u32 n_shards, u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                          compare_fn cmp_fn, copy_fn key_copy, copy_fn val_copy,
+                          move_fn key_move, move_fn val_move,
+                          delete_fn key_del, delete_fn val_del);
+
+// Not thread-safe: no other thread may use the map during destroy
+void shardmap_destroy(shardmap* map);
+
+/**
+ * Insert or update key-value pair (COPY semantics)
+ * @return 1 if key existed (updated), 0 if new key inserted
+ */
+b8 shardmap_put(shardmap* map, const u8* key, const u8* val);
+
+/**
+ * Insert or update key-value pair (MOVE semantics)
+ * @return 1 if key existed (updated), 0 if new key inserted
+ */
+b8 shardmap_put_move(shardmap* map, u8** key, u8** val);
+
+/**
+ * Read-modify-write under a single lock
+ * If key is missing, it is inserted with a copy of init_val first.
+ * Then fn(val_ptr, ctx) is called on the stored value.
+ * @return 1 if key existed, 0 if it was inserted
+ */
+b8 shardmap_update(shardmap* map, const u8* key, const u8* init_val,
+                   shardmap_update_fn fn, void* ctx);
+
+/**
+ * Get value for key (copy semantics), takes a shared (read) lock
+ */
+b8 shardmap_get(shardmap* map, const u8* key, u8* val);
+
+/**
+ * Check if key exists, takes a shared (read) lock
+ */
+b8 shardmap_has(shardmap* map, const u8* key);
+
+/**
+ * Delete key-value pair
+ * If out is provided, value is copied to it before deletion
+ */
+b8 shardmap_del(shardmap* map, const u8* key, u8* out);
+
+/**
+ * Total number of entries
+ * Each shard is read under its lock, but the sum is only a snapshot
+ * if writers are running concurrently
+ */
+u64 shardmap_size(shardmap* map);
+
+
+#endif // SHARDMAP_H
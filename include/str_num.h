@@ -0,0 +1,51 @@
+#ifndef STR_NUM_H
+#define STR_NUM_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Number <-> text kernels on raw buffers, used by string_append_* and
+ * string_parse_* (String.h).
+ *
+ * Integers are written two digits at a time from a 200 byte "00".."99"
+ * table. Doubles are written as the shortest digit string that parses
+ * back to the same value (Ryu), laid out like Python's repr():
+ *   1.0  0.1  123.456  1e-05  1.7976931348623157e+308  -0.0  inf  nan
+ *
+ * Parsers read a prefix of (s, n) and return the number of bytes
+ * consumed, 0 if there is no number there (or it overflows).
+ * No whitespace is skipped. u64 parsing takes 8 digits per step (SWAR).
+ * Doubles use the exact fast path (<= 19 digits, value and power of
+ * ten exact in a double), otherwise strtod on a copy of the span.
+ */
+
+
+#define STR_U64_MAX_CHARS 20 // 18446744073709551615
+#define STR_I64_MAX_CHARS 20 // -9223372036854775808
+#define STR_F64_MAX_CHARS 24 // -2.2250738585072014e-308
+
+
+// Formatting (buf needs the MAX_CHARS, no '\0' is written)
+// ===========================
+
+// @return number of chars written
+u32 str_fmt_u64(char* buf, u64 val);
+u32 str_fmt_i64(char* buf, i64 val);
+u32 str_fmt_f64(char* buf, double val);
+
+
+// Parsing
+// ===========================
+
+// [0-9]+
+u64 str_parse_u64(const char* s, u64 n, u64* out);
+
+// [+-]?[0-9]+
+u64 str_parse_i64(const char* s, u64 n, i64* out);
+
+// [+-]? (digits [. digits] | . digits) [(e|E) [+-]? digits] | inf | infinity | nan
+u64 str_parse_f64(const char* s, u64 n, double* out);
+
+
+#endif // STR_NUM_H
@@ -0,0 +1,48 @@
+#ifndef STR_SEARCH_H
+#define STR_SEARCH_H
+
+#include "common.h"
+#include "gen_vector.h"
+
+
+/*          TLDR
+ * Byte search kernels on raw (ptr, len) buffers, used by String and
+ * StringView. Each one has an AVX2, an SSE2 and a scalar version,
+ * picked at runtime from cpu_simd_level() (cpu_features.h).
+ *
+ * Substring search uses the first-and-last-byte filter: compare 16/32
+ * positions at once against needle[0] and needle[m - 1], and only
+ * memcmp the middle of the candidates that pass both. Typical text
+ * rejects almost every position in the filter, so it runs at close to
+ * the speed of find_char instead of O(n * m).
+ */
+
+
+#define STR_NPOS ((u64)-1)
+
+
+// index of the first c in s[0..n), STR_NPOS if not found
+u64 str_find_char(const char* s, u64 n, char c);
+
+// number of c in s[0..n)
+u64 str_count_char(const char* s, u64 n, char c);
+
+// index of the first needle[0..m) in s[0..n), STR_NPOS if not found
+// (m == 0 matches at 0)
+u64 str_find(const char* s, u64 n, const char* needle, u64 m);
+
+// index of the first byte of s[0..n) that is one of set[0..k), STR_NPOS if none
+// (SIMD for k <= STR_SET_SIMD_MAX, a byte table otherwise)
+u64 str_find_any(const char* s, u64 n, const char* set, u64 k);
+
+#define STR_SET_SIMD_MAX 8
+
+/**
+ * Append the index (u64) of every match of needle to out
+ * Matches may overlap ("aa" in "aaa" -> 0, 1). out must have data_size 8.
+ * @return number of matches appended
+ */
+u64 str_find_all(const char* s, u64 n, const char* needle, u64 m, genVec* out);
+
+
+#endif // STR_SEARCH_H
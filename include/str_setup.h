@@ -4,40 +4,35 @@
 #include "String.h"
 
 
-u64 murmurhash3_str(const u8* key, u64 size) 
+// 32-bit murmurhash3 of len bytes
+static inline u64 murmurhash3_bytes(const char* data, u64 len)
 {
-    (void)size;
-    
-    String* str= (String*)key;
-    const char* data = string_data_ptr(str);
-    u64 len = string_len(str);
-    
     const u32 c1 = 0xcc9e2d51;
     const u32 c2 = 0x1b873593;
     const u32 seed = 0x9747b28c;
-    
+
     u32 h1 = seed;
-    
-    // Body - process 4-byte chunks
-    const u32* blocks = (const u32*)data;
+
+    // Body - process 4-byte chunks (data may be unaligned, e.g. a view)
     const u64 nblocks = len / 4;
-    
+
     for (u64 i = 0; i < nblocks; i++) {
-        u32 k1 = blocks[i];
-        
+        u32 k1;
+        memcpy(&k1, data + (i * 4), sizeof(k1));
+
         k1 *= c1;
         k1 = (k1 << 15) | (k1 >> 17);
         k1 *= c2;
-        
+
         h1 ^= k1;
         h1 = (h1 << 13) | (h1 >> 19);
         h1 = (h1 * 5) + 0xe6546b64;
     }
-    
+
     // Tail - handle remaining bytes
     const u8* tail = (const uint8_t*)(data + ((size_t)nblocks * 4));
     u32 k1 = 0;
-    
+
     switch (len & 3) {
         case 3: k1 ^= tail[2] << 16;
         case 2: k1 ^= tail[1] << 8;
@@ -47,9 +42,9 @@ u64 murmurhash3_str(const u8* key, u64 size)
                 k1 *= c2;
                 h1 ^= k1;
         default:
-           break; 
+           break;
     }
-    
+
     // Finalization
     h1 ^= len;
     h1 ^= h1 >> 16;
@@ -57,9 +52,53 @@ u64 murmurhash3_str(const u8* key, u64 size)
     h1 ^= h1 >> 13;
     h1 *= 0xc2b2ae35;
     h1 ^= h1 >> 16;
-    
+
     return h1;
 }
 
 
+// hash_fn for containers that store String by value
+static inline u64 murmurhash3_str(const u8* key, u64 size)
+{
+    (void)size;
+
+    const String* str = (const String*)key;
+    return murmurhash3_bytes(string_data_ptr(str), string_len(str));
+}
+
+
+/*
+ Heterogeneous lookup of String keys by a StringView
+ (same hash as murmurhash3_str, so it can be used on maps created with it)
+
+    StringView word = { buf, len };
+    u64 hash = murmurhash3_view(word);
+    int* count = (int*)hashmap_find_or_insert(map, hash, &word,
+                                  str_view_eq, str_view_make, NULL);
+*/
+static inline u64 murmurhash3_view(StringView sv)
+{
+    return murmurhash3_bytes(sv.data, sv.len);
+}
+
+// key_eq_fn: stored String vs StringView*
+static inline int str_view_eq(const u8* key, const void* view)
+{
+    const String*     str = (const String*)key;
+    const StringView* sv  = (const StringView*)view;
+
+    if (string_len(str) != sv->len) {
+        return 1;
+    }
+
+    return sv->len != 0 && memcmp(string_data_ptr(str), sv->data, sv->len) != 0;
+}
+
+// key_make_fn: construct the stored String from a StringView*
+static inline void str_view_make(u8* key, const void* view)
+{
+    string_create_stk_view((String*)key, *(const StringView*)view);
+}
+
+
 #endif // STR_SETUP_H
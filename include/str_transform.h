@@ -0,0 +1,64 @@
+#ifndef STR_TRANSFORM_H
+#define STR_TRANSFORM_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * ASCII case conversion and character class filtering on raw (ptr, len)
+ * buffers, used by String and the word counting example.
+ *
+ * Every byte is in exactly one str_class (C locale ctype, bytes >= 0x80
+ * are STR_CLASS_NON_ASCII). The kernels classify 32 (AVX2) / 16 (SSE2)
+ * bytes at once with range compares. Filtering drops the unwanted bytes
+ * by compacting each block: AVX2 shuffles 8 byte lanes through a table
+ * indexed by the keep mask, SSE2 copies the kept bytes of a mixed block
+ * one by one. Blocks where every byte is kept (or none is) take one
+ * store (or nothing).
+ * The level comes from cpu_simd_level() (cpu_features.h).
+ */
+
+
+typedef enum {
+    STR_CLASS_DIGIT     = 1 << 0, // 0-9
+    STR_CLASS_UPPER     = 1 << 1, // A-Z
+    STR_CLASS_LOWER     = 1 << 2, // a-z
+    STR_CLASS_SPACE     = 1 << 3, // ' ' \t \n \v \f \r
+    STR_CLASS_PUNCT     = 1 << 4, // other printable ASCII
+    STR_CLASS_CNTRL     = 1 << 5, // other bytes < 0x20, 0x7f
+    STR_CLASS_NON_ASCII = 1 << 6, // >= 0x80 (UTF-8 lead/continuation)
+} str_class;
+
+#define STR_CLASS_ALPHA (STR_CLASS_UPPER | STR_CLASS_LOWER)
+#define STR_CLASS_ALNUM (STR_CLASS_ALPHA | STR_CLASS_DIGIT)
+#define STR_CLASS_ALL   0x7F
+
+
+// the single str_class bit of c
+u32 str_classify(char c);
+
+// in place, only A-Z / a-z change
+void str_to_lower(char* s, u64 n);
+void str_to_upper(char* s, u64 n);
+
+/**
+ * Remove the bytes of s[0..n) whose class is in drop (str_class bits),
+ * in place, keeping the order of the rest
+ * @return the new length
+ */
+u64 str_filter(char* s, u64 n, u32 drop);
+
+/**
+ * Token normalization in one pass: letters are lowercased and kept,
+ * bytes of the classes in keep are kept as they are, the rest is dropped
+ * out needs n bytes and may be s (in place)
+ *
+ *   str_normalize("Don't 42x!", 10, out, 0)               -> "dontx"
+ *   str_normalize("Don't 42x!", 10, out, STR_CLASS_PUNCT) -> "don'tx!"
+ *
+ * @return length written to out
+ */
+u64 str_normalize(const char* s, u64 n, char* out, u32 keep);
+
+
+#endif // STR_TRANSFORM_H
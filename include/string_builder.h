@@ -0,0 +1,90 @@
+#ifndef STRING_BUILDER_H
+#define STRING_BUILDER_H
+
+#include "String.h"
+#include "arena.h"
+
+
+/*          TLDR
+ * str_builder collects appended bytes in a list of chunks and copies
+ * them out once, into a String of exactly the final size.
+ * Appending never moves bytes that are already in the builder, so
+ * assembling a large output piece by piece is O(total) instead of
+ * paying for every realloc + copy of a growing String.
+ *
+ * Chunks double in size (SB_CHUNK_MIN .. SB_CHUNK_MAX), an append
+ * larger than the next chunk gets a chunk of its own.
+ * With an arena, chunks are carved out of it (freed with the arena);
+ * once it is full the builder falls back to the heap.
+ */
+
+
+#ifndef SB_CHUNK_MIN
+#define SB_CHUNK_MIN 256 // bytes in the first chunk
+#endif
+
+#ifndef SB_CHUNK_MAX
+#define SB_CHUNK_MAX (nKB(64)) // chunks stop doubling here
+#endif
+
+
+typedef struct sb_chunk {
+    struct sb_chunk* next;
+    u64              len;
+    u64              cap;
+    b8               on_heap; // 0 -> lives in the arena
+    char             data[];
+} sb_chunk;
+
+typedef struct {
+    sb_chunk* head;
+    sb_chunk* tail;     // appends go here
+    u64       len;      // total bytes
+    u64       next_cap; // capacity of the next chunk
+    Arena*    arena;    // may be NULL
+} str_builder;
+
+
+// init a builder (struct owned by the caller), arena may be NULL
+void sb_init(str_builder* sb, Arena* arena);
+
+// free the heap chunks (arena chunks go with the arena)
+void sb_destroy(str_builder* sb);
+
+// drop the contents, keep the first chunk for reuse
+void sb_clear(str_builder* sb);
+
+static inline u64 sb_len(const str_builder* sb)
+{
+    CHECK_FATAL(!sb, "sb is null");
+    return sb->len;
+}
+
+
+// Appending
+// ===========================
+
+void sb_append(str_builder* sb, const char* data, u64 n);
+void sb_append_char(str_builder* sb, char c);
+void sb_append_cstr(str_builder* sb, const char* cstr);
+void sb_append_view(str_builder* sb, StringView sv);
+void sb_append_string(str_builder* sb, const String* str);
+
+
+// Materializing (one allocation, one copy of every byte)
+// ===========================
+
+// new heap String with the contents
+String* sb_build(const str_builder* sb);
+
+// append the contents to str (reserves once)
+void sb_build_into(const str_builder* sb, String* str);
+
+// malloced '\0' terminated copy, must be freed by the user
+char* sb_to_cstr(const str_builder* sb);
+
+// copy the contents to out (sb_len bytes, no terminator)
+void sb_copy_to(const str_builder* sb, char* out);
+
+
+#endif // STRING_BUILDER_H
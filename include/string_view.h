@@ -0,0 +1,115 @@
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+
+#include "String.h"
+
+
+/*          TLDR
+ * StringView (String.h) is a non-owning {data, len} slice of chars.
+ * Everything here works on views and returns views: substr, trim,
+ * split and compare never allocate and never copy bytes.
+ * A view is only valid while the bytes it points to are.
+ * Materialize with string_from_view / string_create_stk_view when the
+ * chars have to be stored.
+ */
+
+
+#define SV_NPOS ((u64)-1)
+
+// view of a string literal, no strlen: SV("abc")
+#define SV(lit) ((StringView){ (lit), sizeof(lit) - 1 })
+
+// printf("%.*s", SV_ARG(sv))
+#define SV_ARG(sv) (int)(sv).len, (sv).data
+
+
+static inline StringView sv_from_parts(const char* data, u64 len)
+{
+    return (StringView){ data, len };
+}
+
+StringView sv_from_cstr(const char* cstr);
+
+// view of a whole String (same as string_view)
+static inline StringView sv_from_string(const String* str)
+{
+    return string_view(str);
+}
+
+
+// Slicing (all clamp to the view, never fail)
+// ===========================
+
+// len chars from start (fewer if the view ends first)
+StringView sv_substr(StringView sv, u64 start, u64 len);
+
+// first n / last n chars
+StringView sv_prefix(StringView sv, u64 n);
+StringView sv_suffix(StringView sv, u64 n);
+
+// drop first n / last n chars
+StringView sv_drop_prefix(StringView sv, u64 n);
+StringView sv_drop_suffix(StringView sv, u64 n);
+
+// strip ASCII whitespace (' ', \t, \n, \v, \f, \r)
+StringView sv_trim(StringView sv);
+StringView sv_trim_left(StringView sv);
+StringView sv_trim_right(StringView sv);
+
+
+// Comparison / Search
+// ===========================
+
+// memcmp order, shorter is less if one is a prefix of the other
+int sv_compare(StringView a, StringView b);
+
+b8 sv_equals(StringView a, StringView b);
+b8 sv_equals_cstr(StringView sv, const char* cstr);
+
+b8 sv_starts_with(StringView sv, StringView prefix);
+b8 sv_ends_with(StringView sv, StringView suffix);
+
+// index of first c / needle, SV_NPOS if not found (SIMD, str_search.h)
+u64 sv_find_char(StringView sv, char c);
+u64 sv_find(StringView sv, StringView needle);
+
+u64 sv_count_char(StringView sv, char c);
+
+// append the index (u64) of every (overlapping) match to out
+u64 sv_find_all(StringView sv, StringView needle, genVec* out);
+
+// valid UTF-8 / number of code points in valid UTF-8 (SIMD, utf8.h)
+b8  sv_is_utf8(StringView sv);
+u64 sv_utf8_len(StringView sv);
+
+
+// Splitting
+// ===========================
+
+/*
+ Split iterator, walks the view without allocating
+
+   sv_split_iter it = sv_split(line, ',');
+   StringView field;
+   while (sv_split_next(&it, &field)) { ... }
+
+ sv_split: on one delimiter char, keeps empty fields
+           ("a,,b" -> "a" "" "b", n delimiters -> n + 1 fields)
+ sv_tokenize: on any char of delims ('\0' terminated), skips empty
+           tokens like strtok but without modifying the input
+*/
+typedef struct {
+    StringView  rest;
+    const char* delims; // NULL for sv_split
+    char        delim;
+    b8          done;
+} sv_split_iter;
+
+sv_split_iter sv_split(StringView sv, char delim);
+sv_split_iter sv_tokenize(StringView sv, const char* delims);
+
+// @return 1 and sets out, 0 when there are no more fields
+b8 sv_split_next(sv_split_iter* it, StringView* out);
+
+
+#endif // STRING_VIEW_H
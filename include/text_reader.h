@@ -0,0 +1,90 @@
+#ifndef TEXT_READER_H
+#define TEXT_READER_H
+
+#include "String.h"
+
+
+/*          TLDR
+ * text_reader walks a file (or a buffer) as lines or tokens, handing out
+ * StringViews into its own buffer: no per-line copies and no line length
+ * limit (unlike fgets into a fixed array).
+ *
+ * A stream reader freads READER_BLOCK_SIZE blocks. When a line or token
+ * runs past the end of the block, the unread tail is moved to the front,
+ * the buffer doubles if the tail fills it, and the search continues where
+ * it stopped. A mapped reader mmaps the whole file and never copies.
+ * Boundaries are found with the SIMD kernels in str_search.h.
+ *
+ * A view is valid until the next call on the reader.
+ */
+
+
+#ifndef READER_BLOCK_SIZE
+#define READER_BLOCK_SIZE (nKB(64)) // bytes per read
+#endif
+
+#define READER_DEFAULT_DELIMS " \t\r\n"
+#define READER_MAX_DELIMS     32
+
+
+typedef enum {
+    READER_STREAM, // fread into buf
+    READER_MMAP,   // buf is the mapped file
+    READER_MEMORY, // buf is the caller's memory
+} reader_mode;
+
+typedef struct {
+    FILE*       f;
+    char*       buf;
+    u64         cap;   // buffer size (stream)
+    u64         start; // first unread byte
+    u64         end;   // end of the valid bytes
+    reader_mode mode;
+    b8          eof;   // nothing more to read into buf
+    b8          owns_f;
+    u32         ndelims;
+    char        delims[READER_MAX_DELIMS];
+    u8          is_delim[256];
+} text_reader;
+
+
+/**
+ * Open path for buffered reading (block_size 0 -> READER_BLOCK_SIZE)
+ * @return NULL if the file can't be opened
+ */
+text_reader* reader_open(const char* path, u64 block_size);
+
+/**
+ * Map the whole file (read only), @return NULL if it can't be opened
+ * or mapped
+ */
+text_reader* reader_open_mmap(const char* path);
+
+// read from an open FILE (stdin, a pipe...), f is not closed by the reader
+text_reader* reader_from_file(FILE* f, u64 block_size);
+
+// read from memory, sv must stay valid while the reader is used
+text_reader* reader_from_view(StringView sv);
+
+// free the buffer / unmap / close the file if the reader opened it
+void reader_close(text_reader* r);
+
+
+/**
+ * Next line, without the '\n' (and without a '\r' before it)
+ * The last line doesn't need a '\n'. Empty lines are returned.
+ * @return 0 at the end of the input
+ */
+b8 reader_next_line(text_reader* r, StringView* line);
+
+// delimiter chars for reader_next_token ('\0' terminated, default " \t\r\n")
+void reader_set_delims(text_reader* r, const char* delims);
+
+/**
+ * Next token: skips runs of delimiters, like sv_tokenize
+ * @return 0 at the end of the input
+ */
+b8 reader_next_token(text_reader* r, StringView* token);
+
+
+#endif // TEXT_READER_H
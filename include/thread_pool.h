@@ -0,0 +1,70 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "common.h"
+#include <pthread.h>
+
+
+/*          TLDR
+ * A fixed set of worker threads for data parallel loops:
+ *
+ *   thread_pool_run(pool, fn, arg, n_tasks)
+ *
+ * calls fn(arg, i) for every i in [0, n_tasks) and returns when all of
+ * them are done. Tasks are handed out one at a time from an atomic
+ * counter, so uneven tasks balance out. The calling thread takes tasks
+ * too: a pool of n threads starts n - 1 workers, and a pool of 1 runs
+ * everything inline.
+ *
+ * The workers sleep on a condition variable between runs, so one pool
+ * can be created up front and reused for every call.
+ * Runs from different threads on the same pool are serialized.
+ * A run started from inside a task of the same pool (e.g. gemm_f32_mt
+ * called by a task) executes inline on that thread instead of waiting
+ * for the outer run, which would never finish.
+ */
+
+
+// one task of a run, i in [0, n_tasks)
+typedef void (*thread_pool_fn)(void* arg, u64 i);
+
+
+typedef struct {
+    pthread_t*      workers;
+    u32             n_threads; // workers + the calling thread
+
+    pthread_mutex_t run_lock; // one run at a time
+    pthread_mutex_t lock;     // guards everything below
+    pthread_cond_t  work_cv;  // a new run (or stop)
+    pthread_cond_t  done_cv;  // the last worker left the run
+
+    thread_pool_fn fn;
+    void*          arg;
+    u64            n_tasks;
+    u64            next;       // next task index (atomic)
+    u64            generation; // bumped for every run
+    u32            busy;       // workers still in the current run
+    b8             stop;
+} thread_pool;
+
+
+/**
+ * Start a pool of n_threads (including the caller)
+ * 0 -> the number of online cpus
+ */
+thread_pool* thread_pool_create(u32 n_threads);
+
+// stop and join the workers, the pool must be idle
+void thread_pool_destroy(thread_pool* pool);
+
+// fn(arg, i) for i in [0, n_tasks), returns when all are done
+// (inline on the calling thread when called from one of pool's tasks)
+void thread_pool_run(thread_pool* pool, thread_pool_fn fn, void* arg, u64 n_tasks);
+
+static inline u32 thread_pool_size(const thread_pool* pool)
+{
+    return pool->n_threads;
+}
+
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,53 @@
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Float transposes on row major buffers, used by matrix_T:
+ *
+ *   transpose_f32             dst (n x m) = src^T (m x n), out of place
+ *   transpose_square_f32      a = a^T, in place (n x n)
+ *   transpose_inplace_f32     a = a^T, in place (m x n -> n x m)
+ *
+ * Out of place is cache-oblivious: the larger side is halved (on a
+ * multiple of 8) until both fit TRANSPOSE_BLOCK, so the rows read and
+ * the rows written fit in cache at every level without knowing its
+ * size. Inside a block, AVX2 transposes 8 x 8 tiles in registers
+ * (unpack, shuffle, permute2f128), SSE2 4 x 4 tiles.
+ *
+ * Past TRANSPOSE_STREAM_MIN the matrix no longer fits the caches, and a
+ * tile writes half of each dst line: every line is then read for
+ * ownership twice. Large transposes go over 16 rows at a time instead,
+ * writing whole dst lines with non-temporal stores (same GB/s as memcpy).
+ *
+ * The square in-place version swaps tile pairs (i, j) <-> (j, i),
+ * transposing both in registers. The rectangular one follows the
+ * permutation cycles idx -> idx * m mod (m * n - 1), marking the moved
+ * elements in a bitVec. It only needs m * n bits extra, but the cycles
+ * jump around memory: much slower than out of place, use it when memory
+ * is the constraint.
+ */
+
+
+#ifndef TRANSPOSE_BLOCK
+#define TRANSPOSE_BLOCK 32 // recursion leaf: a 32 x 32 float tile is 4 KB
+#endif
+#ifndef TRANSPOSE_STREAM_MIN
+#define TRANSPOSE_STREAM_MIN (1 << 20) // m * n from here: stream (4 MB, past L2)
+#endif
+
+
+// dst[j][i] = src[i][j], src m x n (row stride lds), dst n x m (row stride ldd)
+// dst may NOT overlap src
+void transpose_f32(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd);
+
+// in place transpose of the n x n matrix at a (row stride lda)
+void transpose_square_f32(u64 n, float* a, u64 lda);
+
+// in place transpose of a dense m x n matrix: a becomes n x m
+void transpose_inplace_f32(u64 m, u64 n, float* a);
+
+
+#endif // TRANSPOSE_H
@@ -0,0 +1,81 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include "String.h"
+
+
+/*          TLDR
+ * UTF-8 on raw (ptr, len) buffers and StringViews.
+ * String stays byte based, these tell you whether the bytes are valid
+ * UTF-8 and walk them as code points.
+ *
+ * Validation rejects everything RFC 3629 does: overlong forms,
+ * surrogates (U+D800..DFFF), values above U+10FFFF, stray or missing
+ * continuation bytes, and a sequence cut off by the end of the buffer.
+ * The AVX2 kernel checks 64 bytes per step with three nibble lookups
+ * (Keiser & Lemire, the simdjson / simdutf validator). The SSE2 kernel
+ * skips ASCII 16 bytes at a time and checks the rest in scalar.
+ * The level comes from cpu_simd_level() (cpu_features.h).
+ */
+
+
+#define UTF8_REPLACEMENT 0xFFFD // decoded for invalid bytes
+#define UTF8_MAX_BYTES   4
+
+
+// Validation
+// ===========================
+
+b8 utf8_valid(const char* s, u64 n);
+
+// length of the longest valid prefix (n if all valid, else the offset
+// of the first byte of the first invalid sequence)
+u64 utf8_valid_prefix(const char* s, u64 n);
+
+// number of code points in valid UTF-8 (counts the non-continuation bytes)
+u64 utf8_count(const char* s, u64 n);
+
+
+// Decoding / Encoding
+// ===========================
+
+/**
+ * Decode the code point at s[0..n)
+ * invalid or truncated sequences give UTF8_REPLACEMENT and consume 1 byte
+ * @return bytes consumed (0 only when n == 0)
+ */
+u32 utf8_decode(const char* s, u64 n, u32* cp);
+
+/**
+ * Encode cp into out (up to 4 bytes, no '\0')
+ * surrogates and cp > U+10FFFF are encoded as UTF8_REPLACEMENT
+ * @return bytes written
+ */
+u32 utf8_encode(u32 cp, char* out);
+
+
+/*
+ Code point iterator
+
+   utf8_iter it = utf8_iter_begin(string_view(str));
+   u32 cp;
+   while (utf8_iter_next(&it, &cp)) { ... }
+
+ it.offset is the byte offset of the code point just returned
+*/
+typedef struct {
+    StringView sv;
+    u64        pos;    // next byte to decode
+    u64        offset; // start of the last decoded code point
+} utf8_iter;
+
+static inline utf8_iter utf8_iter_begin(StringView sv)
+{
+    return (utf8_iter){ sv, 0, 0 };
+}
+
+// @return 1 and sets cp, 0 at the end
+b8 utf8_iter_next(utf8_iter* it, u32* cp);
+
+
+#endif // UTF8_H
@@ -0,0 +1,42 @@
+#ifndef VEC_F32_H
+#define VEC_F32_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * Elementwise kernels over raw float arrays, used by the matrix ops:
+ *
+ *   vec_f32_add    out = a + b
+ *   vec_f32_sub    out = a - b
+ *   vec_f32_scale  out = s * x
+ *   vec_f32_axpy   out = alpha * x + y     (one pass instead of scale + add)
+ *   vec_f32_dot_f64  sum x[i] * y[i], accumulated in double
+ *
+ * AVX2 handles 32 floats per iteration (4 ymm, FMA for axpy), SSE2 16
+ * (4 xmm), the rest is a scalar tail. The level comes from
+ * cpu_simd_level() (cpu_features.h).
+ *
+ * Loads and stores are unaligned. out may be the same array as any
+ * input (in place), but must not partially overlap one.
+ * With FMA, axpy rounds once, so it can differ from the scalar path
+ * in the last bit.
+ *
+ * dot_f64 widens to double before multiplying: the products are exact
+ * and only the sum rounds (in double), for accuracy critical dots.
+ * AVX2 keeps 4 ymm sums of 4 doubles, SSE2 4 xmm of 2.
+ */
+
+
+void vec_f32_add(float* out, const float* a, const float* b, u64 n);
+
+void vec_f32_sub(float* out, const float* a, const float* b, u64 n);
+
+void vec_f32_scale(float* out, const float* x, float s, u64 n);
+
+void vec_f32_axpy(float* out, float alpha, const float* x, const float* y, u64 n);
+
+double vec_f32_dot_f64(const float* x, const float* y, u64 n);
+
+
+#endif // VEC_F32_H
@@ -0,0 +1,30 @@
+#ifndef VEC_F64_H
+#define VEC_F64_H
+
+#include "common.h"
+
+
+/*          TLDR
+ * vec_f32.h for doubles, used by the double matrices of matrix_generic.h:
+ *
+ *   vec_f64_add    out = a + b
+ *   vec_f64_sub    out = a - b
+ *   vec_f64_scale  out = s * x
+ *   vec_f64_axpy   out = alpha * x + y
+ *
+ * AVX2 handles 16 doubles per iteration (4 ymm, FMA for axpy), SSE2 8
+ * (4 xmm), the rest is a scalar tail. Same aliasing rules as vec_f32.h:
+ * out may be an input, but must not partially overlap one.
+ */
+
+
+void vec_f64_add(double* out, const double* a, const double* b, u64 n);
+
+void vec_f64_sub(double* out, const double* a, const double* b, u64 n);
+
+void vec_f64_scale(double* out, const double* x, double s, u64 n);
+
+void vec_f64_axpy(double* out, double alpha, const double* x, const double* y, u64 n);
+
+
+#endif // VEC_F64_H
@@ -1,4 +1,8 @@
 #include "String.h"
+#include "str_num.h"
+#include "str_search.h"
+#include "str_transform.h"
+#include "utf8.h"
 
 #include <string.h>
 
@@ -9,10 +13,128 @@
 u64 cstr_len(const char* cstr);
 
 
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+#define STR_BUF(str) ((str)->is_heap ? (str)->heap.data : (str)->sso.data)
+
+
+static void str_init(String* str)
+{
+    str->sso.size = 0;
+    str->is_heap  = 0;
+}
+
+static void str_set_len(String* str, u64 len)
+{
+    if (str->is_heap) {
+        str->heap.size = len;
+    } else {
+        str->sso.size = (u8)len;
+    }
+}
+
+// set capacity to new_cap (> current), spilling to the heap if inline
+static void str_set_capacity(String* str, u64 new_cap)
+{
+    if (str->is_heap) {
+        char* data = realloc(str->heap.data, new_cap);
+        CHECK_FATAL(!data, "realloc failed");
+
+        str->heap.data     = data;
+        str->heap.capacity = new_cap;
+        return;
+    }
+
+    // inline -> heap
+    char* data = malloc(new_cap);
+    CHECK_FATAL(!data, "str data malloc failed");
+
+    u64 len = str->sso.size;
+    memcpy(data, str->sso.data, len);
+
+    str->heap.data     = data;
+    str->heap.size     = len;
+    str->heap.capacity = new_cap;
+    str->is_heap       = 1;
+}
+
+// make room for at least min_cap chars (amortized growth)
+static void str_grow(String* str, u64 min_cap)
+{
+    u64 cap = string_capacity(str);
+    if (min_cap <= cap) {
+        return;
+    }
+
+    u64 new_cap = (u64)((float)cap * STRING_GROWTH);
+    if (new_cap < min_cap) {
+        new_cap = min_cap;
+    }
+
+    str_set_capacity(str, new_cap);
+}
+
+// insert n bytes of src at index i (src may point into str itself)
+static void str_insert_bytes(String* str, u64 i, const char* src, u64 n)
+{
+    if (n == 0) {
+        return;
+    }
+
+    u64   len = string_len(str);
+    char* buf = STR_BUF(str);
+
+    // src inside our buffer: it may move or be shifted, take a copy
+    char* tmp = NULL;
+    if (src >= buf && src < buf + string_capacity(str)) {
+        tmp = malloc(n);
+        CHECK_FATAL(!tmp, "tmp malloc failed");
+        memcpy(tmp, src, n);
+        src = tmp;
+    }
+
+    str_grow(str, len + n);
+    buf = STR_BUF(str);
+
+    memmove(buf + i + n, buf + i, len - i);
+    memcpy(buf + i, src, n);
+    str_set_len(str, len + n);
+
+    free(tmp);
+}
+
+// construct str from n bytes (str is uninitialized)
+static void str_init_bytes(String* str, const char* src, u64 n)
+{
+    str_init(str);
+
+    if (n > STRING_SSO_CAP) {
+        str->heap.data = malloc(n);
+        CHECK_FATAL(!str->heap.data, "str data malloc failed");
+        str->heap.capacity = n;
+        str->is_heap       = 1;
+    }
+
+    if (n != 0) {
+        memcpy(STR_BUF(str), src, n);
+    }
+    str_set_len(str, n);
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
 
 String* string_create(void)
 {
-    return (String*)genVec_init(0, sizeof(char), NULL, NULL, NULL);
+    String* str = malloc(sizeof(String));
+    CHECK_FATAL(!str, "str malloc failed");
+
+    str_init(str);
+    return str;
 }
 
 
@@ -26,11 +148,16 @@ void string_create_stk(String* str, const char* cstr)
         len = cstr_len(cstr);
     }
 
-    genVec_init_stk(len, sizeof(char), NULL, NULL, NULL, str);
-    
-    if (len != 0) {
-        genVec_insert_multi(str, 0, (const u8*)cstr, len);
-    }
+    str_init_bytes(str, cstr, len);
+}
+
+
+void string_create_stk_view(String* str, StringView sv)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(!sv.data && sv.len != 0, "view data is null");
+
+    str_init_bytes(str, sv.data, sv.len);
 }
 
 
@@ -44,6 +171,16 @@ String* string_from_cstr(const char* cstr)
 }
 
 
+String* string_from_view(StringView sv)
+{
+    String* str = malloc(sizeof(String));
+    CHECK_FATAL(!str, "str malloc failed");
+
+    string_create_stk_view(str, sv);
+    return str;
+}
+
+
 String* string_from_string(const String* other)
 {
     CHECK_FATAL(!other, "other str is null");
@@ -51,11 +188,7 @@ String* string_from_string(const String* other)
     String* str = malloc(sizeof(String));
     CHECK_FATAL(!str, "str malloc failed");
 
-    genVec_init_stk(other->size, sizeof(char), NULL, NULL, NULL, str);
-
-    if (other->size != 0) {
-        genVec_insert_multi(str, 0, other->data, other->size);
-    }
+    str_init_bytes(str, STR_BUF(other), string_len(other));
 
     return str;
 }
@@ -63,13 +196,25 @@ String* string_from_string(const String* other)
 
 void string_reserve(String* str, u64 capacity)
 {
-    genVec_reserve(str, capacity);
+    CHECK_FATAL(!str, "str is null");
+
+    if (capacity > string_capacity(str)) {
+        str_set_capacity(str, capacity);
+    }
 }
 
 
 void string_reserve_char(String* str, u64 capacity, char c)
 {
-    genVec_reserve_val(str, capacity, cast(c));
+    CHECK_FATAL(!str, "str is null");
+
+    u64 len = string_len(str);
+    CHECK_FATAL(capacity < len, "capacity must be >= current len");
+
+    string_reserve(str, capacity);
+
+    memset(STR_BUF(str) + len, c, capacity - len);
+    str_set_len(str, capacity);
 }
 
 
@@ -81,7 +226,14 @@ void string_destroy(String* str)
 
 void string_destroy_stk(String* str)
 {
-    genVec_destroy_stk(str);
+    CHECK_FATAL(!str, "str is null");
+
+    if (str->is_heap) {
+        free(str->heap.data);
+    }
+
+    // back to an empty inline string, safe to destroy again
+    str_init(str);
 }
 
 
@@ -96,13 +248,11 @@ void string_move(String* dest, String** src)
         return;
     }
 
-    // no op if dest's data ptr is null (like stack inited)
     string_destroy_stk(dest);
 
-    // copy fields (including data ptr)
+    // copy fields (heap ptr or the inline chars)
     memcpy(dest, *src, sizeof(String));
 
-    (*src)->data = NULL;
     free(*src);
     *src = NULL;
 }
@@ -117,17 +267,10 @@ void string_copy(String* dest, const String* src)
         return;
     }
 
-    // no op if data ptr is null
     string_destroy_stk(dest);
 
-    // copy all fields (data ptr too)
-    memcpy(dest, src, sizeof(String));
-
-    // malloc new data ptr
-    dest->data = malloc(src->capacity);
-
-    // copy all data (arr of chars)
-    memcpy(dest->data, src->data, src->size);
+    // a short heap string becomes inline in the copy
+    str_init_bytes(dest, STR_BUF(src), string_len(src));
 }
 
 
@@ -135,19 +278,16 @@ char* string_to_cstr(const String* str)
 {
     CHECK_FATAL(!str, "str is null");
 
-    if (str->size == 0) {
-        char* empty = malloc(1);
-        CHECK_FATAL(!empty, "malloc failed");
-        empty[0] = '\0';
-        return empty;
-    }
+    u64 len = string_len(str);
 
-    char* out = malloc(str->size + 1); // + 1 for null term
+    char* out = malloc(len + 1); // + 1 for null term
     CHECK_FATAL(!out, "out str malloc failed");
 
-    memcpy(out, str->data, str->size);
+    if (len != 0) {
+        memcpy(out, STR_BUF(str), len);
+    }
 
-    out[str->size] = '\0'; // add null term
+    out[len] = '\0'; // add null term
 
     return out;
 }
@@ -157,11 +297,7 @@ char* string_data_ptr(const String* str)
 {
     CHECK_FATAL(!str, "str is null");
 
-    if (str->size == 0) {
-        return NULL;
-    }
-
-    return (char*)str->data;
+    return (char*)STR_BUF(str);
 }
 
 
@@ -170,12 +306,7 @@ void string_append_cstr(String* str, const char* cstr)
     CHECK_FATAL(!str, "str is null");
     CHECK_FATAL(!cstr, "cstr is null");
 
-    u64 len = cstr_len(cstr);
-    if (len == 0) {
-        return;
-    }
-
-    genVec_insert_multi(str, str->size, (const u8*)cstr, len);
+    str_insert_bytes(str, string_len(str), cstr, cstr_len(cstr));
 }
 
 
@@ -184,12 +315,8 @@ void string_append_string(String* str, const String* other)
     CHECK_FATAL(!str, "str is empty");
     CHECK_FATAL(!other, "other is empty");
 
-    if (other->size == 0) {
-        return;
-    }
-
     // direct insertion from other's buffer
-    genVec_insert_multi(str, str->size, other->data, other->size);
+    str_insert_bytes(str, string_len(str), STR_BUF(other), string_len(other));
 }
 
 // append and consume source string
@@ -199,9 +326,7 @@ void string_append_string_move(String* str, String** other)
     CHECK_FATAL(!other, "other ptr is null");
     CHECK_FATAL(!*other, "*other is null");
 
-    if ((*other)->size > 0) {
-        genVec_insert_multi(str, str->size, (*other)->data, (*other)->size);
-    }
+    str_insert_bytes(str, string_len(str), STR_BUF(*other), string_len(*other));
 
     string_destroy(*other);
     *other = NULL;
@@ -211,7 +336,45 @@ void string_append_string_move(String* str, String** other)
 void string_append_char(String* str, char c)
 {
     CHECK_FATAL(!str, "str is null");
-    genVec_push(str, cast(c));
+
+    u64 len = string_len(str);
+    str_grow(str, len + 1);
+
+    STR_BUF(str)[len] = c;
+    str_set_len(str, len + 1);
+}
+
+
+void string_append_u64(String* str, u64 val)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    u64 len = string_len(str);
+    str_grow(str, len + STR_U64_MAX_CHARS);
+
+    str_set_len(str, len + str_fmt_u64(STR_BUF(str) + len, val));
+}
+
+
+void string_append_i64(String* str, i64 val)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    u64 len = string_len(str);
+    str_grow(str, len + STR_I64_MAX_CHARS);
+
+    str_set_len(str, len + str_fmt_i64(STR_BUF(str) + len, val));
+}
+
+
+void string_append_f64(String* str, double val)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    u64 len = string_len(str);
+    str_grow(str, len + STR_F64_MAX_CHARS);
+
+    str_set_len(str, len + str_fmt_f64(STR_BUF(str) + len, val));
 }
 
 
@@ -219,8 +382,11 @@ char string_pop_char(String* str)
 {
     CHECK_FATAL(!str, "str is null");
 
-    char c;
-    genVec_pop(str, cast(c));
+    u64 len = string_len(str);
+    CHECK_FATAL(len == 0, "str is empty");
+
+    char c = STR_BUF(str)[len - 1];
+    str_set_len(str, len - 1);
 
     return c;
 }
@@ -229,9 +395,9 @@ char string_pop_char(String* str)
 void string_insert_char(String* str, u64 i, char c)
 {
     CHECK_FATAL(!str, "str is null");
-    CHECK_FATAL(i > str->size, "index out of bounds");
+    CHECK_FATAL(i > string_len(str), "index out of bounds");
 
-    genVec_insert(str, i, cast(c));
+    str_insert_bytes(str, i, &c, 1);
 }
 
 
@@ -239,14 +405,9 @@ void string_insert_cstr(String* str, u64 i, const char* cstr)
 {
     CHECK_FATAL(!str, "str is null");
     CHECK_FATAL(!cstr, "cstr is null");
-    CHECK_FATAL(i > str->size, "index out of bounds");
-
-    u64 len = cstr_len(cstr);
-    if (len == 0) {
-        return;
-    }
+    CHECK_FATAL(i > string_len(str), "index out of bounds");
 
-    genVec_insert_multi(str, i, castptr(cstr), len);
+    str_insert_bytes(str, i, cstr, cstr_len(cstr));
 }
 
 
@@ -254,58 +415,60 @@ void string_insert_string(String* str, u64 i, const String* other)
 {
     CHECK_FATAL(!str, "str is null");
     CHECK_FATAL(!other, "other is null");
-    CHECK_FATAL(i > str->size, "index out of bounds");
-
-    if (other->size == 0) {
-        return;
-    }
+    CHECK_FATAL(i > string_len(str), "index out of bounds");
 
     // direct insertion
-    genVec_insert_multi(str, i, other->data, other->size);
+    str_insert_bytes(str, i, STR_BUF(other), string_len(other));
 }
 
 
 void string_remove_char(String* str, u64 i)
 {
     CHECK_FATAL(!str, "str is null");
-    CHECK_FATAL(i >= str->size, "index out of bounds");
+    CHECK_FATAL(i >= string_len(str), "index out of bounds");
 
-    genVec_remove(str, i, NULL);
+    string_remove_range(str, i, i);
 }
 
 
 void string_remove_range(String* str, u64 l, u64 r)
 {
     CHECK_FATAL(!str, "str is null");
-    CHECK_FATAL(l >= str->size, "index out of bounds");
+
+    u64 len = string_len(str);
+
+    CHECK_FATAL(l >= len, "index out of bounds");
     CHECK_FATAL(l > r, "invalid range");
+    CHECK_FATAL(r >= len, "index out of bounds");
 
-    genVec_remove_range(str, l, r);
+    char* buf = STR_BUF(str);
+    memmove(buf + l, buf + r + 1, len - r - 1);
+    str_set_len(str, len - (r - l + 1));
 }
 
 
 void string_clear(String* str)
 {
     CHECK_FATAL(!str, "str is null");
-    genVec_clear(str);
+    str_set_len(str, 0);
 }
 
 
 char string_char_at(const String* str, u64 i)
 {
     CHECK_FATAL(!str, "str is null");
-    CHECK_FATAL(i >= str->size, "index out of bounds");
+    CHECK_FATAL(i >= string_len(str), "index out of bounds");
 
-    return ((char*)str->data)[i];
+    return STR_BUF(str)[i];
 }
 
 
 void string_set_char(String* str, u64 i, char c)
 {
     CHECK_FATAL(!str, "str is null");
-    CHECK_FATAL(i >= str->size, "index out of bounds");
+    CHECK_FATAL(i >= string_len(str), "index out of bounds");
 
-    ((char*)str->data)[i] = c;
+    STR_BUF(str)[i] = c;
 }
 
 
@@ -314,20 +477,23 @@ int string_compare(const String* str1, const String* str2)
     CHECK_FATAL(!str1, "str1 is null");
     CHECK_FATAL(!str2, "str2 is null");
 
-    u64 min_len = str1->size < str2->size ? str1->size : str2->size;
+    u64 len1 = string_len(str1);
+    u64 len2 = string_len(str2);
+
+    u64 min_len = len1 < len2 ? len1 : len2;
 
     // Compare byte by byte
-    int cmp = memcmp(str1->data, str2->data, min_len);
+    int cmp = memcmp(STR_BUF(str1), STR_BUF(str2), min_len);
 
     if (cmp != 0) {
         return cmp;
     }
 
     // If equal so far, shorter string is "less"
-    if (str1->size < str2->size) {
+    if (len1 < len2) {
         return -1;
     }
-    if (str1->size > str2->size) {
+    if (len1 > len2) {
         return 1;
     }
 
@@ -349,7 +515,7 @@ b8 string_equals_cstr(const String* str, const char* cstr)
     u64 len = cstr_len(cstr);
 
     // Different lengths = not equal
-    if (str->size != len) {
+    if (string_len(str) != len) {
         return false;
     }
     // Both empty
@@ -357,7 +523,7 @@ b8 string_equals_cstr(const String* str, const char* cstr)
         return true;
     }
 
-    return memcmp(str->data, cstr, len) == 0;
+    return memcmp(STR_BUF(str), cstr, len) == 0;
 }
 
 
@@ -365,13 +531,7 @@ u64 string_find_char(const String* str, char c)
 {
     CHECK_FATAL(!str, "str is null");
 
-    for (u64 i = 0; i < str->size; i++) {
-        if (((char*)str->data)[i] == c) {
-            return i;
-        }
-    }
-
-    return (u64)-1; // Not found
+    return str_find_char(STR_BUF(str), string_len(str), c);
 }
 
 
@@ -380,33 +540,31 @@ u64 string_find_cstr(const String* str, const char* substr)
     CHECK_FATAL(!str, "str is null");
     CHECK_FATAL(!substr, "substr is null");
 
-    u64 len = cstr_len(substr);
+    return str_find(STR_BUF(str), string_len(str), substr, cstr_len(substr));
+}
 
-    // Empty substring is found at index 0
-    if (len == 0) {
-        return 0;
-    }
 
-    if (len > str->size) {
-        return (u64)-1;
-    }
+u64 string_count_char(const String* str, char c)
+{
+    CHECK_FATAL(!str, "str is null");
 
-    for (u64 i = 0; i <= str->size - len; i++) {
-        if (memcmp(str->data + i, substr, len) == 0) {
-            return i;
-        }
-    }
+    return str_count_char(STR_BUF(str), string_len(str), c);
+}
 
-    return (u64)-1;
+
+u64 string_find_all(const String* str, const char* substr, genVec* out)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(!substr, "substr is null");
+
+    return str_find_all(STR_BUF(str), string_len(str), substr, cstr_len(substr), out);
 }
 
 
 String* string_substr(const String* str, u64 start, u64 length)
 {
     CHECK_FATAL(!str, "str is null");
-    CHECK_FATAL(start >= str->size, "index out of bounds");
-
-    String* result = string_create();
+    CHECK_FATAL(start >= string_len(str), "index out of bounds");
 
     u64 end     = start + length;
     u64 str_len = string_len(str);
@@ -414,29 +572,205 @@ String* string_substr(const String* str, u64 start, u64 length)
         end = str_len;
     }
 
-    u64 actual_len = end - start;
+    String* result = malloc(sizeof(String));
+    CHECK_FATAL(!result, "str malloc failed");
 
-    if (actual_len > 0) { // Insert substring all at once
-        const char* csrc = string_data_ptr(str) + start;
-        genVec_insert_multi(result, 0, (const u8*)csrc, actual_len);
-    }
+    str_init_bytes(result, STR_BUF(str) + start, end - start);
 
     return result;
 }
 
 
+StringView string_substr_view(const String* str, u64 start, u64 length)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(start > string_len(str), "index out of bounds");
+
+    u64 avail = string_len(str) - start;
+
+    return (StringView){ STR_BUF(str) + start, length < avail ? length : avail };
+}
+
+
+b8 string_is_utf8(const String* str)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    return utf8_valid(STR_BUF(str), string_len(str));
+}
+
+
+u64 string_utf8_len(const String* str)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    return utf8_count(STR_BUF(str), string_len(str));
+}
+
+
+void string_append_utf8(String* str, u32 cp)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    u64 len = string_len(str);
+    str_grow(str, len + UTF8_MAX_BYTES);
+
+    str_set_len(str, len + utf8_encode(cp, STR_BUF(str) + len));
+}
+
+
+void string_to_lower(String* str)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    str_to_lower(STR_BUF(str), string_len(str));
+}
+
+
+void string_to_upper(String* str)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    str_to_upper(STR_BUF(str), string_len(str));
+}
+
+
+void string_filter(String* str, u32 drop)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    str_set_len(str, str_filter(STR_BUF(str), string_len(str), drop));
+}
+
+
+u64 string_parse_u64(const String* str, u64 i, u64* out)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(i > string_len(str), "index out of bounds");
+
+    return str_parse_u64(STR_BUF(str) + i, string_len(str) - i, out);
+}
+
+
+u64 string_parse_i64(const String* str, u64 i, i64* out)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(i > string_len(str), "index out of bounds");
+
+    return str_parse_i64(STR_BUF(str) + i, string_len(str) - i, out);
+}
+
+
+u64 string_parse_f64(const String* str, u64 i, double* out)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(i > string_len(str), "index out of bounds");
+
+    return str_parse_f64(STR_BUF(str) + i, string_len(str) - i, out);
+}
+
+
 void string_print(const String* str)
 {
     CHECK_FATAL(!str, "str is null");
 
+    const char* buf = STR_BUF(str);
+    u64         len = string_len(str);
+
     putchar('\"');
-    for (u64 i = 0; i < str->size; i++) {
-        putchar(((char*)str->data)[i]);
+    for (u64 i = 0; i < len; i++) {
+        putchar(buf[i]);
     }
     putchar('\"');
 }
 
 
+// append len bytes from f in chunks capped by the bytes left in the stream,
+// so a corrupt length can't over-allocate (a short stream fails instead)
+static b8 str_read_bytes(String* str, FILE* f, u64 len)
+{
+    u64 old_len = string_len(str);
+    CHECK_WARN_RET(len > (u64)-1 - old_len, false, "string length overflow");
+
+    u64 chunk = ser_reserve_hint(f, len, 1);
+    if (chunk == 0) { chunk = 1; }
+
+    for (u64 left = len; left > 0;) {
+        u64 cur = string_len(str);
+        u64 n   = left < chunk ? left : chunk;
+
+        str_grow(str, cur + n);
+        if (!ser_read_bytes(f, (u8*)STR_BUF(str) + cur, n)) {
+            str_set_len(str, old_len);
+            return false;
+        }
+        str_set_len(str, cur + n);
+        left -= n;
+    }
+
+    return true;
+}
+
+
+b8 string_write(const String* str, FILE* f)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(!f, "file is null");
+
+    return ser_write_header(f, SER_STRING) && string_ser_write(f, (const u8*)str);
+}
+
+
+b8 string_read(String* str, FILE* f)
+{
+    CHECK_FATAL(!str, "str is null");
+    CHECK_FATAL(!f, "file is null");
+
+    u64 len = 0;
+    if (!ser_read_header(f, SER_STRING) || !ser_read_u64(f, &len)) {
+        return false;
+    }
+
+    if (len == 0) {
+        return true;
+    }
+
+    return str_read_bytes(str, f, len);
+}
+
+
+b8 string_ser_write(FILE* f, const u8* elm)
+{
+    const String* str = (const String*)elm;
+
+    return ser_write_u64(f, string_len(str)) &&
+           ser_write_bytes(f, (const u8*)STR_BUF(str), string_len(str));
+}
+
+
+b8 string_ser_read(FILE* f, u8* elm)
+{
+    u64 len = 0;
+    if (!ser_read_u64(f, &len)) {
+        return false;
+    }
+
+    String* str = (String*)elm;
+    string_create_stk(str, NULL);
+
+    if (len == 0) {
+        return true;
+    }
+
+    if (!str_read_bytes(str, f, len)) {
+        string_destroy_stk(str);
+        return false;
+    }
+
+    return true;
+}
+
+
 u64 cstr_len(const char* cstr)
 {
     u64 len = 0;
@@ -448,5 +782,3 @@ u64 cstr_len(const char* cstr)
 
     return len;
 }
-
-
@@ -0,0 +1,83 @@
+#include "cpu_features.h"
+
+#include <pthread.h>
+
+
+
+static cpu_features   features;
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static u32            max_level   = CPU_AVX2; // atomic
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// runs once (pthread_once)
+static void detect(void)
+{
+    cpu_features f = { 0 };
+
+#if CPU_X86
+    __builtin_cpu_init();
+
+    f.sse2    = __builtin_cpu_supports("sse2") != 0;
+    f.sse42   = __builtin_cpu_supports("sse4.2") != 0;
+    f.avx     = __builtin_cpu_supports("avx") != 0;
+    f.avx2    = __builtin_cpu_supports("avx2") != 0;
+    f.fma     = __builtin_cpu_supports("fma") != 0;
+    f.avx512f = __builtin_cpu_supports("avx512f") != 0;
+#endif
+
+    features = f;
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+const cpu_features* cpu_get_features(void)
+{
+    pthread_once(&detect_once, detect);
+
+    return &features;
+}
+
+
+cpu_level cpu_simd_level(void)
+{
+    const cpu_features* f = cpu_get_features();
+
+    cpu_level level = CPU_SCALAR;
+    if (f->sse2) {
+        level = CPU_SSE2;
+    }
+    if (f->avx2 && f->fma) {
+        level = CPU_AVX2;
+    }
+
+    u32 cap = __atomic_load_n(&max_level, __ATOMIC_RELAXED);
+
+    return level < (cpu_level)cap ? level : (cpu_level)cap;
+}
+
+
+void cpu_set_max_level(cpu_level level)
+{
+    CHECK_FATAL(level > CPU_AVX2, "invalid cpu level");
+
+    __atomic_store_n(&max_level, (u32)level, __ATOMIC_RELAXED);
+}
+
+
+const char* cpu_level_name(cpu_level level)
+{
+    switch (level) {
+        case CPU_SCALAR: return "scalar";
+        case CPU_SSE2:   return "sse2";
+        case CPU_AVX2:   return "avx2";
+    }
+
+    return "?";
+}
@@ -0,0 +1,555 @@
+#include "gemm.h"
+#include "cpu_features.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+// micro-kernel: the MR x NR tile at c = alpha * (packed a * packed b) + beta * c
+typedef void (*gemm_kernel)(u64 kc, const float* a, const float* b, float* c, u64 ldc,
+                            float alpha, float beta);
+
+typedef struct {
+    u32         mr;
+    u32         nr;
+    gemm_kernel kernel;
+} gemm_impl;
+
+#define GEMM_MR_MAX 6
+#define GEMM_NR_MAX 16
+#define GEMM_ALIGN  64
+
+
+/*
+====================SCALAR====================
+*/
+
+#define SCALAR_MR 6
+#define SCALAR_NR 8
+
+static void kernel_scalar(u64 kc, const float* a, const float* b, float* c, u64 ldc,
+                          float alpha, float beta)
+{
+    float acc[SCALAR_MR][SCALAR_NR] = { 0 };
+
+    for (u64 p = 0; p < kc; p++) {
+        for (u32 r = 0; r < SCALAR_MR; r++) {
+            for (u32 j = 0; j < SCALAR_NR; j++) {
+                acc[r][j] += a[r] * b[j];
+            }
+        }
+        a += SCALAR_MR;
+        b += SCALAR_NR;
+    }
+
+    for (u32 r = 0; r < SCALAR_MR; r++) {
+        float* cr = c + (r * ldc);
+        for (u32 j = 0; j < SCALAR_NR; j++) {
+            cr[j] = beta == 0 ? alpha * acc[r][j] : (alpha * acc[r][j]) + (beta * cr[j]);
+        }
+    }
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+#define SSE2_MR 6
+#define SSE2_NR 8
+
+#define SSE2_ROW(r, x0, x1)                           \
+    do {                                              \
+        const __m128 ar = _mm_set1_ps(a[r]);          \
+        x0 = _mm_add_ps(x0, _mm_mul_ps(ar, b0));      \
+        x1 = _mm_add_ps(x1, _mm_mul_ps(ar, b1));      \
+    } while (0)
+
+#define SSE2_STORE(r, x0, x1)                                          \
+    do {                                                               \
+        float* cr = c + ((r) * ldc);                                   \
+        x0        = _mm_mul_ps(x0, va);                                \
+        x1        = _mm_mul_ps(x1, va);                                \
+        if (beta != 0) {                                               \
+            x0 = _mm_add_ps(x0, _mm_mul_ps(_mm_loadu_ps(cr), vb));     \
+            x1 = _mm_add_ps(x1, _mm_mul_ps(_mm_loadu_ps(cr + 4), vb)); \
+        }                                                              \
+        _mm_storeu_ps(cr, x0);                                         \
+        _mm_storeu_ps(cr + 4, x1);                                     \
+    } while (0)
+
+__attribute__((target("sse2")))
+static void kernel_sse2(u64 kc, const float* a, const float* b, float* c, u64 ldc,
+                        float alpha, float beta)
+{
+    __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+    __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+    __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+    __m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+    __m128 c40 = _mm_setzero_ps(), c41 = _mm_setzero_ps();
+    __m128 c50 = _mm_setzero_ps(), c51 = _mm_setzero_ps();
+
+    for (u64 p = 0; p < kc; p++) {
+        const __m128 b0 = _mm_load_ps(b);
+        const __m128 b1 = _mm_load_ps(b + 4);
+
+        SSE2_ROW(0, c00, c01);
+        SSE2_ROW(1, c10, c11);
+        SSE2_ROW(2, c20, c21);
+        SSE2_ROW(3, c30, c31);
+        SSE2_ROW(4, c40, c41);
+        SSE2_ROW(5, c50, c51);
+
+        a += SSE2_MR;
+        b += SSE2_NR;
+    }
+
+    const __m128 va = _mm_set1_ps(alpha);
+    const __m128 vb = _mm_set1_ps(beta);
+
+    SSE2_STORE(0, c00, c01);
+    SSE2_STORE(1, c10, c11);
+    SSE2_STORE(2, c20, c21);
+    SSE2_STORE(3, c30, c31);
+    SSE2_STORE(4, c40, c41);
+    SSE2_STORE(5, c50, c51);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+#define AVX2_MR 6
+#define AVX2_NR 16
+
+#define AVX2_ROW(r, x0, x1)                          \
+    do {                                             \
+        const __m256 ar = _mm256_broadcast_ss(a + (r)); \
+        x0 = _mm256_fmadd_ps(ar, b0, x0);            \
+        x1 = _mm256_fmadd_ps(ar, b1, x1);            \
+    } while (0)
+
+#define AVX2_STORE(r, x0, x1)                                           \
+    do {                                                                \
+        float* cr = c + ((r) * ldc);                                    \
+        x0        = _mm256_mul_ps(x0, va);                              \
+        x1        = _mm256_mul_ps(x1, va);                              \
+        if (beta != 0) {                                                \
+            x0 = _mm256_fmadd_ps(_mm256_loadu_ps(cr), vb, x0);          \
+            x1 = _mm256_fmadd_ps(_mm256_loadu_ps(cr + 8), vb, x1);      \
+        }                                                               \
+        _mm256_storeu_ps(cr, x0);                                       \
+        _mm256_storeu_ps(cr + 8, x1);                                   \
+    } while (0)
+
+// 12 accumulators + 2 B vectors + 1 broadcast = 15 of the 16 ymm registers
+__attribute__((target("avx2,fma")))
+static void kernel_avx2(u64 kc, const float* a, const float* b, float* c, u64 ldc,
+                        float alpha, float beta)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+#pragma GCC unroll 4
+    for (u64 p = 0; p < kc; p++) {
+        const __m256 b0 = _mm256_load_ps(b);
+        const __m256 b1 = _mm256_load_ps(b + 8);
+
+        AVX2_ROW(0, c00, c01);
+        AVX2_ROW(1, c10, c11);
+        AVX2_ROW(2, c20, c21);
+        AVX2_ROW(3, c30, c31);
+        AVX2_ROW(4, c40, c41);
+        AVX2_ROW(5, c50, c51);
+
+        a += AVX2_MR;
+        b += AVX2_NR;
+    }
+
+    const __m256 va = _mm256_set1_ps(alpha);
+    const __m256 vb = _mm256_set1_ps(beta);
+
+    AVX2_STORE(0, c00, c01);
+    AVX2_STORE(1, c10, c11);
+    AVX2_STORE(2, c20, c21);
+    AVX2_STORE(3, c30, c31);
+    AVX2_STORE(4, c40, c41);
+    AVX2_STORE(5, c50, c51);
+}
+
+#endif // CPU_X86
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static gemm_impl pick_impl(void)
+{
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return (gemm_impl){ AVX2_MR, AVX2_NR, kernel_avx2 };
+        case CPU_SSE2: return (gemm_impl){ SSE2_MR, SSE2_NR, kernel_sse2 };
+        default:       break;
+    }
+#endif
+
+    return (gemm_impl){ SCALAR_MR, SCALAR_NR, kernel_scalar };
+}
+
+static inline u64 min_u64(u64 a, u64 b)
+{
+    return a < b ? a : b;
+}
+
+static inline u64 round_up(u64 x, u64 to)
+{
+    return (x + to - 1) / to * to;
+}
+
+static float* alloc_packed(u64 count)
+{
+    void* mem = NULL;
+    CHECK_FATAL(posix_memalign(&mem, GEMM_ALIGN, round_up(count * sizeof(float), GEMM_ALIGN)) != 0,
+                "gemm pack buffer alloc failed");
+    return mem;
+}
+
+/*
+ A block (mc x kc, element (i, p) at a[i * rs + p * cs]) into panels of
+ mr rows: panel by panel, column by column, rows past mc are zero
+*/
+static void pack_a(u64 mc, u64 kc, const float* a, u64 rs, u64 cs, u32 mr, float* out)
+{
+    for (u64 i = 0; i < mc; i += mr) {
+        u64 rows = min_u64(mr, mc - i);
+
+        for (u64 p = 0; p < kc; p++) {
+            const float* src = a + (i * rs) + (p * cs);
+            u64          r   = 0;
+            for (; r < rows; r++) { *out++ = src[r * rs]; }
+            for (; r < mr; r++) { *out++ = 0; }
+        }
+    }
+}
+
+/*
+ B block (kc x nc, element (p, j) at b[p * rs + j * cs]) into panels of
+ nr columns: panel by panel, row by row, columns past nc are zero
+*/
+static void pack_b(u64 kc, u64 nc, const float* b, u64 rs, u64 cs, u32 nr, float* out)
+{
+    for (u64 j = 0; j < nc; j += nr) {
+        u64 cols = min_u64(nr, nc - j);
+
+        for (u64 p = 0; p < kc; p++) {
+            const float* src = b + (p * rs) + (j * cs);
+            u64          c   = 0;
+            if (cs == 1) {
+                memcpy(out, src, cols * sizeof(float));
+                c = cols;
+            } else {
+                for (; c < cols; c++) { out[c] = src[c * cs]; }
+            }
+            for (; c < nr; c++) { out[c] = 0; }
+            out += nr;
+        }
+    }
+}
+
+// every MR x NR tile of the packed mc x nc block
+static void macro_kernel(const gemm_impl* impl, u64 mc, u64 nc, u64 kc, const float* apack,
+                         const float* bpack, float* c, u64 ldc, float alpha, float beta)
+{
+    const u32 mr = impl->mr;
+    const u32 nr = impl->nr;
+
+    float tile[GEMM_MR_MAX * GEMM_NR_MAX];
+
+    for (u64 j = 0; j < nc; j += nr) {
+        u64          cols = min_u64(nr, nc - j);
+        const float* bp   = bpack + (j * kc);
+
+        for (u64 i = 0; i < mc; i += mr) {
+            u64          rows = min_u64(mr, mc - i);
+            const float* ap   = apack + (i * kc);
+            float*       cij  = c + (i * ldc) + j;
+
+            if (rows == mr && cols == nr) {
+                impl->kernel(kc, ap, bp, cij, ldc, alpha, beta);
+                continue;
+            }
+
+            // edge tile: full kernel into scratch, then the valid part
+            impl->kernel(kc, ap, bp, tile, nr, 1, 0);
+            for (u64 r = 0; r < rows; r++) {
+                float* cr = cij + (r * ldc);
+                for (u64 cc = 0; cc < cols; cc++) {
+                    float v = alpha * tile[(r * nr) + cc];
+                    cr[cc]  = beta == 0 ? v : v + (beta * cr[cc]);
+                }
+            }
+        }
+    }
+}
+
+// C = beta * C, without reading C when beta == 0
+static void scale_c(u64 m, u64 n, float beta, float* c, u64 ldc)
+{
+    for (u64 i = 0; i < m; i++) {
+        float* cr = c + (i * ldc);
+        if (beta == 0) {
+            memset(cr, 0, n * sizeof(float));
+        } else if (beta != 1) {
+            for (u64 j = 0; j < n; j++) { cr[j] *= beta; }
+        }
+    }
+}
+
+// small products: ikj, C row by row
+static void gemm_small(u64 m, u64 n, u64 k, float alpha, const float* a, u64 rsa, u64 csa,
+                       const float* b, u64 rsb, u64 csb, float* c, u64 ldc)
+{
+    for (u64 i = 0; i < m; i++) {
+        float* cr = c + (i * ldc);
+
+        for (u64 p = 0; p < k; p++) {
+            const float  av = alpha * a[(i * rsa) + (p * csa)];
+            const float* br = b + (p * rsb);
+            for (u64 j = 0; j < n; j++) {
+                cr[j] += av * br[j * csb];
+            }
+        }
+    }
+}
+
+/*
+ The five loops around the micro-kernel. A and B are read through
+ (row stride, col stride), so a transposed operand is just swapped strides.
+*/
+static void gemm_strided(u64 m, u64 n, u64 k, float alpha, const float* a, u64 rsa, u64 csa,
+                         const float* b, u64 rsb, u64 csb, float beta, float* c, u64 ldc)
+{
+    if (m == 0 || n == 0) {
+        return;
+    }
+
+    if (k == 0 || alpha == 0) {
+        scale_c(m, n, beta, c, ldc);
+        return;
+    }
+
+    if (m * n * k < GEMM_SMALL) {
+        scale_c(m, n, beta, c, ldc);
+        gemm_small(m, n, k, alpha, a, rsa, csa, b, rsb, csb, c, ldc);
+        return;
+    }
+
+    const gemm_impl impl = pick_impl();
+
+    // block sizes rounded to whole micro-tiles
+    const u64 mc_max = min_u64(round_up(m, impl.mr), GEMM_MC / impl.mr * impl.mr);
+    const u64 nc_max = min_u64(round_up(n, impl.nr), GEMM_NC / impl.nr * impl.nr);
+    const u64 kc_max = min_u64(k, GEMM_KC);
+
+    float* apack = alloc_packed(mc_max * kc_max);
+    float* bpack = alloc_packed(nc_max * kc_max);
+
+    for (u64 jc = 0; jc < n; jc += nc_max) {
+        u64 nc = min_u64(nc_max, n - jc);
+
+        for (u64 pc = 0; pc < k; pc += kc_max) {
+            u64   kc     = min_u64(kc_max, k - pc);
+            float beta_p = pc == 0 ? beta : 1; // later slices accumulate
+
+            pack_b(kc, nc, b + (pc * rsb) + (jc * csb), rsb, csb, impl.nr, bpack);
+
+            for (u64 ic = 0; ic < m; ic += mc_max) {
+                u64 mc = min_u64(mc_max, m - ic);
+
+                pack_a(mc, kc, a + (ic * rsa) + (pc * csa), rsa, csa, impl.mr, apack);
+                macro_kernel(&impl, mc, nc, kc, apack, bpack, c + (ic * ldc) + jc, ldc, alpha,
+                             beta_p);
+            }
+        }
+    }
+
+    free(apack);
+    free(bpack);
+}
+
+
+/*
+ One gemm_f32_mt call. For every (jc, pc) block, two pool runs:
+ pack (B panel groups, then A row blocks) and compute (row block x
+ column chunk tiles of C), both reading the shared packed buffers.
+*/
+typedef struct {
+    const gemm_impl* impl;
+    float            alpha, beta; // beta of the current pc slice
+    const float*     a;           // at (0, pc)
+    u64              rsa, csa;
+    const float*     b;           // at (pc, jc)
+    u64              rsb, csb;
+    float*           c; // at (0, jc)
+    u64              ldc;
+    u64              m, nc, kc;
+    u64              mc_max;      // rows per A block
+    u64              n_ablocks;
+    u64              group_cols;  // B cols packed per task
+    u64              n_groups;
+    u64              chunk_cols;  // C cols per compute task
+    u64              n_chunks;
+    float*           apack; // n_ablocks blocks of mc_max x kc
+    float*           bpack;
+} gemm_job;
+
+static inline u64 ceil_div(u64 x, u64 y)
+{
+    return (x + y - 1) / y;
+}
+
+// thread_pool_fn: B column group t, or A row block t - n_groups
+static void gemm_pack_task(void* arg, u64 t)
+{
+    const gemm_job* job = arg;
+
+    if (t < job->n_groups) {
+        u64 j = t * job->group_cols;
+        pack_b(job->kc, min_u64(job->group_cols, job->nc - j), job->b + (j * job->csb), job->rsb,
+               job->csb, job->impl->nr, job->bpack + (j * job->kc));
+        return;
+    }
+
+    u64 i = (t - job->n_groups) * job->mc_max;
+    pack_a(min_u64(job->mc_max, job->m - i), job->kc, job->a + (i * job->rsa), job->rsa,
+           job->csa, job->impl->mr, job->apack + (i * job->kc));
+}
+
+// thread_pool_fn: tile t = (A row block, C column chunk)
+static void gemm_compute_task(void* arg, u64 t)
+{
+    const gemm_job* job = arg;
+
+    u64 i = (t / job->n_chunks) * job->mc_max;
+    u64 j = (t % job->n_chunks) * job->chunk_cols;
+
+    macro_kernel(job->impl, min_u64(job->mc_max, job->m - i), min_u64(job->chunk_cols, job->nc - j),
+                 job->kc, job->apack + (i * job->kc), job->bpack + (j * job->kc),
+                 job->c + (i * job->ldc) + j, job->ldc, job->alpha, job->beta);
+}
+
+/*
+ Same loops as gemm_strided with the packing and the ic / jr loops
+ spread over the pool. B is packed once per (jc, pc) for all threads;
+ all of A's pc slice is packed too, so a row block can be split across
+ column chunks without packing it twice.
+*/
+static void gemm_strided_mt(u64 m, u64 n, u64 k, float alpha, const float* a, u64 rsa,
+                            u64 csa, const float* b, u64 rsb, u64 csb, float beta, float* c,
+                            u64 ldc, thread_pool* pool)
+{
+    u32 threads = thread_pool_size(pool);
+
+    if (threads == 1 || m * n * k < GEMM_MT_MIN || k == 0 || alpha == 0) {
+        gemm_strided(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+        return;
+    }
+
+    const gemm_impl impl = pick_impl(); // once, the workers use the same kernel
+
+    gemm_job job = { 0 };
+    job.impl     = &impl;
+    job.alpha    = alpha;
+    job.rsa      = rsa;
+    job.csa      = csa;
+    job.rsb      = rsb;
+    job.csb      = csb;
+    job.ldc      = ldc;
+    job.m        = m;
+
+    // smaller A blocks when there are few rows for the threads
+    u64 want      = (u64)threads * GEMM_MT_TASKS;
+    job.mc_max    = min_u64(GEMM_MC / impl.mr * impl.mr, round_up(ceil_div(m, threads), impl.mr));
+    job.n_ablocks = ceil_div(m, job.mc_max);
+
+    const u64 nc_max = min_u64(round_up(n, impl.nr), GEMM_NC / impl.nr * impl.nr);
+    const u64 kc_max = min_u64(k, GEMM_KC);
+
+    job.apack = alloc_packed(job.n_ablocks * job.mc_max * kc_max);
+    job.bpack = alloc_packed(nc_max * kc_max);
+
+    for (u64 jc = 0; jc < n; jc += nc_max) {
+        job.nc = min_u64(nc_max, n - jc);
+
+        job.group_cols = round_up(ceil_div(job.nc, threads), impl.nr);
+        job.n_groups   = ceil_div(job.nc, job.group_cols);
+
+        u64 chunks     = ceil_div(want, job.n_ablocks);
+        job.chunk_cols = round_up(ceil_div(job.nc, chunks), impl.nr);
+        job.n_chunks   = ceil_div(job.nc, job.chunk_cols);
+
+        for (u64 pc = 0; pc < k; pc += kc_max) {
+            job.kc   = min_u64(kc_max, k - pc);
+            job.beta = pc == 0 ? beta : 1;
+            job.a    = a + (pc * csa);
+            job.b    = b + (pc * rsb) + (jc * csb);
+            job.c    = c + jc;
+
+            thread_pool_run(pool, gemm_pack_task, &job, job.n_groups + job.n_ablocks);
+            thread_pool_run(pool, gemm_compute_task, &job, job.n_ablocks * job.n_chunks);
+        }
+    }
+
+    free(job.apack);
+    free(job.bpack);
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void gemm_f32(u64 m, u64 n, u64 k, float alpha, const float* a, u64 lda, const float* b,
+              u64 ldb, float beta, float* c, u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+    CHECK_FATAL(lda < k || ldb < n || ldc < n, "leading dimension too small");
+
+    gemm_strided(m, n, k, alpha, a, lda, 1, b, ldb, 1, beta, c, ldc);
+}
+
+
+void gemm_f32_strided(u64 m, u64 n, u64 k, float alpha, const float* a, u64 rsa, u64 csa,
+                      const float* b, u64 rsb, u64 csb, float beta, float* c, u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+
+    gemm_strided(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+}
+
+
+void gemm_f32_mt(u64 m, u64 n, u64 k, float alpha, const float* a, u64 lda, const float* b,
+                 u64 ldb, float beta, float* c, u64 ldc, thread_pool* pool)
+{
+    CHECK_FATAL(!pool, "pool is null");
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+    CHECK_FATAL(lda < k || ldb < n || ldc < n, "leading dimension too small");
+
+    gemm_strided_mt(m, n, k, alpha, a, lda, 1, b, ldb, 1, beta, c, ldc, pool);
+}
@@ -0,0 +1,245 @@
+#include "gemm_batch.h"
+#include "cpu_features.h"
+
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+// every kernel computes one pack: a, b, c point at the pack, and element
+// e of the pack's matrices is the vector at e * GEMM_BATCH_LANES
+#define LANES GEMM_BATCH_LANES
+
+
+/*
+====================SCALAR====================
+*/
+
+static void pack_scalar(u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    for (u64 i = 0; i < m; i++) {
+        for (u64 j = 0; j < n; j++) {
+            float acc[LANES] = { 0 };
+            for (u64 p = 0; p < k; p++) {
+                const float* ap = a + (((i * k) + p) * LANES);
+                const float* bp = b + (((p * n) + j) * LANES);
+                for (u32 t = 0; t < LANES; t++) { acc[t] += ap[t] * bp[t]; }
+            }
+            memcpy(c + (((i * n) + j) * LANES), acc, sizeof(acc));
+        }
+    }
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+// 4 lanes of the pack (a, b, c already offset to the half)
+static void half_sse2(u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    u64 i = 0;
+    for (; i + 2 <= m; i += 2) {
+        u64 j = 0;
+        for (; j + 4 <= n; j += 4) {
+            __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+            __m128 c02 = _mm_setzero_ps(), c03 = _mm_setzero_ps();
+            __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+            __m128 c12 = _mm_setzero_ps(), c13 = _mm_setzero_ps();
+
+            for (u64 p = 0; p < k; p++) {
+                const float* ap = a + (((i * k) + p) * LANES);
+                const float* bp = b + (((p * n) + j) * LANES);
+                __m128       a0 = _mm_loadu_ps(ap);
+                __m128       a1 = _mm_loadu_ps(ap + (k * LANES));
+                __m128       b0 = _mm_loadu_ps(bp);
+                __m128       b1 = _mm_loadu_ps(bp + LANES);
+                __m128       b2 = _mm_loadu_ps(bp + (2 * LANES));
+                __m128       b3 = _mm_loadu_ps(bp + (3 * LANES));
+
+                c00 = _mm_add_ps(c00, _mm_mul_ps(a0, b0));
+                c01 = _mm_add_ps(c01, _mm_mul_ps(a0, b1));
+                c02 = _mm_add_ps(c02, _mm_mul_ps(a0, b2));
+                c03 = _mm_add_ps(c03, _mm_mul_ps(a0, b3));
+                c10 = _mm_add_ps(c10, _mm_mul_ps(a1, b0));
+                c11 = _mm_add_ps(c11, _mm_mul_ps(a1, b1));
+                c12 = _mm_add_ps(c12, _mm_mul_ps(a1, b2));
+                c13 = _mm_add_ps(c13, _mm_mul_ps(a1, b3));
+            }
+
+            float* c0 = c + (((i * n) + j) * LANES);
+            float* c1 = c0 + (n * LANES);
+            _mm_storeu_ps(c0, c00);
+            _mm_storeu_ps(c0 + LANES, c01);
+            _mm_storeu_ps(c0 + (2 * LANES), c02);
+            _mm_storeu_ps(c0 + (3 * LANES), c03);
+            _mm_storeu_ps(c1, c10);
+            _mm_storeu_ps(c1 + LANES, c11);
+            _mm_storeu_ps(c1 + (2 * LANES), c12);
+            _mm_storeu_ps(c1 + (3 * LANES), c13);
+        }
+
+        // leftover columns, one element of c per row
+        for (; j < n; j++) {
+            __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps();
+            for (u64 p = 0; p < k; p++) {
+                const float* ap = a + (((i * k) + p) * LANES);
+                __m128       bv = _mm_loadu_ps(b + (((p * n) + j) * LANES));
+                c0              = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(ap), bv));
+                c1              = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(ap + (k * LANES)), bv));
+            }
+            _mm_storeu_ps(c + (((i * n) + j) * LANES), c0);
+            _mm_storeu_ps(c + ((((i + 1) * n) + j) * LANES), c1);
+        }
+    }
+
+    // leftover row
+    for (; i < m; i++) {
+        for (u64 j = 0; j < n; j++) {
+            __m128 c0 = _mm_setzero_ps();
+            for (u64 p = 0; p < k; p++) {
+                c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(a + (((i * k) + p) * LANES)),
+                                               _mm_loadu_ps(b + (((p * n) + j) * LANES))));
+            }
+            _mm_storeu_ps(c + (((i * n) + j) * LANES), c0);
+        }
+    }
+}
+
+static void pack_sse2(u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    half_sse2(m, n, k, a, b, c);
+    half_sse2(m, n, k, a + 4, b + 4, c + 4);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+__attribute__((target("avx2,fma")))
+static void pack_avx2(u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    u64 i = 0;
+    for (; i + 2 <= m; i += 2) {
+        u64 j = 0;
+        for (; j + 4 <= n; j += 4) {
+            __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+            __m256 c02 = _mm256_setzero_ps(), c03 = _mm256_setzero_ps();
+            __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+            __m256 c12 = _mm256_setzero_ps(), c13 = _mm256_setzero_ps();
+
+            for (u64 p = 0; p < k; p++) {
+                const float* ap = a + (((i * k) + p) * LANES);
+                const float* bp = b + (((p * n) + j) * LANES);
+                __m256       a0 = _mm256_loadu_ps(ap);
+                __m256       a1 = _mm256_loadu_ps(ap + (k * LANES));
+                __m256       b0 = _mm256_loadu_ps(bp);
+                __m256       b1 = _mm256_loadu_ps(bp + LANES);
+                __m256       b2 = _mm256_loadu_ps(bp + (2 * LANES));
+                __m256       b3 = _mm256_loadu_ps(bp + (3 * LANES));
+
+                c00 = _mm256_fmadd_ps(a0, b0, c00);
+                c01 = _mm256_fmadd_ps(a0, b1, c01);
+                c02 = _mm256_fmadd_ps(a0, b2, c02);
+                c03 = _mm256_fmadd_ps(a0, b3, c03);
+                c10 = _mm256_fmadd_ps(a1, b0, c10);
+                c11 = _mm256_fmadd_ps(a1, b1, c11);
+                c12 = _mm256_fmadd_ps(a1, b2, c12);
+                c13 = _mm256_fmadd_ps(a1, b3, c13);
+            }
+
+            float* c0 = c + (((i * n) + j) * LANES);
+            float* c1 = c0 + (n * LANES);
+            _mm256_storeu_ps(c0, c00);
+            _mm256_storeu_ps(c0 + LANES, c01);
+            _mm256_storeu_ps(c0 + (2 * LANES), c02);
+            _mm256_storeu_ps(c0 + (3 * LANES), c03);
+            _mm256_storeu_ps(c1, c10);
+            _mm256_storeu_ps(c1 + LANES, c11);
+            _mm256_storeu_ps(c1 + (2 * LANES), c12);
+            _mm256_storeu_ps(c1 + (3 * LANES), c13);
+        }
+
+        for (; j < n; j++) {
+            __m256 c0 = _mm256_setzero_ps(), c1 = _mm256_setzero_ps();
+            for (u64 p = 0; p < k; p++) {
+                const float* ap = a + (((i * k) + p) * LANES);
+                __m256       bv = _mm256_loadu_ps(b + (((p * n) + j) * LANES));
+                c0              = _mm256_fmadd_ps(_mm256_loadu_ps(ap), bv, c0);
+                c1              = _mm256_fmadd_ps(_mm256_loadu_ps(ap + (k * LANES)), bv, c1);
+            }
+            _mm256_storeu_ps(c + (((i * n) + j) * LANES), c0);
+            _mm256_storeu_ps(c + ((((i + 1) * n) + j) * LANES), c1);
+        }
+    }
+
+    for (; i < m; i++) {
+        for (u64 j = 0; j < n; j++) {
+            __m256 c0 = _mm256_setzero_ps();
+            for (u64 p = 0; p < k; p++) {
+                c0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + (((i * k) + p) * LANES)),
+                                     _mm256_loadu_ps(b + (((p * n) + j) * LANES)), c0);
+            }
+            _mm256_storeu_ps(c + (((i * n) + j) * LANES), c0);
+        }
+    }
+}
+
+#endif // CPU_X86
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void gemm_f32_batched(u64 batch, u64 m, u64 n, u64 k, const float* a, const float* b, float* c)
+{
+    if (batch == 0 || m == 0 || n == 0) {
+        return;
+    }
+    CHECK_FATAL(!c, "c is null");
+    CHECK_FATAL((!a || !b) && k != 0, "a or b is null");
+
+    void (*kernel)(u64, u64, u64, const float*, const float*, float*) = pack_scalar;
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: kernel = pack_avx2; break;
+        case CPU_SSE2: kernel = pack_sse2; break;
+        default:       break;
+    }
+#endif
+
+    const u64 packs = (batch + LANES - 1) / LANES;
+    for (u64 q = 0; q < packs; q++) {
+        kernel(m, n, k, a + (q * m * k * LANES), b + (q * k * n * LANES), c + (q * m * n * LANES));
+    }
+}
+
+
+void gemm_batch_interleave(float* dst, const float* src, u64 batch, u64 elems)
+{
+    CHECK_FATAL((!dst || !src) && batch * elems != 0, "dst or src is null");
+
+    u64 padded = (batch + LANES - 1) / LANES * LANES;
+    for (u64 t = 0; t < padded; t++) {
+        for (u64 e = 0; e < elems; e++) {
+            GEMM_BATCH_AT(dst, elems, e, t) = t < batch ? src[(t * elems) + e] : 0;
+        }
+    }
+}
+
+
+void gemm_batch_deinterleave(float* dst, const float* src, u64 batch, u64 elems)
+{
+    CHECK_FATAL((!dst || !src) && batch * elems != 0, "dst or src is null");
+
+    for (u64 t = 0; t < batch; t++) {
+        for (u64 e = 0; e < elems; e++) { dst[(t * elems) + e] = GEMM_BATCH_AT(src, elems, e, t); }
+    }
+}
@@ -0,0 +1,442 @@
+#include "gemm_f64.h"
+#include "cpu_features.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+// micro-kernel: the MR x NR tile at c = alpha * (packed a * packed b) + beta * c
+typedef void (*gemm_f64_kernel)(u64 kc, const double* a, const double* b, double* c, u64 ldc,
+                                double alpha, double beta);
+
+typedef struct {
+    u32             mr;
+    u32             nr;
+    gemm_f64_kernel kernel;
+} gemm_f64_impl;
+
+/*
+ Packing and the small path for one source element type: double for
+ gemm_f64, float for gemm_f32_f64 (widened on the way into the panels)
+*/
+typedef struct {
+    void (*pack_a)(u64 mc, u64 kc, const void* a, u64 rs, u64 cs, u32 mr, double* out);
+    void (*pack_b)(u64 kc, u64 nc, const void* b, u64 rs, u64 cs, u32 nr, double* out);
+    void (*small)(u64 m, u64 n, u64 k, double alpha, const void* a, u64 rsa, u64 csa,
+                  const void* b, u64 rsb, u64 csb, double* c, u64 ldc);
+    u32 size; // sizeof the source element
+} gemm_f64_src;
+
+#define GEMM_MR_MAX 6
+#define GEMM_NR_MAX 8
+#define GEMM_ALIGN  64
+
+
+/*
+====================SCALAR====================
+*/
+
+#define SCALAR_MR 6
+#define SCALAR_NR 4
+
+static void kernel_scalar(u64 kc, const double* a, const double* b, double* c, u64 ldc,
+                          double alpha, double beta)
+{
+    double acc[SCALAR_MR][SCALAR_NR] = { 0 };
+
+    for (u64 p = 0; p < kc; p++) {
+        for (u32 r = 0; r < SCALAR_MR; r++) {
+            for (u32 j = 0; j < SCALAR_NR; j++) {
+                acc[r][j] += a[r] * b[j];
+            }
+        }
+        a += SCALAR_MR;
+        b += SCALAR_NR;
+    }
+
+    for (u32 r = 0; r < SCALAR_MR; r++) {
+        double* cr = c + (r * ldc);
+        for (u32 j = 0; j < SCALAR_NR; j++) {
+            cr[j] = beta == 0 ? alpha * acc[r][j] : (alpha * acc[r][j]) + (beta * cr[j]);
+        }
+    }
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+#define SSE2_MR 6
+#define SSE2_NR 4
+
+#define SSE2_ROW(r, x0, x1)                      \
+    do {                                         \
+        const __m128d ar = _mm_set1_pd(a[r]);    \
+        x0 = _mm_add_pd(x0, _mm_mul_pd(ar, b0)); \
+        x1 = _mm_add_pd(x1, _mm_mul_pd(ar, b1)); \
+    } while (0)
+
+#define SSE2_STORE(r, x0, x1)                                          \
+    do {                                                               \
+        double* cr = c + ((r) * ldc);                                  \
+        x0         = _mm_mul_pd(x0, va);                               \
+        x1         = _mm_mul_pd(x1, va);                               \
+        if (beta != 0) {                                               \
+            x0 = _mm_add_pd(x0, _mm_mul_pd(_mm_loadu_pd(cr), vb));     \
+            x1 = _mm_add_pd(x1, _mm_mul_pd(_mm_loadu_pd(cr + 2), vb)); \
+        }                                                              \
+        _mm_storeu_pd(cr, x0);                                         \
+        _mm_storeu_pd(cr + 2, x1);                                     \
+    } while (0)
+
+__attribute__((target("sse2")))
+static void kernel_sse2(u64 kc, const double* a, const double* b, double* c, u64 ldc,
+                        double alpha, double beta)
+{
+    __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd();
+    __m128d c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+    __m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd();
+    __m128d c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+    __m128d c40 = _mm_setzero_pd(), c41 = _mm_setzero_pd();
+    __m128d c50 = _mm_setzero_pd(), c51 = _mm_setzero_pd();
+
+    for (u64 p = 0; p < kc; p++) {
+        const __m128d b0 = _mm_load_pd(b);
+        const __m128d b1 = _mm_load_pd(b + 2);
+
+        SSE2_ROW(0, c00, c01);
+        SSE2_ROW(1, c10, c11);
+        SSE2_ROW(2, c20, c21);
+        SSE2_ROW(3, c30, c31);
+        SSE2_ROW(4, c40, c41);
+        SSE2_ROW(5, c50, c51);
+
+        a += SSE2_MR;
+        b += SSE2_NR;
+    }
+
+    const __m128d va = _mm_set1_pd(alpha);
+    const __m128d vb = _mm_set1_pd(beta);
+
+    SSE2_STORE(0, c00, c01);
+    SSE2_STORE(1, c10, c11);
+    SSE2_STORE(2, c20, c21);
+    SSE2_STORE(3, c30, c31);
+    SSE2_STORE(4, c40, c41);
+    SSE2_STORE(5, c50, c51);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+#define AVX2_MR 6
+#define AVX2_NR 8
+
+#define AVX2_ROW(r, x0, x1)                              \
+    do {                                                 \
+        const __m256d ar = _mm256_broadcast_sd(a + (r)); \
+        x0 = _mm256_fmadd_pd(ar, b0, x0);                \
+        x1 = _mm256_fmadd_pd(ar, b1, x1);                \
+    } while (0)
+
+#define AVX2_STORE(r, x0, x1)                                      \
+    do {                                                           \
+        double* cr = c + ((r) * ldc);                              \
+        x0         = _mm256_mul_pd(x0, va);                        \
+        x1         = _mm256_mul_pd(x1, va);                        \
+        if (beta != 0) {                                           \
+            x0 = _mm256_fmadd_pd(_mm256_loadu_pd(cr), vb, x0);     \
+            x1 = _mm256_fmadd_pd(_mm256_loadu_pd(cr + 4), vb, x1); \
+        }                                                          \
+        _mm256_storeu_pd(cr, x0);                                  \
+        _mm256_storeu_pd(cr + 4, x1);                              \
+    } while (0)
+
+// 12 accumulators + 2 B vectors + 1 broadcast = 15 of the 16 ymm registers
+__attribute__((target("avx2,fma")))
+static void kernel_avx2(u64 kc, const double* a, const double* b, double* c, u64 ldc,
+                        double alpha, double beta)
+{
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+#pragma GCC unroll 4
+    for (u64 p = 0; p < kc; p++) {
+        const __m256d b0 = _mm256_load_pd(b);
+        const __m256d b1 = _mm256_load_pd(b + 4);
+
+        AVX2_ROW(0, c00, c01);
+        AVX2_ROW(1, c10, c11);
+        AVX2_ROW(2, c20, c21);
+        AVX2_ROW(3, c30, c31);
+        AVX2_ROW(4, c40, c41);
+        AVX2_ROW(5, c50, c51);
+
+        a += AVX2_MR;
+        b += AVX2_NR;
+    }
+
+    const __m256d va = _mm256_set1_pd(alpha);
+    const __m256d vb = _mm256_set1_pd(beta);
+
+    AVX2_STORE(0, c00, c01);
+    AVX2_STORE(1, c10, c11);
+    AVX2_STORE(2, c20, c21);
+    AVX2_STORE(3, c30, c31);
+    AVX2_STORE(4, c40, c41);
+    AVX2_STORE(5, c50, c51);
+}
+
+#endif // CPU_X86
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static gemm_f64_impl pick_impl(void)
+{
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return (gemm_f64_impl){ AVX2_MR, AVX2_NR, kernel_avx2 };
+        case CPU_SSE2: return (gemm_f64_impl){ SSE2_MR, SSE2_NR, kernel_sse2 };
+        default:       break;
+    }
+#endif
+
+    return (gemm_f64_impl){ SCALAR_MR, SCALAR_NR, kernel_scalar };
+}
+
+static inline u64 min_u64(u64 a, u64 b)
+{
+    return a < b ? a : b;
+}
+
+static inline u64 round_up(u64 x, u64 to)
+{
+    return (x + to - 1) / to * to;
+}
+
+static double* alloc_packed(u64 count)
+{
+    void* mem = NULL;
+    CHECK_FATAL(posix_memalign(&mem, GEMM_ALIGN, round_up(count * sizeof(double), GEMM_ALIGN)) != 0,
+                "gemm pack buffer alloc failed");
+    return mem;
+}
+
+/*
+ pack_a / pack_b / small of gemm.c for source type T, converting each
+ element to double. A panels: mr rows, column by column; B panels: nr
+ columns, row by row; rows / columns past the block are zero.
+*/
+#define GEMM_F64_SRC(sfx, T)                                                               \
+    static void pack_a_##sfx(u64 mc, u64 kc, const void* av, u64 rs, u64 cs, u32 mr,       \
+                             double* out)                                                  \
+    {                                                                                      \
+        const T* a = av;                                                                   \
+        for (u64 i = 0; i < mc; i += mr) {                                                 \
+            u64 rows = min_u64(mr, mc - i);                                                \
+            for (u64 p = 0; p < kc; p++) {                                                 \
+                const T* src = a + (i * rs) + (p * cs);                                    \
+                u64      r   = 0;                                                          \
+                for (; r < rows; r++) { *out++ = (double)src[r * rs]; }                    \
+                for (; r < mr; r++) { *out++ = 0; }                                        \
+            }                                                                              \
+        }                                                                                  \
+    }                                                                                      \
+                                                                                           \
+    static void pack_b_##sfx(u64 kc, u64 nc, const void* bv, u64 rs, u64 cs, u32 nr,       \
+                             double* out)                                                  \
+    {                                                                                      \
+        const T* b = bv;                                                                   \
+        for (u64 j = 0; j < nc; j += nr) {                                                 \
+            u64 cols = min_u64(nr, nc - j);                                                \
+            for (u64 p = 0; p < kc; p++) {                                                 \
+                const T* src = b + (p * rs) + (j * cs);                                    \
+                u64      c   = 0;                                                          \
+                for (; c < cols; c++) { out[c] = (double)src[c * cs]; }                    \
+                for (; c < nr; c++) { out[c] = 0; }                                        \
+                out += nr;                                                                 \
+            }                                                                              \
+        }                                                                                  \
+    }                                                                                      \
+                                                                                           \
+    static void small_##sfx(u64 m, u64 n, u64 k, double alpha, const void* av, u64 rsa,    \
+                            u64 csa, const void* bv, u64 rsb, u64 csb, double* c, u64 ldc) \
+    {                                                                                      \
+        const T* a = av;                                                                   \
+        const T* b = bv;                                                                   \
+        for (u64 i = 0; i < m; i++) {                                                      \
+            double* cr = c + (i * ldc);                                                    \
+            for (u64 p = 0; p < k; p++) {                                                  \
+                const double av_ = alpha * (double)a[(i * rsa) + (p * csa)];               \
+                const T*     br  = b + (p * rsb);                                          \
+                for (u64 j = 0; j < n; j++) { cr[j] += av_ * (double)br[j * csb]; }        \
+            }                                                                              \
+        }                                                                                  \
+    }                                                                                      \
+                                                                                           \
+    static const gemm_f64_src src_##sfx = { pack_a_##sfx, pack_b_##sfx, small_##sfx, sizeof(T) };
+
+GEMM_F64_SRC(f64, double)
+GEMM_F64_SRC(f32, float)
+
+// every MR x NR tile of the packed mc x nc block
+static void macro_kernel(const gemm_f64_impl* impl, u64 mc, u64 nc, u64 kc, const double* apack,
+                         const double* bpack, double* c, u64 ldc, double alpha, double beta)
+{
+    const u32 mr = impl->mr;
+    const u32 nr = impl->nr;
+
+    double tile[GEMM_MR_MAX * GEMM_NR_MAX];
+
+    for (u64 j = 0; j < nc; j += nr) {
+        u64           cols = min_u64(nr, nc - j);
+        const double* bp   = bpack + (j * kc);
+
+        for (u64 i = 0; i < mc; i += mr) {
+            u64           rows = min_u64(mr, mc - i);
+            const double* ap   = apack + (i * kc);
+            double*       cij  = c + (i * ldc) + j;
+
+            if (rows == mr && cols == nr) {
+                impl->kernel(kc, ap, bp, cij, ldc, alpha, beta);
+                continue;
+            }
+
+            // edge tile: full kernel into scratch, then the valid part
+            impl->kernel(kc, ap, bp, tile, nr, 1, 0);
+            for (u64 r = 0; r < rows; r++) {
+                double* cr = cij + (r * ldc);
+                for (u64 cc = 0; cc < cols; cc++) {
+                    double v = alpha * tile[(r * nr) + cc];
+                    cr[cc]   = beta == 0 ? v : v + (beta * cr[cc]);
+                }
+            }
+        }
+    }
+}
+
+// C = beta * C, without reading C when beta == 0
+static void scale_c(u64 m, u64 n, double beta, double* c, u64 ldc)
+{
+    for (u64 i = 0; i < m; i++) {
+        double* cr = c + (i * ldc);
+        if (beta == 0) {
+            memset(cr, 0, n * sizeof(double));
+        } else if (beta != 1) {
+            for (u64 j = 0; j < n; j++) { cr[j] *= beta; }
+        }
+    }
+}
+
+// byte offset of element (i, j) of a strided source
+static inline const void* at(const gemm_f64_src* src, const void* base, u64 i, u64 rs, u64 j,
+                             u64 cs)
+{
+    return (const u8*)base + (((i * rs) + (j * cs)) * src->size);
+}
+
+// the five loops around the micro-kernel, as in gemm.c
+static void gemm_strided(const gemm_f64_src* src, u64 m, u64 n, u64 k, double alpha,
+                         const void* a, u64 rsa, u64 csa, const void* b, u64 rsb, u64 csb,
+                         double beta, double* c, u64 ldc)
+{
+    if (m == 0 || n == 0) {
+        return;
+    }
+
+    if (k == 0 || alpha == 0) {
+        scale_c(m, n, beta, c, ldc);
+        return;
+    }
+
+    if (m * n * k < GEMM_F64_SMALL) {
+        scale_c(m, n, beta, c, ldc);
+        src->small(m, n, k, alpha, a, rsa, csa, b, rsb, csb, c, ldc);
+        return;
+    }
+
+    const gemm_f64_impl impl = pick_impl();
+
+    // block sizes rounded to whole micro-tiles
+    const u64 mc_max = min_u64(round_up(m, impl.mr), GEMM_F64_MC / impl.mr * impl.mr);
+    const u64 nc_max = min_u64(round_up(n, impl.nr), GEMM_F64_NC / impl.nr * impl.nr);
+    const u64 kc_max = min_u64(k, GEMM_F64_KC);
+
+    double* apack = alloc_packed(mc_max * kc_max);
+    double* bpack = alloc_packed(nc_max * kc_max);
+
+    for (u64 jc = 0; jc < n; jc += nc_max) {
+        u64 nc = min_u64(nc_max, n - jc);
+
+        for (u64 pc = 0; pc < k; pc += kc_max) {
+            u64    kc     = min_u64(kc_max, k - pc);
+            double beta_p = pc == 0 ? beta : 1; // later slices accumulate
+
+            src->pack_b(kc, nc, at(src, b, pc, rsb, jc, csb), rsb, csb, impl.nr, bpack);
+
+            for (u64 ic = 0; ic < m; ic += mc_max) {
+                u64 mc = min_u64(mc_max, m - ic);
+
+                src->pack_a(mc, kc, at(src, a, ic, rsa, pc, csa), rsa, csa, impl.mr, apack);
+                macro_kernel(&impl, mc, nc, kc, apack, bpack, c + (ic * ldc) + jc, ldc, alpha,
+                             beta_p);
+            }
+        }
+    }
+
+    free(apack);
+    free(bpack);
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void gemm_f64(u64 m, u64 n, u64 k, double alpha, const double* a, u64 lda, const double* b,
+              u64 ldb, double beta, double* c, u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+    CHECK_FATAL(lda < k || ldb < n || ldc < n, "leading dimension too small");
+
+    gemm_strided(&src_f64, m, n, k, alpha, a, lda, 1, b, ldb, 1, beta, c, ldc);
+}
+
+
+void gemm_f64_strided(u64 m, u64 n, u64 k, double alpha, const double* a, u64 rsa, u64 csa,
+                      const double* b, u64 rsb, u64 csb, double beta, double* c, u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+
+    gemm_strided(&src_f64, m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+}
+
+
+void gemm_f32_f64(u64 m, u64 n, u64 k, double alpha, const float* a, u64 lda, const float* b,
+                  u64 ldb, double beta, double* c, u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+    CHECK_FATAL(lda < k || ldb < n || ldc < n, "leading dimension too small");
+
+    gemm_strided(&src_f32, m, n, k, alpha, a, lda, 1, b, ldb, 1, beta, c, ldc);
+}
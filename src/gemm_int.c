@@ -0,0 +1,531 @@
+#include "gemm_int.h"
+#include "cpu_features.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+/*
+ micro-kernel: the MR x NR tile at c = (packed a * packed b), or c += it
+ when add is set (the later k slices). steps is the packed depth in words.
+*/
+typedef void (*gemm_int_kernel)(u64 steps, const i32* a, const i32* b, i32* c, u64 ldc, b8 add);
+
+// packs an mc x kc block of A / a kc x nc block of B into words
+typedef void (*gemm_int_pack)(u64 rows, u64 cols, const void* src, u64 ld, u32 width, i32* out);
+
+typedef struct {
+    u32             mr;
+    u32             nr;
+    u32             kstep; // k per packed word: 2 for int8, 1 for int32
+    gemm_int_kernel kernel;
+    gemm_int_pack   pack_a;
+    gemm_int_pack   pack_b;
+} gemm_int_impl;
+
+#define GEMM_MR_MAX 6
+#define GEMM_NR_MAX 16
+#define GEMM_ALIGN  64
+
+// two int16 in a word, lo in the low half (the madd_epi16 lane order)
+static inline i32 pair_i16(i32 lo, i32 hi)
+{
+    return (i32)((u32)(u16)lo | ((u32)(u16)hi << 16));
+}
+
+static inline i32 pair_lo(i32 w)
+{
+    return (i16)(u16)(u32)w;
+}
+
+static inline i32 pair_hi(i32 w)
+{
+    return (i16)(u16)((u32)w >> 16);
+}
+
+
+/*
+====================SCALAR====================
+*/
+
+#define SCALAR_MR 6
+#define SCALAR_NR 8
+
+// tile store shared by the scalar kernels, acc as u32 so the sums wrap
+static inline void store_scalar(const u32 acc[SCALAR_MR][SCALAR_NR], i32* c, u64 ldc, b8 add)
+{
+    for (u32 r = 0; r < SCALAR_MR; r++) {
+        i32* cr = c + (r * ldc);
+        for (u32 j = 0; j < SCALAR_NR; j++) {
+            cr[j] = (i32)(add ? (u32)cr[j] + acc[r][j] : acc[r][j]);
+        }
+    }
+}
+
+static void kernel_i8_scalar(u64 steps, const i32* a, const i32* b, i32* c, u64 ldc, b8 add)
+{
+    u32 acc[SCALAR_MR][SCALAR_NR] = { { 0 } };
+
+    for (u64 p = 0; p < steps; p++) {
+        for (u32 r = 0; r < SCALAR_MR; r++) {
+            i32 lo = pair_lo(a[r]);
+            i32 hi = pair_hi(a[r]);
+            for (u32 j = 0; j < SCALAR_NR; j++) {
+                acc[r][j] += (u32)((lo * pair_lo(b[j])) + (hi * pair_hi(b[j])));
+            }
+        }
+        a += SCALAR_MR;
+        b += SCALAR_NR;
+    }
+
+    store_scalar(acc, c, ldc, add);
+}
+
+static void kernel_i32_scalar(u64 steps, const i32* a, const i32* b, i32* c, u64 ldc, b8 add)
+{
+    u32 acc[SCALAR_MR][SCALAR_NR] = { { 0 } };
+
+    for (u64 p = 0; p < steps; p++) {
+        for (u32 r = 0; r < SCALAR_MR; r++) {
+            for (u32 j = 0; j < SCALAR_NR; j++) {
+                acc[r][j] += (u32)a[r] * (u32)b[j];
+            }
+        }
+        a += SCALAR_MR;
+        b += SCALAR_NR;
+    }
+
+    store_scalar(acc, c, ldc, add);
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+#define SSE2_MR 6
+#define SSE2_NR 8
+
+// low 32 bits of the lane products (SSE4.1's mullo_epi32)
+static inline __m128i mullo_sse2(__m128i x, __m128i y)
+{
+    __m128i even = _mm_mul_epu32(x, y);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+#define SSE2_ROW(r, x0, x1, mul)                 \
+    do {                                         \
+        const __m128i ar = _mm_set1_epi32(a[r]); \
+        x0 = _mm_add_epi32(x0, mul(ar, b0));     \
+        x1 = _mm_add_epi32(x1, mul(ar, b1));     \
+    } while (0)
+
+#define SSE2_STORE(r, x0, x1)                                                  \
+    do {                                                                       \
+        i32* cr = c + ((r) * ldc);                                             \
+        if (add) {                                                             \
+            x0 = _mm_add_epi32(x0, _mm_loadu_si128((const __m128i*)cr));       \
+            x1 = _mm_add_epi32(x1, _mm_loadu_si128((const __m128i*)(cr + 4))); \
+        }                                                                      \
+        _mm_storeu_si128((__m128i*)cr, x0);                                    \
+        _mm_storeu_si128((__m128i*)(cr + 4), x1);                              \
+    } while (0)
+
+// int8 (madd_epi16 on the int16 pairs) and int32 (mullo_sse2) kernels
+#define SSE2_KERNEL(name, mul)                                                      \
+    __attribute__((target("sse2"))) static void name(u64 steps, const i32* a,       \
+                                                     const i32* b, i32* c, u64 ldc, \
+                                                     b8 add)                        \
+    {                                                                               \
+        __m128i c00 = _mm_setzero_si128(), c01 = _mm_setzero_si128();               \
+        __m128i c10 = _mm_setzero_si128(), c11 = _mm_setzero_si128();               \
+        __m128i c20 = _mm_setzero_si128(), c21 = _mm_setzero_si128();               \
+        __m128i c30 = _mm_setzero_si128(), c31 = _mm_setzero_si128();               \
+        __m128i c40 = _mm_setzero_si128(), c41 = _mm_setzero_si128();               \
+        __m128i c50 = _mm_setzero_si128(), c51 = _mm_setzero_si128();               \
+                                                                                    \
+        for (u64 p = 0; p < steps; p++) {                                           \
+            const __m128i b0 = _mm_load_si128((const __m128i*)b);                   \
+            const __m128i b1 = _mm_load_si128((const __m128i*)(b + 4));             \
+                                                                                    \
+            SSE2_ROW(0, c00, c01, mul);                                             \
+            SSE2_ROW(1, c10, c11, mul);                                             \
+            SSE2_ROW(2, c20, c21, mul);                                             \
+            SSE2_ROW(3, c30, c31, mul);                                             \
+            SSE2_ROW(4, c40, c41, mul);                                             \
+            SSE2_ROW(5, c50, c51, mul);                                             \
+                                                                                    \
+            a += SSE2_MR;                                                           \
+            b += SSE2_NR;                                                           \
+        }                                                                           \
+                                                                                    \
+        SSE2_STORE(0, c00, c01);                                                    \
+        SSE2_STORE(1, c10, c11);                                                    \
+        SSE2_STORE(2, c20, c21);                                                    \
+        SSE2_STORE(3, c30, c31);                                                    \
+        SSE2_STORE(4, c40, c41);                                                    \
+        SSE2_STORE(5, c50, c51);                                                    \
+    }
+
+SSE2_KERNEL(kernel_i8_sse2, _mm_madd_epi16)
+SSE2_KERNEL(kernel_i32_sse2, mullo_sse2)
+
+
+/*
+====================AVX2====================
+*/
+
+#define AVX2_MR 6
+#define AVX2_NR 16
+
+#define AVX2_ROW(r, x0, x1, mul)                    \
+    do {                                            \
+        const __m256i ar = _mm256_set1_epi32(a[r]); \
+        x0 = _mm256_add_epi32(x0, mul(ar, b0));     \
+        x1 = _mm256_add_epi32(x1, mul(ar, b1));     \
+    } while (0)
+
+#define AVX2_STORE(r, x0, x1)                                                        \
+    do {                                                                             \
+        i32* cr = c + ((r) * ldc);                                                   \
+        if (add) {                                                                   \
+            x0 = _mm256_add_epi32(x0, _mm256_loadu_si256((const __m256i*)cr));       \
+            x1 = _mm256_add_epi32(x1, _mm256_loadu_si256((const __m256i*)(cr + 8))); \
+        }                                                                            \
+        _mm256_storeu_si256((__m256i*)cr, x0);                                       \
+        _mm256_storeu_si256((__m256i*)(cr + 8), x1);                                 \
+    } while (0)
+
+// 12 accumulators + 2 B vectors + 1 broadcast = 15 of the 16 ymm registers
+#define AVX2_KERNEL(name, mul)                                                      \
+    __attribute__((target("avx2"))) static void name(u64 steps, const i32* a,       \
+                                                     const i32* b, i32* c, u64 ldc, \
+                                                     b8 add)                        \
+    {                                                                               \
+        __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();         \
+        __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();         \
+        __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();         \
+        __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();         \
+        __m256i c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256();         \
+        __m256i c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();         \
+                                                                                    \
+        _Pragma("GCC unroll 4")                                                     \
+        for (u64 p = 0; p < steps; p++) {                                           \
+            const __m256i b0 = _mm256_load_si256((const __m256i*)b);                \
+            const __m256i b1 = _mm256_load_si256((const __m256i*)(b + 8));          \
+                                                                                    \
+            AVX2_ROW(0, c00, c01, mul);                                             \
+            AVX2_ROW(1, c10, c11, mul);                                             \
+            AVX2_ROW(2, c20, c21, mul);                                             \
+            AVX2_ROW(3, c30, c31, mul);                                             \
+            AVX2_ROW(4, c40, c41, mul);                                             \
+            AVX2_ROW(5, c50, c51, mul);                                             \
+                                                                                    \
+            a += AVX2_MR;                                                           \
+            b += AVX2_NR;                                                           \
+        }                                                                           \
+                                                                                    \
+        AVX2_STORE(0, c00, c01);                                                    \
+        AVX2_STORE(1, c10, c11);                                                    \
+        AVX2_STORE(2, c20, c21);                                                    \
+        AVX2_STORE(3, c30, c31);                                                    \
+        AVX2_STORE(4, c40, c41);                                                    \
+        AVX2_STORE(5, c50, c51);                                                    \
+    }
+
+AVX2_KERNEL(kernel_i8_avx2, _mm256_madd_epi16)
+AVX2_KERNEL(kernel_i32_avx2, _mm256_mullo_epi32)
+
+#endif // CPU_X86
+
+
+/*
+====================PACKING====================
+*/
+
+static inline u64 min_u64(u64 a, u64 b)
+{
+    return a < b ? a : b;
+}
+
+static inline u64 round_up(u64 x, u64 to)
+{
+    return (x + to - 1) / to * to;
+}
+
+/*
+ A block (mc x kc, rows lda apart) into panels of mr rows: panel by
+ panel, word by word, rows past mc are zero. int8 words hold k pairs.
+*/
+static void pack_a_i8(u64 mc, u64 kc, const void* src, u64 lda, u32 mr, i32* out)
+{
+    const i8* a = src;
+
+    for (u64 i = 0; i < mc; i += mr) {
+        u64 rows = min_u64(mr, mc - i);
+
+        for (u64 p = 0; p < kc; p += 2) {
+            const i8* ap = a + (i * lda) + p;
+            u64       r  = 0;
+            for (; r < rows; r++) {
+                *out++ = pair_i16(ap[r * lda], p + 1 < kc ? ap[(r * lda) + 1] : 0);
+            }
+            for (; r < mr; r++) { *out++ = 0; }
+        }
+    }
+}
+
+static void pack_a_i32(u64 mc, u64 kc, const void* src, u64 lda, u32 mr, i32* out)
+{
+    const i32* a = src;
+
+    for (u64 i = 0; i < mc; i += mr) {
+        u64 rows = min_u64(mr, mc - i);
+
+        for (u64 p = 0; p < kc; p++) {
+            const i32* ap = a + (i * lda) + p;
+            u64        r  = 0;
+            for (; r < rows; r++) { *out++ = ap[r * lda]; }
+            for (; r < mr; r++) { *out++ = 0; }
+        }
+    }
+}
+
+/*
+ B block (kc x nc, rows ldb apart) into panels of nr columns: panel by
+ panel, word row by word row, columns past nc are zero
+*/
+static void pack_b_i8(u64 kc, u64 nc, const void* src, u64 ldb, u32 nr, i32* out)
+{
+    const i8* b = src;
+
+    for (u64 j = 0; j < nc; j += nr) {
+        u64 cols = min_u64(nr, nc - j);
+
+        for (u64 p = 0; p < kc; p += 2) {
+            const i8* b0 = b + (p * ldb) + j;
+            const i8* b1 = b0 + ldb;
+            u64       c  = 0;
+            if (p + 1 < kc) {
+                for (; c < cols; c++) { out[c] = pair_i16(b0[c], b1[c]); }
+            } else {
+                for (; c < cols; c++) { out[c] = pair_i16(b0[c], 0); }
+            }
+            for (; c < nr; c++) { out[c] = 0; }
+            out += nr;
+        }
+    }
+}
+
+static void pack_b_i32(u64 kc, u64 nc, const void* src, u64 ldb, u32 nr, i32* out)
+{
+    const i32* b = src;
+
+    for (u64 j = 0; j < nc; j += nr) {
+        u64 cols = min_u64(nr, nc - j);
+
+        for (u64 p = 0; p < kc; p++) {
+            memcpy(out, b + (p * ldb) + j, cols * sizeof(i32));
+            memset(out + cols, 0, (nr - cols) * sizeof(i32));
+            out += nr;
+        }
+    }
+}
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static gemm_int_impl pick_impl(b8 int8)
+{
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2:
+            return int8 ? (gemm_int_impl){ AVX2_MR, AVX2_NR, 2, kernel_i8_avx2, pack_a_i8, pack_b_i8 }
+                        : (gemm_int_impl){ AVX2_MR, AVX2_NR, 1, kernel_i32_avx2, pack_a_i32, pack_b_i32 };
+        case CPU_SSE2:
+            return int8 ? (gemm_int_impl){ SSE2_MR, SSE2_NR, 2, kernel_i8_sse2, pack_a_i8, pack_b_i8 }
+                        : (gemm_int_impl){ SSE2_MR, SSE2_NR, 1, kernel_i32_sse2, pack_a_i32, pack_b_i32 };
+        default: break;
+    }
+#endif
+
+    return int8 ? (gemm_int_impl){ SCALAR_MR, SCALAR_NR, 2, kernel_i8_scalar, pack_a_i8, pack_b_i8 }
+                : (gemm_int_impl){ SCALAR_MR, SCALAR_NR, 1, kernel_i32_scalar, pack_a_i32, pack_b_i32 };
+}
+
+static i32* alloc_packed(u64 count)
+{
+    void* mem = NULL;
+    CHECK_FATAL(posix_memalign(&mem, GEMM_ALIGN, round_up(count * sizeof(i32), GEMM_ALIGN)) != 0,
+                "gemm pack buffer alloc failed");
+    return mem;
+}
+
+// every MR x NR tile of the packed mc x nc block
+static void macro_kernel(const gemm_int_impl* impl, u64 mc, u64 nc, u64 steps, const i32* apack,
+                         const i32* bpack, i32* c, u64 ldc, b8 add)
+{
+    const u32 mr = impl->mr;
+    const u32 nr = impl->nr;
+
+    i32 tile[GEMM_MR_MAX * GEMM_NR_MAX];
+
+    for (u64 j = 0; j < nc; j += nr) {
+        u64        cols = min_u64(nr, nc - j);
+        const i32* bp   = bpack + (j * steps);
+
+        for (u64 i = 0; i < mc; i += mr) {
+            u64        rows = min_u64(mr, mc - i);
+            const i32* ap   = apack + (i * steps);
+            i32*       cij  = c + (i * ldc) + j;
+
+            if (rows == mr && cols == nr) {
+                impl->kernel(steps, ap, bp, cij, ldc, add);
+                continue;
+            }
+
+            // edge tile: full kernel into scratch, then the valid part
+            impl->kernel(steps, ap, bp, tile, nr, false);
+            for (u64 r = 0; r < rows; r++) {
+                i32*       cr = cij + (r * ldc);
+                const i32* tr = tile + (r * nr);
+                for (u64 cc = 0; cc < cols; cc++) {
+                    cr[cc] = add ? (i32)((u32)cr[cc] + (u32)tr[cc]) : tr[cc];
+                }
+            }
+        }
+    }
+}
+
+// small products: ikj, C row by row, u32 so the sums wrap
+static void small_i8(u64 m, u64 n, u64 k, const i8* a, u64 lda, const i8* b, u64 ldb, i32* c,
+                     u64 ldc)
+{
+    for (u64 i = 0; i < m; i++) {
+        i32* cr = c + (i * ldc);
+        memset(cr, 0, n * sizeof(i32));
+
+        for (u64 p = 0; p < k; p++) {
+            const i32 av = a[(i * lda) + p];
+            const i8* br = b + (p * ldb);
+            for (u64 j = 0; j < n; j++) { cr[j] = (i32)((u32)cr[j] + (u32)(av * br[j])); }
+        }
+    }
+}
+
+static void small_i32(u64 m, u64 n, u64 k, const i32* a, u64 lda, const i32* b, u64 ldb,
+                      i32* c, u64 ldc)
+{
+    for (u64 i = 0; i < m; i++) {
+        i32* cr = c + (i * ldc);
+        memset(cr, 0, n * sizeof(i32));
+
+        for (u64 p = 0; p < k; p++) {
+            const u32  av = (u32)a[(i * lda) + p];
+            const i32* br = b + (p * ldb);
+            for (u64 j = 0; j < n; j++) { cr[j] = (i32)((u32)cr[j] + (av * (u32)br[j])); }
+        }
+    }
+}
+
+// the five loops around the micro-kernel, as in gemm.c; int8 picks the i8 kernels
+static void gemm_int(b8 int8, u64 m, u64 n, u64 k, const void* a, u64 lda, const void* b,
+                     u64 ldb, i32* c, u64 ldc)
+{
+    const gemm_int_impl impl  = pick_impl(int8);
+    const u64           esize = int8 ? sizeof(i8) : sizeof(i32);
+
+    // block sizes rounded to whole micro-tiles, kc to whole words
+    const u64 mc_max = min_u64(round_up(m, impl.mr), GEMM_INT_MC / impl.mr * impl.mr);
+    const u64 nc_max = min_u64(round_up(n, impl.nr), GEMM_INT_NC / impl.nr * impl.nr);
+    const u64 kc_max = min_u64(round_up(k, impl.kstep), (u64)GEMM_INT_KC * impl.kstep);
+    const u64 steps_max = kc_max / impl.kstep;
+
+    i32* apack = alloc_packed(mc_max * steps_max);
+    i32* bpack = alloc_packed(nc_max * steps_max);
+
+    for (u64 jc = 0; jc < n; jc += nc_max) {
+        u64 nc = min_u64(nc_max, n - jc);
+
+        for (u64 pc = 0; pc < k; pc += kc_max) {
+            u64 kc    = min_u64(kc_max, k - pc);
+            u64 steps = (kc + impl.kstep - 1) / impl.kstep;
+            b8  add   = pc != 0; // later slices accumulate
+
+            impl.pack_b(kc, nc, (const u8*)b + (((pc * ldb) + jc) * esize), ldb, impl.nr, bpack);
+
+            for (u64 ic = 0; ic < m; ic += mc_max) {
+                u64 mc = min_u64(mc_max, m - ic);
+
+                impl.pack_a(mc, kc, (const u8*)a + (((ic * lda) + pc) * esize), lda, impl.mr,
+                            apack);
+                macro_kernel(&impl, mc, nc, steps, apack, bpack, c + (ic * ldc) + jc, ldc, add);
+            }
+        }
+    }
+
+    free(apack);
+    free(bpack);
+}
+
+// C = 0 for an empty k
+static void zero_c(u64 m, u64 n, i32* c, u64 ldc)
+{
+    for (u64 i = 0; i < m; i++) { memset(c + (i * ldc), 0, n * sizeof(i32)); }
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void gemm_i8(u64 m, u64 n, u64 k, const i8* a, u64 lda, const i8* b, u64 ldb, i32* c, u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+    CHECK_FATAL(lda < k || ldb < n || ldc < n, "leading dimension too small");
+
+    if (m == 0 || n == 0) {
+        return;
+    }
+
+    if (k == 0) {
+        zero_c(m, n, c, ldc);
+    } else if (m * n * k < GEMM_INT_SMALL) {
+        small_i8(m, n, k, a, lda, b, ldb, c, ldc);
+    } else {
+        gemm_int(true, m, n, k, a, lda, b, ldb, c, ldc);
+    }
+}
+
+
+void gemm_i32(u64 m, u64 n, u64 k, const i32* a, u64 lda, const i32* b, u64 ldb, i32* c,
+              u64 ldc)
+{
+    CHECK_FATAL(!c && m * n != 0, "c is null");
+    CHECK_FATAL((!a || !b) && m * n * k != 0, "a or b is null");
+    CHECK_FATAL(lda < k || ldb < n || ldc < n, "leading dimension too small");
+
+    if (m == 0 || n == 0) {
+        return;
+    }
+
+    if (k == 0) {
+        zero_c(m, n, c, ldc);
+    } else if (m * n * k < GEMM_INT_SMALL) {
+        small_i32(m, n, k, a, lda, b, ldb, c, ldc);
+    } else {
+        gemm_int(false, m, n, k, a, lda, b, ldb, c, ldc);
+    }
+}
@@ -0,0 +1,269 @@
+#include "gemv.h"
+#include "cpu_features.h"
+
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+// y[0, len) *= beta, beta == 0 writes zeros (drops NaNs)
+static void scale_y(float* y, u64 len, float beta)
+{
+    if (beta == 0) {
+        memset(y, 0, len * sizeof(float));
+    } else if (beta != 1) {
+        for (u64 j = 0; j < len; j++) { y[j] *= beta; }
+    }
+}
+
+static inline float axby(float alpha, float sum, float beta, float y)
+{
+    return beta == 0 ? alpha * sum : (alpha * sum) + (beta * y);
+}
+
+
+/*
+====================SCALAR====================
+*/
+
+static void gemv_scalar(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x,
+                        float beta, float* y)
+{
+    for (u64 i = 0; i < m; i++) {
+        const float* ar  = a + (i * lda);
+        float        sum = 0;
+        for (u64 j = 0; j < n; j++) { sum += ar[j] * x[j]; }
+        y[i] = axby(alpha, sum, beta, y[i]);
+    }
+}
+
+static void gemv_t_scalar(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x,
+                          float* y)
+{
+    for (u64 i = 0; i < m; i++) {
+        const float* ar = a + (i * lda);
+        const float  c  = alpha * x[i];
+        for (u64 j = 0; j < n; j++) { y[j] += c * ar[j]; }
+    }
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+static void gemv_sse2(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x,
+                      float beta, float* y)
+{
+    u64 i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + (i * lda);
+        const float* a1 = a0 + lda;
+        const float* a2 = a1 + lda;
+        const float* a3 = a2 + lda;
+
+        __m128 s0 = _mm_setzero_ps();
+        __m128 s1 = _mm_setzero_ps();
+        __m128 s2 = _mm_setzero_ps();
+        __m128 s3 = _mm_setzero_ps();
+
+        u64 j = 0;
+        for (; j + 4 <= n; j += 4) {
+            __m128 xv = _mm_loadu_ps(x + j);
+            s0        = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a0 + j), xv));
+            s1        = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a1 + j), xv));
+            s2        = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(a2 + j), xv));
+            s3        = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(a3 + j), xv));
+        }
+
+        // transpose, so adding the 4 vectors gives the 4 row sums
+        _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+        float sum[4];
+        _mm_storeu_ps(sum, _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+
+        for (; j < n; j++) {
+            sum[0] += a0[j] * x[j];
+            sum[1] += a1[j] * x[j];
+            sum[2] += a2[j] * x[j];
+            sum[3] += a3[j] * x[j];
+        }
+        for (u32 r = 0; r < 4; r++) { y[i + r] = axby(alpha, sum[r], beta, y[i + r]); }
+    }
+
+    gemv_scalar(m - i, n, alpha, a + (i * lda), lda, x, beta, y + i);
+}
+
+static void gemv_t_sse2(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x,
+                        float* y)
+{
+    u64 i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + (i * lda);
+        const float* a1 = a0 + lda;
+        const float* a2 = a1 + lda;
+        const float* a3 = a2 + lda;
+
+        const float c[4] = { alpha * x[i], alpha * x[i + 1], alpha * x[i + 2], alpha * x[i + 3] };
+        const __m128 c0  = _mm_set1_ps(c[0]);
+        const __m128 c1  = _mm_set1_ps(c[1]);
+        const __m128 c2  = _mm_set1_ps(c[2]);
+        const __m128 c3  = _mm_set1_ps(c[3]);
+
+        u64 j = 0;
+        for (; j + 4 <= n; j += 4) {
+            __m128 yv = _mm_loadu_ps(y + j);
+            yv        = _mm_add_ps(yv, _mm_mul_ps(c0, _mm_loadu_ps(a0 + j)));
+            yv        = _mm_add_ps(yv, _mm_mul_ps(c1, _mm_loadu_ps(a1 + j)));
+            yv        = _mm_add_ps(yv, _mm_mul_ps(c2, _mm_loadu_ps(a2 + j)));
+            yv        = _mm_add_ps(yv, _mm_mul_ps(c3, _mm_loadu_ps(a3 + j)));
+            _mm_storeu_ps(y + j, yv);
+        }
+        for (; j < n; j++) {
+            y[j] += (c[0] * a0[j]) + (c[1] * a1[j]) + (c[2] * a2[j]) + (c[3] * a3[j]);
+        }
+    }
+
+    gemv_t_scalar(m - i, n, alpha, a + (i * lda), lda, x + i, y);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+__attribute__((target("avx2,fma")))
+static void gemv_avx2(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x,
+                      float beta, float* y)
+{
+    u64 i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + (i * lda);
+        const float* a1 = a0 + lda;
+        const float* a2 = a1 + lda;
+        const float* a3 = a2 + lda;
+
+        __m256 s0 = _mm256_setzero_ps();
+        __m256 s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps();
+        __m256 s3 = _mm256_setzero_ps();
+
+        u64 j = 0;
+        for (; j + 8 <= n; j += 8) {
+            __m256 xv = _mm256_loadu_ps(x + j);
+            s0        = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), xv, s0);
+            s1        = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j), xv, s1);
+            s2        = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j), xv, s2);
+            s3        = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j), xv, s3);
+        }
+
+        // 4 horizontal sums at once: hadd pairs, then fold the two lanes
+        __m256 h  = _mm256_hadd_ps(_mm256_hadd_ps(s0, s1), _mm256_hadd_ps(s2, s3));
+        __m128 hs = _mm_add_ps(_mm256_castps256_ps128(h), _mm256_extractf128_ps(h, 1));
+        float  sum[4];
+        _mm_storeu_ps(sum, hs);
+
+        for (; j < n; j++) {
+            sum[0] += a0[j] * x[j];
+            sum[1] += a1[j] * x[j];
+            sum[2] += a2[j] * x[j];
+            sum[3] += a3[j] * x[j];
+        }
+        for (u32 r = 0; r < 4; r++) { y[i + r] = axby(alpha, sum[r], beta, y[i + r]); }
+    }
+
+    gemv_scalar(m - i, n, alpha, a + (i * lda), lda, x, beta, y + i);
+}
+
+__attribute__((target("avx2,fma")))
+static void gemv_t_avx2(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x,
+                        float* y)
+{
+    u64 i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + (i * lda);
+        const float* a1 = a0 + lda;
+        const float* a2 = a1 + lda;
+        const float* a3 = a2 + lda;
+
+        const float c[4] = { alpha * x[i], alpha * x[i + 1], alpha * x[i + 2], alpha * x[i + 3] };
+        const __m256 c0  = _mm256_set1_ps(c[0]);
+        const __m256 c1  = _mm256_set1_ps(c[1]);
+        const __m256 c2  = _mm256_set1_ps(c[2]);
+        const __m256 c3  = _mm256_set1_ps(c[3]);
+
+        u64 j = 0;
+        for (; j + 8 <= n; j += 8) {
+            __m256 yv = _mm256_loadu_ps(y + j);
+            yv        = _mm256_fmadd_ps(c0, _mm256_loadu_ps(a0 + j), yv);
+            yv        = _mm256_fmadd_ps(c1, _mm256_loadu_ps(a1 + j), yv);
+            yv        = _mm256_fmadd_ps(c2, _mm256_loadu_ps(a2 + j), yv);
+            yv        = _mm256_fmadd_ps(c3, _mm256_loadu_ps(a3 + j), yv);
+            _mm256_storeu_ps(y + j, yv);
+        }
+        for (; j < n; j++) {
+            y[j] += (c[0] * a0[j]) + (c[1] * a1[j]) + (c[2] * a2[j]) + (c[3] * a3[j]);
+        }
+    }
+
+    gemv_t_scalar(m - i, n, alpha, a + (i * lda), lda, x + i, y);
+}
+
+#endif // CPU_X86
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void gemv_f32(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x, float beta,
+              float* y)
+{
+    if (m == 0) {
+        return;
+    }
+    CHECK_FATAL(!y, "y is null");
+    CHECK_FATAL((!a || !x) && n != 0, "a or x is null");
+    CHECK_FATAL(lda < n, "lda < n");
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: gemv_avx2(m, n, alpha, a, lda, x, beta, y); return;
+        case CPU_SSE2: gemv_sse2(m, n, alpha, a, lda, x, beta, y); return;
+        default:       break;
+    }
+#endif
+
+    gemv_scalar(m, n, alpha, a, lda, x, beta, y);
+}
+
+
+void gemv_t_f32(u64 m, u64 n, float alpha, const float* a, u64 lda, const float* x, float beta,
+                float* y)
+{
+    if (n == 0) {
+        return;
+    }
+    CHECK_FATAL(!y, "y is null");
+    CHECK_FATAL((!a || !x) && m != 0, "a or x is null");
+    CHECK_FATAL(lda < n, "lda < n");
+
+    scale_y(y, n, beta);
+    if (alpha == 0) {
+        return;
+    }
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: gemv_t_avx2(m, n, alpha, a, lda, x, y); return;
+        case CPU_SSE2: gemv_t_sse2(m, n, alpha, a, lda, x, y); return;
+        default:       break;
+    }
+#endif
+
+    gemv_t_scalar(m, n, alpha, a, lda, x, y);
+}
@@ -679,6 +679,86 @@ void genVec_move(genVec* dest, genVec** src)
 }
 
 
+b8 genVec_write(const genVec* vec, FILE* f, ser_write_fn write_fn)
+{
+    CHECK_FATAL(!vec, "vec is null");
+    CHECK_FATAL(!f, "file is null");
+
+    if (!ser_write_header(f, SER_GENVEC) ||
+        !ser_write_u32(f, vec->data_size) ||
+        !ser_write_u64(f, vec->size)) {
+        return false;
+    }
+
+    if (!write_fn) { // POD fast path, whole buffer at once
+        return ser_write_bytes(f, vec->data, GET_SCALED(vec, vec->size));
+    }
+
+    for (u64 i = 0; i < vec->size; i++) {
+        if (!write_fn(f, GET_PTR(vec, i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+b8 genVec_read(genVec* vec, FILE* f, ser_read_fn read_fn)
+{
+    CHECK_FATAL(!vec, "vec is null");
+    CHECK_FATAL(!f, "file is null");
+
+    u32 data_size = 0;
+    u64 count     = 0;
+
+    if (!ser_read_header(f, SER_GENVEC) ||
+        !ser_read_u32(f, &data_size) ||
+        !ser_read_u64(f, &count)) {
+        return false;
+    }
+
+    CHECK_WARN_RET(data_size != vec->data_size, false,
+                   "data_size mismatch (stored %u, vec %u)", data_size, vec->data_size);
+
+    if (count == 0) {
+        return true;
+    }
+
+    // one allocation for all incoming elements, capped by the bytes left
+    // so a corrupt count can't over-allocate (a short stream fails below)
+    u64 hint = ser_reserve_hint(f, count, read_fn ? 0 : vec->data_size);
+    genVec_reserve(vec, vec->size + hint);
+
+    if (!read_fn) { // POD fast path: bulk reads of at most hint elements
+        u64 chunk = hint ? hint : 1;
+        for (u64 left = count; left > 0;) {
+            u64 n = left < chunk ? left : chunk;
+            genVec_reserve(vec, vec->size + n);
+            if (!ser_read_bytes(f, GET_PTR(vec, vec->size), GET_SCALED(vec, n))) {
+                return false;
+            }
+            vec->size += n;
+            left -= n;
+        }
+        return true;
+    }
+
+    // construct in place, size only grows over fully read elements
+    for (u64 i = 0; i < count; i++) {
+        if (vec->size == vec->capacity) {
+            genVec_grow(vec);
+        }
+        if (!read_fn(f, GET_PTR(vec, vec->size))) {
+            return false;
+        }
+        vec->size++;
+    }
+
+    return true;
+}
+
+
 void genVec_grow(genVec* vec)
 {
     CHECK_FATAL(!vec, "vec is null");
@@ -87,6 +87,44 @@ static u64 find_slot(const hashmap* map, const u8* key,
     return (*tombstone != -1) ? (u64)*tombstone : 0;
 }
 
+// find_slot with a precomputed hash and a key view
+// on a miss the first tombstone on the probe path is returned for reuse
+static u64 find_slot_hashed(const hashmap* map, u64 hash, const void* view,
+                            key_eq_fn eq_fn, b8* found)
+{
+    u64 index     = hash % map->capacity;
+    u64 tombstone = (u64)-1;
+
+    *found = 0;
+
+    for (u64 x = 0; x < map->capacity; x++) 
+    {
+        u64 i = (index + x) % map->capacity;
+        const KV* kv = GET_KV(map->buckets, i);
+
+        switch (kv->state) {
+            case EMPTY:
+                return (tombstone != (u64)-1) ? tombstone : i;
+            case FILLED: {
+                int cmp = eq_fn ? eq_fn(kv->key, view)
+                                : map->cmp_fn(kv->key, view, map->key_size);
+                if (cmp == 0) {
+                    *found = 1;
+                    return i;
+                }
+                break;
+            }
+            case TOMBSTONE:
+                if (tombstone == (u64)-1) {
+                    tombstone = i;
+                }
+                break;
+        }
+    }
+
+    return (tombstone != (u64)-1) ? tombstone : 0;
+}
+
 static void hashmap_resize(hashmap* map, u64 new_capacity) 
 {
     if (new_capacity <= HASHMAP_INIT_CAPACITY) {
@@ -97,6 +135,7 @@ static void hashmap_resize(hashmap* map, u64 new_capacity)
     u64 old_cap = map->capacity;
 
     map->buckets = malloc(new_capacity * sizeof(KV));
+    CHECK_FATAL(!map->buckets, "resize malloc failed");
     reset_buckets(map->buckets, new_capacity);
 
     map->capacity = new_capacity;
@@ -125,7 +164,9 @@ static void hashmap_resize(hashmap* map, u64 new_capacity)
      free(old_vec);  // the key, vals of each KV are transferred    
 }
 
-static void hashmap_maybe_resize(hashmap* map) 
+// grow is only checked on insert and shrink only on delete,
+// so a presized (hashmap_reserve) map stays presized while it fills up
+static void hashmap_maybe_grow(hashmap* map) 
 {
     CHECK_FATAL(!map, "map is null");
     
@@ -135,7 +176,15 @@ static void hashmap_maybe_resize(hashmap* map)
         u64 new_cap = next_prime(map->capacity);
         hashmap_resize(map, new_cap);
     }
-    else if (load_factor < LOAD_FACTOR_SHRINK && map->capacity > HASHMAP_INIT_CAPACITY) 
+}
+
+static void hashmap_maybe_shrink(hashmap* map) 
+{
+    CHECK_FATAL(!map, "map is null");
+    
+    double load_factor = (double)map->size / (double)map->capacity;
+    
+    if (load_factor < LOAD_FACTOR_SHRINK && map->capacity > HASHMAP_INIT_CAPACITY) 
     {
         u64 new_cap = prev_prime(map->capacity);
         if (new_cap >= HASHMAP_INIT_CAPACITY) {
@@ -144,6 +193,46 @@ static void hashmap_maybe_resize(hashmap* map)
     }
 }
 
+// insert already constructed key/val buffers, map takes ownership of both
+// if key exists, the old val is replaced and the passed key is destroyed
+static void hashmap_put_owned(hashmap* map, u8* k, u8* v)
+{
+    hashmap_maybe_grow(map);
+
+    b8 found = 0;
+    int tombstone = -1;
+    u64 slot = find_slot(map, k, &found, &tombstone);
+
+    KV* kv = GET_KV(map->buckets, slot);
+
+    if (found) {
+        kv_destroy(map->key_del_fn, map->val_del_fn, &(KV){ .key = k, .val = kv->val });
+        kv->val = v;
+        return;
+    }
+
+    kv->key = k;
+    kv->val = v;
+    kv->state = FILLED;
+
+    map->size++;
+}
+
+// read one key or val into a fresh buffer (callback or raw bytes)
+static u8* read_elm(FILE* f, u32 size, ser_read_fn read_fn)
+{
+    u8* elm = malloc(size);
+    CHECK_FATAL(!elm, "elm malloc failed");
+
+    b8 ok = read_fn ? read_fn(f, elm) : ser_read_bytes(f, elm, size);
+    if (!ok) {
+        free(elm);
+        return NULL;
+    }
+
+    return elm;
+}
+
 /*
 ====================PUBLIC FUNCTIONS====================
 */
@@ -184,6 +273,52 @@ hashmap* hashmap_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn,
     return map;
 }
 
+hashmap* hashmap_clone(const hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    hashmap* clone = malloc(sizeof(hashmap));
+    CHECK_FATAL(!clone, "map malloc failed");
+
+    memcpy(clone, map, sizeof(hashmap)); // sizes, capacity and callbacks
+
+    clone->buckets = malloc(map->capacity * sizeof(KV));
+    CHECK_FATAL(!clone->buckets, "map bucket init failed");
+
+    // same slot for every key: tombstones are kept so probe chains stay valid
+    for (u64 i = 0; i < map->capacity; i++) {
+        const KV* src = GET_KV(map->buckets, i);
+        KV*       dst = GET_KV(clone->buckets, i);
+
+        dst->state = src->state;
+        dst->key   = NULL;
+        dst->val   = NULL;
+
+        if (src->state != FILLED) {
+            continue;
+        }
+
+        dst->key = malloc(map->key_size);
+        CHECK_FATAL(!dst->key, "key malloc failed");
+        dst->val = malloc(map->val_size);
+        CHECK_FATAL(!dst->val, "val malloc failed");
+
+        if (map->key_copy_fn) {
+            map->key_copy_fn(dst->key, src->key);
+        } else {
+            memcpy(dst->key, src->key, map->key_size);
+        }
+
+        if (map->val_copy_fn) {
+            map->val_copy_fn(dst->val, src->val);
+        } else {
+            memcpy(dst->val, src->val, map->val_size);
+        }
+    }
+
+    return clone;
+}
+
 void hashmap_destroy(hashmap* map)
 {
     CHECK_FATAL(!map, "map is null");
@@ -211,7 +346,7 @@ b8 hashmap_put(hashmap* map, const u8* key, const u8* val)
     CHECK_FATAL(!key, "key is null");
     CHECK_FATAL(!val, "val is null");
 
-    hashmap_maybe_resize(map);
+    hashmap_maybe_grow(map);
     
     b8 found = 0;
     int tombstone = -1;
@@ -280,7 +415,7 @@ b8 hashmap_put_move(hashmap* map, u8** key, u8** val)
     CHECK_FATAL(!val, "val is null");
     CHECK_FATAL(!*val, "*val is null");
     
-    hashmap_maybe_resize(map);
+    hashmap_maybe_grow(map);
     
     b8 found = 0;
     int tombstone = -1;
@@ -354,7 +489,7 @@ b8 hashmap_put_val_move(hashmap* map, const u8* key, u8** val)
     CHECK_FATAL(!val, "val is null");
     CHECK_FATAL(!*val, "*val is null");
     
-    hashmap_maybe_resize(map);
+    hashmap_maybe_grow(map);
     
     b8 found = 0;
     int tombstone = -1;
@@ -415,7 +550,7 @@ b8 hashmap_put_key_move(hashmap* map, u8** key, const u8* val)
     CHECK_FATAL(!*key, "*key is null");
     CHECK_FATAL(!val, "val is null");
     
-    hashmap_maybe_resize(map);
+    hashmap_maybe_grow(map);
     
     b8 found = 0;
     int tombstone = -1;
@@ -514,6 +649,61 @@ u8* hashmap_get_ptr(hashmap* map, const u8* key)
     return NULL;
 }
 
+u8* hashmap_get_hashed(const hashmap* map, u64 hash, const void* key_view, key_eq_fn eq_fn)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key_view, "key_view is null");
+
+    if (map->size == 0) { return NULL; }
+
+    b8 found = 0;
+    u64 slot = find_slot_hashed(map, hash, key_view, eq_fn, &found);
+
+    return found ? GET_KV(map->buckets, slot)->val : NULL;
+}
+
+u8* hashmap_find_or_insert(hashmap* map, u64 hash, const void* key_view, key_eq_fn eq_fn,
+                           key_make_fn make_fn, b8* inserted)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key_view, "key_view is null");
+
+    // grow before probing so the slot found stays valid for the insert
+    hashmap_maybe_grow(map);
+
+    b8 found = 0;
+    u64 slot = find_slot_hashed(map, hash, key_view, eq_fn, &found);
+
+    KV* kv = GET_KV(map->buckets, slot);
+
+    if (inserted) {
+        *inserted = !found;
+    }
+
+    if (found) {
+        return kv->val;
+    }
+
+    u8* k = malloc(map->key_size);
+    CHECK_FATAL(!k, "key malloc failed");
+    u8* v = calloc(1, map->val_size);
+    CHECK_FATAL(!v, "val calloc failed");
+
+    if (make_fn) {
+        make_fn(k, key_view);
+    } else {
+        memcpy(k, key_view, map->key_size);
+    }
+
+    kv->key = k;
+    kv->val = v;
+    kv->state = FILLED;
+
+    map->size++;
+
+    return v;
+}
+
 b8 hashmap_del(hashmap* map, const u8* key, u8* out)
 {
     CHECK_FATAL(!map, "map is null");
@@ -544,7 +734,7 @@ b8 hashmap_del(hashmap* map, const u8* key, u8* out)
 
         map->size--;
 
-        hashmap_maybe_resize(map);
+        hashmap_maybe_shrink(map);
 
         return 1;
     }
@@ -589,4 +779,161 @@ void hashmap_print(const hashmap* map, print_fn key_print, print_fn val_print)
 }
 
 
+hashmap_iter hashmap_iter_begin(const hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    return (hashmap_iter){ .map = map, .index = 0, .left = map->size };
+}
+
+
+b8 hashmap_iter_next(hashmap_iter* it, const u8** key, u8** val)
+{
+    CHECK_FATAL(!it, "iter is null");
+
+    // stop as soon as every entry was seen, the empty tail is never scanned
+    if (it->left == 0) {
+        return 0;
+    }
+
+    const hashmap* map = it->map;
+
+    while (it->index < map->capacity) {
+        const KV* kv = GET_KV(map->buckets, it->index++);
+
+        if (kv->state == FILLED) {
+            if (key) { *key = kv->key; }
+            if (val) { *val = kv->val; }
+
+            it->left--;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+void hashmap_keys(const hashmap* map, genVec* out)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!out, "out is null");
+    CHECK_FATAL(out->data_size != map->key_size, "out data_size must be key_size");
+
+    genVec_reserve(out, genVec_size(out) + map->size);
+
+    const u8* key = NULL;
+    hashmap_iter it = hashmap_iter_begin(map);
+    while (hashmap_iter_next(&it, &key, NULL)) {
+        genVec_push(out, key);
+    }
+}
+
+
+void hashmap_values(const hashmap* map, genVec* out)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!out, "out is null");
+    CHECK_FATAL(out->data_size != map->val_size, "out data_size must be val_size");
+
+    genVec_reserve(out, genVec_size(out) + map->size);
+
+    u8* val = NULL;
+    hashmap_iter it = hashmap_iter_begin(map);
+    while (hashmap_iter_next(&it, NULL, &val)) {
+        genVec_push(out, val);
+    }
+}
+
+
+void hashmap_reserve(hashmap* map, u64 n)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    // next_prime doubles past its table: keep new_cap far from overflow
+    if (n > MAP_RESERVE_MAX) {
+        WARN("reserve of %lu clamped to %llu", n, MAP_RESERVE_MAX);
+        n = MAP_RESERVE_MAX;
+    }
+
+    u64 new_cap = map->capacity;
+    while ((double)n > (double)new_cap * LOAD_FACTOR_GROW) {
+        new_cap = next_prime(new_cap);
+    }
 
+    if (new_cap > map->capacity) {
+        hashmap_resize(map, new_cap);
+    }
+}
+
+
+b8 hashmap_write(const hashmap* map, FILE* f, ser_write_fn key_write, ser_write_fn val_write)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!f, "file is null");
+
+    if (!ser_write_header(f, SER_HASHMAP) ||
+        !ser_write_u32(f, map->key_size) ||
+        !ser_write_u32(f, map->val_size) ||
+        !ser_write_u64(f, map->size)) {
+        return false;
+    }
+
+    for (u64 i = 0; i < map->capacity; i++) {
+        const KV* kv = GET_KV(map->buckets, i);
+        if (kv->state != FILLED) {
+            continue;
+        }
+
+        b8 ok = key_write ? key_write(f, kv->key) : ser_write_bytes(f, kv->key, map->key_size);
+        ok = ok && (val_write ? val_write(f, kv->val) : ser_write_bytes(f, kv->val, map->val_size));
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+b8 hashmap_read(hashmap* map, FILE* f, ser_read_fn key_read, ser_read_fn val_read)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!f, "file is null");
+
+    u32 key_size = 0;
+    u32 val_size = 0;
+    u64 count    = 0;
+
+    if (!ser_read_header(f, SER_HASHMAP) ||
+        !ser_read_u32(f, &key_size) ||
+        !ser_read_u32(f, &val_size) ||
+        !ser_read_u64(f, &count)) {
+        return false;
+    }
+
+    CHECK_WARN_RET(key_size != map->key_size || val_size != map->val_size, false,
+                   "key/val size mismatch (stored %u/%u)", key_size, val_size);
+
+    // presize once (capped by the bytes left, a bad count can't over-allocate);
+    // put_owned grows past it, a short stream fails the reads below
+    u64 min_size = (key_read ? 0 : map->key_size) + (val_read ? 0 : map->val_size);
+    hashmap_reserve(map, map->size + ser_reserve_hint(f, count, min_size));
+
+    for (u64 i = 0; i < count; i++) {
+        u8* k = read_elm(f, map->key_size, key_read);
+        if (!k) {
+            return false;
+        }
+
+        u8* v = read_elm(f, map->val_size, val_read);
+        if (!v) {
+            kv_destroy(map->key_del_fn, NULL, &(KV){ .key = k });
+            return false;
+        }
+
+        hashmap_put_owned(map, k, v);
+    }
+
+    return true;
+}
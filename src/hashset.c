@@ -77,6 +77,44 @@ static u64 find_slot(const hashset* set, const u8* element,
     return (*tombstone != -1) ? (u64)*tombstone : 0;
 }
 
+// find_slot with a precomputed hash and an element view
+// on a miss the first tombstone on the probe path is returned for reuse
+static u64 find_slot_hashed(const hashset* set, u64 hash, const void* view,
+                            key_eq_fn eq_fn, b8* found)
+{
+    u64 index     = hash % set->capacity;
+    u64 tombstone = (u64)-1;
+
+    *found = 0;
+
+    for (u64 x = 0; x < set->capacity; x++) 
+    {
+        u64 i = (index + x) % set->capacity;
+        const ELM* elm = GET_ELM(set->buckets, i);
+
+        switch (elm->state) {
+            case EMPTY:
+                return (tombstone != (u64)-1) ? tombstone : i;
+            case FILLED: {
+                int cmp = eq_fn ? eq_fn(elm->elm, view)
+                                : set->cmp_fn(elm->elm, view, set->elm_size);
+                if (cmp == 0) {
+                    *found = 1;
+                    return i;
+                }
+                break;
+            }
+            case TOMBSTONE:
+                if (tombstone == (u64)-1) {
+                    tombstone = i;
+                }
+                break;
+        }
+    }
+
+    return (tombstone != (u64)-1) ? tombstone : 0;
+}
+
 static void hashset_resize(hashset* set, u64 new_capacity) 
 {
     if (new_capacity <= HASHMAP_INIT_CAPACITY) {
@@ -113,7 +151,9 @@ static void hashset_resize(hashset* set, u64 new_capacity)
     free(old_buckets);
 }
 
-static void hashset_maybe_resize(hashset* set) 
+// grow is only checked on insert and shrink only on remove,
+// so a presized (hashset_reserve) set stays presized while it fills up
+static void hashset_maybe_grow(hashset* set) 
 {
     CHECK_FATAL(!set, "set is null");
     
@@ -123,7 +163,15 @@ static void hashset_maybe_resize(hashset* set)
         u64 new_cap = next_prime(set->capacity);
         hashset_resize(set, new_cap);
     }
-    else if (load_factor < LOAD_FACTOR_SHRINK && set->capacity > HASHMAP_INIT_CAPACITY) 
+}
+
+static void hashset_maybe_shrink(hashset* set) 
+{
+    CHECK_FATAL(!set, "set is null");
+    
+    double load_factor = (double)set->size / (double)set->capacity;
+    
+    if (load_factor < LOAD_FACTOR_SHRINK && set->capacity > HASHMAP_INIT_CAPACITY) 
     {
         u64 new_cap = prev_prime(set->capacity);
         if (new_cap >= HASHMAP_INIT_CAPACITY) {
@@ -220,7 +268,7 @@ b8 hashset_insert(hashset* set, const u8* elm)
     CHECK_FATAL(!set, "set is null");
     CHECK_FATAL(!elm, "elm is null");
     
-    hashset_maybe_resize(set);
+    hashset_maybe_grow(set);
 
     b8 found = 0;
     int tombstone = -1;
@@ -256,7 +304,7 @@ b8 hashset_insert_move(hashset* set, u8** elm)
     CHECK_FATAL(!elm, "elm is null");
     CHECK_FATAL(!*elm, "*elm is null");
     
-    hashset_maybe_resize(set);
+    hashset_maybe_grow(set);
 
     b8 found = 0;
     int tombstone = -1;
@@ -314,7 +362,7 @@ b8 hashset_remove(hashset* set, const u8* elm)
         
         set->size--;
 
-        hashset_maybe_resize(set);
+        hashset_maybe_shrink(set);
         return 1; // found
     }
 
@@ -333,6 +381,58 @@ b8 hashset_has(const hashset* set, const u8* elm)
     return found;
 }
 
+const u8* hashset_get_hashed(const hashset* set, u64 hash, const void* view, key_eq_fn eq_fn)
+{
+    CHECK_FATAL(!set, "set is null");
+    CHECK_FATAL(!view, "view is null");
+
+    if (set->size == 0) { return NULL; }
+
+    b8 found = 0;
+    u64 slot = find_slot_hashed(set, hash, view, eq_fn, &found);
+
+    return found ? GET_ELM(set->buckets, slot)->elm : NULL;
+}
+
+u8* hashset_find_or_insert(hashset* set, u64 hash, const void* view, key_eq_fn eq_fn,
+                           key_make_fn make_fn, b8* inserted)
+{
+    CHECK_FATAL(!set, "set is null");
+    CHECK_FATAL(!view, "view is null");
+
+    // grow before probing so the slot found stays valid for the insert
+    hashset_maybe_grow(set);
+
+    b8 found = 0;
+    u64 slot = find_slot_hashed(set, hash, view, eq_fn, &found);
+
+    ELM* elem = GET_ELM(set->buckets, slot);
+
+    if (inserted) {
+        *inserted = !found;
+    }
+
+    if (found) {
+        return elem->elm;
+    }
+
+    u8* new_elm = malloc(set->elm_size);
+    CHECK_FATAL(!new_elm, "elm malloc failed");
+
+    if (make_fn) {
+        make_fn(new_elm, view);
+    } else {
+        memcpy(new_elm, view, set->elm_size);
+    }
+
+    elem->elm = new_elm;
+    elem->state = FILLED;
+
+    set->size++;
+
+    return new_elm;
+}
+
 void hashset_print(const hashset* set, print_fn print_fn)
 {
     CHECK_FATAL(!set, "set is null");
@@ -354,3 +454,137 @@ void hashset_print(const hashset* set, print_fn print_fn)
     printf("\t=========\n");
 }
 
+
+hashset_iter hashset_iter_begin(const hashset* set)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    return (hashset_iter){ .set = set, .index = 0, .left = set->size };
+}
+
+
+b8 hashset_iter_next(hashset_iter* it, const u8** elm)
+{
+    CHECK_FATAL(!it, "iter is null");
+    CHECK_FATAL(!elm, "elm is null");
+
+    // stop as soon as every element was seen, the empty tail is never scanned
+    if (it->left == 0) {
+        return 0;
+    }
+
+    const hashset* set = it->set;
+
+    while (it->index < set->capacity) {
+        const ELM* e = GET_ELM(set->buckets, it->index++);
+
+        if (e->state == FILLED) {
+            *elm = e->elm;
+            it->left--;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+void hashset_reserve(hashset* set, u64 n)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    // next_prime doubles past its table: keep new_cap far from overflow
+    if (n > MAP_RESERVE_MAX) {
+        WARN("reserve of %lu clamped to %llu", n, MAP_RESERVE_MAX);
+        n = MAP_RESERVE_MAX;
+    }
+
+    u64 new_cap = set->capacity;
+    while ((double)n > (double)new_cap * LOAD_FACTOR_GROW) {
+        new_cap = next_prime(new_cap);
+    }
+
+    if (new_cap > set->capacity) {
+        hashset_resize(set, new_cap);
+    }
+}
+
+
+b8 hashset_write(const hashset* set, FILE* f, ser_write_fn write_fn)
+{
+    CHECK_FATAL(!set, "set is null");
+    CHECK_FATAL(!f, "file is null");
+
+    if (!ser_write_header(f, SER_HASHSET) ||
+        !ser_write_u32(f, set->elm_size) ||
+        !ser_write_u64(f, set->size)) {
+        return false;
+    }
+
+    for (u64 i = 0; i < set->capacity; i++) {
+        const ELM* elm = GET_ELM(set->buckets, i);
+        if (elm->state != FILLED) {
+            continue;
+        }
+
+        b8 ok = write_fn ? write_fn(f, elm->elm) : ser_write_bytes(f, elm->elm, set->elm_size);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+b8 hashset_read(hashset* set, FILE* f, ser_read_fn read_fn)
+{
+    CHECK_FATAL(!set, "set is null");
+    CHECK_FATAL(!f, "file is null");
+
+    u32 elm_size = 0;
+    u64 count    = 0;
+
+    if (!ser_read_header(f, SER_HASHSET) ||
+        !ser_read_u32(f, &elm_size) ||
+        !ser_read_u64(f, &count)) {
+        return false;
+    }
+
+    CHECK_WARN_RET(elm_size != set->elm_size, false,
+                   "elm_size mismatch (stored %u, set %u)", elm_size, set->elm_size);
+
+    // presize once (capped by the bytes left, a bad count can't over-allocate);
+    // the loop grows past it, a short stream fails the reads below
+    hashset_reserve(set, set->size + ser_reserve_hint(f, count, read_fn ? 0 : set->elm_size));
+
+    for (u64 i = 0; i < count; i++) {
+        u8* new_elm = malloc(set->elm_size);
+        CHECK_FATAL(!new_elm, "elm malloc failed");
+
+        b8 ok = read_fn ? read_fn(f, new_elm) : ser_read_bytes(f, new_elm, set->elm_size);
+        if (!ok) {
+            free(new_elm);
+            return false;
+        }
+
+        hashset_maybe_grow(set);
+
+        b8 found = 0;
+        int tombstone = -1;
+        u64 slot = find_slot(set, new_elm, &found, &tombstone);
+
+        if (found) { // already present, drop the loaded copy
+            elm_destroy(set->del_fn, &(ELM){ .elm = new_elm });
+            continue;
+        }
+
+        ELM* elem = GET_ELM(set->buckets, slot);
+        elem->elm = new_elm;
+        elem->state = FILLED;
+
+        set->size++;
+    }
+
+    return true;
+}
@@ -0,0 +1,185 @@
+#include "interner.h"
+
+
+
+// view passed to the hashset: the bytes + what make needs to store them
+typedef struct {
+    StringView sv;
+    u64        hash;
+    interner*  in;
+} intern_key;
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// the hash is stored in the entry, rehash never touches the bytes
+static u64 entry_hash(const u8* elm, u64 size)
+{
+    (void)size;
+    return ((const intern_entry*)elm)->hash;
+}
+
+static int entry_cmp(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+
+    const intern_entry* x = (const intern_entry*)a;
+    const intern_entry* y = (const intern_entry*)b;
+
+    if (x->len != y->len) {
+        return 1;
+    }
+
+    return memcmp(x->str, y->str, x->len);
+}
+
+static int entry_eq_key(const u8* elm, const void* view)
+{
+    const intern_entry* e = (const intern_entry*)elm;
+    const intern_key*   k = (const intern_key*)view;
+
+    if (e->hash != k->hash || e->len != k->sv.len) {
+        return 1;
+    }
+
+    return memcmp(e->str, k->sv.data, e->len);
+}
+
+// copy len bytes + '\0' into the last block, chain a new one if full
+static const char* store_bytes(interner* in, StringView sv)
+{
+    u64    need  = sv.len + 1;
+    Arena* block = NULL;
+
+    if (!genVec_empty(in->blocks)) {
+        block = *(Arena**)genVec_back(in->blocks);
+    }
+
+    if (!block || arena_remaining(block) < need) {
+        block = arena_create(need > in->block_size ? need : in->block_size);
+        genVec_push(in->blocks, cast(block));
+    }
+
+    char* dst = (char*)arena_alloc_aligned(block, need, 1);
+    if (sv.len != 0) {
+        memcpy(dst, sv.data, sv.len);
+    }
+    dst[sv.len] = '\0';
+
+    return dst;
+}
+
+// called by the hashset on insert only
+static void entry_make(u8* elm, const void* view)
+{
+    const intern_key* k  = (const intern_key*)view;
+    interner*         in = k->in;
+
+    CHECK_FATAL(k->sv.len > (u32)-1, "string too long to intern");
+    CHECK_FATAL(genVec_size(in->strs) >= INTERNER_INVALID_ID, "interner is full");
+
+    intern_entry* e = (intern_entry*)elm;
+
+    e->str  = store_bytes(in, k->sv);
+    e->len  = (u32)k->sv.len;
+    e->id   = (u32)genVec_size(in->strs);
+    e->hash = k->hash;
+
+    StringView canon = { e->str, e->len };
+    genVec_push(in->strs, cast(canon));
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+interner* interner_create(u64 block_size)
+{
+    interner* in = malloc(sizeof(interner));
+    CHECK_FATAL(!in, "interner malloc failed");
+
+    in->block_size = block_size ? block_size : INTERNER_BLOCK_SIZE;
+
+    // entries only point into the arenas, nothing to delete per element
+    in->set    = hashset_create(sizeof(intern_entry), entry_hash, entry_cmp, NULL, NULL, NULL);
+    in->strs   = genVec_init(0, sizeof(StringView), NULL, NULL, NULL);
+    in->blocks = genVec_init(0, sizeof(Arena*), NULL, NULL, NULL);
+
+    return in;
+}
+
+
+void interner_destroy(interner* in)
+{
+    CHECK_FATAL(!in, "interner is null");
+
+    for (u64 i = 0; i < genVec_size(in->blocks); i++) {
+        arena_release(*(Arena**)genVec_get_ptr(in->blocks, i));
+    }
+
+    genVec_destroy(in->blocks);
+    genVec_destroy(in->strs);
+    hashset_destroy(in->set);
+    free(in);
+}
+
+
+u32 interner_intern_hashed(interner* in, StringView sv, u64 hash)
+{
+    CHECK_FATAL(!in, "interner is null");
+    CHECK_FATAL(!sv.data && sv.len != 0, "view data is null");
+
+    intern_key k = { .sv = sv, .hash = hash, .in = in };
+
+    const intern_entry* e = (const intern_entry*)hashset_find_or_insert(
+        in->set, hash, &k, entry_eq_key, entry_make, NULL);
+
+    return e->id;
+}
+
+
+u32 interner_intern(interner* in, StringView sv)
+{
+    return interner_intern_hashed(in, sv, murmurhash3_view(sv));
+}
+
+
+u32 interner_intern_cstr(interner* in, const char* cstr)
+{
+    CHECK_FATAL(!cstr, "cstr is null");
+
+    StringView sv = { cstr, strlen(cstr) };
+    return interner_intern_hashed(in, sv, murmurhash3_view(sv));
+}
+
+
+u32 interner_find(const interner* in, StringView sv)
+{
+    CHECK_FATAL(!in, "interner is null");
+    CHECK_FATAL(!sv.data && sv.len != 0, "view data is null");
+
+    intern_key k = { .sv = sv, .hash = murmurhash3_view(sv), .in = NULL };
+
+    const intern_entry* e = (const intern_entry*)hashset_get_hashed(
+        in->set, k.hash, &k, entry_eq_key);
+
+    return e ? e->id : INTERNER_INVALID_ID;
+}
+
+
+StringView interner_get(const interner* in, u32 id)
+{
+    CHECK_FATAL(!in, "interner is null");
+    CHECK_FATAL(id >= genVec_size(in->strs), "invalid id %u", id);
+
+    return *(const StringView*)genVec_get_ptr(in->strs, id);
+}
+
+
+const char* interner_cstr(const interner* in, u32 id)
+{
+    return interner_get(in, id).data;
+}
@@ -0,0 +1,172 @@
+#include "lu.h"
+#include "gemm.h"
+#include "gemm_f64.h"
+#include "vec_f32.h"
+#include "vec_f64.h"
+
+#include <math.h>
+#include <string.h>
+
+
+
+/*
+ LU_IMPL(T, S) generates the float (S = f32) and double (S = f64) LU from
+ one body. vec_S_axpy / vec_S_scale and gemm_S do the arithmetic.
+
+ Row swaps are applied to whole rows right away (row major: a contiguous
+ swap), which covers both the factored L columns and the pending ones.
+ Almost all flops land in gemm_S.
+*/
+
+#define LU_IMPL(T, S)                                                                      \
+    /* B = L^-1 B, L unit lower k×k, B k×w (rows ldl / ldb apart) */                       \
+    static void trsm_lower_unit_##S(const T* l, u64 ldl, T* b, u64 ldb, u64 k, u64 w)      \
+    {                                                                                      \
+        if (k <= LU_BLOCK) {                                                               \
+            for (u64 i = 1; i < k; i++) {                                                  \
+                for (u64 p = 0; p < i; p++) {                                              \
+                    vec_##S##_axpy(b + (i * ldb), -l[(i * ldl) + p], b + (p * ldb),        \
+                                   b + (i * ldb), w);                                      \
+                }                                                                          \
+            }                                                                              \
+            return;                                                                        \
+        }                                                                                  \
+                                                                                           \
+        u64 k1 = k / 2;                                                                    \
+        trsm_lower_unit_##S(l, ldl, b, ldb, k1, w);                                        \
+        gemm_##S(k - k1, w, k1, -1, l + (k1 * ldl), ldl, b, ldb, 1, b + (k1 * ldb), ldb);  \
+        trsm_lower_unit_##S(l + (k1 * ldl) + k1, ldl, b + (k1 * ldb), ldb, k - k1, w);     \
+    }                                                                                      \
+                                                                                           \
+    /* B = U^-1 B, U upper k×k (non-unit diagonal), B k×w */                               \
+    static void trsm_upper_##S(const T* u, u64 ldu, T* b, u64 ldb, u64 k, u64 w)           \
+    {                                                                                      \
+        if (k <= LU_BLOCK) {                                                               \
+            for (u64 i = k; i-- > 0;) {                                                    \
+                T* bi = b + (i * ldb);                                                     \
+                for (u64 p = i + 1; p < k; p++) {                                          \
+                    vec_##S##_axpy(bi, -u[(i * ldu) + p], b + (p * ldb), bi, w);           \
+                }                                                                          \
+                vec_##S##_scale(bi, bi, (T)1 / u[(i * ldu) + i], w);                       \
+            }                                                                              \
+            return;                                                                        \
+        }                                                                                  \
+                                                                                           \
+        u64 k1 = k / 2;                                                                    \
+        trsm_upper_##S(u + (k1 * ldu) + k1, ldu, b + (k1 * ldb), ldb, k - k1, w);          \
+        gemm_##S(k1, w, k - k1, -1, u + k1, ldu, b + (k1 * ldb), ldb, 1, b, ldb);          \
+        trsm_upper_##S(u, ldu, b, ldb, k1, w);                                             \
+    }                                                                                      \
+                                                                                           \
+    static void swap_rows_##S(T* a, u64 len, u64 ld, u64 r1, u64 r2)                       \
+    {                                                                                      \
+        T* x = a + (r1 * ld);                                                              \
+        T* y = a + (r2 * ld);                                                              \
+        for (u64 j = 0; j < len; j++) {                                                    \
+            T t  = x[j];                                                                   \
+            x[j] = y[j];                                                                   \
+            y[j] = t;                                                                      \
+        }                                                                                  \
+    }                                                                                      \
+                                                                                           \
+    /* factor the m×w block at (r, c) of the n wide a, m >= w; */                          \
+    /* false on an exact zero pivot */                                                     \
+    static b8 lu_rec_##S(T* a, u64 ld, u64 n, u64 r, u64 c, u64 m, u64 w, u64* perm,       \
+                         u64* swaps)                                                       \
+    {                                                                                      \
+        if (w == 1) {                                                                      \
+            /* partial pivoting: the largest magnitude in the column */                    \
+            u64 p    = r;                                                                  \
+            T   best = (T)fabs(a[(r * ld) + c]);                                           \
+            for (u64 i = r + 1; i < r + m; i++) {                                          \
+                T v = (T)fabs(a[(i * ld) + c]);                                            \
+                if (v > best) {                                                            \
+                    best = v;                                                              \
+                    p    = i;                                                              \
+                }                                                                          \
+            }                                                                              \
+            if (!(best > 0)) { /* zero or NaN column */                                    \
+                return false;                                                              \
+            }                                                                              \
+                                                                                           \
+            if (p != r) {                                                                  \
+                swap_rows_##S(a, n, ld, r, p);                                             \
+                u64 t   = perm[r];                                                         \
+                perm[r] = perm[p];                                                         \
+                perm[p] = t;                                                               \
+                (*swaps)++;                                                                \
+            }                                                                              \
+                                                                                           \
+            T inv = (T)1 / a[(r * ld) + c];                                                \
+            for (u64 i = r + 1; i < r + m; i++) { a[(i * ld) + c] *= inv; }                \
+            return true;                                                                   \
+        }                                                                                  \
+                                                                                           \
+        u64 w1 = w / 2;                                                                    \
+        u64 w2 = w - w1;                                                                   \
+                                                                                           \
+        if (!lu_rec_##S(a, ld, n, r, c, m, w1, perm, swaps)) {                             \
+            return false;                                                                  \
+        }                                                                                  \
+                                                                                           \
+        T* a11 = a + (r * ld) + c;                                                         \
+        T* a12 = a11 + w1;                                                                 \
+        T* a21 = a11 + (w1 * ld);                                                          \
+        T* a22 = a21 + w1;                                                                 \
+                                                                                           \
+        trsm_lower_unit_##S(a11, ld, a12, ld, w1, w2);                                     \
+        gemm_##S(m - w1, w2, w1, -1, a21, ld, a12, ld, 1, a22, ld);                        \
+                                                                                           \
+        return lu_rec_##S(a, ld, n, r + w1, c + w1, m - w1, w2, perm, swaps);              \
+    }                                                                                      \
+                                                                                           \
+    b8 lu_##S##_factor(T* a, u64 lda, u64 n, u64* perm, u64* swaps)                        \
+    {                                                                                      \
+        CHECK_FATAL(!a && n != 0, "a is null");                                            \
+        CHECK_FATAL(!perm && n != 0, "perm is null");                                      \
+        CHECK_FATAL(lda < n, "leading dimension too small");                               \
+                                                                                           \
+        u64 count = 0;                                                                     \
+        for (u64 i = 0; i < n; i++) { perm[i] = i; }                                       \
+                                                                                           \
+        b8 ok = n == 0 || lu_rec_##S(a, lda, n, 0, 0, n, n, perm, &count);                 \
+                                                                                           \
+        if (swaps) { *swaps = count; }                                                     \
+        return ok;                                                                         \
+    }                                                                                      \
+                                                                                           \
+    void lu_##S##_solve_in_place(const T* lu, u64 ldl, u64 n, T* x, u64 ldx, u64 r)        \
+    {                                                                                      \
+        CHECK_FATAL((!lu || !x) && n * r != 0, "lu or x is null");                         \
+                                                                                           \
+        trsm_lower_unit_##S(lu, ldl, x, ldx, n, r);                                        \
+        trsm_upper_##S(lu, ldl, x, ldx, n, r);                                             \
+    }                                                                                      \
+                                                                                           \
+    void lu_##S##_solve(const T* lu, u64 ldl, const u64* perm, u64 n, const T* b, u64 ldb, \
+                        T* x, u64 ldx, u64 r)                                              \
+    {                                                                                      \
+        CHECK_FATAL((!lu || !perm || !b || !x) && n * r != 0, "lu, perm, b or x is null"); \
+        CHECK_FATAL(x == b && n * r != 0, "x may not alias b");                            \
+                                                                                           \
+        /* x = P b */                                                                      \
+        for (u64 i = 0; i < n; i++) {                                                      \
+            memcpy(x + (i * ldx), b + (perm[i] * ldb), sizeof(T) * r);                     \
+        }                                                                                  \
+                                                                                           \
+        lu_##S##_solve_in_place(lu, ldl, n, x, ldx, r);                                    \
+    }                                                                                      \
+                                                                                           \
+    double lu_##S##_det(const T* lu, u64 ldl, u64 n, u64 swaps)                            \
+    {                                                                                      \
+        CHECK_FATAL(!lu && n != 0, "lu is null");                                          \
+                                                                                           \
+        double det = swaps % 2 ? -1 : 1;                                                   \
+        for (u64 i = 0; i < n; i++) { det *= lu[(i * ldl) + i]; }                          \
+                                                                                           \
+        return det;                                                                        \
+    }
+
+
+LU_IMPL(float, f32)
+LU_IMPL(double, f64)
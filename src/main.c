@@ -1,23 +1,62 @@
 #include "arena_test.h"
 #include "genVec_test.h"
 #include "matrix_test.h"
+#include "matrix_generic_test.h"
+#include "thread_pool_test.h"
 #include "random_test.h"
 #include "string_test.h"
+#include "string_view_test.h"
+#include "str_search_test.h"
+#include "str_num_test.h"
+#include "str_transform_test.h"
+#include "utf8_test.h"
+#include "text_reader_test.h"
+#include "string_builder_test.h"
+#include "rope_test.h"
 #include "hashmap_test.h"
 #include "hashset_test.h"
 #include "stack_test.h"
 #include "queue_test.h"
+#include "serialize_test.h"
+#include "shardmap_test.h"
+#include "rcumap_test.h"
+#include "interner_test.h"
 
 
 int main(void)
 {
     // return genVec_test_8();
-    // return string_test_1();
-    // return hashmap_test_5();
-    // return hashset_test_2();
+    // return string_test_2();
+    // return string_view_test_1();
+    // return str_search_test_1();
+    // return str_num_test_1();
+    // return str_transform_test_1();
+    // return utf8_test_1();
+    // return text_reader_test_1();
+    // return string_builder_test_1();
+    // return rope_test_1();
+    // return hashmap_test_7();
+    // return hashset_test_3();
     // return stack_test_1();
     // return queue_test_2();
     // return arena_test_3();
     // matrix_test_7();
+    // return matrix_test_8();
+    // return matrix_test_9();
+    // return matrix_test_10();
+    // return matrix_test_11();
+    // return matrix_test_12();
+    // return matrix_test_13();
+    // return matrix_test_14();
+    // return matrix_test_15();
+    // return matrix_test_16();
+    // return matrix_generic_test_1();
+    // return thread_pool_test_1();
+    // return thread_pool_test_2();
+    // serialize_test_2();
+    // return serialize_test_3();
+    // shardmap_test_1();
+    // rcumap_test_1();
+    // interner_test_1();
     return random_test_5();
 }
@@ -1,7 +1,38 @@
 #include "matrix.h"
+#include "gemm.h"
+#include "gemv.h"
+#include "lu.h"
+#include "transpose.h"
+#include "vec_f32.h"
 
 
 
+// element wise ops cover the padding too when all leading dims match:
+// the rows then join into one contiguous run (no per row tails)
+static inline u64 common_width(const Matrix* a, const Matrix* b, const Matrix* c)
+{
+    return (a->ld == b->ld && a->ld == c->ld) ? a->ld : a->n;
+}
+
+// the first width floats of every row
+static inline MatrixView rows_view(const Matrix* mat, u64 width)
+{
+    return (MatrixView){ mat->data, mat->m, width, mat->ld, 1 };
+}
+
+// floats from the first element to past the last one
+static inline u64 span(const Matrix* mat)
+{
+    return mat->m == 0 ? 0 : ((mat->m - 1) * mat->ld) + mat->n;
+}
+
+// a packed m×n buffer as a view
+static inline MatrixView packed_view(float* data, u64 m, u64 n)
+{
+    return (MatrixView){ data, m, n, n, 1 };
+}
+
+
 Matrix* matrix_create(u64 m, u64 n)
 {
     CHECK_FATAL(n == 0 && m == 0, "n == m == 0");
@@ -11,12 +42,39 @@ Matrix* matrix_create(u64 m, u64 n)
 
     mat->m    = m;
     mat->n    = n;
+    mat->ld   = n;
     mat->data = (float*)malloc(sizeof(float) * n * m);
     CHECK_FATAL(!mat->data, "matrix data malloc failed");
 
     return mat;
 }
 
+Matrix* matrix_create_aligned(u64 m, u64 n)
+{
+    CHECK_FATAL(n == 0 && m == 0, "n == m == 0");
+
+    Matrix* mat = (Matrix*)malloc(sizeof(Matrix));
+    CHECK_FATAL(!mat, "matrix malloc failed");
+
+    mat->m  = m;
+    mat->n  = n;
+    mat->ld = MATRIX_LD_ALIGNED(n);
+
+    void* mem = NULL;
+    CHECK_FATAL(posix_memalign(&mem, MATRIX_ALIGN, sizeof(float) * m * mat->ld) != 0,
+                "matrix data aligned alloc failed");
+    mat->data = mem;
+
+    // zero the padding, whole row runs then compute on zeros
+    if (mat->ld != n) {
+        for (u64 i = 0; i < m; i++) {
+            memset(mat->data + (i * mat->ld) + n, 0, sizeof(float) * (mat->ld - n));
+        }
+    }
+
+    return mat;
+}
+
 Matrix* matrix_create_arr(u64 m, u64 n, const float* arr)
 {
     CHECK_FATAL(!arr, "input arr is null");
@@ -34,6 +92,7 @@ void matrix_create_stk(Matrix* mat, u64 m, u64 n, float* data)
     mat->data = data; // copying stk ptr 
     mat->m    = m;
     mat->n    = n;
+    mat->ld   = n;
 }
 
 void matrix_destroy(Matrix* mat)
@@ -51,7 +110,7 @@ void matrix_set_val_arr(Matrix* mat, u64 count, const float* arr)
     CHECK_FATAL(!arr, "arr is null");
     CHECK_FATAL(count != MATRIX_TOTAL(mat), "count doesn't match matrix size");
 
-    memcpy(mat->data, arr, sizeof(float) * count);
+    matrix_view_copy(matrix_view(mat), packed_view((float*)arr, mat->m, mat->n));
 }
 
 void matrix_set_val_arr2(Matrix* mat, u64 m, u64 n, const float** arr2)
@@ -62,10 +121,8 @@ void matrix_set_val_arr2(Matrix* mat, u64 m, u64 n, const float** arr2)
     CHECK_FATAL(m != mat->m || n != mat->n,
                 "mat dimentions dont match passed arr2");
 
-    u64 idx = 0;
     for (u64 i = 0; i < m; i++) {
-        memcpy(mat->data + idx, arr2[i], sizeof(float) * n);
-        idx += n;
+        memcpy(mat->data + (i * mat->ld), arr2[i], sizeof(float) * n);
     }
 }
 
@@ -86,11 +143,8 @@ void matrix_add(Matrix* out, const Matrix* a, const Matrix* b)
                     a->n != out->n,
                 "a, b, out mat dimentions dont match");
 
-    u64 total = MATRIX_TOTAL(a);
-
-    for (u64 i = 0; i < total; i++) { 
-        out->data[i] = a->data[i] + b->data[i]; 
-    }
+    u64 w = common_width(out, a, b);
+    matrix_view_add(rows_view(out, w), rows_view(a, w), rows_view(b, w));
 }
 
 
@@ -104,15 +158,25 @@ void matrix_sub(Matrix* out, const Matrix* a, const Matrix* b)
                     a->n != out->n,
                 "a, b, out mat dimentions dont match");
 
-    u64 total = MATRIX_TOTAL(a);
+    u64 w = common_width(out, a, b);
+    matrix_view_sub(rows_view(out, w), rows_view(a, w), rows_view(b, w));
+}
+
 
-    for (u64 i = 0; i < total; i++) { 
-        out->data[i] = a->data[i] - b->data[i]; 
-    }
+void matrix_axpy(Matrix* out, float alpha, const Matrix* x, const Matrix* y)
+{
+    CHECK_FATAL(!out, "out matrix is null");
+    CHECK_FATAL(!x, "x matrix is null");
+    CHECK_FATAL(!y, "y matrix is null");
+    CHECK_FATAL(x->m != y->m || x->n != y->n || x->m != out->m ||
+                    x->n != out->n,
+                "x, y, out mat dimentions dont match");
+
+    u64 w = common_width(out, x, y);
+    matrix_view_axpy(rows_view(out, w), alpha, rows_view(x, w), rows_view(y, w));
 }
 
-// ikj multiplication. (mxk) * (kxn) = (mxn)
-// this is good for small to medium size matrices
+// packed, register blocked GEMM (gemm.h). (mxk) * (kxn) = (mxn)
 void matrix_xply(Matrix* out, const Matrix* a, const Matrix* b)
 {
     CHECK_FATAL(!out, "out matrix is null");
@@ -127,93 +191,123 @@ void matrix_xply(Matrix* out, const Matrix* a, const Matrix* b)
     u64 k = a->n; // cols of A = rows of B
     u64 n = b->n; // cols of B
 
-    // Initialize output to zero
-    memset(out->data, 0, sizeof(float) * m * n);
-
-    // Block size for cache optimization
-    const u64 BLOCK_SIZE = 16;
-
-    // Blocked matrix multiplication (ikj order for cache efficiency)
-    for (u64 i = 0; i < m; i += BLOCK_SIZE) {
-        for (u64 k_outer = 0; k_outer < k; k_outer += BLOCK_SIZE) {
-            for (u64 j = 0; j < n; j += BLOCK_SIZE) {
-                // Block boundaries
-                u64 i_max = (i + BLOCK_SIZE < m) ? i + BLOCK_SIZE : m;
-                u64 k_max =
-                    (k_outer + BLOCK_SIZE < k) ? k_outer + BLOCK_SIZE : k;
-                u64 j_max = (j + BLOCK_SIZE < n) ? j + BLOCK_SIZE : n;
-                // Multiply this block
-                for (u64 ii = i; ii < i_max; ii++) {
-                    for (u64 kk = k_outer; kk < k_max; kk++) {
-
-                        float a_val = a->data[IDX(a, ii, kk)];
-                        for (u64 jj = j; jj < j_max; jj++) {
-                            out->data[IDX(out, ii, jj)] +=
-                                a_val * b->data[IDX(b, kk, jj)];
-                        }
-                    }
-                }
-            }
-        }
-    }
-
+    gemm_f32(m, n, k, 1, a->data, a->ld, b->data, b->ld, 0, out->data, out->ld);
 }
 
 
-// this function transposes b for cache-friendly access
-// takes more memory, good for large size matrices
-void matrix_xply_2(Matrix* out, const Matrix* a, const Matrix* b)
+void matrix_xply_mt(Matrix* out, const Matrix* a, const Matrix* b, thread_pool* pool)
 {
     CHECK_FATAL(!out, "out matrix is null");
     CHECK_FATAL(!a, "a matrix is null");
     CHECK_FATAL(!b, "b matrix is null");
-    CHECK_FATAL(a->n != b->m, "incompatible matrix dimensions");
+    CHECK_FATAL(a->n != b->m,
+                "incompatible matrix dimensions for multiplication");
     CHECK_FATAL(out->m != a->m || out->n != b->n,
                 "output matrix has wrong dimensions");
 
+    gemm_f32_mt(a->m, b->n, a->n, 1, a->data, a->ld, b->data, b->ld, 0, out->data, out->ld, pool);
+}
+
+
+void matrix_gemv(float* y, float alpha, const Matrix* a, const float* x, float beta)
+{
+    CHECK_FATAL(!a, "a matrix is null");
+
+    gemv_f32(a->m, a->n, alpha, a->data, a->ld, x, beta, y);
+}
+
+
+void matrix_gemv_T(float* y, float alpha, const Matrix* a, const float* x, float beta)
+{
+    CHECK_FATAL(!a, "a matrix is null");
+
+    gemv_t_f32(a->m, a->n, alpha, a->data, a->ld, x, beta, y);
+}
+
+
+// out = a × bt^T straight from bt's rows: B(p, j) = bt[j][p]
+void matrix_xply_bt(Matrix* out, const Matrix* a, const Matrix* bt)
+{
+    CHECK_FATAL(!out, "out matrix is null");
+    CHECK_FATAL(!a, "a matrix is null");
+    CHECK_FATAL(!bt, "bt matrix is null");
+    CHECK_FATAL(a->n != bt->n, "incompatible matrix dimensions");
+    CHECK_FATAL(out->m != a->m || out->n != bt->m,
+                "output matrix has wrong dimensions");
+
     u64 m = a->m;
     u64 k = a->n;
-    u64 n = b->n;
+    u64 n = bt->m;
 
-    // Transpose B for cache-friendly access
+    gemm_f32_strided(m, n, k, 1, a->data, a->ld, 1, bt->data, 1, bt->ld, 0, out->data, out->ld);
+}
+
+
+static void xply_2_with(Matrix* out, const Matrix* a, const Matrix* b, float* bt_data)
+{
+    // Transpose B into the workspace, then multiply by its rows
     Matrix b_T;
-    float  data[n * k]; // random vals
-    matrix_create_stk(&b_T, n, k, data);
+    matrix_create_stk(&b_T, b->n, b->m, bt_data);
     matrix_T(&b_T, b); // transpose sets all vals
 
-    memset(out->data, 0, sizeof(float) * m * n);
+    matrix_xply_bt(out, a, &b_T);
+}
 
-    const u64 BLOCK_SIZE = 16;
 
-    // Now both A and B^T are accessed row-wise
-    for (u64 i = 0; i < m; i += BLOCK_SIZE) {
-        for (u64 j = 0; j < n; j += BLOCK_SIZE) {
-            u64 i_max = (i + BLOCK_SIZE < m) ? i + BLOCK_SIZE : m;
-            u64 j_max = (j + BLOCK_SIZE < n) ? j + BLOCK_SIZE : n;
+// this function transposes b into a heap workspace
+// (it used to be a VLA: 16 MB of stack for 2048x2048)
+void matrix_xply_2(Matrix* out, const Matrix* a, const Matrix* b)
+{
+    CHECK_FATAL(!out, "out matrix is null");
+    CHECK_FATAL(!a, "a matrix is null");
+    CHECK_FATAL(!b, "b matrix is null");
+    CHECK_FATAL(a->n != b->m, "incompatible matrix dimensions");
+    CHECK_FATAL(out->m != a->m || out->n != b->n,
+                "output matrix has wrong dimensions");
 
-            for (u64 ii = i; ii < i_max; ii++) {
-                for (u64 jj = j; jj < j_max; jj++) {
+    if (b->m * b->n == 0) { // nothing to transpose
+        matrix_xply(out, a, b);
+        return;
+    }
 
-                    float sum = 0;
-                    // Dot product of A[ii] and B_T[jj] (both row-wise)
-                    for (u64 kk = 0; kk < k; kk++) {
-                        sum += a->data[IDX(a, ii, kk)] *
-                               // b_T->data[IDX(b_T, jj, kk)];
-                               b_T.data[IDX(&b_T, jj, kk)];
-                    }
-                    out->data[IDX(out, ii, jj)] = sum;
-                }
-            }
-        }
+    float* data = malloc(sizeof(float) * b->m * b->n);
+    CHECK_FATAL(!data, "transpose workspace malloc failed");
+
+    xply_2_with(out, a, b, data);
+
+    free(data);
+}
+
+
+void matrix_xply_2_arena(Matrix* out, const Matrix* a, const Matrix* b, Arena* scratch)
+{
+    CHECK_FATAL(!out, "out matrix is null");
+    CHECK_FATAL(!a, "a matrix is null");
+    CHECK_FATAL(!b, "b matrix is null");
+    CHECK_FATAL(!scratch, "scratch arena is null");
+    CHECK_FATAL(a->n != b->m, "incompatible matrix dimensions");
+    CHECK_FATAL(out->m != a->m || out->n != b->n,
+                "output matrix has wrong dimensions");
+
+    if (b->m * b->n == 0) {
+        matrix_xply(out, a, b);
+        return;
     }
 
+    u64    mark = arena_get_mark(scratch);
+    float* data = (float*)arena_alloc_aligned(scratch, sizeof(float) * b->m * b->n, 64);
+    CHECK_FATAL(!data, "scratch arena too small for the transpose");
+
+    xply_2_with(out, a, b, data);
+
+    arena_clear_mark(scratch, mark);
 }
 
 /*
 Doolittle algorithm computes U's i-th row, then L's i-th column, alternating.
 For each element, you subtract the dot product of already-computed L and U values.
 */
-void matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat)
+b8 matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat)
 {
     CHECK_FATAL(!L, "L mat is null");
     CHECK_FATAL(!U, "U mat is null");
@@ -225,8 +319,8 @@ void matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat)
     const u64 n = mat->n;
 
     // 0 init matrices
-    memset(L->data, 0, sizeof(float) * n * n);
-    memset(U->data, 0, sizeof(float) * n * n);
+    memset(L->data, 0, sizeof(float) * span(L));
+    memset(U->data, 0, sizeof(float) * span(U));
     // L main diagonal is 1
     for (u64 i = 0; i < n; i++) { L->data[IDX(L, i, i)] = 1; }
 
@@ -249,15 +343,16 @@ void matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat)
                 sum += L->data[IDX(L, k, j)] * U->data[IDX(U, j, i)];
             }
 
-            // Check for zero diagonal in U (would cause division by zero)
-            if (U->data[IDX(U, i, i)] == 0) {
-                CHECK_FATAL(1, "Matrix is singular - LU decomposition failed");
-            }
+            // Zero diagonal in U: no LU without pivoting (see matrix_LU)
+            CHECK_WARN_RET(U->data[IDX(U, i, i)] == 0, false,
+                           "zero pivot - LU decomposition failed");
 
             L->data[IDX(L, k, i)] =
                 (MATRIX_AT(mat, k, i) - sum) / U->data[IDX(U, i, i)];
         }
     }
+
+    return true;
 }
 
 /*
@@ -272,28 +367,149 @@ void matrix_LU_Decomp(Matrix* L, Matrix* U, const Matrix* mat)
     LU Decomposition is when we make 2 triangular matrices from one,
     which when multiplied give original matrix: A = L * U
 */
+// the pivoted LU itself (float and double share it) is in lu.c
+
+// perm (n u64) followed by the n×n factors, one heap block freed through perm
+static float* lu_workspace(u64 n, u64** perm)
+{
+    *perm = malloc((sizeof(u64) * n) + (sizeof(float) * n * n));
+    CHECK_FATAL(!*perm, "LU workspace malloc failed");
+
+    return (float*)(*perm + n);
+}
+
+
+b8 matrix_LU(Matrix* lu, u64* perm, const Matrix* mat)
+{
+    CHECK_FATAL(!lu, "lu mat is null");
+    CHECK_FATAL(!perm, "perm is null");
+    CHECK_FATAL(!mat, "mat is null");
+    CHECK_FATAL(mat->n != mat->m, "mat is not a square matrix");
+    CHECK_FATAL(lu->n != mat->n || lu->m != mat->m, "lu dimensions don't match");
+
+    if (lu->data != mat->data) {
+        matrix_view_copy(matrix_view(lu), matrix_view(mat));
+    }
+
+    return lu_f32_factor(lu->data, lu->ld, mat->n, perm, NULL);
+}
+
+
+void matrix_LU_solve(Matrix* x, const Matrix* lu, const u64* perm, const Matrix* b)
+{
+    CHECK_FATAL(!x, "x mat is null");
+    CHECK_FATAL(!lu, "lu mat is null");
+    CHECK_FATAL(!perm, "perm is null");
+    CHECK_FATAL(!b, "b mat is null");
+    CHECK_FATAL(lu->m != lu->n, "lu is not a square matrix");
+    CHECK_FATAL(b->m != lu->n || x->m != b->m || x->n != b->n,
+                "incompatible matrix dimensions");
+    CHECK_FATAL(x->data == b->data, "x may not alias b");
+
+    lu_f32_solve(lu->data, lu->ld, perm, lu->n, b->data, b->ld, x->data, x->ld, b->n);
+}
+
+
+b8 matrix_solve(Matrix* x, const Matrix* a, const Matrix* b)
+{
+    CHECK_FATAL(!x, "x mat is null");
+    CHECK_FATAL(!a, "a mat is null");
+    CHECK_FATAL(!b, "b mat is null");
+    CHECK_FATAL(a->m != a->n, "a is not a square matrix");
+    CHECK_FATAL(b->m != a->n || x->m != b->m || x->n != b->n,
+                "incompatible matrix dimensions");
+    CHECK_FATAL(x->data == b->data, "x may not alias b");
+
+    u64 n = a->n;
+
+    u64*   perm;
+    float* lu = lu_workspace(n, &perm);
+
+    matrix_view_copy(packed_view(lu, n, n), matrix_view(a));
+
+    b8 ok = lu_f32_factor(lu, n, n, perm, NULL);
+    if (ok) {
+        Matrix lu_mat = { lu, n, n, n };
+        matrix_LU_solve(x, &lu_mat, perm, b);
+    } else {
+        WARN("matrix is singular, no solution");
+    }
+
+    free(perm);
+    return ok;
+}
+
+
+b8 matrix_inv(Matrix* out, const Matrix* mat)
+{
+    CHECK_FATAL(!out, "out mat is null");
+    CHECK_FATAL(!mat, "mat is null");
+    CHECK_FATAL(mat->m != mat->n, "only square matrices have an inverse");
+    CHECK_FATAL(out->m != mat->m || out->n != mat->n, "out dimensions don't match");
+
+    u64 n = mat->n;
+
+    u64*   perm;
+    float* lu = lu_workspace(n, &perm);
+
+    matrix_view_copy(packed_view(lu, n, n), matrix_view(mat));
+
+    b8 ok = lu_f32_factor(lu, n, n, perm, NULL);
+    if (ok) {
+        // out = P I, then solve in place (out may be mat, it was copied)
+        memset(out->data, 0, sizeof(float) * span(out));
+        for (u64 i = 0; i < n; i++) { out->data[IDX(out, i, perm[i])] = 1; }
+
+        lu_f32_solve_in_place(lu, n, n, out->data, out->ld, n);
+    } else {
+        WARN("matrix is singular, no inverse");
+    }
+
+    free(perm);
+    return ok;
+}
+
+
 float matrix_det(const Matrix* mat)
 {
     CHECK_FATAL(!mat, "mat matrix is null");
     CHECK_FATAL(mat->m != mat->n, "only square matrices have determinant");
 
+    u64 n = mat->n;
+
+    // pivoted LU on the heap (two n×n VLAs used to overflow the stack)
+    u64*   perm;
+    float* lu = lu_workspace(n, &perm);
+
+    matrix_view_copy(packed_view(lu, n, n), matrix_view(mat));
+
+    u64   swaps;
+    float det = lu_f32_factor(lu, n, n, perm, &swaps) ? (float)lu_f32_det(lu, n, n, swaps) : 0;
+
+    free(perm);
+    return det;
+}
+
+
+float matrix_det_arena(const Matrix* mat, Arena* scratch)
+{
+    CHECK_FATAL(!mat, "mat matrix is null");
+    CHECK_FATAL(!scratch, "scratch arena is null");
+    CHECK_FATAL(mat->m != mat->n, "only square matrices have determinant");
 
     u64 n = mat->n;
 
-    Matrix L, U;
-    float  Ldata[n * n]; // random vals
-    float  Udata[n * n];
-    matrix_create_stk(&L, n, n, Ldata);
-    matrix_create_stk(&U, n, n, Udata);
+    u64    mark = arena_get_mark(scratch);
+    float* lu   = (float*)arena_alloc_aligned(scratch, sizeof(float) * n * n, 64);
+    u64*   perm = (u64*)arena_alloc_aligned(scratch, sizeof(u64) * n, 8);
+    CHECK_FATAL(!lu || !perm, "scratch arena too small for the LU");
 
-    // Perform LU decomposition
-    matrix_LU_Decomp(&L, &U, mat); // L and U set to zero
+    matrix_view_copy(packed_view(lu, n, n), matrix_view(mat));
 
-    // Calculate determinant as product of U's diagonal
-    float det = 1;
-    // for (u64 i = 0; i < n; i++) { det *= U->data[IDX(U, i, i)]; }
-    for (u64 i = 0; i < n; i++) { det *= U.data[IDX(&U, i, i)]; }
+    u64   swaps;
+    float det = lu_f32_factor(lu, n, n, perm, &swaps) ? (float)lu_f32_det(lu, n, n, swaps) : 0;
 
+    arena_clear_mark(scratch, mark);
     return det;
 }
 
@@ -305,34 +521,41 @@ void matrix_T(Matrix* out, const Matrix* mat)
     CHECK_FATAL(mat->m != out->n || mat->n != out->m,
                 "incompatible matrix dimensions");
 
-    // Block size for cache optimization (tune based on cache line size)
-    const u64 BLOCK_SIZE = 16; // TODO: user adjustable macro?
+    // recursive, cache-oblivious, SIMD register tiles (transpose.h)
+    transpose_f32(mat->m, mat->n, mat->data, mat->ld, out->data, out->ld);
+}
 
-    // Blocked transpose: process matrix in BLOCK_SIZE x BLOCK_SIZE tiles
-    for (u64 i = 0; i < mat->m; i += BLOCK_SIZE) {
-        for (u64 j = 0; j < mat->n; j += BLOCK_SIZE) {
 
-            // Calculate block boundaries
-            u64 i_max = (i + BLOCK_SIZE < mat->m) ? i + BLOCK_SIZE : mat->m;
-            u64 j_max = (j + BLOCK_SIZE < mat->n) ? j + BLOCK_SIZE : mat->n;
+void matrix_T_inplace(Matrix* mat)
+{
+    CHECK_FATAL(!mat, "mat matrix is null");
 
-            // Transpose the block
-            for (u64 ii = i; ii < i_max; ii++) {
-                for (u64 jj = j; jj < j_max; jj++) {
-                    // mat[ii][jj] -> out[jj][ii]
-                    out->data[IDX(out, jj, ii)] = mat->data[IDX(mat, ii, jj)];
-                }
-            }
+    if (mat->m == mat->n) {
+        transpose_square_f32(mat->n, mat->data, mat->ld);
+        return;
+    }
+
+    // the cycles need packed rows: close the padding gaps first
+    // (row i moves down to i * n <= i * ld, in order nothing is overwritten early)
+    if (mat->ld != mat->n) {
+        for (u64 i = 1; i < mat->m; i++) {
+            memmove(mat->data + (i * mat->n), mat->data + (i * mat->ld), sizeof(float) * mat->n);
         }
     }
+
+    transpose_inplace_f32(mat->m, mat->n, mat->data);
+
+    u64 t   = mat->m;
+    mat->m  = mat->n;
+    mat->n  = t;
+    mat->ld = t;
 }
 
 void matrix_scale(Matrix* mat, float val)
 {
     CHECK_FATAL(!mat, "matrix is null");
 
-    u64 total = MATRIX_TOTAL(mat);
-    for (u64 i = 0; i < total; i++) { mat->data[i] *= val; }
+    matrix_view_scale(rows_view(mat, mat->ld), val);
 }
 
 
@@ -341,8 +564,8 @@ void matrix_div(Matrix* mat, float val)
     CHECK_FATAL(!mat, "mat is null");
     CHECK_FATAL(val == 0, "division by zero!");
 
-    u64 total = MATRIX_TOTAL(mat);
-    for (u64 i = 0; i < total; i++) { mat->data[i] /= val; }
+    // one division, then a multiply per element
+    matrix_view_scale(rows_view(mat, mat->ld), 1.0f / val);
 }
 
 void matrix_copy(Matrix* dest, const Matrix* src)
@@ -352,9 +575,218 @@ void matrix_copy(Matrix* dest, const Matrix* src)
     CHECK_FATAL(dest->m != src->m || dest->n != src->n,
                 "matrix dimensions don't match");
 
-    memcpy(dest->data, src->data, sizeof(float) * MATRIX_TOTAL(src));
+    u64 w = common_width(dest, src, src);
+    matrix_view_copy(rows_view(dest, w), rows_view(src, w));
+}
+
+// MATRIX VIEWS
+// ============================================================================
+
+typedef enum { VIEW_ADD, VIEW_SUB, VIEW_AXPY } view_op;
+
+static inline b8 view_same_dims(const MatrixView* a, const MatrixView* b)
+{
+    return a->m == b->m && a->n == b->n;
+}
+
+// rows are contiguous and follow each other: one flat array of m * n
+static inline b8 view_contiguous(const MatrixView* v)
+{
+    return (v->cs == 1 || v->n == 1) && (v->rs == v->n || v->m == 1);
+}
+
+// one contiguous run of n floats
+static void view_op_run(view_op op, float alpha, float* out, const float* a, const float* b, u64 n)
+{
+    switch (op) {
+        case VIEW_ADD: vec_f32_add(out, a, b, n); break;
+        case VIEW_SUB: vec_f32_sub(out, a, b, n); break;
+        default:       vec_f32_axpy(out, alpha, a, b, n); break;
+    }
+}
+
+static void view_binary(view_op op, float alpha, MatrixView out, MatrixView a, MatrixView b)
+{
+    CHECK_FATAL(!view_same_dims(&out, &a) || !view_same_dims(&out, &b),
+                "a, b, out view dimentions dont match");
+
+    if (out.m * out.n == 0) {
+        return;
+    }
+
+    // all column contiguous (transposed views): work on the transposes
+    if (out.rs == 1 && a.rs == 1 && b.rs == 1 && !(out.cs == 1 && a.cs == 1 && b.cs == 1)) {
+        out = matrix_view_T(out);
+        a   = matrix_view_T(a);
+        b   = matrix_view_T(b);
+    }
+
+    if (view_contiguous(&out) && view_contiguous(&a) && view_contiguous(&b)) {
+        view_op_run(op, alpha, out.data, a.data, b.data, out.m * out.n);
+        return;
+    }
+
+    if (out.cs == 1 && a.cs == 1 && b.cs == 1) {
+        for (u64 i = 0; i < out.m; i++) {
+            view_op_run(op, alpha, out.data + (i * out.rs), a.data + (i * a.rs),
+                        b.data + (i * b.rs), out.n);
+        }
+        return;
+    }
+
+    for (u64 i = 0; i < out.m; i++) {
+        for (u64 j = 0; j < out.n; j++) {
+            float x = MATRIX_VIEW_AT(a, i, j);
+            float y = MATRIX_VIEW_AT(b, i, j);
+            MATRIX_VIEW_AT(out, i, j) = op == VIEW_ADD ? x + y
+                                      : op == VIEW_SUB ? x - y
+                                                       : (alpha * x) + y;
+        }
+    }
+}
+
+
+MatrixView matrix_view(const Matrix* mat)
+{
+    CHECK_FATAL(!mat, "mat matrix is null");
+
+    return (MatrixView){ mat->data, mat->m, mat->n, mat->ld, 1 };
+}
+
+
+MatrixView matrix_view_slice(MatrixView v, u64 i, u64 j, u64 m, u64 n)
+{
+    CHECK_FATAL(i + m > v.m || j + n > v.n, "slice out of the view's bounds");
+
+    return (MatrixView){ v.data + (i * v.rs) + (j * v.cs), m, n, v.rs, v.cs };
+}
+
+
+MatrixView matrix_view_T(MatrixView v)
+{
+    return (MatrixView){ v.data, v.n, v.m, v.cs, v.rs };
+}
+
+
+void matrix_view_copy(MatrixView dst, MatrixView src)
+{
+    CHECK_FATAL(!view_same_dims(&dst, &src), "view dimensions don't match");
+
+    if (dst.m * dst.n == 0) {
+        return;
+    }
+
+    if (view_contiguous(&dst) && view_contiguous(&src)) {
+        memcpy(dst.data, src.data, sizeof(float) * dst.m * dst.n);
+        return;
+    }
+
+    if (dst.cs == 1 && src.cs == 1) {
+        for (u64 i = 0; i < dst.m; i++) {
+            memcpy(dst.data + (i * dst.rs), src.data + (i * src.rs), sizeof(float) * dst.n);
+        }
+        return;
+    }
+
+    // a transposed source into rows: the transpose kernels
+    if (dst.cs == 1 && src.rs == 1 && dst.rs >= dst.n && src.cs >= dst.m) {
+        transpose_f32(dst.n, dst.m, src.data, src.cs, dst.data, dst.rs);
+        return;
+    }
+
+    // any other strides: in tiles
+    for (u64 i = 0; i < dst.m; i += TRANSPOSE_BLOCK) {
+        for (u64 j = 0; j < dst.n; j += TRANSPOSE_BLOCK) {
+            u64 i_max = (i + TRANSPOSE_BLOCK < dst.m) ? i + TRANSPOSE_BLOCK : dst.m;
+            u64 j_max = (j + TRANSPOSE_BLOCK < dst.n) ? j + TRANSPOSE_BLOCK : dst.n;
+
+            for (u64 ii = i; ii < i_max; ii++) {
+                for (u64 jj = j; jj < j_max; jj++) {
+                    MATRIX_VIEW_AT(dst, ii, jj) = MATRIX_VIEW_AT(src, ii, jj);
+                }
+            }
+        }
+    }
+}
+
+
+void matrix_view_add(MatrixView out, MatrixView a, MatrixView b)
+{
+    view_binary(VIEW_ADD, 1, out, a, b);
 }
 
+
+void matrix_view_sub(MatrixView out, MatrixView a, MatrixView b)
+{
+    view_binary(VIEW_SUB, 1, out, a, b);
+}
+
+
+void matrix_view_axpy(MatrixView out, float alpha, MatrixView x, MatrixView y)
+{
+    view_binary(VIEW_AXPY, alpha, out, x, y);
+}
+
+
+void matrix_view_scale(MatrixView v, float val)
+{
+    if (v.m * v.n == 0) {
+        return;
+    }
+
+    if (v.rs == 1 && v.cs != 1) {
+        v = matrix_view_T(v);
+    }
+
+    if (view_contiguous(&v)) {
+        vec_f32_scale(v.data, v.data, val, v.m * v.n);
+    } else if (v.cs == 1) {
+        for (u64 i = 0; i < v.m; i++) {
+            vec_f32_scale(v.data + (i * v.rs), v.data + (i * v.rs), val, v.n);
+        }
+    } else {
+        for (u64 i = 0; i < v.m; i++) {
+            for (u64 j = 0; j < v.n; j++) { MATRIX_VIEW_AT(v, i, j) *= val; }
+        }
+    }
+}
+
+
+// the GEMM packs a and b through their strides, so only out needs a unit stride
+void matrix_view_xply(MatrixView out, MatrixView a, MatrixView b)
+{
+    CHECK_FATAL(a.n != b.m, "incompatible matrix dimensions for multiplication");
+    CHECK_FATAL(out.m != a.m || out.n != b.n, "output view has wrong dimensions");
+
+    u64 m = a.m;
+    u64 k = a.n;
+    u64 n = b.n;
+
+    if (m * n == 0) {
+        return;
+    }
+
+    if (out.cs == 1 || n == 1) {
+        gemm_f32_strided(m, n, k, 1, a.data, a.rs, a.cs, b.data, b.rs, b.cs, 0, out.data, out.rs);
+        return;
+    }
+
+    // column contiguous out: out^T = b^T × a^T
+    if (out.rs == 1) {
+        gemm_f32_strided(n, m, k, 1, b.data, b.cs, b.rs, a.data, a.cs, a.rs, 0, out.data, out.cs);
+        return;
+    }
+
+    float* tmp = malloc(sizeof(float) * m * n);
+    CHECK_FATAL(!tmp, "view xply temporary malloc failed");
+
+    gemm_f32_strided(m, n, k, 1, a.data, a.rs, a.cs, b.data, b.rs, b.cs, 0, tmp, n);
+    matrix_view_copy(out, (MatrixView){ tmp, m, n, n, 1 });
+
+    free(tmp);
+}
+
+
 void matrix_print(const Matrix* mat)
 {
     CHECK_FATAL(!mat, "matrix is null");
@@ -372,7 +804,7 @@ void matrix_print(const Matrix* mat)
         }
 
         // Print element
-        printf("%f ", mat->data[i]);
+        printf("%f ", MATRIX_AT(mat, i / mat->n, i % mat->n));
     }
 
     // Close last row
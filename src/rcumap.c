@@ -0,0 +1,235 @@
+#include "rcumap.h"
+
+#include <sched.h>
+
+
+
+typedef struct {
+    hashmap* map;
+    u64      epoch; // global epoch when it was unpublished
+} rcu_retired;
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+/*
+ A retired table tagged with epoch E can only be held by a reader whose
+ slot epoch is <= E: a reader that announced a later epoch did so after
+ the increment, which happens after the new table was published, so it
+ loaded the new pointer. Everything is SEQ_CST, the store of the slot
+ epoch must be ordered before the load of the table pointer.
+*/
+static u64 min_active_epoch(rcumap* map)
+{
+    u64 min = (u64)-1;
+
+    for (u32 i = 0; i < RCUMAP_MAX_READERS; i++) {
+        u64 e = __atomic_load_n(&map->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (e != 0 && e < min) {
+            min = e;
+        }
+    }
+
+    return min;
+}
+
+// free retired tables no reader can see (writer lock held)
+static void reclaim(rcumap* map)
+{
+    if (genVec_empty(map->retired)) {
+        return;
+    }
+
+    u64 min = min_active_epoch(map);
+
+    u64 i = 0;
+    while (i < genVec_size(map->retired)) {
+        const rcu_retired* r = (const rcu_retired*)genVec_get_ptr(map->retired, i);
+
+        if (r->epoch < min) {
+            hashmap_destroy(r->map);
+            genVec_remove(map->retired, i, NULL);
+        } else {
+            i++;
+        }
+    }
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+rcumap* rcumap_create(hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    void* mem = NULL;
+    CHECK_FATAL(posix_memalign(&mem, 64, sizeof(rcumap)) != 0, "rcumap alloc failed");
+
+    rcumap* rcu = mem;
+    memset(rcu, 0, sizeof(rcumap));
+
+    rcu->current      = map;
+    rcu->global_epoch = 1;
+    rcu->retired      = genVec_init(0, sizeof(rcu_retired), NULL, NULL, NULL);
+
+    CHECK_FATAL(pthread_mutex_init(&rcu->write_lock, NULL) != 0, "mutex init failed");
+
+    return rcu;
+}
+
+
+void rcumap_destroy(rcumap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    for (u64 i = 0; i < genVec_size(map->retired); i++) {
+        hashmap_destroy(((const rcu_retired*)genVec_get_ptr(map->retired, i))->map);
+    }
+    genVec_destroy(map->retired);
+
+    hashmap_destroy(map->current);
+    pthread_mutex_destroy(&map->write_lock);
+
+    free(map);
+}
+
+
+u32 rcumap_reader_register(rcumap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    for (u32 i = 0; i < RCUMAP_MAX_READERS; i++) {
+        u32 expected = 0;
+        if (__atomic_compare_exchange_n(&map->readers[i].used, &expected, 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return i;
+        }
+    }
+
+    FATAL("all %d reader slots are in use", RCUMAP_MAX_READERS);
+}
+
+
+void rcumap_reader_unregister(rcumap* map, u32 reader)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(reader >= RCUMAP_MAX_READERS, "invalid reader id");
+    CHECK_FATAL(map->readers[reader].epoch != 0, "reader is inside a read section");
+
+    __atomic_store_n(&map->readers[reader].used, 0, __ATOMIC_RELEASE);
+}
+
+
+const hashmap* rcumap_read_lock(rcumap* map, u32 reader)
+{
+    rcu_reader* slot = &map->readers[reader];
+
+    u64 epoch = __atomic_load_n(&map->global_epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&slot->epoch, epoch, __ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&map->current, __ATOMIC_SEQ_CST);
+}
+
+
+void rcumap_read_unlock(rcumap* map, u32 reader)
+{
+    __atomic_store_n(&map->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+
+b8 rcumap_get(rcumap* map, u32 reader, const u8* key, u8* val)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(reader >= RCUMAP_MAX_READERS, "invalid reader id");
+
+    const hashmap* snap  = rcumap_read_lock(map, reader);
+    b8             found = hashmap_get(snap, key, val);
+    rcumap_read_unlock(map, reader);
+
+    return found;
+}
+
+
+hashmap* rcumap_write_begin(rcumap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    pthread_mutex_lock(&map->write_lock);
+
+    // only writers change current, and we hold the writer lock
+    return hashmap_clone(map->current);
+}
+
+
+void rcumap_write_commit(rcumap* map, hashmap* next)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!next, "next is null");
+
+    hashmap* old = map->current;
+
+    __atomic_store_n(&map->current, next, __ATOMIC_SEQ_CST);
+    u64 epoch = __atomic_fetch_add(&map->global_epoch, 1, __ATOMIC_SEQ_CST);
+
+    rcu_retired r = { .map = old, .epoch = epoch };
+    genVec_push(map->retired, cast(r));
+
+    reclaim(map);
+
+    pthread_mutex_unlock(&map->write_lock);
+}
+
+
+void rcumap_write_abort(rcumap* map, hashmap* next)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!next, "next is null");
+
+    hashmap_destroy(next);
+    pthread_mutex_unlock(&map->write_lock);
+}
+
+
+b8 rcumap_put(rcumap* map, const u8* key, const u8* val)
+{
+    hashmap* next    = rcumap_write_begin(map);
+    b8       existed = hashmap_put(next, key, val);
+    rcumap_write_commit(map, next);
+
+    return existed;
+}
+
+
+b8 rcumap_del(rcumap* map, const u8* key)
+{
+    hashmap* next  = rcumap_write_begin(map);
+    b8       found = hashmap_del(next, key, NULL);
+
+    if (!found) { // nothing changed, don't publish a copy
+        rcumap_write_abort(map, next);
+        return 0;
+    }
+
+    rcumap_write_commit(map, next);
+    return 1;
+}
+
+
+void rcumap_synchronize(rcumap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    pthread_mutex_lock(&map->write_lock);
+
+    reclaim(map);
+    while (!genVec_empty(map->retired)) {
+        sched_yield();
+        reclaim(map);
+    }
+
+    pthread_mutex_unlock(&map->write_lock);
+}
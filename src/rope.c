@@ -0,0 +1,401 @@
+#include "rope.h"
+
+#include <string.h>
+
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static inline u64 node_size(const rope_node* t)
+{
+    return t ? t->size : 0;
+}
+
+static inline void node_update(rope_node* t)
+{
+    t->size = node_size(t->left) + node_size(t->right) + t->len;
+}
+
+// xorshift64, priorities only need to be well spread
+static u32 next_prio(rope* r)
+{
+    u64 x = r->seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    r->seed = x;
+
+    return (u32)(x >> 32);
+}
+
+static rope_node* node_create(rope* r, const char* data, u32 len)
+{
+    rope_node* t = malloc(sizeof(rope_node));
+    CHECK_FATAL(!t, "rope node malloc failed");
+
+    t->left  = NULL;
+    t->right = NULL;
+    t->prio  = next_prio(r);
+    t->len   = len;
+    t->size  = len;
+    memcpy(t->data, data, len);
+
+    return t;
+}
+
+static void tree_destroy(rope_node* t)
+{
+    if (!t) {
+        return;
+    }
+
+    tree_destroy(t->left);
+    tree_destroy(t->right);
+    free(t);
+}
+
+// all of a, then all of b
+static rope_node* merge(rope_node* a, rope_node* b)
+{
+    if (!a) { return b; }
+    if (!b) { return a; }
+
+    if (a->prio > b->prio) {
+        a->right = merge(a->right, b);
+        node_update(a);
+        return a;
+    }
+
+    b->left = merge(a, b->left);
+    node_update(b);
+    return b;
+}
+
+// first pos bytes to *l, the rest to *rt (a leaf is cut if pos falls inside it)
+static void split(rope* r, rope_node* t, u64 pos, rope_node** l, rope_node** rt)
+{
+    if (!t) {
+        *l  = NULL;
+        *rt = NULL;
+        return;
+    }
+
+    u64 lsz = node_size(t->left);
+
+    if (pos <= lsz) {
+        split(r, t->left, pos, l, &t->left);
+        node_update(t);
+        *rt = t;
+    } else if (pos >= lsz + t->len) {
+        split(r, t->right, pos - lsz - t->len, &t->right, rt);
+        node_update(t);
+        *l = t;
+    } else {
+        // cut the leaf: t keeps data[0, off), the tail is a new node that
+        // inherits t's priority so merge(tail, rest) can't outrank the parent
+        u32        off  = (u32)(pos - lsz);
+        rope_node* tail = node_create(r, t->data + off, t->len - off);
+        rope_node* rest = t->right;
+
+        tail->prio = t->prio;
+
+        t->len   = off;
+        t->right = NULL;
+        node_update(t);
+
+        *l  = t;
+        *rt = merge(tail, rest);
+    }
+}
+
+// treap of leaves holding n bytes of data
+static rope_node* build(rope* r, const char* data, u64 n)
+{
+    rope_node* t = NULL;
+
+    while (n != 0) {
+        u32 k = n < ROPE_LEAF_MAX ? (u32)n : ROPE_LEAF_MAX;
+        t     = merge(t, node_create(r, data, k));
+        data += k;
+        n -= k;
+    }
+
+    return t;
+}
+
+// insert inside the leaf at pos if it has room, @return 1 on success
+static b8 insert_in_leaf(rope_node* t, u64 pos, const char* s, u64 n)
+{
+    if (!t) {
+        return 0;
+    }
+
+    u64 lsz = node_size(t->left);
+    b8  ok;
+
+    if (pos < lsz) {
+        ok = insert_in_leaf(t->left, pos, s, n);
+    } else if (pos <= lsz + t->len) {
+        if (t->len + n > ROPE_LEAF_MAX) {
+            return 0;
+        }
+        u32 off = (u32)(pos - lsz);
+        memmove(t->data + off + n, t->data + off, t->len - off);
+        memcpy(t->data + off, s, n);
+        t->len += (u32)n;
+        ok = 1;
+    } else {
+        ok = insert_in_leaf(t->right, pos - lsz - t->len, s, n);
+    }
+
+    if (ok) {
+        t->size += n;
+    }
+    return ok;
+}
+
+// remove n bytes if they are all inside one leaf that stays non empty
+static b8 remove_in_leaf(rope_node* t, u64 pos, u64 n)
+{
+    if (!t) {
+        return 0;
+    }
+
+    u64 lsz = node_size(t->left);
+    b8  ok;
+
+    if (pos < lsz) {
+        ok = remove_in_leaf(t->left, pos, n);
+    } else if (pos < lsz + t->len) {
+        u32 off = (u32)(pos - lsz);
+        if (off + n > t->len || n >= t->len) {
+            return 0;
+        }
+        memmove(t->data + off, t->data + off + n, t->len - off - n);
+        t->len -= (u32)n;
+        ok = 1;
+    } else {
+        ok = remove_in_leaf(t->right, pos - lsz - t->len, n);
+    }
+
+    if (ok) {
+        t->size -= n;
+    }
+    return ok;
+}
+
+// copy up to n bytes starting at i (relative to t), @return bytes copied
+static u64 copy_range(const rope_node* t, u64 i, u64 n, char* out)
+{
+    if (!t || n == 0) {
+        return 0;
+    }
+
+    u64 copied = 0;
+    u64 lsz    = node_size(t->left);
+
+    if (i < lsz) {
+        u64 c = copy_range(t->left, i, n, out);
+        copied += c;
+        n -= c;
+        i = 0;
+    } else {
+        i -= lsz;
+    }
+
+    if (n != 0 && i < t->len) {
+        u64 k = t->len - i < n ? t->len - i : n;
+        memcpy(out + copied, t->data + i, k);
+        copied += k;
+        n -= k;
+        i = 0;
+    } else if (i >= t->len) {
+        i -= t->len;
+    }
+
+    if (n != 0) {
+        copied += copy_range(t->right, i, n, out + copied);
+    }
+
+    return copied;
+}
+
+static void for_each_leaf(const rope_node* t, rope_chunk_fn fn, void* ctx)
+{
+    if (!t) {
+        return;
+    }
+
+    for_each_leaf(t->left, fn, ctx);
+    fn((StringView){ t->data, t->len }, ctx);
+    for_each_leaf(t->right, fn, ctx);
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+rope* rope_create(void)
+{
+    rope* r = malloc(sizeof(rope));
+    CHECK_FATAL(!r, "rope malloc failed");
+
+    r->root = NULL;
+    r->seed = 0x9E3779B97F4A7C15ULL;
+
+    return r;
+}
+
+
+rope* rope_from_view(StringView sv)
+{
+    CHECK_FATAL(!sv.data && sv.len != 0, "view data is null");
+
+    rope* r = rope_create();
+    r->root = build(r, sv.data, sv.len);
+
+    return r;
+}
+
+
+void rope_destroy(rope* r)
+{
+    CHECK_FATAL(!r, "rope is null");
+
+    tree_destroy(r->root);
+    free(r);
+}
+
+
+void rope_insert(rope* r, u64 i, StringView text)
+{
+    CHECK_FATAL(!r, "rope is null");
+    CHECK_FATAL(i > rope_len(r), "index out of bounds");
+
+    if (text.len == 0) {
+        return;
+    }
+    CHECK_FATAL(!text.data, "text data is null");
+
+    if (insert_in_leaf(r->root, i, text.data, text.len)) {
+        return;
+    }
+
+    rope_node* a;
+    rope_node* b;
+    split(r, r->root, i, &a, &b);
+
+    r->root = merge(merge(a, build(r, text.data, text.len)), b);
+}
+
+
+void rope_insert_cstr(rope* r, u64 i, const char* cstr)
+{
+    CHECK_FATAL(!cstr, "cstr is null");
+
+    rope_insert(r, i, (StringView){ cstr, strlen(cstr) });
+}
+
+
+void rope_append(rope* r, StringView text)
+{
+    rope_insert(r, rope_len(r), text);
+}
+
+
+void rope_remove(rope* r, u64 i, u64 n)
+{
+    CHECK_FATAL(!r, "rope is null");
+
+    u64 len = rope_len(r);
+    CHECK_FATAL(i > len, "index out of bounds");
+
+    if (n > len - i) {
+        n = len - i;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    if (remove_in_leaf(r->root, i, n)) {
+        return;
+    }
+
+    rope_node* a;
+    rope_node* mid;
+    rope_node* c;
+    split(r, r->root, i, &a, &c);
+    split(r, c, n, &mid, &c);
+
+    tree_destroy(mid);
+    r->root = merge(a, c);
+}
+
+
+char rope_char_at(const rope* r, u64 i)
+{
+    CHECK_FATAL(!r, "rope is null");
+    CHECK_FATAL(i >= rope_len(r), "index out of bounds");
+
+    const rope_node* t = r->root;
+
+    while (1) {
+        u64 lsz = node_size(t->left);
+
+        if (i < lsz) {
+            t = t->left;
+        } else if (i < lsz + t->len) {
+            return t->data[i - lsz];
+        } else {
+            i -= lsz + t->len;
+            t = t->right;
+        }
+    }
+}
+
+
+u64 rope_copy(const rope* r, u64 i, u64 n, char* out)
+{
+    CHECK_FATAL(!r, "rope is null");
+    CHECK_FATAL(i > rope_len(r), "index out of bounds");
+    CHECK_FATAL(!out && n != 0, "out is null");
+
+    return copy_range(r->root, i, n, out);
+}
+
+
+String* rope_to_string(const rope* r)
+{
+    return rope_substr(r, 0, rope_len(r));
+}
+
+
+String* rope_substr(const rope* r, u64 i, u64 n)
+{
+    CHECK_FATAL(!r, "rope is null");
+    CHECK_FATAL(i > rope_len(r), "index out of bounds");
+
+    if (n > rope_len(r) - i) {
+        n = rope_len(r) - i;
+    }
+
+    String* str = string_create();
+    if (n != 0) {
+        string_reserve_char(str, n, '\0');
+        rope_copy(r, i, n, string_data_ptr(str));
+    }
+
+    return str;
+}
+
+
+void rope_for_each_chunk(const rope* r, rope_chunk_fn fn, void* ctx)
+{
+    CHECK_FATAL(!r, "rope is null");
+    CHECK_FATAL(!fn, "fn is null");
+
+    for_each_leaf(r->root, fn, ctx);
+}
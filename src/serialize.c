@@ -0,0 +1,105 @@
+#include "serialize.h"
+
+
+
+b8 ser_write_header(FILE* f, SER_KIND kind)
+{
+    CHECK_FATAL(!f, "file is null");
+
+    u32 magic   = SER_MAGIC;
+    u16 version = SER_VERSION;
+    u16 k       = (u16)kind;
+
+    return ser_write_bytes(f, cast(magic), sizeof(magic)) &&
+           ser_write_bytes(f, cast(version), sizeof(version)) &&
+           ser_write_bytes(f, cast(k), sizeof(k));
+}
+
+
+b8 ser_read_header(FILE* f, SER_KIND kind)
+{
+    CHECK_FATAL(!f, "file is null");
+
+    u32 magic   = 0;
+    u16 version = 0;
+    u16 k       = 0;
+
+    if (!ser_read_bytes(f, cast(magic), sizeof(magic)) ||
+        !ser_read_bytes(f, cast(version), sizeof(version)) ||
+        !ser_read_bytes(f, cast(k), sizeof(k))) {
+        return false;
+    }
+
+    CHECK_WARN_RET(magic != SER_MAGIC, false, "bad magic, not a serialized container");
+    CHECK_WARN_RET(version > SER_VERSION, false, "unsupported format version %u", version);
+    CHECK_WARN_RET(k != (u16)kind, false, "container kind mismatch (got %u)", k);
+
+    return true;
+}
+
+
+b8 ser_write_u32(FILE* f, u32 val)
+{
+    return ser_write_bytes(f, cast(val), sizeof(val));
+}
+
+b8 ser_read_u32(FILE* f, u32* val)
+{
+    CHECK_FATAL(!val, "val is null");
+    return ser_read_bytes(f, (u8*)val, sizeof(*val));
+}
+
+
+b8 ser_write_u64(FILE* f, u64 val)
+{
+    return ser_write_bytes(f, cast(val), sizeof(val));
+}
+
+b8 ser_read_u64(FILE* f, u64* val)
+{
+    CHECK_FATAL(!val, "val is null");
+    return ser_read_bytes(f, (u8*)val, sizeof(*val));
+}
+
+
+b8 ser_write_bytes(FILE* f, const u8* data, u64 size)
+{
+    CHECK_FATAL(!f, "file is null");
+
+    if (size == 0) { return true; }
+
+    CHECK_FATAL(!data, "data is null");
+    CHECK_WARN_RET(fwrite(data, 1, size, f) != size, false, "write failed");
+
+    return true;
+}
+
+b8 ser_read_bytes(FILE* f, u8* data, u64 size)
+{
+    CHECK_FATAL(!f, "file is null");
+
+    if (size == 0) { return true; }
+
+    CHECK_FATAL(!data, "data is null");
+    CHECK_WARN_RET(fread(data, 1, size, f) != size, false, "unexpected end of stream");
+
+    return true;
+}
+
+
+u64 ser_reserve_hint(FILE* f, u64 count, u64 min_size)
+{
+    CHECK_FATAL(!f, "file is null");
+
+    if (min_size == 0) { min_size = 1; }
+
+    u64  cap = SER_RESERVE_MAX;
+    long pos = ftell(f);
+    if (pos >= 0 && fseek(f, 0, SEEK_END) == 0) {
+        long end = ftell(f);
+        if (end >= pos) { cap = (u64)(end - pos) / min_size; }
+        CHECK_WARN_RET(fseek(f, pos, SEEK_SET) != 0, 0, "seek failed");
+    }
+
+    return count < cap ? count : cap;
+}
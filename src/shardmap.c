@@ -0,0 +1,210 @@
+#include "shardmap.h"
+
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// the hashmap inside the shard uses (hash % capacity), i.e. the low bits.
+// fibonacci mixing spreads every hash bit into the top bits of the product,
+// so shard selection stays independent of the slot inside the shard
+static shard* get_shard(const shardmap* map, const u8* key)
+{
+    if (map->shard_bits == 0) {
+        return map->shards;
+    }
+
+    u64 hash = map->hash_fn(key, map->key_size);
+    u64 idx  = (hash * 0x9E3779B97F4A7C15ULL) >> (64 - map->shard_bits);
+
+    return &map->shards[idx];
+}
+
+#define READ_LOCK(s)  pthread_rwlock_rdlock(&(s)->lock)
+#define WRITE_LOCK(s) pthread_rwlock_wrlock(&(s)->lock)
+#define UNLOCK(s)     pthread_rwlock_unlock(&(s)->lock)
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+shardmap* shardmap_create(u32 n_shards, u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                          compare_fn cmp_fn, copy_fn key_copy, copy_fn val_copy,
+                          move_fn key_move, move_fn val_move,
+                          delete_fn key_del, delete_fn val_del)
+{
+    CHECK_FATAL(key_size == 0, "key size can't be zero");
+    CHECK_FATAL(val_size == 0, "val size can't be zero");
+
+    if (n_shards == 0) {
+        n_shards = SHARDMAP_DEFAULT_SHARDS;
+    }
+
+    u32 bits = 0;
+    while ((1U << bits) < n_shards) {
+        bits++;
+    }
+    CHECK_FATAL(bits > 16, "too many shards");
+
+    shardmap* map = malloc(sizeof(shardmap));
+    CHECK_FATAL(!map, "shardmap malloc failed");
+
+    map->n_shards   = 1U << bits;
+    map->shard_bits = bits;
+    map->key_size   = key_size;
+    map->hash_fn    = hash_fn ? hash_fn : fnv1a_hash; // same default as hashmap
+
+    void* shards = NULL;
+    CHECK_FATAL(posix_memalign(&shards, SHARDMAP_CACHE_LINE, sizeof(shard) * map->n_shards) != 0,
+                "shards alloc failed");
+    map->shards = shards;
+
+    for (u32 i = 0; i < map->n_shards; i++) {
+        shard* s = &map->shards[i];
+
+        s->map = hashmap_create(key_size, val_size, map->hash_fn, cmp_fn, key_copy, val_copy,
+                                key_move, val_move, key_del, val_del);
+
+        CHECK_FATAL(pthread_rwlock_init(&s->lock, NULL) != 0, "rwlock init failed");
+    }
+
+    return map;
+}
+
+
+void shardmap_destroy(shardmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    for (u32 i = 0; i < map->n_shards; i++) {
+        hashmap_destroy(map->shards[i].map);
+        pthread_rwlock_destroy(&map->shards[i].lock);
+    }
+
+    free(map->shards);
+    free(map);
+}
+
+
+b8 shardmap_put(shardmap* map, const u8* key, const u8* val)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key, "key is null");
+
+    shard* s = get_shard(map, key);
+
+    WRITE_LOCK(s);
+    b8 existed = hashmap_put(s->map, key, val);
+    UNLOCK(s);
+
+    return existed;
+}
+
+
+b8 shardmap_put_move(shardmap* map, u8** key, u8** val)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key, "key is null");
+    CHECK_FATAL(!*key, "*key is null");
+
+    shard* s = get_shard(map, *key);
+
+    WRITE_LOCK(s);
+    b8 existed = hashmap_put_move(s->map, key, val);
+    UNLOCK(s);
+
+    return existed;
+}
+
+
+b8 shardmap_update(shardmap* map, const u8* key, const u8* init_val,
+                   shardmap_update_fn fn, void* ctx)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key, "key is null");
+    CHECK_FATAL(!init_val, "init_val is null");
+    CHECK_FATAL(!fn, "update fn is null");
+
+    shard* s = get_shard(map, key);
+
+    WRITE_LOCK(s);
+
+    u8* val     = hashmap_get_ptr(s->map, key);
+    b8  existed = val != NULL;
+
+    if (!existed) {
+        hashmap_put(s->map, key, init_val);
+        val = hashmap_get_ptr(s->map, key);
+    }
+
+    fn(val, ctx);
+
+    UNLOCK(s);
+
+    return existed;
+}
+
+
+b8 shardmap_get(shardmap* map, const u8* key, u8* val)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key, "key is null");
+
+    shard* s = get_shard(map, key);
+
+    READ_LOCK(s);
+    b8 found = hashmap_get(s->map, key, val);
+    UNLOCK(s);
+
+    return found;
+}
+
+
+b8 shardmap_has(shardmap* map, const u8* key)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key, "key is null");
+
+    shard* s = get_shard(map, key);
+
+    READ_LOCK(s);
+    b8 found = hashmap_has(s->map, key);
+    UNLOCK(s);
+
+    return found;
+}
+
+
+b8 shardmap_del(shardmap* map, const u8* key, u8* out)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(!key, "key is null");
+
+    shard* s = get_shard(map, key);
+
+    WRITE_LOCK(s);
+    b8 found = hashmap_del(s->map, key, out);
+    UNLOCK(s);
+
+    return found;
+}
+
+
+u64 shardmap_size(shardmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    u64 total = 0;
+
+    for (u32 i = 0; i < map->n_shards; i++) {
+        shard* s = &map->shards[i];
+
+        READ_LOCK(s);
+        total += hashmap_size(s->map);
+        UNLOCK(s);
+    }
+
+    return total;
+}
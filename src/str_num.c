@@ -0,0 +1,785 @@
+#include "str_num.h"
+
+#include <pthread.h>
+#include <string.h>
+
+
+
+typedef unsigned __int128 u128;
+
+
+/*
+====================INTEGERS====================
+*/
+
+static const char digit_pairs[200] = "0001020304050607080910111213141516171819"
+                                     "2021222324252627282930313233343536373839"
+                                     "4041424344454647484950515253545556575859"
+                                     "6061626364656667686970717273747576777879"
+                                     "8081828384858687888990919293949596979899";
+
+static const u64 pow10_u64[20] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+static inline u32 u64_digits(u64 v)
+{
+    u32 n = 1;
+    while (n < 20 && v >= pow10_u64[n]) {
+        n++;
+    }
+    return n;
+}
+
+// write v so that its last digit is at end[-1]
+static inline void write_digits(char* end, u64 v)
+{
+    while (v >= 100) {
+        u64 q = v / 100;
+        u32 r = (u32)(v - q * 100);
+        end -= 2;
+        memcpy(end, digit_pairs + r * 2, 2);
+        v = q;
+    }
+
+    if (v >= 10) {
+        memcpy(end - 2, digit_pairs + v * 2, 2);
+    } else {
+        end[-1] = (char)('0' + v);
+    }
+}
+
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_DIGITS 1
+
+// all 8 bytes are '0'..'9'
+static inline b8 is_eight_digits(const char* p)
+{
+    u64 v;
+    memcpy(&v, p, 8);
+
+    return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
+// 8 ascii digits -> value, 3 multiplies (pairs, quads, halves)
+static inline u64 parse_eight_digits(const char* p)
+{
+    u64 v;
+    memcpy(&v, p, 8);
+
+    v = ((v & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return ((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+#else
+#define SWAR_DIGITS 0
+#endif
+
+
+/*
+====================RYU TABLES====================
+*/
+
+#define F64_MANTISSA_BITS   52
+#define F64_BIAS            1023
+#define POW5_INV_BITCOUNT   125
+#define POW5_BITCOUNT       125
+#define POW5_INV_TABLE_SIZE 342
+#define POW5_TABLE_SIZE     326
+
+// 128 bit multipliers, {low, high}
+static u64            pow5_inv_split[POW5_INV_TABLE_SIZE][2]; // floor(2^j / 5^i) + 1
+static u64            pow5_split[POW5_TABLE_SIZE][2];         // top 125 bits of 5^i
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+
+// just enough big integer for the tables (5^341 is 792 bits)
+#define BIG_WORDS 14
+
+typedef struct {
+    u64 w[BIG_WORDS]; // little endian
+} big;
+
+static u32 big_bitlen(const big* a)
+{
+    for (int i = BIG_WORDS - 1; i >= 0; i--) {
+        if (a->w[i]) {
+            return (u32)(i * 64 + 64 - __builtin_clzll(a->w[i]));
+        }
+    }
+    return 0;
+}
+
+static void big_mul_small(big* a, u64 m)
+{
+    u64 carry = 0;
+    for (int i = 0; i < BIG_WORDS; i++) {
+        u128 p   = (u128)a->w[i] * m + carry;
+        a->w[i]  = (u64)p;
+        carry    = (u64)(p >> 64);
+    }
+}
+
+static void big_shl1(big* a)
+{
+    for (int i = BIG_WORDS - 1; i > 0; i--) {
+        a->w[i] = (a->w[i] << 1) | (a->w[i - 1] >> 63);
+    }
+    a->w[0] <<= 1;
+}
+
+static int big_cmp(const big* a, const big* b)
+{
+    for (int i = BIG_WORDS - 1; i >= 0; i--) {
+        if (a->w[i] != b->w[i]) {
+            return a->w[i] < b->w[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static void big_sub(big* a, const big* b)
+{
+    u64 borrow = 0;
+    for (int i = 0; i < BIG_WORDS; i++) {
+        u64 x   = a->w[i];
+        u64 d   = x - b->w[i] - borrow;
+        borrow  = (x < b->w[i]) || (x - b->w[i] < borrow);
+        a->w[i] = d;
+    }
+}
+
+// bits [shift, shift + 128) of a
+static u128 big_bits128(const big* a, u32 shift)
+{
+    u128 r = 0;
+    for (u32 k = 0; k < 2; k++) {
+        u32 s = shift + k * 64;
+        u32 w = s / 64;
+        u32 o = s % 64;
+
+        u64 lo = w < BIG_WORDS ? a->w[w] >> o : 0;
+        u64 hi = (o != 0 && w + 1 < BIG_WORDS) ? a->w[w + 1] << (64 - o) : 0;
+        r |= (u128)(lo | hi) << (k * 64);
+    }
+    return r;
+}
+
+// same values as the tables in the reference Ryu (d2s_full_table.h),
+// built once instead of shipping ~10 KB of constants
+static void build_tables(void)
+{
+    big pow5 = { { 1 } }; // 5^i
+
+    for (u32 i = 0; i < POW5_INV_TABLE_SIZE; i++) {
+        u32 len = big_bitlen(&pow5);
+
+        if (i < POW5_TABLE_SIZE) {
+            u128 v = len >= POW5_BITCOUNT ? big_bits128(&pow5, len - POW5_BITCOUNT)
+                                          : big_bits128(&pow5, 0) << (POW5_BITCOUNT - len);
+            pow5_split[i][0] = (u64)v;
+            pow5_split[i][1] = (u64)(v >> 64);
+        }
+
+        // long division 2^(len - 1 + 125) / 5^i, only the last 126 quotient
+        // bits can be set: start with the remainder at 2^(len - 1)
+        big rem = { { 0 } };
+        rem.w[(len - 1) / 64] = 1ULL << ((len - 1) % 64);
+
+        u128 q = 0;
+        for (int b = POW5_INV_BITCOUNT; b >= 0; b--) {
+            if (b != POW5_INV_BITCOUNT) {
+                big_shl1(&rem);
+            }
+            q <<= 1;
+            if (big_cmp(&rem, &pow5) >= 0) {
+                big_sub(&rem, &pow5);
+                q |= 1;
+            }
+        }
+        q += 1;
+
+        pow5_inv_split[i][0] = (u64)q;
+        pow5_inv_split[i][1] = (u64)(q >> 64);
+
+        big_mul_small(&pow5, 5);
+    }
+}
+
+
+/*
+====================RYU (double -> shortest decimal)====================
+*/
+
+typedef struct {
+    u64 mantissa;
+    i32 exponent; // value = mantissa * 10^exponent
+} f64_decimal;
+
+// ceil(log2(5^e)) for e > 0, 1 for e = 0
+static inline i32 pow5bits(i32 e)
+{
+    return (i32)(((u32)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)), floor(log10(5^e))
+static inline u32 log10_pow2(i32 e)
+{
+    return ((u32)e * 78913) >> 18;
+}
+
+static inline u32 log10_pow5(i32 e)
+{
+    return ((u32)e * 732923) >> 20;
+}
+
+static inline u32 pow5_factor(u64 v)
+{
+    u32 count = 0;
+    while (v % 5 == 0) {
+        v /= 5;
+        count++;
+    }
+    return count;
+}
+
+static inline b8 multiple_of_pow5(u64 v, u32 p)
+{
+    return pow5_factor(v) >= p;
+}
+
+static inline b8 multiple_of_pow2(u64 v, u32 p)
+{
+    return (v & ((1ULL << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, mul is 128 bit, j >= 64
+static inline u64 mul_shift64(u64 m, const u64* mul, i32 j)
+{
+    u128 b0 = (u128)m * mul[0];
+    u128 b2 = (u128)m * mul[1];
+
+    return (u64)(((b0 >> 64) + b2) >> (j - 64));
+}
+
+static f64_decimal d2d(u64 ieee_mantissa, u32 ieee_exponent)
+{
+    i32 e2;
+    u64 m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - F64_BIAS - F64_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (i32)ieee_exponent - F64_BIAS - F64_MANTISSA_BITS - 2;
+        m2 = (1ULL << F64_MANTISSA_BITS) | ieee_mantissa;
+    }
+
+    const b8 accept_bounds = (m2 & 1) == 0; // round half even
+
+    // interval of values that round to this double: [mm, mp], 4 * m2 +- ...
+    const u64 mv       = 4 * m2;
+    const u32 mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    u64 vr, vp, vm;
+    i32 e10;
+    b8  vm_trailing_zeros = 0;
+    b8  vr_trailing_zeros = 0;
+
+    if (e2 >= 0) {
+        const u32 q = log10_pow2(e2) - (e2 > 3);
+        e10         = (i32)q;
+
+        const i32 k = POW5_INV_BITCOUNT + pow5bits((i32)q) - 1;
+        const i32 i = -e2 + (i32)q + k;
+
+        vr = mul_shift64(4 * m2, pow5_inv_split[q], i);
+        vp = mul_shift64(4 * m2 + 2, pow5_inv_split[q], i);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, pow5_inv_split[q], i);
+
+        if (q <= 21) {
+            // only one of mp, mv, mm can be a multiple of 5, if any
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= multiple_of_pow5(mv + 2, q);
+            }
+        }
+    } else {
+        const u32 q = log10_pow5(-e2) - (-e2 > 1);
+        e10         = (i32)q + e2;
+
+        const i32 i = -e2 - (i32)q;
+        const i32 k = pow5bits(i) - POW5_BITCOUNT;
+        const i32 j = (i32)q - k;
+
+        vr = mul_shift64(4 * m2, pow5_split[i], j);
+        vp = mul_shift64(4 * m2 + 2, pow5_split[i], j);
+        vm = mul_shift64(4 * m2 - 1 - mm_shift, pow5_split[i], j);
+
+        if (q <= 1) {
+            // mv = 4 * m2 has at least 2 trailing 0 bits
+            vr_trailing_zeros = 1;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // drop digits while the interval still holds a shorter number
+    i32 removed     = 0;
+    u8  last_digit  = 0;
+    u64 output;
+
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // rare exact cases
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_digit == 0;
+            last_digit = (u8)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_digit == 0;
+                last_digit = (u8)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+
+        if (vr_trailing_zeros && last_digit == 5 && vr % 2 == 0) {
+            last_digit = 4; // exactly halfway, round to even
+        }
+
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_digit >= 5);
+    } else {
+        // common case
+        b8 round_up = 0;
+
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        output = vr + (vr == vm || round_up);
+    }
+
+    return (f64_decimal){ output, e10 + removed };
+}
+
+
+/*
+====================FLOAT PARSING====================
+*/
+
+static const double pow10_f64[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline b8 is_digit(char c)
+{
+    return (u8)(c - '0') < 10;
+}
+
+// case insensitive match of word (lowercase) at s, @return its length or 0
+static u64 match_word(const char* s, u64 n, const char* word)
+{
+    u64 i = 0;
+    for (; word[i]; i++) {
+        if (i >= n || (s[i] | 0x20) != word[i]) {
+            return 0;
+        }
+    }
+    return i;
+}
+
+// mantissa * 10^exp10 if it can be done with one exact operation
+static b8 fast_path(u64 mantissa, i64 exp10, double* out)
+{
+    const u64 max_exact = 1ULL << 53;
+
+    if (mantissa > max_exact) {
+        return 0;
+    }
+
+    if (exp10 >= -22 && exp10 <= 22) {
+        // both operands exact -> one correctly rounded op
+        double v = (double)mantissa;
+        *out     = exp10 < 0 ? v / pow10_f64[-exp10] : v * pow10_f64[exp10];
+        return 1;
+    }
+
+    // 123e25: move the extra power into the mantissa while it stays exact
+    if (exp10 > 22 && exp10 <= 22 + 15) {
+        u64 scaled;
+        if (__builtin_mul_overflow(mantissa, pow10_u64[exp10 - 22], &scaled) ||
+            scaled > max_exact) {
+            return 0;
+        }
+        *out = (double)scaled * 1e22;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+u32 str_fmt_u64(char* buf, u64 val)
+{
+    CHECK_FATAL(!buf, "buf is null");
+
+    u32 n = u64_digits(val);
+    write_digits(buf + n, val);
+
+    return n;
+}
+
+
+u32 str_fmt_i64(char* buf, i64 val)
+{
+    CHECK_FATAL(!buf, "buf is null");
+
+    if (val < 0) {
+        buf[0] = '-';
+        return 1 + str_fmt_u64(buf + 1, 0ULL - (u64)val);
+    }
+
+    return str_fmt_u64(buf, (u64)val);
+}
+
+
+u32 str_fmt_f64(char* buf, double val)
+{
+    CHECK_FATAL(!buf, "buf is null");
+
+    u64 bits;
+    memcpy(&bits, &val, sizeof(bits));
+
+    const b8  sign          = (b8)(bits >> 63);
+    const u64 ieee_mantissa = bits & ((1ULL << F64_MANTISSA_BITS) - 1);
+    const u32 ieee_exponent = (u32)(bits >> F64_MANTISSA_BITS) & 0x7FF;
+
+    char* p = buf;
+
+    if (ieee_exponent == 0x7FF) {
+        if (ieee_mantissa != 0) {
+            memcpy(p, "nan", 3);
+            return 3;
+        }
+        if (sign) {
+            *p++ = '-';
+        }
+        memcpy(p, "inf", 3);
+        return (u32)(p - buf) + 3;
+    }
+
+    if (sign) {
+        *p++ = '-';
+    }
+
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        memcpy(p, "0.0", 3);
+        return (u32)(p - buf) + 3;
+    }
+
+    pthread_once(&tables_once, build_tables);
+
+    f64_decimal d = d2d(ieee_mantissa, ieee_exponent);
+
+    char digits[20];
+    u32  olen = u64_digits(d.mantissa);
+    write_digits(digits + olen, d.mantissa);
+
+    // value = 0.DIGITS * 10^decpt
+    i32 decpt = (i32)olen + d.exponent;
+
+    if (decpt > -4 && decpt <= 16) {
+        if (decpt <= 0) {
+            // 0.000ddd
+            *p++ = '0';
+            *p++ = '.';
+            memset(p, '0', (u64)-decpt);
+            p += -decpt;
+            memcpy(p, digits, olen);
+            p += olen;
+        } else if ((u32)decpt >= olen) {
+            // ddd000.0
+            memcpy(p, digits, olen);
+            p += olen;
+            memset(p, '0', (u64)decpt - olen);
+            p += decpt - (i32)olen;
+            *p++ = '.';
+            *p++ = '0';
+        } else {
+            // dd.ddd
+            memcpy(p, digits, (u64)decpt);
+            p += decpt;
+            *p++ = '.';
+            memcpy(p, digits + decpt, olen - (u32)decpt);
+            p += olen - (u32)decpt;
+        }
+        return (u32)(p - buf);
+    }
+
+    // d.ddde+XX
+    *p++ = digits[0];
+    if (olen > 1) {
+        *p++ = '.';
+        memcpy(p, digits + 1, olen - 1);
+        p += olen - 1;
+    }
+
+    i32 e = decpt - 1;
+    *p++  = 'e';
+    *p++  = e < 0 ? '-' : '+';
+    if (e < 0) {
+        e = -e;
+    }
+
+    if (e >= 100) {
+        *p++ = (char)('0' + e / 100);
+        e %= 100;
+    }
+    memcpy(p, digit_pairs + e * 2, 2);
+    p += 2;
+
+    return (u32)(p - buf);
+}
+
+
+u64 str_parse_u64(const char* s, u64 n, u64* out)
+{
+    CHECK_FATAL(!out, "out is null");
+    CHECK_FATAL(!s && n != 0, "s is null");
+
+    u64 i = 0;
+    while (i < n && s[i] == '0') {
+        i++;
+    }
+
+    const u64 start = i; // first significant digit
+    u64       v     = 0;
+
+#if SWAR_DIGITS
+    // 16 significant digits can't overflow
+    while (i + 8 <= n && i - start <= 8 && is_eight_digits(s + i)) {
+        v = v * 100000000ULL + parse_eight_digits(s + i);
+        i += 8;
+    }
+#endif
+
+    while (i < n && is_digit(s[i])) {
+        u64 d = (u64)(s[i] - '0');
+
+        if (i - start < 19) {
+            v = v * 10 + d;
+        } else if (__builtin_mul_overflow(v, 10, &v) || __builtin_add_overflow(v, d, &v)) {
+            return 0;
+        }
+        i++;
+    }
+
+    if (i == 0) {
+        return 0;
+    }
+
+    *out = v;
+    return i;
+}
+
+
+u64 str_parse_i64(const char* s, u64 n, i64* out)
+{
+    CHECK_FATAL(!out, "out is null");
+    CHECK_FATAL(!s && n != 0, "s is null");
+
+    u64 i   = 0;
+    b8  neg = 0;
+    if (i < n && (s[i] == '-' || s[i] == '+')) {
+        neg = s[i] == '-';
+        i++;
+    }
+
+    u64 v;
+    u64 k = str_parse_u64(s + i, n - i, &v);
+    if (k == 0) {
+        return 0;
+    }
+
+    const u64 limit = (u64)INT64_MAX + neg;
+    if (v > limit) {
+        return 0;
+    }
+
+    *out = neg ? (i64)(0ULL - v) : (i64)v;
+    return i + k;
+}
+
+
+u64 str_parse_f64(const char* s, u64 n, double* out)
+{
+    CHECK_FATAL(!out, "out is null");
+    CHECK_FATAL(!s && n != 0, "s is null");
+
+    u64 i   = 0;
+    b8  neg = 0;
+    if (i < n && (s[i] == '-' || s[i] == '+')) {
+        neg = s[i] == '-';
+        i++;
+    }
+
+    // inf / infinity / nan
+    if (i < n && ((s[i] | 0x20) == 'i' || (s[i] | 0x20) == 'n')) {
+        u64 k;
+        if ((k = match_word(s + i, n - i, "infinity")) || (k = match_word(s + i, n - i, "inf"))) {
+            *out = neg ? -__builtin_inf() : __builtin_inf();
+            return i + k;
+        }
+        if ((k = match_word(s + i, n - i, "nan"))) {
+            *out = neg ? -__builtin_nan("") : __builtin_nan("");
+            return i + k;
+        }
+        return 0;
+    }
+
+    // up to 19 significant digits in mantissa, the rest only shift exp10
+    u64 mantissa  = 0;
+    u32 sig       = 0;
+    i64 exp10     = 0;
+    u64 ndigits   = 0;
+    b8  truncated = 0;
+
+    while (i < n && is_digit(s[i])) {
+        u64 d = (u64)(s[i] - '0');
+        if (sig < 19) {
+            mantissa = mantissa * 10 + d;
+            sig += mantissa != 0;
+        } else {
+            exp10++;
+            truncated |= d != 0;
+        }
+        ndigits++;
+        i++;
+    }
+
+    if (i < n && s[i] == '.') {
+        u64 j = i + 1;
+        while (j < n && is_digit(s[j])) {
+            u64 d = (u64)(s[j] - '0');
+            if (sig < 19) {
+                mantissa = mantissa * 10 + d;
+                sig += mantissa != 0;
+                exp10--;
+            } else {
+                truncated |= d != 0;
+            }
+            ndigits++;
+            j++;
+        }
+        // "5." is a number, a lone "." is not
+        if (ndigits != 0) {
+            i = j;
+        }
+    }
+
+    if (ndigits == 0) {
+        return 0;
+    }
+
+    // exponent, only taken if it has digits ("1e" parses as 1)
+    if (i < n && (s[i] | 0x20) == 'e') {
+        u64 j    = i + 1;
+        b8  eneg = 0;
+        if (j < n && (s[j] == '-' || s[j] == '+')) {
+            eneg = s[j] == '-';
+            j++;
+        }
+
+        if (j < n && is_digit(s[j])) {
+            i64 e = 0;
+            while (j < n && is_digit(s[j])) {
+                if (e < 100000) { // way past the double range either way
+                    e = e * 10 + (s[j] - '0');
+                }
+                j++;
+            }
+            exp10 += eneg ? -e : e;
+            i = j;
+        }
+    }
+
+    double v;
+    if (mantissa == 0 && !truncated) {
+        v = 0.0;
+    } else if (truncated || !fast_path(mantissa, exp10, &v)) {
+        // slow path: strtod needs a '\0' terminated copy of the span
+        char  stk[64];
+        char* tmp = stk;
+        if (i >= sizeof(stk)) {
+            tmp = malloc(i + 1);
+            CHECK_FATAL(!tmp, "tmp malloc failed");
+        }
+
+        memcpy(tmp, s, i);
+        tmp[i] = '\0';
+        *out   = strtod(tmp, NULL);
+
+        if (tmp != stk) {
+            free(tmp);
+        }
+        return i;
+    }
+
+    *out = neg ? -v : v;
+    return i;
+}
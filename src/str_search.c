@@ -0,0 +1,389 @@
+#include "str_search.h"
+#include "cpu_features.h"
+
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+/*
+====================SCALAR====================
+*/
+
+static u64 find_char_scalar(const char* s, u64 n, char c)
+{
+    for (u64 i = 0; i < n; i++) {
+        if (s[i] == c) {
+            return i;
+        }
+    }
+
+    return STR_NPOS;
+}
+
+static u64 count_char_scalar(const char* s, u64 n, char c)
+{
+    u64 count = 0;
+
+    for (u64 i = 0; i < n; i++) {
+        count += (s[i] == c);
+    }
+
+    return count;
+}
+
+static u64 find_any_scalar(const char* s, u64 n, const char* set, u64 k)
+{
+    u8 table[256] = { 0 };
+    for (u64 j = 0; j < k; j++) {
+        table[(u8)set[j]] = 1;
+    }
+
+    for (u64 i = 0; i < n; i++) {
+        if (table[(u8)s[i]]) {
+            return i;
+        }
+    }
+
+    return STR_NPOS;
+}
+
+// candidates from position i on, first/last byte check before memcmp
+static u64 find_scalar(const char* s, u64 n, const char* needle, u64 m, u64 i)
+{
+    const char first = needle[0];
+    const char last  = needle[m - 1];
+
+    for (; i + m <= n; i++) {
+        if (s[i] == first && s[i + m - 1] == last &&
+            memcmp(s + i + 1, needle + 1, m - 1) == 0) {
+            return i;
+        }
+    }
+
+    return STR_NPOS;
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+__attribute__((target("sse2")))
+static u64 find_char_sse2(const char* s, u64 n, char c)
+{
+    const __m128i vc = _mm_set1_epi8(c);
+    u64 i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v    = _mm_loadu_si128((const __m128i*)(s + i));
+        u32     mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vc));
+
+        if (mask) {
+            return i + (u64)__builtin_ctz(mask);
+        }
+    }
+
+    u64 r = find_char_scalar(s + i, n - i, c);
+    return r == STR_NPOS ? r : i + r;
+}
+
+__attribute__((target("sse2")))
+static u64 count_char_sse2(const char* s, u64 n, char c)
+{
+    const __m128i vc = _mm_set1_epi8(c);
+    u64 count = 0;
+    u64 i     = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        count += (u64)__builtin_popcount((u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vc)));
+    }
+
+    return count + count_char_scalar(s + i, n - i, c);
+}
+
+__attribute__((target("sse2")))
+static u64 find_any_sse2(const char* s, u64 n, const char* set, u64 k)
+{
+    __m128i vs[STR_SET_SIMD_MAX];
+    for (u64 j = 0; j < k; j++) {
+        vs[j] = _mm_set1_epi8(set[j]);
+    }
+
+    u64 i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v  = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i eq = _mm_cmpeq_epi8(v, vs[0]);
+        for (u64 j = 1; j < k; j++) {
+            eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, vs[j]));
+        }
+
+        u32 mask = (u32)_mm_movemask_epi8(eq);
+        if (mask) {
+            return i + (u64)__builtin_ctz(mask);
+        }
+    }
+
+    u64 r = find_any_scalar(s + i, n - i, set, k);
+    return r == STR_NPOS ? r : i + r;
+}
+
+__attribute__((target("sse2")))
+static u64 find_sse2(const char* s, u64 n, const char* needle, u64 m)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last  = _mm_set1_epi8(needle[m - 1]);
+    u64 i = 0;
+
+    // block at i covers starts i..i+15, its last bytes end at i + 15 + m - 1
+    for (; i + 16 + m - 1 <= n; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i bl = _mm_loadu_si128((const __m128i*)(s + i + m - 1));
+
+        u32 mask = (u32)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last)));
+
+        while (mask) {
+            u64 pos = i + (u64)__builtin_ctz(mask);
+            if (memcmp(s + pos + 1, needle + 1, m - 1) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar(s, n, needle, m, i);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+__attribute__((target("avx2")))
+static u64 find_char_avx2(const char* s, u64 n, char c)
+{
+    const __m256i vc = _mm256_set1_epi8(c);
+    u64 i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i v    = _mm256_loadu_si256((const __m256i*)(s + i));
+        u32     mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc));
+
+        if (mask) {
+            return i + (u64)__builtin_ctz(mask);
+        }
+    }
+
+    u64 r = find_char_sse2(s + i, n - i, c);
+    return r == STR_NPOS ? r : i + r;
+}
+
+__attribute__((target("avx2,popcnt")))
+static u64 count_char_avx2(const char* s, u64 n, char c)
+{
+    const __m256i vc = _mm256_set1_epi8(c);
+    u64 count = 0;
+    u64 i     = 0;
+
+    // 4 blocks per iteration to keep the popcounts off the critical path
+    for (; i + 128 <= n; i += 128) {
+        const __m256i* p = (const __m256i*)(s + i);
+
+        u32 m0 = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p + 0), vc));
+        u32 m1 = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p + 1), vc));
+        u32 m2 = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p + 2), vc));
+        u32 m3 = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p + 3), vc));
+
+        count += (u64)__builtin_popcountll(((u64)m1 << 32) | m0);
+        count += (u64)__builtin_popcountll(((u64)m3 << 32) | m2);
+    }
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        count += (u64)__builtin_popcount((u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc)));
+    }
+
+    return count + count_char_scalar(s + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+static u64 find_any_avx2(const char* s, u64 n, const char* set, u64 k)
+{
+    __m256i vs[STR_SET_SIMD_MAX];
+    for (u64 j = 0; j < k; j++) {
+        vs[j] = _mm256_set1_epi8(set[j]);
+    }
+
+    u64 i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v  = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i eq = _mm256_cmpeq_epi8(v, vs[0]);
+        for (u64 j = 1; j < k; j++) {
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(v, vs[j]));
+        }
+
+        u32 mask = (u32)_mm256_movemask_epi8(eq);
+        if (mask) {
+            return i + (u64)__builtin_ctz(mask);
+        }
+    }
+
+    u64 r = find_any_sse2(s + i, n - i, set, k);
+    return r == STR_NPOS ? r : i + r;
+}
+
+__attribute__((target("avx2")))
+static u64 find_avx2(const char* s, u64 n, const char* needle, u64 m)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last  = _mm256_set1_epi8(needle[m - 1]);
+    u64 i = 0;
+
+    for (; i + 32 + m - 1 <= n; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i*)(s + i + m - 1));
+
+        u32 mask = (u32)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last)));
+
+        while (mask) {
+            u64 pos = i + (u64)__builtin_ctz(mask);
+            if (memcmp(s + pos + 1, needle + 1, m - 1) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar(s, n, needle, m, i);
+}
+
+#endif // CPU_X86
+
+
+/*
+====================DISPATCH====================
+*/
+
+u64 str_find_char(const char* s, u64 n, char c)
+{
+    if (n == 0) {
+        return STR_NPOS;
+    }
+    CHECK_FATAL(!s, "s is null");
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return find_char_avx2(s, n, c);
+        case CPU_SSE2: return find_char_sse2(s, n, c);
+        default:       break;
+    }
+#endif
+
+    return find_char_scalar(s, n, c);
+}
+
+
+u64 str_count_char(const char* s, u64 n, char c)
+{
+    if (n == 0) {
+        return 0;
+    }
+    CHECK_FATAL(!s, "s is null");
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return count_char_avx2(s, n, c);
+        case CPU_SSE2: return count_char_sse2(s, n, c);
+        default:       break;
+    }
+#endif
+
+    return count_char_scalar(s, n, c);
+}
+
+
+u64 str_find(const char* s, u64 n, const char* needle, u64 m)
+{
+    if (m == 0) {
+        return 0;
+    }
+    if (m > n) {
+        return STR_NPOS;
+    }
+    CHECK_FATAL(!s, "s is null");
+    CHECK_FATAL(!needle, "needle is null");
+
+    if (m == 1) {
+        return str_find_char(s, n, needle[0]);
+    }
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return find_avx2(s, n, needle, m);
+        case CPU_SSE2: return find_sse2(s, n, needle, m);
+        default:       break;
+    }
+#endif
+
+    return find_scalar(s, n, needle, m, 0);
+}
+
+
+u64 str_find_any(const char* s, u64 n, const char* set, u64 k)
+{
+    if (n == 0 || k == 0) {
+        return STR_NPOS;
+    }
+    CHECK_FATAL(!s, "s is null");
+    CHECK_FATAL(!set, "set is null");
+
+    if (k == 1) {
+        return str_find_char(s, n, set[0]);
+    }
+
+#if CPU_X86
+    if (k <= STR_SET_SIMD_MAX) {
+        switch (cpu_simd_level()) {
+            case CPU_AVX2: return find_any_avx2(s, n, set, k);
+            case CPU_SSE2: return find_any_sse2(s, n, set, k);
+            default:       break;
+        }
+    }
+#endif
+
+    return find_any_scalar(s, n, set, k);
+}
+
+
+u64 str_find_all(const char* s, u64 n, const char* needle, u64 m, genVec* out)
+{
+    CHECK_FATAL(!out, "out is null");
+    CHECK_FATAL(out->data_size != sizeof(u64), "out data_size must be 8 (u64)");
+    CHECK_FATAL(m == 0, "needle is empty");
+
+    u64 count = 0;
+    u64 i     = 0;
+
+    while (i + m <= n) {
+        u64 r = str_find(s + i, n - i, needle, m);
+        if (r == STR_NPOS) {
+            break;
+        }
+
+        u64 pos = i + r;
+        genVec_push(out, cast(pos));
+        count++;
+
+        i = pos + 1; // overlapping matches
+    }
+
+    return count;
+}
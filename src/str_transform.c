@@ -0,0 +1,380 @@
+#include "str_transform.h"
+#include "cpu_features.h"
+
+#include <pthread.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+/*
+====================SCALAR====================
+*/
+
+static inline u32 class_of(u8 c)
+{
+    if (c >= 0x80) { return STR_CLASS_NON_ASCII; }
+    if (c >= '0' && c <= '9') { return STR_CLASS_DIGIT; }
+    if (c >= 'A' && c <= 'Z') { return STR_CLASS_UPPER; }
+    if (c >= 'a' && c <= 'z') { return STR_CLASS_LOWER; }
+    if (c == ' ' || (c >= '\t' && c <= '\r')) { return STR_CLASS_SPACE; }
+    if (c > ' ' && c < 0x7F) { return STR_CLASS_PUNCT; }
+
+    return STR_CLASS_CNTRL;
+}
+
+static u8             class_table[256];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// flip bit 5 of the bytes in lo..lo+25 (A-Z or a-z)
+static void case_scalar(char* s, u64 n, u8 lo)
+{
+    for (u64 i = 0; i < n; i++) {
+        s[i] = (char)(s[i] ^ (((u8)(s[i] - lo) < 26) << 5));
+    }
+}
+
+// keep the bytes whose class is in keep, lowercase A-Z if lower
+static u64 transform_scalar(const char* s, u64 n, char* out, u32 keep, b8 lower)
+{
+    u64 o = 0;
+
+    for (u64 i = 0; i < n; i++) {
+        u8  c   = (u8)s[i];
+        u32 cls = class_table[c];
+
+        if (cls & keep) {
+            out[o++] = (char)(lower && cls == STR_CLASS_UPPER ? c | 0x20 : c);
+        }
+    }
+
+    return o;
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+// 0xFF where lo <= v <= hi (unsigned)
+__attribute__((target("sse2")))
+static inline __m128i in_range_sse2(__m128i v, u8 lo, u8 hi)
+{
+    __m128i t = _mm_sub_epi8(v, _mm_set1_epi8((char)lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8((char)(hi - lo))), t);
+}
+
+// 0xFF for the bytes whose class is in keep
+__attribute__((target("sse2")))
+static inline __m128i class_mask_sse2(__m128i v, u32 keep, __m128i upper)
+{
+    __m128i m = _mm_setzero_si128();
+
+    __m128i alnum = _mm_setzero_si128();
+    if (keep & (STR_CLASS_DIGIT | STR_CLASS_PUNCT)) {
+        __m128i digit = in_range_sse2(v, '0', '9');
+        alnum         = _mm_or_si128(alnum, digit);
+        if (keep & STR_CLASS_DIGIT) { m = _mm_or_si128(m, digit); }
+    }
+    if (keep & (STR_CLASS_UPPER | STR_CLASS_PUNCT)) {
+        alnum = _mm_or_si128(alnum, upper);
+        if (keep & STR_CLASS_UPPER) { m = _mm_or_si128(m, upper); }
+    }
+    if (keep & (STR_CLASS_LOWER | STR_CLASS_PUNCT)) {
+        __m128i low = in_range_sse2(v, 'a', 'z');
+        alnum       = _mm_or_si128(alnum, low);
+        if (keep & STR_CLASS_LOWER) { m = _mm_or_si128(m, low); }
+    }
+    if (keep & STR_CLASS_PUNCT) {
+        m = _mm_or_si128(m, _mm_andnot_si128(alnum, in_range_sse2(v, 0x21, 0x7E)));
+    }
+    if (keep & (STR_CLASS_SPACE | STR_CLASS_CNTRL)) {
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                     in_range_sse2(v, '\t', '\r'));
+        if (keep & STR_CLASS_SPACE) { m = _mm_or_si128(m, space); }
+        if (keep & STR_CLASS_CNTRL) {
+            __m128i cntrl = _mm_or_si128(in_range_sse2(v, 0, 0x1F),
+                                         _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+            m = _mm_or_si128(m, _mm_andnot_si128(space, cntrl));
+        }
+    }
+    if (keep & STR_CLASS_NON_ASCII) {
+        m = _mm_or_si128(m, _mm_cmplt_epi8(v, _mm_setzero_si128()));
+    }
+
+    return m;
+}
+
+__attribute__((target("sse2")))
+static void case_sse2(char* s, u64 n, u8 lo)
+{
+    const __m128i bit = _mm_set1_epi8(0x20);
+
+    u64 i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i m = in_range_sse2(v, lo, (u8)(lo + 25));
+        _mm_storeu_si128((__m128i*)(s + i), _mm_xor_si128(v, _mm_and_si128(m, bit)));
+    }
+
+    case_scalar(s + i, n - i, lo);
+}
+
+// mixed blocks are compacted byte by byte (no pshufb in SSE2)
+__attribute__((target("sse2")))
+static u64 transform_sse2(const char* s, u64 n, char* out, u32 keep, b8 lower)
+{
+    const __m128i bit = _mm_set1_epi8(lower ? 0x20 : 0);
+
+    u64 i = 0;
+    u64 o = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v     = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i upper = in_range_sse2(v, 'A', 'Z');
+        u32     m     = (u32)_mm_movemask_epi8(class_mask_sse2(v, keep, upper));
+
+        v = _mm_or_si128(v, _mm_and_si128(upper, bit));
+
+        if (m == 0xFFFF) {
+            _mm_storeu_si128((__m128i*)(out + o), v);
+            o += 16;
+        } else if (m != 0) {
+            char block[16];
+            _mm_storeu_si128((__m128i*)block, v);
+            while (m) {
+                out[o++] = block[__builtin_ctz(m)];
+                m &= m - 1;
+            }
+        }
+    }
+
+    return o + transform_scalar(s + i, n - i, out + o, keep, lower);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+// shuffle indices that pack the bytes set in an 8 bit mask to the front
+static u8 compact_idx[256][8];
+static u8 compact_len[256];
+
+static void build_compact_tables(void)
+{
+    for (u32 m = 0; m < 256; m++) {
+        u8 k = 0;
+        for (u8 b = 0; b < 8; b++) {
+            if (m & (1U << b)) {
+                compact_idx[m][k++] = b;
+            }
+        }
+        compact_len[m] = k;
+        while (k < 8) {
+            compact_idx[m][k++] = 0x80; // zero, never counted
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static inline __m256i in_range_avx2(__m256i v, u8 lo, u8 hi)
+{
+    __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8((char)lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8((char)(hi - lo))), t);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i class_mask_avx2(__m256i v, u32 keep, __m256i upper)
+{
+    __m256i m = _mm256_setzero_si256();
+
+    __m256i alnum = _mm256_setzero_si256();
+    if (keep & (STR_CLASS_DIGIT | STR_CLASS_PUNCT)) {
+        __m256i digit = in_range_avx2(v, '0', '9');
+        alnum         = _mm256_or_si256(alnum, digit);
+        if (keep & STR_CLASS_DIGIT) { m = _mm256_or_si256(m, digit); }
+    }
+    if (keep & (STR_CLASS_UPPER | STR_CLASS_PUNCT)) {
+        alnum = _mm256_or_si256(alnum, upper);
+        if (keep & STR_CLASS_UPPER) { m = _mm256_or_si256(m, upper); }
+    }
+    if (keep & (STR_CLASS_LOWER | STR_CLASS_PUNCT)) {
+        __m256i low = in_range_avx2(v, 'a', 'z');
+        alnum       = _mm256_or_si256(alnum, low);
+        if (keep & STR_CLASS_LOWER) { m = _mm256_or_si256(m, low); }
+    }
+    if (keep & STR_CLASS_PUNCT) {
+        m = _mm256_or_si256(m, _mm256_andnot_si256(alnum, in_range_avx2(v, 0x21, 0x7E)));
+    }
+    if (keep & (STR_CLASS_SPACE | STR_CLASS_CNTRL)) {
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                        in_range_avx2(v, '\t', '\r'));
+        if (keep & STR_CLASS_SPACE) { m = _mm256_or_si256(m, space); }
+        if (keep & STR_CLASS_CNTRL) {
+            __m256i cntrl = _mm256_or_si256(in_range_avx2(v, 0, 0x1F),
+                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+            m = _mm256_or_si256(m, _mm256_andnot_si256(space, cntrl));
+        }
+    }
+    if (keep & STR_CLASS_NON_ASCII) {
+        m = _mm256_or_si256(m, _mm256_cmpgt_epi8(_mm256_setzero_si256(), v));
+    }
+
+    return m;
+}
+
+__attribute__((target("avx2")))
+static void case_avx2(char* s, u64 n, u8 lo)
+{
+    const __m256i bit = _mm256_set1_epi8(0x20);
+
+    u64 i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i m = in_range_avx2(v, lo, (u8)(lo + 25));
+        _mm256_storeu_si256((__m256i*)(s + i), _mm256_xor_si256(v, _mm256_and_si256(m, bit)));
+    }
+
+    case_sse2(s + i, n - i, lo);
+}
+
+/*
+ Pack the bytes of one 8 byte lane selected by mask to out.
+ The store is 8 bytes wide; the bytes past the packed ones are
+ overwritten by the next lane. With out <= s this never reaches input
+ that hasn't been loaded yet (o <= i at every lane).
+*/
+__attribute__((target("avx2")))
+static inline u64 compact_lane(__m128i half, u32 mask, u8 offset, char* out)
+{
+    __m128i idx = _mm_loadl_epi64((const __m128i*)compact_idx[mask]);
+    idx         = _mm_add_epi8(idx, _mm_set1_epi8((char)offset)); // 0x80 + 8 keeps the high bit
+    _mm_storel_epi64((__m128i*)out, _mm_shuffle_epi8(half, idx));
+
+    return compact_len[mask];
+}
+
+__attribute__((target("avx2")))
+static u64 transform_avx2(const char* s, u64 n, char* out, u32 keep, b8 lower)
+{
+    const __m256i bit = _mm256_set1_epi8(lower ? 0x20 : 0);
+
+    u64 i = 0;
+    u64 o = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v     = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i upper = in_range_avx2(v, 'A', 'Z');
+        u32     m     = (u32)_mm256_movemask_epi8(class_mask_avx2(v, keep, upper));
+
+        v = _mm256_or_si256(v, _mm256_and_si256(upper, bit));
+
+        if (m == 0xFFFFFFFF) {
+            _mm256_storeu_si256((__m256i*)(out + o), v);
+            o += 32;
+        } else if (m != 0) {
+            __m128i lo = _mm256_castsi256_si128(v);
+            __m128i hi = _mm256_extracti128_si256(v, 1);
+
+            o += compact_lane(lo, m & 0xFF, 0, out + o);
+            o += compact_lane(lo, (m >> 8) & 0xFF, 8, out + o);
+            o += compact_lane(hi, (m >> 16) & 0xFF, 0, out + o);
+            o += compact_lane(hi, m >> 24, 8, out + o);
+        }
+    }
+
+    return o + transform_sse2(s + i, n - i, out + o, keep, lower);
+}
+
+#endif // CPU_X86
+
+
+/*
+====================DISPATCH====================
+*/
+
+static void build_tables(void)
+{
+    for (u32 c = 0; c < 256; c++) {
+        class_table[c] = (u8)class_of((u8)c);
+    }
+#if CPU_X86
+    build_compact_tables();
+#endif
+}
+
+static void to_case(char* s, u64 n, u8 lo)
+{
+    if (n == 0) {
+        return;
+    }
+    CHECK_FATAL(!s, "s is null");
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: case_avx2(s, n, lo); return;
+        case CPU_SSE2: case_sse2(s, n, lo); return;
+        default:       break;
+    }
+#endif
+
+    case_scalar(s, n, lo);
+}
+
+static u64 transform(const char* s, u64 n, char* out, u32 keep, b8 lower)
+{
+    if (n == 0) {
+        return 0;
+    }
+    CHECK_FATAL(!s, "s is null");
+    CHECK_FATAL(!out, "out is null");
+
+    pthread_once(&tables_once, build_tables);
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return transform_avx2(s, n, out, keep, lower);
+        case CPU_SSE2: return transform_sse2(s, n, out, keep, lower);
+        default:       break;
+    }
+#endif
+
+    return transform_scalar(s, n, out, keep, lower);
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+u32 str_classify(char c)
+{
+    return class_of((u8)c);
+}
+
+
+void str_to_lower(char* s, u64 n)
+{
+    to_case(s, n, 'A');
+}
+
+
+void str_to_upper(char* s, u64 n)
+{
+    to_case(s, n, 'a');
+}
+
+
+u64 str_filter(char* s, u64 n, u32 drop)
+{
+    return transform(s, n, s, STR_CLASS_ALL & ~drop, 0);
+}
+
+
+u64 str_normalize(const char* s, u64 n, char* out, u32 keep)
+{
+    return transform(s, n, out, STR_CLASS_ALPHA | keep, 1);
+}
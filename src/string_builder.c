@@ -0,0 +1,220 @@
+#include "string_builder.h"
+
+#include <string.h>
+
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// chunk with room for at least min_cap bytes, linked at the tail
+static sb_chunk* sb_new_chunk(str_builder* sb, u64 min_cap)
+{
+    u64 cap = sb->next_cap;
+    if (cap < min_cap) {
+        cap = min_cap; // oversized append, own chunk
+    } else if (sb->next_cap < SB_CHUNK_MAX) {
+        sb->next_cap *= 2;
+    }
+
+    u64       bytes = sizeof(sb_chunk) + cap;
+    sb_chunk* chunk = NULL;
+    b8        heap  = 1;
+
+    // check first, arena_alloc warns when it runs out
+    if (sb->arena && arena_remaining(sb->arena) >= bytes + ARENA_DEFAULT_ALIGNMENT) {
+        chunk = (sb_chunk*)arena_alloc(sb->arena, bytes);
+        heap  = chunk == NULL;
+    }
+    if (!chunk) {
+        chunk = malloc(bytes);
+        CHECK_FATAL(!chunk, "chunk malloc failed");
+    }
+
+    chunk->next    = NULL;
+    chunk->len     = 0;
+    chunk->cap     = cap;
+    chunk->on_heap = heap;
+
+    if (sb->tail) {
+        sb->tail->next = chunk;
+    } else {
+        sb->head = chunk;
+    }
+    sb->tail = chunk;
+
+    return chunk;
+}
+
+static void sb_free_chunks(sb_chunk* chunk)
+{
+    while (chunk) {
+        sb_chunk* next = chunk->next;
+        if (chunk->on_heap) {
+            free(chunk);
+        }
+        chunk = next;
+    }
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void sb_init(str_builder* sb, Arena* arena)
+{
+    CHECK_FATAL(!sb, "sb is null");
+
+    sb->head     = NULL;
+    sb->tail     = NULL;
+    sb->len      = 0;
+    sb->next_cap = SB_CHUNK_MIN;
+    sb->arena    = arena;
+}
+
+
+void sb_destroy(str_builder* sb)
+{
+    CHECK_FATAL(!sb, "sb is null");
+
+    sb_free_chunks(sb->head);
+    sb_init(sb, sb->arena);
+}
+
+
+void sb_clear(str_builder* sb)
+{
+    CHECK_FATAL(!sb, "sb is null");
+
+    if (!sb->head) {
+        return;
+    }
+
+    sb_free_chunks(sb->head->next);
+
+    sb->head->next = NULL;
+    sb->head->len  = 0;
+    sb->tail       = sb->head;
+    sb->len        = 0;
+}
+
+
+void sb_append(str_builder* sb, const char* data, u64 n)
+{
+    CHECK_FATAL(!sb, "sb is null");
+    if (n == 0) {
+        return;
+    }
+    CHECK_FATAL(!data, "data is null");
+
+    sb->len += n;
+
+    // fill what is left of the tail, the rest goes in one new chunk
+    sb_chunk* tail = sb->tail;
+    if (tail) {
+        u64 room = tail->cap - tail->len;
+        u64 k    = n < room ? n : room;
+
+        memcpy(tail->data + tail->len, data, k);
+        tail->len += k;
+        data += k;
+        n -= k;
+    }
+
+    if (n != 0) {
+        tail = sb_new_chunk(sb, n);
+        memcpy(tail->data, data, n);
+        tail->len = n;
+    }
+}
+
+
+void sb_append_char(str_builder* sb, char c)
+{
+    CHECK_FATAL(!sb, "sb is null");
+
+    sb_chunk* tail = sb->tail;
+    if (!tail || tail->len == tail->cap) {
+        tail = sb_new_chunk(sb, 1);
+    }
+
+    tail->data[tail->len++] = c;
+    sb->len++;
+}
+
+
+void sb_append_cstr(str_builder* sb, const char* cstr)
+{
+    CHECK_FATAL(!cstr, "cstr is null");
+
+    sb_append(sb, cstr, strlen(cstr));
+}
+
+
+void sb_append_view(str_builder* sb, StringView sv)
+{
+    sb_append(sb, sv.data, sv.len);
+}
+
+
+void sb_append_string(str_builder* sb, const String* str)
+{
+    CHECK_FATAL(!str, "str is null");
+
+    sb_append(sb, string_data_ptr(str), string_len(str));
+}
+
+
+void sb_copy_to(const str_builder* sb, char* out)
+{
+    CHECK_FATAL(!sb, "sb is null");
+    CHECK_FATAL(!out && sb->len != 0, "out is null");
+
+    for (const sb_chunk* c = sb->head; c; c = c->next) {
+        memcpy(out, c->data, c->len);
+        out += c->len;
+    }
+}
+
+
+String* sb_build(const str_builder* sb)
+{
+    String* str = string_create();
+
+    sb_build_into(sb, str);
+
+    return str;
+}
+
+
+void sb_build_into(const str_builder* sb, String* str)
+{
+    CHECK_FATAL(!sb, "sb is null");
+    CHECK_FATAL(!str, "str is null");
+
+    if (sb->len == 0) {
+        return;
+    }
+
+    // one reserve, then copy the chunks straight into the buffer
+    u64 len = string_len(str);
+    string_reserve_char(str, len + sb->len, '\0');
+
+    sb_copy_to(sb, string_data_ptr(str) + len);
+}
+
+
+char* sb_to_cstr(const str_builder* sb)
+{
+    CHECK_FATAL(!sb, "sb is null");
+
+    char* out = malloc(sb->len + 1);
+    CHECK_FATAL(!out, "cstr malloc failed");
+
+    sb_copy_to(sb, out);
+    out[sb->len] = '\0';
+
+    return out;
+}
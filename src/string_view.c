@@ -0,0 +1,235 @@
+#include "string_view.h"
+#include "str_search.h"
+#include "utf8.h"
+
+#include <string.h>
+
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static b8 is_space(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static b8 is_delim(const sv_split_iter* it, char c)
+{
+    if (it->delims) {
+        return c != '\0' && strchr(it->delims, c) != NULL;
+    }
+
+    return c == it->delim;
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+StringView sv_from_cstr(const char* cstr)
+{
+    CHECK_FATAL(!cstr, "cstr is null");
+
+    return (StringView){ cstr, strlen(cstr) };
+}
+
+
+StringView sv_substr(StringView sv, u64 start, u64 len)
+{
+    if (start == 0) { // also keeps a NULL data ptr free of pointer math
+        return (StringView){ sv.data, len < sv.len ? len : sv.len };
+    }
+    if (start > sv.len) {
+        start = sv.len;
+    }
+    if (len > sv.len - start) {
+        len = sv.len - start;
+    }
+
+    return (StringView){ sv.data + start, len };
+}
+
+
+StringView sv_prefix(StringView sv, u64 n)
+{
+    return sv_substr(sv, 0, n);
+}
+
+StringView sv_suffix(StringView sv, u64 n)
+{
+    return n >= sv.len ? sv : sv_substr(sv, sv.len - n, n);
+}
+
+StringView sv_drop_prefix(StringView sv, u64 n)
+{
+    return sv_substr(sv, n, SV_NPOS);
+}
+
+StringView sv_drop_suffix(StringView sv, u64 n)
+{
+    return n >= sv.len ? sv_substr(sv, 0, 0) : sv_substr(sv, 0, sv.len - n);
+}
+
+
+StringView sv_trim_left(StringView sv)
+{
+    u64 i = 0;
+    while (i < sv.len && is_space(sv.data[i])) {
+        i++;
+    }
+
+    return sv_drop_prefix(sv, i);
+}
+
+StringView sv_trim_right(StringView sv)
+{
+    u64 n = sv.len;
+    while (n > 0 && is_space(sv.data[n - 1])) {
+        n--;
+    }
+
+    return (StringView){ sv.data, n };
+}
+
+StringView sv_trim(StringView sv)
+{
+    return sv_trim_right(sv_trim_left(sv));
+}
+
+
+int sv_compare(StringView a, StringView b)
+{
+    u64 min_len = a.len < b.len ? a.len : b.len;
+
+    int cmp = min_len ? memcmp(a.data, b.data, min_len) : 0;
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    if (a.len < b.len) { return -1; }
+    if (a.len > b.len) { return 1; }
+
+    return 0;
+}
+
+
+b8 sv_equals(StringView a, StringView b)
+{
+    return a.len == b.len && (a.len == 0 || memcmp(a.data, b.data, a.len) == 0);
+}
+
+b8 sv_equals_cstr(StringView sv, const char* cstr)
+{
+    return sv_equals(sv, sv_from_cstr(cstr));
+}
+
+
+b8 sv_starts_with(StringView sv, StringView prefix)
+{
+    return prefix.len <= sv.len && sv_equals(sv_prefix(sv, prefix.len), prefix);
+}
+
+b8 sv_ends_with(StringView sv, StringView suffix)
+{
+    return suffix.len <= sv.len && sv_equals(sv_suffix(sv, suffix.len), suffix);
+}
+
+
+u64 sv_find_char(StringView sv, char c)
+{
+    return str_find_char(sv.data, sv.len, c);
+}
+
+
+u64 sv_find(StringView sv, StringView needle)
+{
+    return str_find(sv.data, sv.len, needle.data, needle.len);
+}
+
+
+u64 sv_count_char(StringView sv, char c)
+{
+    return str_count_char(sv.data, sv.len, c);
+}
+
+
+u64 sv_find_all(StringView sv, StringView needle, genVec* out)
+{
+    return str_find_all(sv.data, sv.len, needle.data, needle.len, out);
+}
+
+
+b8 sv_is_utf8(StringView sv)
+{
+    return utf8_valid(sv.data, sv.len);
+}
+
+
+u64 sv_utf8_len(StringView sv)
+{
+    return utf8_count(sv.data, sv.len);
+}
+
+
+sv_split_iter sv_split(StringView sv, char delim)
+{
+    return (sv_split_iter){ .rest = sv, .delims = NULL, .delim = delim, .done = 0 };
+}
+
+
+sv_split_iter sv_tokenize(StringView sv, const char* delims)
+{
+    CHECK_FATAL(!delims, "delims is null");
+
+    return (sv_split_iter){ .rest = sv, .delims = delims, .delim = 0, .done = 0 };
+}
+
+
+b8 sv_split_next(sv_split_iter* it, StringView* out)
+{
+    CHECK_FATAL(!it, "iter is null");
+    CHECK_FATAL(!out, "out is null");
+
+    if (it->done) {
+        return 0;
+    }
+
+    StringView rest = it->rest;
+
+    if (it->delims) {
+        // tokenize: skip leading delimiters, stop when nothing is left
+        u64 i = 0;
+        while (i < rest.len && is_delim(it, rest.data[i])) {
+            i++;
+        }
+        rest = sv_drop_prefix(rest, i);
+
+        if (rest.len == 0) {
+            it->done = 1;
+            return 0;
+        }
+    }
+
+    u64 end = 0;
+    if (it->delims) {
+        while (end < rest.len && !is_delim(it, rest.data[end])) {
+            end++;
+        }
+    } else {
+        end = sv_find_char(rest, it->delim);
+    }
+
+    if (end == SV_NPOS || end >= rest.len) {
+        *out     = rest; // last field
+        it->rest = sv_drop_prefix(rest, rest.len);
+        it->done = 1;
+        return 1;
+    }
+
+    *out     = sv_prefix(rest, end);
+    it->rest = sv_drop_prefix(rest, end + 1);
+    return 1;
+}
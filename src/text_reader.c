@@ -0,0 +1,289 @@
+#include "text_reader.h"
+#include "str_search.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static text_reader* reader_alloc(reader_mode mode)
+{
+    text_reader* r = calloc(1, sizeof(text_reader));
+    CHECK_FATAL(!r, "reader calloc failed");
+
+    r->mode = mode;
+    reader_set_delims(r, READER_DEFAULT_DELIMS);
+
+    return r;
+}
+
+/*
+ Keep the unread bytes, read another block after them.
+ The unread part moves to the front of buf, so views handed out
+ before are invalid after this.
+ @return 0 if nothing more could be read
+*/
+static b8 refill(text_reader* r)
+{
+    if (r->eof) {
+        return 0;
+    }
+
+    if (r->start != 0) {
+        memmove(r->buf, r->buf + r->start, r->end - r->start);
+        r->end -= r->start;
+        r->start = 0;
+    }
+
+    // one line / token fills the whole buffer
+    if (r->end == r->cap) {
+        u64   cap = r->cap * 2;
+        char* buf = realloc(r->buf, cap);
+        CHECK_FATAL(!buf, "reader buffer realloc failed");
+
+        r->buf = buf;
+        r->cap = cap;
+    }
+
+    u64 got = fread(r->buf + r->end, 1, r->cap - r->end, r->f);
+    r->end += got;
+
+    if (got == 0) {
+        CHECK_WARN(ferror(r->f), "read error");
+        r->eof = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+text_reader* reader_open(const char* path, u64 block_size)
+{
+    CHECK_FATAL(!path, "path is null");
+
+    FILE* f = fopen(path, "rb");
+    CHECK_WARN_RET(!f, NULL, "can't open file");
+
+    text_reader* r = reader_from_file(f, block_size);
+    r->owns_f      = 1;
+
+    return r;
+}
+
+
+text_reader* reader_open_mmap(const char* path)
+{
+    CHECK_FATAL(!path, "path is null");
+
+    int fd = open(path, O_RDONLY);
+    CHECK_WARN_RET(fd < 0, NULL, "can't open file");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        WARN("can't stat file");
+        return NULL;
+    }
+
+    text_reader* r = reader_alloc(READER_MMAP);
+    r->buf         = (char*)"";
+    r->eof         = 1;
+
+    // an empty file can't be mapped, it just reads as empty
+    if (st.st_size > 0) {
+        void* map = mmap(NULL, (u64)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            free(r);
+            WARN("mmap failed");
+            return NULL;
+        }
+        madvise(map, (u64)st.st_size, MADV_SEQUENTIAL);
+
+        r->buf = map;
+        r->cap = (u64)st.st_size;
+        r->end = (u64)st.st_size;
+    }
+
+    close(fd); // the mapping stays valid
+    return r;
+}
+
+
+text_reader* reader_from_file(FILE* f, u64 block_size)
+{
+    CHECK_FATAL(!f, "f is null");
+
+    if (block_size == 0) {
+        block_size = READER_BLOCK_SIZE;
+    }
+
+    text_reader* r = reader_alloc(READER_STREAM);
+
+    r->f   = f;
+    r->cap = block_size;
+    r->buf = malloc(block_size);
+    CHECK_FATAL(!r->buf, "reader buffer malloc failed");
+
+    return r;
+}
+
+
+text_reader* reader_from_view(StringView sv)
+{
+    CHECK_FATAL(!sv.data && sv.len != 0, "view data is null");
+
+    text_reader* r = reader_alloc(READER_MEMORY);
+
+    r->buf = sv.len ? (char*)sv.data : (char*)""; // never written in this mode
+    r->cap = sv.len;
+    r->end = sv.len;
+    r->eof = 1;
+
+    return r;
+}
+
+
+void reader_close(text_reader* r)
+{
+    CHECK_FATAL(!r, "reader is null");
+
+    switch (r->mode) {
+        case READER_STREAM:
+            free(r->buf);
+            if (r->owns_f) {
+                fclose(r->f);
+            }
+            break;
+        case READER_MMAP:
+            if (r->cap != 0) {
+                munmap(r->buf, r->cap);
+            }
+            break;
+        case READER_MEMORY:
+            break;
+    }
+
+    free(r);
+}
+
+
+b8 reader_next_line(text_reader* r, StringView* line)
+{
+    CHECK_FATAL(!r, "reader is null");
+    CHECK_FATAL(!line, "line is null");
+
+    u64 scanned = 0; // bytes after start known to have no '\n'
+    u64 len;
+    b8  found = 0;
+
+    while (1) {
+        const char* s     = r->buf + r->start;
+        u64         avail = r->end - r->start;
+
+        u64 i = str_find_char(s + scanned, avail - scanned, '\n');
+        if (i != STR_NPOS) {
+            len   = scanned + i;
+            found = 1;
+            break;
+        }
+
+        scanned = avail;
+        if (!refill(r)) {
+            break;
+        }
+    }
+
+    if (!found) {
+        // last line without a '\n'
+        len = r->end - r->start;
+        if (len == 0) {
+            return 0;
+        }
+    }
+
+    const char* s = r->buf + r->start;
+    r->start += len + found;
+
+    if (len != 0 && s[len - 1] == '\r') {
+        len--;
+    }
+
+    *line = (StringView){ s, len };
+    return 1;
+}
+
+
+void reader_set_delims(text_reader* r, const char* delims)
+{
+    CHECK_FATAL(!r, "reader is null");
+    CHECK_FATAL(!delims, "delims is null");
+
+    u64 k = strlen(delims);
+    CHECK_FATAL(k == 0 || k > READER_MAX_DELIMS, "need 1 to READER_MAX_DELIMS delimiters");
+
+    memcpy(r->delims, delims, k);
+    r->ndelims = (u32)k;
+
+    memset(r->is_delim, 0, sizeof(r->is_delim));
+    for (u64 j = 0; j < k; j++) {
+        r->is_delim[(u8)delims[j]] = 1;
+    }
+}
+
+
+b8 reader_next_token(text_reader* r, StringView* token)
+{
+    CHECK_FATAL(!r, "reader is null");
+    CHECK_FATAL(!token, "token is null");
+
+    // skip delimiters (runs are short, a table lookup per byte)
+    while (1) {
+        while (r->start < r->end && r->is_delim[(u8)r->buf[r->start]]) {
+            r->start++;
+        }
+        if (r->start < r->end) {
+            break;
+        }
+        if (!refill(r)) {
+            return 0;
+        }
+    }
+
+    u64 scanned = 0;
+    u64 len;
+
+    while (1) {
+        const char* s     = r->buf + r->start;
+        u64         avail = r->end - r->start;
+
+        u64 i = str_find_any(s + scanned, avail - scanned, r->delims, r->ndelims);
+        if (i != STR_NPOS) {
+            len = scanned + i;
+            break;
+        }
+
+        scanned = avail;
+        if (!refill(r)) {
+            len = r->end - r->start; // last token, ends with the input
+            break;
+        }
+    }
+
+    *token = (StringView){ r->buf + r->start, len };
+    r->start += len; // the delimiter is skipped by the next call
+
+    return 1;
+}
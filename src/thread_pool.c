@@ -0,0 +1,163 @@
+#include "thread_pool.h"
+
+#include <unistd.h>
+
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// the pool whose tasks this thread is running (nested runs go inline)
+static __thread const thread_pool* running_pool;
+
+// take tasks until the counter runs past n_tasks
+static void run_tasks(thread_pool_fn fn, void* arg, u64 n_tasks, u64* next)
+{
+    while (1) {
+        u64 i = __atomic_fetch_add(next, 1, __ATOMIC_RELAXED);
+        if (i >= n_tasks) {
+            return;
+        }
+        fn(arg, i);
+    }
+}
+
+static void* worker_main(void* p)
+{
+    thread_pool* pool = p;
+    u64          seen = 0;
+
+    running_pool = pool; // workers only ever run this pool's tasks
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (pool->generation == seen && !pool->stop) {
+            pthread_cond_wait(&pool->work_cv, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+
+        thread_pool_fn fn      = pool->fn;
+        void*          arg     = pool->arg;
+        u64            n_tasks = pool->n_tasks;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_tasks(fn, arg, n_tasks, &pool->next);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) {
+            pthread_cond_signal(&pool->done_cv);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+thread_pool* thread_pool_create(u32 n_threads)
+{
+    if (n_threads == 0) {
+        long n    = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = n < 1 ? 1 : (u32)n;
+    }
+
+    thread_pool* pool = calloc(1, sizeof(thread_pool));
+    CHECK_FATAL(!pool, "thread pool calloc failed");
+
+    pool->n_threads = n_threads;
+
+    pthread_mutex_init(&pool->run_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cv, NULL);
+    pthread_cond_init(&pool->done_cv, NULL);
+
+    if (n_threads > 1) {
+        pool->workers = malloc(sizeof(pthread_t) * (n_threads - 1));
+        CHECK_FATAL(!pool->workers, "thread pool workers malloc failed");
+
+        for (u32 t = 0; t < n_threads - 1; t++) {
+            CHECK_FATAL(pthread_create(&pool->workers[t], NULL, worker_main, pool) != 0,
+                        "thread pool pthread_create failed");
+        }
+    }
+
+    return pool;
+}
+
+
+void thread_pool_destroy(thread_pool* pool)
+{
+    CHECK_FATAL(!pool, "pool is null");
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (u32 t = 0; t + 1 < pool->n_threads; t++) {
+        pthread_join(pool->workers[t], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cv);
+    pthread_cond_destroy(&pool->work_cv);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run_lock);
+
+    free(pool->workers);
+    free(pool);
+}
+
+
+void thread_pool_run(thread_pool* pool, thread_pool_fn fn, void* arg, u64 n_tasks)
+{
+    CHECK_FATAL(!pool, "pool is null");
+    CHECK_FATAL(!fn, "fn is null");
+
+    if (n_tasks == 0) {
+        return;
+    }
+
+    // nothing to share: no wake up round trip
+    // nested in one of pool's tasks: the workers are taken, and run_lock is
+    // held by the outer run until this task returns
+    if (pool->n_threads == 1 || n_tasks == 1 || running_pool == pool) {
+        for (u64 i = 0; i < n_tasks; i++) {
+            fn(arg, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run_lock);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn      = fn;
+    pool->arg     = arg;
+    pool->n_tasks = n_tasks;
+    pool->next    = 0;
+    pool->busy    = pool->n_threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    const thread_pool* outer = running_pool;
+    running_pool             = pool;
+    run_tasks(fn, arg, n_tasks, &pool->next);
+    running_pool = outer;
+
+    // the workers may still be finishing their last task
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy != 0) {
+        pthread_cond_wait(&pool->done_cv, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->run_lock);
+}
@@ -0,0 +1,392 @@
+#include "transpose.h"
+#include "bit_vector.h"
+#include "cpu_features.h"
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+// transposes an m x n block (both <= TRANSPOSE_BLOCK)
+typedef void (*tile_fn)(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd);
+
+// in place square transpose
+typedef void (*square_fn)(u64 n, float* a, u64 lda);
+
+// large transposes, m % 16 == 0, n % tile width == 0, dst rows aligned
+typedef void (*stream_fn)(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd);
+
+typedef struct {
+    tile_fn   tile;
+    square_fn square;
+    stream_fn stream; // NULL: no streaming path
+    u64       width;  // register tile width (floats), also the dst row alignment
+} kernels;
+
+
+/*
+====================SCALAR====================
+*/
+
+static void block_scalar(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd)
+{
+    for (u64 i = 0; i < m; i++) {
+        for (u64 j = 0; j < n; j++) { dst[(j * ldd) + i] = src[(i * lds) + j]; }
+    }
+}
+
+// swap a[i][j] <-> a[j][i] for i < n, j in [max(i + 1, from), n)
+static void swap_tail(u64 n, float* a, u64 lda, u64 from)
+{
+    for (u64 i = 0; i < n; i++) {
+        for (u64 j = (i + 1 > from ? i + 1 : from); j < n; j++) {
+            float t            = a[(i * lda) + j];
+            a[(i * lda) + j]   = a[(j * lda) + i];
+            a[(j * lda) + i]   = t;
+        }
+    }
+}
+
+static void square_scalar(u64 n, float* a, u64 lda)
+{
+    swap_tail(n, a, lda, 0);
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+static inline void tile4_sse2(const float* src, u64 lds, float* dst, u64 ldd)
+{
+    __m128 r0 = _mm_loadu_ps(src);
+    __m128 r1 = _mm_loadu_ps(src + lds);
+    __m128 r2 = _mm_loadu_ps(src + (2 * lds));
+    __m128 r3 = _mm_loadu_ps(src + (3 * lds));
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + ldd, r1);
+    _mm_storeu_ps(dst + (2 * ldd), r2);
+    _mm_storeu_ps(dst + (3 * ldd), r3);
+}
+
+static void block_sse2(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd)
+{
+    u64 m4 = m & ~3ULL;
+    u64 n4 = n & ~3ULL;
+
+    for (u64 i = 0; i < m4; i += 4) {
+        for (u64 j = 0; j < n4; j += 4) {
+            tile4_sse2(src + (i * lds) + j, lds, dst + (j * ldd) + i, ldd);
+        }
+    }
+    block_scalar(m4, n - n4, src + n4, lds, dst + (n4 * ldd), ldd);
+    block_scalar(m - m4, n, src + (m4 * lds), lds, dst + m4, ldd);
+}
+
+static void square_sse2(u64 n, float* a, u64 lda)
+{
+    u64 n4 = n & ~3ULL;
+
+    for (u64 i = 0; i < n4; i += 4) {
+        float* d = a + (i * lda) + i;
+        float  t[16];
+        tile4_sse2(d, lda, t, 4);
+        for (u32 r = 0; r < 4; r++) { _mm_storeu_ps(d + (r * lda), _mm_loadu_ps(t + (r * 4))); }
+
+        for (u64 j = i + 4; j < n4; j += 4) {
+            float* x = a + (i * lda) + j; // tile (i, j)
+            float* y = a + (j * lda) + i; // tile (j, i)
+            __m128 x0 = _mm_loadu_ps(x), x1 = _mm_loadu_ps(x + lda);
+            __m128 x2 = _mm_loadu_ps(x + (2 * lda)), x3 = _mm_loadu_ps(x + (3 * lda));
+            __m128 y0 = _mm_loadu_ps(y), y1 = _mm_loadu_ps(y + lda);
+            __m128 y2 = _mm_loadu_ps(y + (2 * lda)), y3 = _mm_loadu_ps(y + (3 * lda));
+            _MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+            _MM_TRANSPOSE4_PS(y0, y1, y2, y3);
+            _mm_storeu_ps(x, y0);
+            _mm_storeu_ps(x + lda, y1);
+            _mm_storeu_ps(x + (2 * lda), y2);
+            _mm_storeu_ps(x + (3 * lda), y3);
+            _mm_storeu_ps(y, x0);
+            _mm_storeu_ps(y + lda, x1);
+            _mm_storeu_ps(y + (2 * lda), x2);
+            _mm_storeu_ps(y + (3 * lda), x3);
+        }
+    }
+    swap_tail(n, a, lda, n4);
+}
+
+
+// 16 rows at a time: every dst row gets a full 64 byte line,
+// written with non-temporal stores (no read for ownership)
+static void stream_sse2(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd)
+{
+    for (u64 i = 0; i < m; i += 16) {
+        for (u64 j = 0; j < n; j += 4) {
+            const float* s = src + (i * lds) + j;
+            float*       d = dst + (j * ldd) + i;
+
+            for (u32 q = 0; q < 16; q += 4) {
+                __m128 r0 = _mm_loadu_ps(s + (q * lds));
+                __m128 r1 = _mm_loadu_ps(s + ((q + 1) * lds));
+                __m128 r2 = _mm_loadu_ps(s + ((q + 2) * lds));
+                __m128 r3 = _mm_loadu_ps(s + ((q + 3) * lds));
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_stream_ps(d + q, r0);
+                _mm_stream_ps(d + ldd + q, r1);
+                _mm_stream_ps(d + (2 * ldd) + q, r2);
+                _mm_stream_ps(d + (3 * ldd) + q, r3);
+            }
+        }
+    }
+    _mm_sfence();
+}
+
+
+/*
+====================AVX2====================
+*/
+
+// r[0..8) = the 8 x 8 tile, transposed in registers
+__attribute__((target("avx2,fma")))
+static inline void tr8_avx2(__m256 r[8])
+{
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+    __m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+__attribute__((target("avx2,fma")))
+static inline void load8_avx2(__m256 r[8], const float* src, u64 lds)
+{
+    for (u32 k = 0; k < 8; k++) { r[k] = _mm256_loadu_ps(src + (k * lds)); }
+}
+
+__attribute__((target("avx2,fma")))
+static inline void store8_avx2(const __m256 r[8], float* dst, u64 ldd)
+{
+    for (u32 k = 0; k < 8; k++) { _mm256_storeu_ps(dst + (k * ldd), r[k]); }
+}
+
+__attribute__((target("avx2,fma")))
+static void block_avx2(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd)
+{
+    u64 m8 = m & ~7ULL;
+    u64 n8 = n & ~7ULL;
+
+    for (u64 i = 0; i < m8; i += 8) {
+        for (u64 j = 0; j < n8; j += 8) {
+            __m256 r[8];
+            load8_avx2(r, src + (i * lds) + j, lds);
+            tr8_avx2(r);
+            store8_avx2(r, dst + (j * ldd) + i, ldd);
+        }
+    }
+    block_scalar(m8, n - n8, src + n8, lds, dst + (n8 * ldd), ldd);
+    block_scalar(m - m8, n, src + (m8 * lds), lds, dst + m8, ldd);
+}
+
+__attribute__((target("avx2,fma")))
+static void square_avx2(u64 n, float* a, u64 lda)
+{
+    u64 n8 = n & ~7ULL;
+
+    for (u64 i = 0; i < n8; i += 8) {
+        __m256 d[8];
+        float* dp = a + (i * lda) + i;
+        load8_avx2(d, dp, lda);
+        tr8_avx2(d);
+        store8_avx2(d, dp, lda);
+
+        for (u64 j = i + 8; j < n8; j += 8) {
+            float* xp = a + (i * lda) + j; // tile (i, j)
+            float* yp = a + (j * lda) + i; // tile (j, i)
+            __m256 x[8], y[8];
+            load8_avx2(x, xp, lda);
+            load8_avx2(y, yp, lda);
+            tr8_avx2(x);
+            tr8_avx2(y);
+            store8_avx2(y, xp, lda);
+            store8_avx2(x, yp, lda);
+        }
+    }
+    swap_tail(n, a, lda, n8);
+}
+
+// two 8 x 8 tiles on top of each other: 8 full 64 byte dst lines
+__attribute__((target("avx2,fma")))
+static void stream_avx2(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd)
+{
+    for (u64 i = 0; i < m; i += 16) {
+        for (u64 j = 0; j < n; j += 8) {
+            __m256 hi[8], lo[8];
+            load8_avx2(hi, src + (i * lds) + j, lds);
+            load8_avx2(lo, src + ((i + 8) * lds) + j, lds);
+            tr8_avx2(hi);
+            tr8_avx2(lo);
+
+            float* d = dst + (j * ldd) + i;
+            for (u32 k = 0; k < 8; k++) {
+                _mm256_stream_ps(d + (k * ldd), hi[k]);
+                _mm256_stream_ps(d + (k * ldd) + 8, lo[k]);
+            }
+        }
+    }
+    _mm_sfence();
+}
+
+#endif // CPU_X86
+
+
+/*
+====================DISPATCH====================
+*/
+
+static kernels pick(void)
+{
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return (kernels){ block_avx2, square_avx2, stream_avx2, 8 };
+        case CPU_SSE2: return (kernels){ block_sse2, square_sse2, stream_sse2, 4 };
+        default:       break;
+    }
+#endif
+
+    return (kernels){ block_scalar, square_scalar, NULL, 1 };
+}
+
+// halve the larger side (on a multiple of 8) until the block fits
+static void transpose_rec(tile_fn tile, u64 m, u64 n, const float* src, u64 lds, float* dst,
+                          u64 ldd)
+{
+    if (m <= TRANSPOSE_BLOCK && n <= TRANSPOSE_BLOCK) {
+        tile(m, n, src, lds, dst, ldd);
+        return;
+    }
+
+    if (m >= n) {
+        u64 h = m / 2 >= 8 ? (m / 2) & ~7ULL : m / 2;
+        transpose_rec(tile, h, n, src, lds, dst, ldd);
+        transpose_rec(tile, m - h, n, src + (h * lds), lds, dst + h, ldd);
+    } else {
+        u64 h = n / 2 >= 8 ? (n / 2) & ~7ULL : n / 2;
+        transpose_rec(tile, m, h, src, lds, dst, ldd);
+        transpose_rec(tile, m, n - h, src + h, lds, dst + (h * ldd), ldd);
+    }
+}
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+void transpose_f32(u64 m, u64 n, const float* src, u64 lds, float* dst, u64 ldd)
+{
+    if (m == 0 || n == 0) {
+        return;
+    }
+    CHECK_FATAL(!src || !dst, "src or dst is null");
+    CHECK_FATAL(lds < n || ldd < m, "leading dimension too small");
+
+    kernels k = pick();
+
+    // rows skipped so dst rows start on a 64 byte line
+    u64 head = ((64 - ((uintptr_t)dst % 64)) % 64) / sizeof(float);
+
+    if (!k.stream || m * n < TRANSPOSE_STREAM_MIN || ldd % k.width != 0 ||
+        (uintptr_t)dst % sizeof(float) != 0 || head >= m) {
+        transpose_rec(k.tile, m, n, src, lds, dst, ldd);
+        return;
+    }
+
+    // past the caches, write whole dst lines around the cache instead:
+    // half lines from the 8 x 8 tiles are read for ownership twice
+    u64 rows = (m - head) & ~15ULL;
+    u64 cols = n & ~(k.width - 1);
+
+    transpose_rec(k.tile, head, n, src, lds, dst, ldd);
+    k.stream(rows, cols, src + (head * lds), lds, dst + head, ldd);
+    transpose_rec(k.tile, rows, n - cols, src + (head * lds) + cols, lds,
+                  dst + (cols * ldd) + head, ldd);
+    transpose_rec(k.tile, m - head - rows, n, src + ((head + rows) * lds), lds,
+                  dst + head + rows, ldd);
+}
+
+
+void transpose_square_f32(u64 n, float* a, u64 lda)
+{
+    if (n == 0) {
+        return;
+    }
+    CHECK_FATAL(!a, "a is null");
+    CHECK_FATAL(lda < n, "leading dimension too small");
+
+    pick().square(n, a, lda);
+}
+
+
+void transpose_inplace_f32(u64 m, u64 n, float* a)
+{
+    if (m <= 1 || n <= 1) { // a row or a column: same data
+        return;
+    }
+    CHECK_FATAL(!a, "a is null");
+
+    if (m == n) {
+        transpose_square_f32(n, a, n);
+        return;
+    }
+
+    // element idx (= i * n + j) moves to j * m + i = idx * m mod (m * n - 1)
+    // 0 and m * n - 1 stay put
+    const u64 last = (m * n) - 1;
+
+    bitVec* moved = bitVec_create();
+    bitVec_set(moved, last); // sizes the vector, all other bits 0
+
+    for (u64 start = 1; start < last; start++) {
+        if (bitVec_test(moved, start)) {
+            continue;
+        }
+
+        // carry the value along the cycle until it comes back to start
+        float carry = a[start];
+        u64   idx   = start;
+        do {
+            u64   next = (u64)(((unsigned __int128)idx * m) % last);
+            float t    = a[next];
+            a[next]    = carry;
+            carry      = t;
+            bitVec_set(moved, next);
+            idx = next;
+        } while (idx != start);
+    }
+
+    bitVec_destroy(moved);
+}
@@ -0,0 +1,457 @@
+#include "utf8.h"
+#include "cpu_features.h"
+
+#include <string.h>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+/*
+====================SCALAR====================
+*/
+
+static inline b8 is_cont(u8 c)
+{
+    return (c & 0xC0) == 0x80;
+}
+
+// length of the valid sequence at s[i], 0 if it is invalid
+static inline u32 valid_char(const u8* s, u64 n, u64 i)
+{
+    u8 c = s[i];
+    if (c < 0x80) {
+        return 1;
+    }
+
+    u32 len;
+    u8  lo = 0x80; // allowed range of the second byte
+    u8  hi = 0xBF;
+
+    if (c >= 0xC2 && c <= 0xDF) {
+        len = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        len = 3;
+        if (c == 0xE0) { lo = 0xA0; } // overlong
+        if (c == 0xED) { hi = 0x9F; } // surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        len = 4;
+        if (c == 0xF0) { lo = 0x90; } // overlong
+        if (c == 0xF4) { hi = 0x8F; } // > U+10FFFF
+    } else {
+        return 0;
+    }
+
+    if (i + len > n || s[i + 1] < lo || s[i + 1] > hi) {
+        return 0;
+    }
+    for (u32 k = 2; k < len; k++) {
+        if (!is_cont(s[i + k])) {
+            return 0;
+        }
+    }
+
+    return len;
+}
+
+static u64 valid_prefix_scalar(const u8* s, u64 n, u64 i)
+{
+    while (i < n) {
+        // 8 ASCII bytes at a time
+        if (i + 8 <= n) {
+            u64 v;
+            memcpy(&v, s + i, 8);
+            if ((v & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+
+        u32 len = valid_char(s, n, i);
+        if (len == 0) {
+            return i;
+        }
+        i += len;
+    }
+
+    return n;
+}
+
+static u64 count_scalar(const u8* s, u64 n)
+{
+    u64 count = 0;
+    for (u64 i = 0; i < n; i++) {
+        count += !is_cont(s[i]);
+    }
+    return count;
+}
+
+// start of the code point that covers s[i - 1] (i itself if that one
+// ended before i); everything before it was already validated
+static inline u64 char_start_before(const u8* s, u64 i)
+{
+    for (u64 k = 1; k <= 3 && k <= i; k++) {
+        if (!is_cont(s[i - k])) {
+            return i - k;
+        }
+    }
+    return i;
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2====================
+*/
+
+__attribute__((target("sse2")))
+static u64 valid_prefix_sse2(const u8* s, u64 n)
+{
+    u64 i = 0;
+
+    while (i < n) {
+        while (i + 16 <= n &&
+               _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(s + i))) == 0) {
+            i += 16;
+        }
+        if (i >= n) {
+            break;
+        }
+
+        u32 len = valid_char(s, n, i);
+        if (len == 0) {
+            return i;
+        }
+        i += len;
+    }
+
+    return n;
+}
+
+// non-continuation bytes: compare masks (-1) are subtracted into byte
+// counters, summed with psadbw before they can wrap (255 steps)
+__attribute__((target("sse2")))
+static u64 count_sse2(const u8* s, u64 n)
+{
+    const __m128i lim   = _mm_set1_epi8(-65); // continuation bytes are -128..-65
+    u64           count = 0;
+    u64           i     = 0;
+
+    while (i + 16 <= n) {
+        __m128i acc   = _mm_setzero_si128();
+        u64     steps = (n - i) / 16 < 255 ? (n - i) / 16 : 255;
+
+        for (u64 k = 0; k < steps; k++, i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+            acc       = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, lim));
+        }
+
+        __m128i sum = _mm_sad_epu8(acc, _mm_setzero_si128());
+        count += (u64)_mm_cvtsi128_si64(sum) + (u64)_mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum));
+    }
+
+    return count + count_scalar(s + i, n - i);
+}
+
+
+/*
+====================AVX2====================
+*/
+
+// error bits of the lookup tables: which bad pair a byte pair can be
+#define TOO_SHORT   (1 << 0) // lead or ASCII followed by a lead or ASCII
+#define TOO_LONG    (1 << 1) // ASCII followed by a continuation
+#define OVERLONG_3  (1 << 2) // E0 80..9F
+#define TOO_LARGE   (1 << 3) // F4 90.., F5..FF
+#define SURROGATE   (1 << 4) // ED A0..BF
+#define OVERLONG_2  (1 << 5) // C0, C1
+#define TOO_LG_1000 (1 << 6) // F5.. 80..8F
+#define OVERLONG_4  (1 << 6) // F0 80..8F
+#define TWO_CONTS   (1 << 7) // continuation followed by continuation (checked below)
+#define CARRY       (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// the same 16 byte table in both lanes
+#define LOOKUP16(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p)                                 \
+    _mm256_setr_epi8(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, a, b, c, d, e, f, g, h, i, j, \
+                     k, l, m, n, o, p)
+
+// input shifted right by k bytes, the first k bytes come from the end of prev
+#define PREV(input, prev, k) \
+    _mm256_alignr_epi8((input), _mm256_permute2x128_si256((prev), (input), 0x21), 16 - (k))
+
+__attribute__((target("avx2")))
+static inline __m256i nibble_hi(__m256i v)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+// nonzero bytes where a 2 byte pair (prev1, input) is bad
+__attribute__((target("avx2")))
+static inline __m256i check_special_cases(__m256i input, __m256i prev1)
+{
+    const __m256i byte_1_high_tbl = LOOKUP16(
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, // 0___
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                    // 10__
+        TOO_SHORT | OVERLONG_2,                                                        // 1100
+        TOO_SHORT,                                                                     // 1101
+        TOO_SHORT | OVERLONG_3 | SURROGATE,                                            // 1110
+        TOO_SHORT | TOO_LARGE | TOO_LG_1000 | OVERLONG_4);                             // 1111
+
+    const __m256i byte_1_low_tbl = LOOKUP16(
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, // ____0000
+        CARRY | OVERLONG_2,                           // ____0001
+        CARRY, CARRY,                                 // ____001_
+        CARRY | TOO_LARGE,                            // ____0100
+        CARRY | TOO_LARGE | TOO_LG_1000,              // ____0101
+        CARRY | TOO_LARGE | TOO_LG_1000, CARRY | TOO_LARGE | TOO_LG_1000,
+        CARRY | TOO_LARGE | TOO_LG_1000, CARRY | TOO_LARGE | TOO_LG_1000, // ____1___
+        CARRY | TOO_LARGE | TOO_LG_1000, CARRY | TOO_LARGE | TOO_LG_1000,
+        CARRY | TOO_LARGE | TOO_LG_1000,
+        CARRY | TOO_LARGE | TOO_LG_1000 | SURROGATE, // ____1101
+        CARRY | TOO_LARGE | TOO_LG_1000, CARRY | TOO_LARGE | TOO_LG_1000);
+
+    const __m256i byte_2_high_tbl = LOOKUP16(
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT,                                                                    // 0___
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LG_1000 | OVERLONG_4,  // 1000
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                 // 1001
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                  // 101_
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT); // 11__
+
+    __m256i b1h = _mm256_shuffle_epi8(byte_1_high_tbl, nibble_hi(prev1));
+    __m256i b1l = _mm256_shuffle_epi8(byte_1_low_tbl, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+    __m256i b2h = _mm256_shuffle_epi8(byte_2_high_tbl, nibble_hi(input));
+
+    return _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+}
+
+// 3rd / 4th bytes must be continuations, and only they may be
+// (the TWO_CONTS bit is set exactly where that holds)
+__attribute__((target("avx2")))
+static inline __m256i check_multibyte_lengths(__m256i input, __m256i prev, __m256i sc)
+{
+    __m256i prev2 = PREV(input, prev, 2);
+    __m256i prev3 = PREV(input, prev, 3);
+
+    __m256i third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 1))); // 111_____
+    __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 1))); // 1111____
+
+    // all values are <= 0x20, signed compare is fine
+    __m256i must23 = _mm256_cmpgt_epi8(_mm256_or_si256(third, fourth), _mm256_setzero_si256());
+
+    return _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8((char)0x80)), sc);
+}
+
+// nonzero if the block ends inside a sequence
+__attribute__((target("avx2")))
+static inline __m256i is_incomplete(__m256i input)
+{
+    const __m256i max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+
+    return _mm256_subs_epu8(input, max);
+}
+
+// errors of one 32 byte block that follows prev
+__attribute__((target("avx2")))
+static inline __m256i check_block(__m256i input, __m256i prev)
+{
+    __m256i sc = check_special_cases(input, PREV(input, prev, 1));
+    return check_multibyte_lengths(input, prev, sc);
+}
+
+__attribute__((target("avx2")))
+static u64 valid_prefix_avx2(const u8* s, u64 n)
+{
+    __m256i prev_input      = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    u64     i               = 0;
+
+    // 64 bytes per step: one ASCII test and one error test for both blocks
+    for (; i + 64 <= n; i += 64) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(s + i + 32));
+        __m256i error;
+
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+            // ASCII, only a sequence cut at the previous block is bad
+            error           = prev_incomplete;
+            prev_incomplete = _mm256_setzero_si256();
+        } else {
+            error           = _mm256_or_si256(check_block(a, prev_input), check_block(b, a));
+            prev_incomplete = is_incomplete(b);
+        }
+
+        if (!_mm256_testz_si256(error, error)) {
+            // find the exact offset from the last known boundary
+            return valid_prefix_scalar(s, n, char_start_before(s, i));
+        }
+
+        prev_input = b;
+    }
+
+    // tail (and a sequence cut at the last block)
+    return valid_prefix_scalar(s, n, char_start_before(s, i));
+}
+
+__attribute__((target("avx2")))
+static u64 count_avx2(const u8* s, u64 n)
+{
+    const __m256i lim   = _mm256_set1_epi8(-65);
+    u64           count = 0;
+    u64           i     = 0;
+
+    while (i + 64 <= n) {
+        __m256i acc   = _mm256_setzero_si256();
+        u64     steps = (n - i) / 64 < 127 ? (n - i) / 64 : 127; // 2 per step
+
+        for (u64 k = 0; k < steps; k++, i += 64) {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(s + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(s + i + 32));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(a, lim));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(b, lim));
+        }
+
+        __m256i sum = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+        count += (u64)_mm256_extract_epi64(sum, 0) + (u64)_mm256_extract_epi64(sum, 1) +
+                 (u64)_mm256_extract_epi64(sum, 2) + (u64)_mm256_extract_epi64(sum, 3);
+    }
+
+    return count + count_sse2(s + i, n - i);
+}
+
+#endif // CPU_X86
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+u64 utf8_valid_prefix(const char* s, u64 n)
+{
+    if (n == 0) {
+        return 0;
+    }
+    CHECK_FATAL(!s, "s is null");
+
+    const u8* p = (const u8*)s;
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return valid_prefix_avx2(p, n);
+        case CPU_SSE2: return valid_prefix_sse2(p, n);
+        default:       break;
+    }
+#endif
+
+    return valid_prefix_scalar(p, n, 0);
+}
+
+
+b8 utf8_valid(const char* s, u64 n)
+{
+    return utf8_valid_prefix(s, n) == n;
+}
+
+
+u64 utf8_count(const char* s, u64 n)
+{
+    if (n == 0) {
+        return 0;
+    }
+    CHECK_FATAL(!s, "s is null");
+
+    const u8* p = (const u8*)s;
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return count_avx2(p, n);
+        case CPU_SSE2: return count_sse2(p, n);
+        default:       break;
+    }
+#endif
+
+    return count_scalar(p, n);
+}
+
+
+u32 utf8_decode(const char* s, u64 n, u32* cp)
+{
+    CHECK_FATAL(!cp, "cp is null");
+
+    if (n == 0) {
+        return 0;
+    }
+    CHECK_FATAL(!s, "s is null");
+
+    const u8* p   = (const u8*)s;
+    u32       len = valid_char(p, n, 0);
+
+    switch (len) {
+        case 1:  *cp = p[0]; break;
+        case 2:  *cp = ((u32)(p[0] & 0x1F) << 6) | (p[1] & 0x3F); break;
+        case 3:  *cp = ((u32)(p[0] & 0x0F) << 12) | ((u32)(p[1] & 0x3F) << 6) | (p[2] & 0x3F); break;
+        case 4:
+            *cp = ((u32)(p[0] & 0x07) << 18) | ((u32)(p[1] & 0x3F) << 12) |
+                  ((u32)(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+            break;
+        default:
+            *cp = UTF8_REPLACEMENT;
+            len = 1;
+            break;
+    }
+
+    return len;
+}
+
+
+u32 utf8_encode(u32 cp, char* out)
+{
+    CHECK_FATAL(!out, "out is null");
+
+    if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        cp = UTF8_REPLACEMENT;
+    }
+
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+
+b8 utf8_iter_next(utf8_iter* it, u32* cp)
+{
+    CHECK_FATAL(!it, "it is null");
+
+    if (it->pos >= it->sv.len) {
+        return 0;
+    }
+
+    it->offset = it->pos;
+    it->pos += utf8_decode(it->sv.data + it->pos, it->sv.len - it->pos, cp);
+
+    return 1;
+}
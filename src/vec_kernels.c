@@ -0,0 +1,291 @@
+#include "vec_f32.h"
+#include "vec_f64.h"
+#include "cpu_features.h"
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+
+
+/*
+ vec_f32.h and vec_f64.h from one body, for element type T with suffix S
+ (f32 / f64):
+
+   VEC_SCALAR(T, S)                       the portable loops
+   VEC_ISA(T, S, P, V, W, ISA, FMA)       SSE2 (W empty) or AVX2 (W = 256)
+   VEC_IMPL(T, S)                         the public vec_S_* with dispatch
+
+ P is the intrinsic suffix (ps / pd), V the vector type and FMA the scalar
+ fma for the AVX2 tail. Each SIMD loop does 4 vectors per iteration, then
+ one, then a scalar tail; a vector holds VEC_LANES(T, W) elements.
+*/
+
+
+/*
+====================SCALAR====================
+*/
+
+#define VEC_SCALAR(T, S)                                                          \
+    static void add_##S##_scalar(T* out, const T* a, const T* b, u64 n)           \
+    {                                                                             \
+        for (u64 i = 0; i < n; i++) { out[i] = a[i] + b[i]; }                     \
+    }                                                                             \
+                                                                                  \
+    static void sub_##S##_scalar(T* out, const T* a, const T* b, u64 n)           \
+    {                                                                             \
+        for (u64 i = 0; i < n; i++) { out[i] = a[i] - b[i]; }                     \
+    }                                                                             \
+                                                                                  \
+    static void scale_##S##_scalar(T* out, const T* x, T s, u64 n)                \
+    {                                                                             \
+        for (u64 i = 0; i < n; i++) { out[i] = s * x[i]; }                        \
+    }                                                                             \
+                                                                                  \
+    static void axpy_##S##_scalar(T* out, T alpha, const T* x, const T* y, u64 n) \
+    {                                                                             \
+        for (u64 i = 0; i < n; i++) { out[i] = (alpha * x[i]) + y[i]; }           \
+    }
+
+VEC_SCALAR(float, f32)
+VEC_SCALAR(double, f64)
+
+static double dot_f64_scalar(const float* x, const float* y, u64 n)
+{
+    double sum = 0;
+    for (u64 i = 0; i < n; i++) { sum += (double)x[i] * y[i]; }
+    return sum;
+}
+
+
+#if CPU_X86
+
+/*
+====================SSE2 / AVX2====================
+*/
+
+#define VEC_BYTES_       16
+#define VEC_BYTES_256    32
+#define VEC_LANES(T, W)  (VEC_BYTES_##W / sizeof(T))
+
+#define VEC_ATTR_
+#define VEC_ATTR_256     __attribute__((target("avx2,fma")))
+
+// _mm(W)_op_P: VEC_OP(256, add, ps) is _mm256_add_ps
+#define VEC_OP(W, op, P) _mm##W##_##op##_##P
+
+// alpha * x + y: mul + add without FMA (SSE2), one rounding with it (AVX2)
+#define VEC_MADD_(P, a, x, y)         _mm_add_##P(_mm_mul_##P(a, x), y)
+#define VEC_MADD_256(P, a, x, y)      _mm256_fmadd_##P(a, x, y)
+#define VEC_MADD1_(FMA, a, x, y)      (((a) * (x)) + (y))
+#define VEC_MADD1_256(FMA, a, x, y)   FMA(a, x, y)
+
+// out = a OP b
+#define VEC_BINARY(T, S, P, V, W, ISA, name, op)                                           \
+    VEC_ATTR_##W static void name##_##S##_##ISA(T* out, const T* a, const T* b, u64 n)     \
+    {                                                                                      \
+        const u64 L = VEC_LANES(T, W);                                                     \
+                                                                                           \
+        u64 i = 0;                                                                         \
+        for (; i + (4 * L) <= n; i += 4 * L) {                                             \
+            V r0 = VEC_OP(W, name, P)(VEC_OP(W, loadu, P)(a + i),                          \
+                                      VEC_OP(W, loadu, P)(b + i));                         \
+            V r1 = VEC_OP(W, name, P)(VEC_OP(W, loadu, P)(a + i + L),                      \
+                                      VEC_OP(W, loadu, P)(b + i + L));                     \
+            V r2 = VEC_OP(W, name, P)(VEC_OP(W, loadu, P)(a + i + (2 * L)),                \
+                                      VEC_OP(W, loadu, P)(b + i + (2 * L)));               \
+            V r3 = VEC_OP(W, name, P)(VEC_OP(W, loadu, P)(a + i + (3 * L)),                \
+                                      VEC_OP(W, loadu, P)(b + i + (3 * L)));               \
+            VEC_OP(W, storeu, P)(out + i, r0);                                             \
+            VEC_OP(W, storeu, P)(out + i + L, r1);                                         \
+            VEC_OP(W, storeu, P)(out + i + (2 * L), r2);                                   \
+            VEC_OP(W, storeu, P)(out + i + (3 * L), r3);                                   \
+        }                                                                                  \
+        for (; i + L <= n; i += L) {                                                       \
+            VEC_OP(W, storeu, P)(out + i, VEC_OP(W, name, P)(VEC_OP(W, loadu, P)(a + i),   \
+                                                             VEC_OP(W, loadu, P)(b + i))); \
+        }                                                                                  \
+        for (; i < n; i++) { out[i] = a[i] op b[i]; }                                      \
+    }
+
+// add, sub, scale and axpy for one instruction set
+#define VEC_ISA(T, S, P, V, W, ISA, FMA)                                                      \
+    VEC_BINARY(T, S, P, V, W, ISA, add, +)                                                    \
+    VEC_BINARY(T, S, P, V, W, ISA, sub, -)                                                    \
+                                                                                              \
+    VEC_ATTR_##W static void scale_##S##_##ISA(T* out, const T* x, T s, u64 n)                \
+    {                                                                                         \
+        const u64 L  = VEC_LANES(T, W);                                                       \
+        const V   vs = VEC_OP(W, set1, P)(s);                                                 \
+                                                                                              \
+        u64 i = 0;                                                                            \
+        for (; i + (4 * L) <= n; i += 4 * L) {                                                \
+            V r0 = VEC_OP(W, mul, P)(vs, VEC_OP(W, loadu, P)(x + i));                         \
+            V r1 = VEC_OP(W, mul, P)(vs, VEC_OP(W, loadu, P)(x + i + L));                     \
+            V r2 = VEC_OP(W, mul, P)(vs, VEC_OP(W, loadu, P)(x + i + (2 * L)));               \
+            V r3 = VEC_OP(W, mul, P)(vs, VEC_OP(W, loadu, P)(x + i + (3 * L)));               \
+            VEC_OP(W, storeu, P)(out + i, r0);                                                \
+            VEC_OP(W, storeu, P)(out + i + L, r1);                                            \
+            VEC_OP(W, storeu, P)(out + i + (2 * L), r2);                                      \
+            VEC_OP(W, storeu, P)(out + i + (3 * L), r3);                                      \
+        }                                                                                     \
+        for (; i + L <= n; i += L) {                                                          \
+            VEC_OP(W, storeu, P)(out + i, VEC_OP(W, mul, P)(vs, VEC_OP(W, loadu, P)(x + i))); \
+        }                                                                                     \
+        for (; i < n; i++) { out[i] = s * x[i]; }                                             \
+    }                                                                                         \
+                                                                                              \
+    VEC_ATTR_##W static void axpy_##S##_##ISA(T* out, T alpha, const T* x, const T* y,        \
+                                              u64 n)                                          \
+    {                                                                                         \
+        const u64 L  = VEC_LANES(T, W);                                                       \
+        const V   va = VEC_OP(W, set1, P)(alpha);                                             \
+                                                                                              \
+        u64 i = 0;                                                                            \
+        for (; i + (4 * L) <= n; i += 4 * L) {                                                \
+            V r0 = VEC_MADD_##W(P, va, VEC_OP(W, loadu, P)(x + i),                            \
+                                VEC_OP(W, loadu, P)(y + i));                                  \
+            V r1 = VEC_MADD_##W(P, va, VEC_OP(W, loadu, P)(x + i + L),                        \
+                                VEC_OP(W, loadu, P)(y + i + L));                              \
+            V r2 = VEC_MADD_##W(P, va, VEC_OP(W, loadu, P)(x + i + (2 * L)),                  \
+                                VEC_OP(W, loadu, P)(y + i + (2 * L)));                        \
+            V r3 = VEC_MADD_##W(P, va, VEC_OP(W, loadu, P)(x + i + (3 * L)),                  \
+                                VEC_OP(W, loadu, P)(y + i + (3 * L)));                        \
+            VEC_OP(W, storeu, P)(out + i, r0);                                                \
+            VEC_OP(W, storeu, P)(out + i + L, r1);                                            \
+            VEC_OP(W, storeu, P)(out + i + (2 * L), r2);                                      \
+            VEC_OP(W, storeu, P)(out + i + (3 * L), r3);                                      \
+        }                                                                                     \
+        for (; i + L <= n; i += L) {                                                          \
+            VEC_OP(W, storeu, P)(out + i, VEC_MADD_##W(P, va, VEC_OP(W, loadu, P)(x + i),     \
+                                                       VEC_OP(W, loadu, P)(y + i)));          \
+        }                                                                                     \
+        for (; i < n; i++) { out[i] = VEC_MADD1_##W(FMA, alpha, x[i], y[i]); }                \
+    }
+
+VEC_ISA(float, f32, ps, __m128, , sse2, __builtin_fmaf)
+VEC_ISA(float, f32, ps, __m256, 256, avx2, __builtin_fmaf)
+VEC_ISA(double, f64, pd, __m128d, , sse2, __builtin_fma)
+VEC_ISA(double, f64, pd, __m256d, 256, avx2, __builtin_fma)
+
+
+static double dot_f64_sse2(const float* x, const float* y, u64 n)
+{
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    __m128d s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+
+// 4 floats of x and y widened into two double pairs
+#define DOT4(o, lo, hi)                                                       \
+    do {                                                                      \
+        __m128 xv = _mm_loadu_ps(x + i + (o));                                \
+        __m128 yv = _mm_loadu_ps(y + i + (o));                                \
+        lo = _mm_add_pd(lo, _mm_mul_pd(_mm_cvtps_pd(xv), _mm_cvtps_pd(yv)));  \
+        hi = _mm_add_pd(hi, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(xv, xv)),   \
+                                       _mm_cvtps_pd(_mm_movehl_ps(yv, yv)))); \
+    } while (0)
+    u64 i = 0;
+    for (; i + 8 <= n; i += 8) {
+        DOT4(0, s0, s1);
+        DOT4(4, s2, s3);
+    }
+    for (; i + 4 <= n; i += 4) { DOT4(0, s0, s1); }
+#undef DOT4
+
+    __m128d s = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+    double  sum = _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    for (; i < n; i++) { sum += (double)x[i] * y[i]; }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_f64_avx2(const float* x, const float* y, u64 n)
+{
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+
+#define DOT4(o, acc)                                                  \
+    acc = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x + i + (o))), \
+                          _mm256_cvtps_pd(_mm_loadu_ps(y + i + (o))), acc)
+    u64 i = 0;
+    for (; i + 16 <= n; i += 16) {
+        DOT4(0, s0);
+        DOT4(4, s1);
+        DOT4(8, s2);
+        DOT4(12, s3);
+    }
+    for (; i + 4 <= n; i += 4) { DOT4(0, s0); }
+#undef DOT4
+
+    __m256d s   = _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3));
+    __m128d h   = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    double  sum = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    for (; i < n; i++) { sum += (double)x[i] * y[i]; }
+    return sum;
+}
+
+#endif // CPU_X86
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+#if CPU_X86
+// call fn_avx2 / fn_sse2 (args) and return if the CPU has them
+#define VEC_DISPATCH(fn, ...)                          \
+    switch (cpu_simd_level()) {                        \
+        case CPU_AVX2: fn##_avx2(__VA_ARGS__); return; \
+        case CPU_SSE2: fn##_sse2(__VA_ARGS__); return; \
+        default:       break;                          \
+    }
+#else
+#define VEC_DISPATCH(fn, ...)
+#endif
+
+#define VEC_IMPL(T, S)                                                    \
+    void vec_##S##_add(T* out, const T* a, const T* b, u64 n)             \
+    {                                                                     \
+        CHECK_FATAL((!out || !a || !b) && n != 0, "out, a or b is null"); \
+        VEC_DISPATCH(add_##S, out, a, b, n)                               \
+        add_##S##_scalar(out, a, b, n);                                   \
+    }                                                                     \
+                                                                          \
+    void vec_##S##_sub(T* out, const T* a, const T* b, u64 n)             \
+    {                                                                     \
+        CHECK_FATAL((!out || !a || !b) && n != 0, "out, a or b is null"); \
+        VEC_DISPATCH(sub_##S, out, a, b, n)                               \
+        sub_##S##_scalar(out, a, b, n);                                   \
+    }                                                                     \
+                                                                          \
+    void vec_##S##_scale(T* out, const T* x, T s, u64 n)                  \
+    {                                                                     \
+        CHECK_FATAL((!out || !x) && n != 0, "out or x is null");          \
+        VEC_DISPATCH(scale_##S, out, x, s, n)                             \
+        scale_##S##_scalar(out, x, s, n);                                 \
+    }                                                                     \
+                                                                          \
+    void vec_##S##_axpy(T* out, T alpha, const T* x, const T* y, u64 n)   \
+    {                                                                     \
+        CHECK_FATAL((!out || !x || !y) && n != 0, "out, x or y is null"); \
+        VEC_DISPATCH(axpy_##S, out, alpha, x, y, n)                       \
+        axpy_##S##_scalar(out, alpha, x, y, n);                           \
+    }
+
+VEC_IMPL(float, f32)
+VEC_IMPL(double, f64)
+
+
+double vec_f32_dot_f64(const float* x, const float* y, u64 n)
+{
+    CHECK_FATAL((!x || !y) && n != 0, "x or y is null");
+
+#if CPU_X86
+    switch (cpu_simd_level()) {
+        case CPU_AVX2: return dot_f64_avx2(x, y, n);
+        case CPU_SSE2: return dot_f64_sse2(x, y, n);
+        default:       break;
+    }
+#endif
+
+    return dot_f64_scalar(x, y, n);
+}
@@ -238,3 +238,95 @@ int hashmap_test_5(void)
     return 0;
 }
 
+
+
+// iterate, then export keys / vals (String keys are deep copied into the vec)
+int hashmap_test_6(void)
+{
+    hashmap* map = hashmap_create(sizeof(String), sizeof(int), murmurhash3_str, str_cmp,
+                                  str_copy, NULL, str_move, NULL, str_del, NULL);
+
+    const char* words[] = { "alpha", "beta", "gamma", "delta", "epsilon" };
+    String str;
+    for (int i = 0; i < 5; i++) {
+        string_create_stk(&str, words[i]);
+        hashmap_put(map, cast(str), cast(i));
+        string_destroy_stk(&str);
+    }
+
+    string_create_stk(&str, "beta");
+    hashmap_del(map, cast(str), NULL); // leaves a tombstone
+    string_destroy_stk(&str);
+
+    int       sum   = 0;
+    u64       count = 0;
+    const u8* k     = NULL;
+    u8*       v     = NULL;
+
+    hashmap_iter it = hashmap_iter_begin(map);
+    while (hashmap_iter_next(&it, &k, &v)) {
+        str_print(k);
+        printf(" => %d\n", *(int*)v);
+        *(int*)v *= 10; // in place
+        sum += *(int*)v;
+        count++;
+    }
+    printf("count: %lu, sum: %d\n", count, sum); // 4, 90
+
+    genVec* keys = genVec_init(0, sizeof(String), str_copy, str_move, str_del);
+    genVec* vals = genVec_init(0, sizeof(int), NULL, NULL, NULL);
+
+    hashmap_keys(map, keys);
+    hashmap_values(map, vals);
+
+    genVec_print(keys, str_print);
+    genVec_print(vals, int_print);
+
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+    hashmap_destroy(map);
+    return 0;
+}
+
+
+// heterogeneous lookup: String keys found / inserted through a StringView
+int hashmap_test_7(void)
+{
+    hashmap* map = hashmap_create(sizeof(String), sizeof(int), murmurhash3_str, str_cmp,
+                                  str_copy, NULL, str_move, NULL, str_del, NULL);
+
+    const char* text = "the cat and the dog and the bird";
+    const char* p    = text;
+
+    while (*p) {
+        const char* start = p;
+        while (*p && *p != ' ') { p++; }
+
+        StringView word = { start, (u64)(p - start) };
+        b8 inserted = 0;
+        int* count = (int*)hashmap_find_or_insert(map, murmurhash3_view(word), &word,
+                                                  str_view_eq, str_view_make, &inserted);
+        (*count)++;
+
+        if (*p) { p++; }
+    }
+
+    hashmap_print(map, str_print, int_print); // the 3, and 2, cat/dog/bird 1
+
+    // same hash as murmurhash3_str: normal lookups agree
+    String the;
+    string_create_stk(&the, "the");
+    int c = 0;
+    hashmap_get(map, cast(the), cast(c));
+    string_destroy_stk(&the);
+
+    StringView q = { "and", 3 };
+    const int* and_c = (const int*)hashmap_get_hashed(map, murmurhash3_view(q), &q, str_view_eq);
+    StringView m = { "fish", 4 };
+    const u8* none = hashmap_get_hashed(map, murmurhash3_view(m), &m, str_view_eq);
+
+    printf("the: %d, and: %d, fish: %s\n", c, and_c ? *and_c : -1, none ? "found" : "missing");
+
+    hashmap_destroy(map);
+    return 0;
+}
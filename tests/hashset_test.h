@@ -59,3 +59,30 @@ int hashset_test_2(void)
 }
 
 
+
+int hashset_test_3(void)
+{
+    hashset* set = hashset_create(sizeof(int), NULL, NULL, NULL, NULL, NULL);
+
+    for (int i = 0; i < 100; i++) {
+        hashset_insert(set, cast(i));
+    }
+    for (int i = 0; i < 100; i += 2) {
+        hashset_remove(set, cast(i));
+    }
+
+    u64       count = 0;
+    long      sum   = 0;
+    const u8* e     = NULL;
+
+    hashset_iter it = hashset_iter_begin(set);
+    while (hashset_iter_next(&it, &e)) {
+        sum += *(const int*)e;
+        count++;
+    }
+
+    printf("count: %lu, sum: %ld\n", count, sum); // 50, 2500
+
+    hashset_destroy(set);
+    return 0;
+}
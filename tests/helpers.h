@@ -15,21 +15,15 @@
 // === test vec of string (sizeof(String)) ===
 //============================================
 
-// container stores String by value (40 bytes), not ptr
+// container stores String by value (sizeof(String)), not ptr
 void str_copy(u8* dest, const u8* src)
 {
     String* d = (String*)dest; // malloced, not initalized container (garbage value)
     String* s = (String*)src;
 
-    // copy all field values
-    memcpy(d, s, sizeof(String)); // both point to same data
-
-    // allocate space for data
-    u64 n   = s->size * s->data_size;
-    d->data = malloc(n);
-
-    // copy data
-    memcpy(d->data, s->data, n);
+    // init dest as an empty string, then deep copy (inline or heap chars)
+    string_create_stk(d, NULL);
+    string_copy(d, s);
 }
 
 // in case of String by val, buffer is malloced (but unitialized)
@@ -69,18 +63,8 @@ void str_copy_ptr(u8* dest, const u8* src)
 {
     String* s = *(String**)src; // double ptr to str (input)
 
-    // allocate memory for heap string, point d to it
-    String* d = malloc(sizeof(String));
-
-    // copy all the fields
-    memcpy(d, s, sizeof(String));
-
-    // allocate memroy for new data
-    u64 n   = s->size * s->data_size;
-    d->data = malloc(n);
-
-    // copy all elements
-    memcpy(d->data, s->data, n);
+    // allocate a heap string with a deep copy of s
+    String* d = string_from_string(s);
 
     *(String**)dest = d; // dest is double ptr to str
 }
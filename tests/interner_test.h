@@ -0,0 +1,53 @@
+#pragma once
+
+#include "interner.h"
+#include <stdio.h>
+
+
+int interner_test_1(void)
+{
+    interner* in = interner_create(32); // tiny blocks to force chaining
+
+    const char* text = "the cat and the dog and the bird and a very long word "
+                       "that does not fit in one block at all";
+
+    u32 ids[64];
+    u32 n = 0;
+
+    const char* p = text;
+    while (*p) {
+        const char* start = p;
+        while (*p && *p != ' ') { p++; }
+
+        ids[n++] = interner_intern(in, (StringView){ start, (u64)(p - start) });
+
+        if (*p) { p++; }
+    }
+
+    // "the" is word 0, 3 and 6
+    printf("the: %u %u %u\n", ids[0], ids[3], ids[6]);
+    printf("distinct: %u / words: %u\n", interner_size(in), n);
+
+    u32 the = interner_intern_cstr(in, "the");
+    printf("same ptr: %d\n", interner_cstr(in, the) == interner_cstr(in, ids[0]));
+
+    StringView sv = interner_get(in, ids[2]);
+    printf("id %u -> %.*s (%s)\n", ids[2], (int)sv.len, sv.data, interner_cstr(in, ids[2]));
+
+    u32 missing = interner_find(in, (StringView){ "fish", 4 });
+    printf("fish: %s, bird: %u\n", missing == INTERNER_INVALID_ID ? "not interned" : "found",
+           interner_find(in, (StringView){ "bird", 4 }));
+
+    // every id maps back to its bytes
+    for (u32 i = 0; i < interner_size(in); i++) {
+        StringView s = interner_get(in, i);
+        if (interner_find(in, s) != i) {
+            printf("mismatch at %u\n", i);
+        }
+    }
+
+    printf("blocks: %lu\n", genVec_size(in->blocks));
+
+    interner_destroy(in);
+    return 0;
+}
@@ -0,0 +1,204 @@
+#ifndef MATRIX_GENERIC_TEST_H
+#define MATRIX_GENERIC_TEST_H
+
+#include "common.h"
+#include "cpu_features.h"
+#include "matrix_generic.h"
+#include "random.h"
+#include "vec_f32.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+INSTANTIATE_MATRIX(float, "%f");
+INSTANTIATE_MATRIX(double, "%lf");
+INSTANTIATE_MATRIX(i32, "%d");
+INSTANTIATE_MATRIX(i8, "%d");
+
+INSTANTIATE_MATRIX_ACC(i8, i32)
+INSTANTIATE_MATRIX_ACC(float, double)
+
+
+static double generic_rand_unit(void)
+{
+    return ((double)pcg32_rand_bounded(2001) / 1000.0) - 1.0;
+}
+
+// the double, int32, int8 -> int32 and float -> double products against
+// plain loops at every cpu level, past the packing threshold and across k
+// slices; the double elementwise ops; det / solve with a zero first pivot
+int matrix_generic_test_1(void)
+{
+    pcg32_rand_seed(42, 50);
+
+    u64 fails = 0;
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        u64 dims[][3] = { { 3, 5, 7 }, { 37, 29, 41 }, { 67, 45, 83 }, { 13, 35, 1031 } };
+        for (u32 d = 0; d < 4; d++) {
+            u64 m = dims[d][0], n = dims[d][1], k = dims[d][2];
+
+            // double: gemm_f64 vs ikj
+            Matrix_double* ad = matrix_create_double(m, k);
+            Matrix_double* bd = matrix_create_double(k, n);
+            Matrix_double* cd = matrix_create_double(m, n);
+            for (u64 i = 0; i < m * k; i++) { ad->data[i] = generic_rand_unit(); }
+            for (u64 i = 0; i < k * n; i++) { bd->data[i] = generic_rand_unit(); }
+
+            matrix_xply_double(cd, ad, bd);
+            for (u64 i = 0; i < m; i++) {
+                for (u64 j = 0; j < n; j++) {
+                    double ref = 0;
+                    for (u64 p = 0; p < k; p++) { ref += MATRIX_AT(ad, i, p) * MATRIX_AT(bd, p, j); }
+                    fails += fabs(MATRIX_AT(cd, i, j) - ref) > 1e-12 * (double)k;
+                }
+            }
+            Matrix_double* cd2 = matrix_create_double(m, n);
+            matrix_xply_2_double(cd2, ad, bd);
+            for (u64 i = 0; i < m * n; i++) { fails += cd2->data[i] != cd->data[i]; }
+            matrix_destroy_double(cd2);
+
+            // int32 (wrapping) and int8 -> int32: exact
+            Matrix_i32* ai = matrix_create_i32(m, k);
+            Matrix_i32* bi = matrix_create_i32(k, n);
+            Matrix_i32* ci = matrix_create_i32(m, n);
+            Matrix_i8*  a8 = matrix_create_i8(m, k);
+            Matrix_i8*  b8 = matrix_create_i8(k, n);
+            Matrix_i32* c8 = matrix_create_i32(m, n);
+            for (u64 i = 0; i < m * k; i++) {
+                ai->data[i] = (i32)pcg32_rand();
+                a8->data[i] = (i8)(pcg32_rand_bounded(256) - 128);
+            }
+            for (u64 i = 0; i < k * n; i++) {
+                bi->data[i] = (i32)pcg32_rand();
+                b8->data[i] = (i8)(pcg32_rand_bounded(256) - 128);
+            }
+            a8->data[0] = -128; // -128 * -128 pairs: the largest madd_epi16 lane
+            b8->data[0] = -128;
+            b8->data[n] = -128;
+            if (k > 1) { a8->data[1] = -128; }
+
+            matrix_xply_i32(ci, ai, bi);
+            matrix_xply_acc_i8_i32(c8, a8, b8);
+            for (u64 i = 0; i < m; i++) {
+                for (u64 j = 0; j < n; j++) {
+                    u32 ref  = 0;
+                    i32 ref8 = 0;
+                    for (u64 p = 0; p < k; p++) {
+                        ref += (u32)MATRIX_AT(ai, i, p) * (u32)MATRIX_AT(bi, p, j);
+                        ref8 += (i32)MATRIX_AT(a8, i, p) * MATRIX_AT(b8, p, j);
+                    }
+                    fails += MATRIX_AT(ci, i, j) != (i32)ref;
+                    fails += MATRIX_AT(c8, i, j) != ref8;
+                }
+            }
+
+            // float accumulated in double: the products are exact
+            Matrix_float* af = matrix_create_float(m, k);
+            Matrix_float* bf = matrix_create_float(k, n);
+            for (u64 i = 0; i < m * k; i++) { af->data[i] = (float)ad->data[i]; }
+            for (u64 i = 0; i < k * n; i++) { bf->data[i] = (float)bd->data[i]; }
+
+            matrix_xply_acc_float_double(cd, af, bf);
+            for (u64 i = 0; i < m; i++) {
+                for (u64 j = 0; j < n; j++) {
+                    double ref = 0;
+                    for (u64 p = 0; p < k; p++) {
+                        ref += (double)MATRIX_AT(af, i, p) * MATRIX_AT(bf, p, j);
+                    }
+                    fails += fabs(MATRIX_AT(cd, i, j) - ref) > 1e-12 * (double)k;
+                }
+            }
+
+            // double elementwise
+            Matrix_double* ed = matrix_create_double(m, k);
+            matrix_copy_double(ed, ad);
+            matrix_add_double(ed, ed, ad);
+            matrix_sub_double(ed, ed, ad);
+            matrix_scale_double(ed, 3);
+            matrix_div_double(ed, 3);
+            for (u64 i = 0; i < m * k; i++) { fails += fabs(ed->data[i] - ad->data[i]) > 1e-15; }
+
+            matrix_destroy_double(ad);
+            matrix_destroy_double(bd);
+            matrix_destroy_double(cd);
+            matrix_destroy_double(ed);
+            matrix_destroy_i32(ai);
+            matrix_destroy_i32(bi);
+            matrix_destroy_i32(ci);
+            matrix_destroy_i8(a8);
+            matrix_destroy_i8(b8);
+            matrix_destroy_i32(c8);
+            matrix_destroy_float(af);
+            matrix_destroy_float(bf);
+        }
+
+        // a zero first pivot: the old unpivoted LU stopped here
+        Matrix_i32 ai;
+        Matrix_i32 bi;
+        Matrix_i32 xi;
+        i32        adata[9] = { 0, 1, 2, 1, 0, 3, 4, -3, 8 };
+        i32        bdata[3] = { 8, 10, 22 }; // a * (1, 2, 3)
+        i32        xdata[3];
+        matrix_create_stk_i32(&ai, 3, 3, adata);
+        matrix_create_stk_i32(&bi, 3, 1, bdata);
+        matrix_create_stk_i32(&xi, 3, 1, xdata);
+
+        fails += fabs(matrix_det_i32(&ai) + 2) > 1e-12;
+        fails += !matrix_solve_i32(&xi, &ai, &bi);
+
+        Matrix_double ad;
+        Matrix_double bd;
+        Matrix_double xd;
+        double        addata[9] = { 0, 1, 2, 1, 0, 3, 4, -3, 8 };
+        double        bddata[3] = { 8, 10, 22 };
+        double        xddata[3];
+        matrix_create_stk_double(&ad, 3, 3, addata);
+        matrix_create_stk_double(&bd, 3, 1, bddata);
+        matrix_create_stk_double(&xd, 3, 1, xddata);
+        fails += !matrix_solve_double(&xd, &ad, &bd);
+        for (u32 i = 0; i < 3; i++) {
+            fails += fabs(xddata[i] - (i + 1)) > 1e-12;
+            fails += xdata[i] < (i32)i || xdata[i] > (i32)i + 1; // truncated: i + 1 or just below
+        }
+
+        Matrix_i32 si;
+        i32        sdata[9] = { 1, 2, 3, 2, 4, 6, 1, 1, 1 };
+        matrix_create_stk_i32(&si, 3, 3, sdata);
+        fails += matrix_det_i32(&si) != 0;
+
+        // a larger solve: recursive LU through gemm_f64, checked by residual
+        u64            n  = 70;
+        Matrix_double* a  = matrix_create_double(n, n);
+        Matrix_double* b  = matrix_create_double(n, 2);
+        Matrix_double* x  = matrix_create_double(n, 2);
+        Matrix_double* ax = matrix_create_double(n, 2);
+        for (u64 i = 0; i < n * n; i++) { a->data[i] = generic_rand_unit(); }
+        for (u64 i = 0; i < n * 2; i++) { b->data[i] = generic_rand_unit(); }
+        fails += !matrix_solve_double(x, a, b);
+        matrix_xply_double(ax, a, x);
+        for (u64 i = 0; i < n * 2; i++) { fails += fabs(ax->data[i] - b->data[i]) > 1e-9; }
+        matrix_destroy_double(a);
+        matrix_destroy_double(b);
+        matrix_destroy_double(x);
+        matrix_destroy_double(ax);
+
+        // dot accumulated in double: 2^24 + 1000 ones - 2^24
+        float ones[1002];
+        float xs[1002];
+        for (u32 i = 0; i < 1002; i++) { ones[i] = 1; xs[i] = 1; }
+        xs[0]    = 16777216.0f;
+        xs[1001] = -16777216.0f;
+        fails += vec_f32_dot_f64(xs, ones, 1002) != 1000.0;
+        fails += vec_f32_dot_f64(xs + 1, ones, 1000) != 1000.0;
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    printf("matrix generic kernels: %lu fails\n", fails);
+    return fails != 0;
+}
+
+#endif // MATRIX_GENERIC_TEST_H
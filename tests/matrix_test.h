@@ -3,8 +3,17 @@
 
 #include "arena.h"
 #include "common.h"
+#include "cpu_features.h"
+#include "gemm.h"
+#include "gemm_batch.h"
+#include "gemv.h"
+#include "vec_f32.h"
 #include "matrix.h"
+#include "random.h"
+#include "transpose.h"
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 
 int matrix_test_1(void)
@@ -223,4 +232,872 @@ int matrix_test_7(void)
 }
 
 
+static float rand_unit(void)
+{
+    return ((float)pcg32_rand_bounded(2001) / 1000.0f) - 1.0f;
+}
+
+// gemm_f32 vs a double accumulated triple loop: edge tiles, k across
+// GEMM_KC slices, leading dimensions > width, alpha / beta, every level
+int matrix_test_8(void)
+{
+    pcg32_rand_seed(42, 7);
+
+    u64 fails = 0;
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        for (int t = 0; t < 40; t++) {
+            u64 m   = 1 + pcg32_rand_bounded(t < 20 ? 40 : 200);
+            u64 n   = 1 + pcg32_rand_bounded(t < 20 ? 40 : 200);
+            u64 k   = 1 + pcg32_rand_bounded(t < 20 ? 40 : 600);
+            u64 pad = pcg32_rand_bounded(3);
+
+            u64 lda = k + pad, ldb = n + pad, ldc = n + pad;
+
+            float* a = malloc(sizeof(float) * m * lda);
+            float* b = malloc(sizeof(float) * k * ldb);
+            float* c = malloc(sizeof(float) * m * ldc);
+
+            for (u64 i = 0; i < m * lda; i++) { a[i] = rand_unit(); }
+            for (u64 i = 0; i < k * ldb; i++) { b[i] = rand_unit(); }
+            for (u64 i = 0; i < m * ldc; i++) { c[i] = rand_unit(); }
+
+            float alpha = t % 3 == 0 ? 1.0f : rand_unit();
+            float beta  = t % 2 == 0 ? 0.0f : rand_unit();
+
+            float* ref = malloc(sizeof(float) * m * ldc);
+            memcpy(ref, c, sizeof(float) * m * ldc);
+            for (u64 i = 0; i < m; i++) {
+                for (u64 j = 0; j < n; j++) {
+                    double sum = 0;
+                    for (u64 p = 0; p < k; p++) { sum += (double)a[(i * lda) + p] * b[(p * ldb) + j]; }
+                    ref[(i * ldc) + j] = (float)((alpha * sum) + (beta == 0 ? 0 : beta * ref[(i * ldc) + j]));
+                }
+            }
+
+            gemm_f32(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+
+            for (u64 i = 0; i < m; i++) {
+                for (u64 j = 0; j < ldc; j++) {
+                    float want = ref[(i * ldc) + j];
+                    float got  = c[(i * ldc) + j];
+                    // padding columns must not be touched
+                    fails += j < n ? fabsf(got - want) > 1e-4f * (float)k : got != want;
+                }
+            }
+
+            free(a);
+            free(b);
+            free(c);
+            free(ref);
+        }
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    return (int)fails;
+}
+
+
+// gemm_f32_mt vs gemm_f32 (tiles at odd offsets, row and column splits)
+int matrix_test_9(void)
+{
+    pcg32_rand_seed(42, 7);
+
+    u64 fails = 0;
+    u64 dims[][3] = { { 300, 200, 150 }, { 97, 500, 61 }, { 1000, 40, 77 }, { 20, 20, 20 } };
+
+    u32 sizes[] = { 1, 3, 8 };
+    for (u32 s = 0; s < 3; s++) {
+        thread_pool* pool = thread_pool_create(sizes[s]);
+
+        for (u32 d = 0; d < 4; d++) {
+            u64 m = dims[d][0], n = dims[d][1], k = dims[d][2];
+
+            float* a   = malloc(sizeof(float) * m * k);
+            float* b   = malloc(sizeof(float) * k * n);
+            float* c   = malloc(sizeof(float) * m * n);
+            float* ref = malloc(sizeof(float) * m * n);
+
+            for (u64 i = 0; i < m * k; i++) { a[i] = rand_unit(); }
+            for (u64 i = 0; i < k * n; i++) { b[i] = rand_unit(); }
+            for (u64 i = 0; i < m * n; i++) { c[i] = ref[i] = rand_unit(); }
+
+            gemm_f32(m, n, k, 0.5f, a, k, b, n, 2.0f, ref, n);
+            gemm_f32_mt(m, n, k, 0.5f, a, k, b, n, 2.0f, c, n, pool);
+
+            for (u64 i = 0; i < m * n; i++) { fails += fabsf(c[i] - ref[i]) > 1e-4f; }
+
+            free(a);
+            free(b);
+            free(c);
+            free(ref);
+        }
+
+        printf("%u threads: fails %lu\n", sizes[s], fails);
+        thread_pool_destroy(pool);
+    }
+
+    return (int)fails;
+}
+
+
+// xply_2 / xply_bt / the arena variants on sizes whose VLAs overflowed the stack
+int matrix_test_10(void)
+{
+    pcg32_rand_seed(42, 9);
+
+    u64 fails = 0;
+
+    // b is 3000x1000: its transpose was a 12 MB VLA
+    u64     m = 5, k = 3000, n = 1000;
+    Matrix* a   = matrix_create(m, k);
+    Matrix* b   = matrix_create(k, n);
+    Matrix* bt  = matrix_create(n, k);
+    Matrix* c   = matrix_create(m, n);
+    Matrix* ref = matrix_create(m, n);
+
+    for (u64 i = 0; i < m * k; i++) { a->data[i] = rand_unit(); }
+    for (u64 i = 0; i < k * n; i++) { b->data[i] = rand_unit(); }
+    matrix_T(bt, b);
+    matrix_xply(ref, a, b);
+
+    matrix_xply_2(c, a, b);
+    for (u64 i = 0; i < m * n; i++) { fails += fabsf(c->data[i] - ref->data[i]) > 1e-3f; }
+
+    memset(c->data, 0, sizeof(float) * m * n);
+    matrix_xply_bt(c, a, bt);
+    for (u64 i = 0; i < m * n; i++) { fails += fabsf(c->data[i] - ref->data[i]) > 1e-3f; }
+
+    Arena* scratch = arena_create(nMB(16));
+    u64    used    = arena_used(scratch);
+
+    memset(c->data, 0, sizeof(float) * m * n);
+    matrix_xply_2_arena(c, a, b, scratch);
+    for (u64 i = 0; i < m * n; i++) { fails += fabsf(c->data[i] - ref->data[i]) > 1e-3f; }
+    fails += arena_used(scratch) != used;
+
+    // unit upper triangular 1100x1100: det 1, L and U were 9.7 MB of VLAs
+    u64     d = 1100;
+    Matrix* t = matrix_create(d, d);
+    for (u64 i = 0; i < d; i++) {
+        for (u64 j = 0; j < d; j++) {
+            t->data[IDX(t, i, j)] = j < i ? 0 : j == i ? 1 : rand_unit();
+        }
+    }
+
+    float det  = matrix_det(t);
+    float det2 = matrix_det_arena(t, scratch);
+    fails += fabsf(det - 1) > 1e-5f || fabsf(det2 - 1) > 1e-5f;
+    fails += arena_used(scratch) != used;
+
+    printf("det %f %f fails %lu\n", det, det2, fails);
+
+    arena_release(scratch);
+    matrix_destroy(a);
+    matrix_destroy(b);
+    matrix_destroy(bt);
+    matrix_destroy(c);
+    matrix_destroy(ref);
+    matrix_destroy(t);
+
+    return (int)fails;
+}
+
+
+// vec_f32 kernels at every level vs plain loops (odd lengths, unaligned, in place)
+int matrix_test_11(void)
+{
+    pcg32_rand_seed(42, 11);
+
+    u64    fails = 0;
+    u64    cap   = 300;
+    float* a     = malloc(sizeof(float) * (cap + 1));
+    float* b     = malloc(sizeof(float) * (cap + 1));
+    float* out   = malloc(sizeof(float) * (cap + 1));
+    float* ref   = malloc(sizeof(float) * (cap + 1));
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        for (u64 n = 0; n <= cap; n += (n < 70 ? 1 : 37)) {
+            for (u64 off = 0; off < 2; off++) {
+                float* x = a + off;
+                float* y = b + off;
+                for (u64 i = 0; i < n; i++) { x[i] = rand_unit(); y[i] = rand_unit(); }
+
+                vec_f32_add(out, x, y, n);
+                for (u64 i = 0; i < n; i++) { fails += out[i] != x[i] + y[i]; }
+
+                vec_f32_sub(out, x, y, n);
+                for (u64 i = 0; i < n; i++) { fails += out[i] != x[i] - y[i]; }
+
+                vec_f32_scale(out, x, 3.5f, n);
+                for (u64 i = 0; i < n; i++) { fails += out[i] != 3.5f * x[i]; }
+
+                // fused on AVX2: within an ulp of the two step result
+                for (u64 i = 0; i < n; i++) { ref[i] = (-0.75f * x[i]) + y[i]; }
+                vec_f32_axpy(out, -0.75f, x, y, n);
+                for (u64 i = 0; i < n; i++) { fails += fabsf(out[i] - ref[i]) > 1e-6f; }
+
+                // in place: y = 2x + y
+                for (u64 i = 0; i < n; i++) { ref[i] = (2.0f * x[i]) + y[i]; }
+                vec_f32_axpy(y, 2.0f, x, y, n);
+                for (u64 i = 0; i < n; i++) { fails += fabsf(y[i] - ref[i]) > 1e-6f; }
+            }
+        }
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    // matrix ops on top: div by reciprocal, axpy, add in place
+    Matrix* m1 = matrix_create(7, 9);
+    Matrix* m2 = matrix_create(7, 9);
+    for (u64 i = 0; i < 63; i++) { m1->data[i] = rand_unit(); m2->data[i] = rand_unit(); }
+    memcpy(ref, m1->data, sizeof(float) * 63);
+
+    matrix_div(m1, 3.0f);
+    for (u64 i = 0; i < 63; i++) { fails += fabsf(m1->data[i] - (ref[i] / 3.0f)) > 1e-6f; }
+
+    matrix_scale(m1, 3.0f);
+    matrix_axpy(m1, -1.0f, m2, m1);
+    matrix_add(m1, m1, m2);
+    for (u64 i = 0; i < 63; i++) { fails += fabsf(m1->data[i] - ref[i]) > 1e-5f; }
+
+    matrix_destroy(m1);
+    matrix_destroy(m2);
+    free(a);
+    free(b);
+    free(out);
+    free(ref);
+
+    return (int)fails;
+}
+
+
+// naive out = a × b over view indices, the reference for matrix_view_xply
+static void view_xply_ref(MatrixView out, MatrixView a, MatrixView b)
+{
+    for (u64 i = 0; i < out.m; i++) {
+        for (u64 j = 0; j < out.n; j++) {
+            double sum = 0;
+            for (u64 p = 0; p < a.n; p++) {
+                sum += (double)MATRIX_VIEW_AT(a, i, p) * MATRIX_VIEW_AT(b, p, j);
+            }
+            MATRIX_VIEW_AT(out, i, j) = (float)sum;
+        }
+    }
+}
+
+// relative difference above tol
+static u64 view_diff(MatrixView a, MatrixView b, float tol)
+{
+    u64 fails = 0;
+    for (u64 i = 0; i < a.m; i++) {
+        for (u64 j = 0; j < a.n; j++) {
+            float x = MATRIX_VIEW_AT(a, i, j), y = MATRIX_VIEW_AT(b, i, j);
+            fails += fabsf(x - y) > tol * (1 + fabsf(y));
+        }
+    }
+    return fails;
+}
+
+// views: slicing, transpose, elementwise ops and xply over every layout
+int matrix_test_12(void)
+{
+    pcg32_rand_seed(42, 12);
+
+    u64 fails = 0;
+
+    Matrix* big = matrix_create(60, 70);
+    for (u64 i = 0; i < 60 * 70; i++) { big->data[i] = rand_unit(); }
+
+    MatrixView v = matrix_view(big);
+    MatrixView s = matrix_view_slice(v, 3, 5, 40, 33);
+    MatrixView t = matrix_view_T(s);
+
+    fails += MATRIX_VIEW_AT(s, 2, 7) != MATRIX_AT(big, 5, 12);
+    fails += MATRIX_VIEW_AT(t, 7, 2) != MATRIX_AT(big, 5, 12);
+    fails += matrix_view_slice(t, 1, 1, 2, 2).data != &MATRIX_AT(big, 4, 6);
+
+    // every 2nd row and col: no unit stride at all
+    MatrixView g = { big->data + 1, 30, 34, 2 * big->n, 2 };
+
+    // elementwise: contiguous, sliced rows, transposed, strided, mixed
+    Matrix*    o_mat = matrix_create(40, 33);
+    Matrix*    r_mat = matrix_create(40, 33);
+    MatrixView o     = matrix_view(o_mat);
+    MatrixView r     = matrix_view(r_mat);
+
+    MatrixView s2 = matrix_view_slice(v, 10, 30, 40, 33);
+    MatrixView t2 = matrix_view_T(matrix_view_slice(v, 1, 2, 33, 40));
+
+    MatrixView xs[] = { s, s2, t2, o };
+    for (u32 xi = 0; xi < 4; xi++) {
+        for (u32 yi = 0; yi < 3; yi++) {
+            MatrixView x = xs[xi], y = xs[yi];
+            for (u32 op = 0; op < 3; op++) {
+                for (u64 i = 0; i < 40; i++) {
+                    for (u64 j = 0; j < 33; j++) {
+                        float a = MATRIX_VIEW_AT(x, i, j), b = MATRIX_VIEW_AT(y, i, j);
+                        MATRIX_VIEW_AT(r, i, j) = op == 0 ? a + b : op == 1 ? a - b : (3 * a) + b;
+                    }
+                }
+                if (op == 0) { matrix_view_add(o, x, y); }
+                if (op == 1) { matrix_view_sub(o, x, y); }
+                if (op == 2) { matrix_view_axpy(o, 3, x, y); }
+                fails += view_diff(o, r, 1e-6f);
+            }
+        }
+    }
+
+    // into a transposed output
+    Matrix*    ot_mat = matrix_create(33, 40);
+    MatrixView ot     = matrix_view_T(matrix_view(ot_mat));
+    matrix_view_add(ot, t2, s);
+    matrix_view_add(r, t2, s);
+    fails += view_diff(ot, r, 0);
+
+    // copy and scale
+    matrix_view_copy(o, t2);
+    fails += view_diff(o, t2, 0);
+    matrix_view_scale(o, 2);
+    matrix_view_scale(ot, 2);
+    matrix_view_axpy(r, 1, t2, t2);
+    fails += view_diff(o, r, 1e-6f);
+
+    // xply with transposed / sliced / strided operands and outputs
+    Matrix*    c_mat = matrix_create(60, 70);
+    Matrix*    d_mat = matrix_create(60, 70);
+    MatrixView c     = matrix_view(c_mat);
+
+    MatrixView as[] = { matrix_view_slice(v, 0, 0, 20, 30), matrix_view_T(matrix_view_slice(v, 0, 0, 30, 20)),
+                        matrix_view_slice(g, 0, 0, 20, 30) };
+    MatrixView bs[] = { matrix_view_slice(v, 5, 9, 30, 25), matrix_view_T(matrix_view_slice(v, 2, 3, 25, 30)),
+                        matrix_view_slice(g, 0, 1, 30, 25) };
+    MatrixView cs[] = { matrix_view_slice(c, 0, 0, 20, 25), matrix_view_T(matrix_view_slice(c, 1, 1, 25, 20)),
+                        (MatrixView){ c_mat->data + 3, 20, 25, 2 * c_mat->n, 2 } };
+
+    for (u32 ai = 0; ai < 3; ai++) {
+        for (u32 bi = 0; bi < 3; bi++) {
+            for (u32 ci = 0; ci < 3; ci++) {
+                MatrixView b = bs[bi];
+
+                MatrixView dc = cs[ci];
+                dc.data       = d_mat->data + (cs[ci].data - c_mat->data);
+
+                view_xply_ref(dc, as[ai], b);
+                matrix_view_xply(cs[ci], as[ai], b);
+                fails += view_diff(cs[ci], dc, 1e-4f);
+            }
+        }
+    }
+
+    // a large transposed product goes through the packed path
+    Matrix* p  = matrix_create(60, 60);
+    Matrix* pr = matrix_create(60, 60);
+    matrix_view_xply(matrix_view(p), v, matrix_view_T(v));
+    view_xply_ref(matrix_view(pr), v, matrix_view_T(v));
+    fails += view_diff(matrix_view(p), matrix_view(pr), 1e-4f);
+
+    printf("view fails %lu\n", fails);
+
+    matrix_destroy(big);
+    matrix_destroy(o_mat);
+    matrix_destroy(r_mat);
+    matrix_destroy(ot_mat);
+    matrix_destroy(c_mat);
+    matrix_destroy(d_mat);
+    matrix_destroy(p);
+    matrix_destroy(pr);
+
+    return (int)fails;
+}
+
+
+// pivoted LU: det, solve, inverse, and singular inputs that used to abort
+int matrix_test_13(void)
+{
+    pcg32_rand_seed(42, 13);
+
+    u64 fails = 0;
+
+    // det: a zero leading pivot (Doolittle aborted), a 3x3, a singular one
+    Matrix* swap = matrix_create_arr(2, 2, (float[4]){ 0, 1, 1, 0 });
+    Matrix* m3   = matrix_create_arr(3, 3, (float[9]){ 3, 2, 4, 2, 0, 2, 4, 2, 3 });
+    Matrix* sing = matrix_create_arr(3, 3, (float[9]){ 1, 2, 3, 2, 4, 6, 1, 0, 1 });
+
+    fails += matrix_det(swap) != -1;
+    fails += fabsf(matrix_det(m3) - 8) > 1e-5f;
+    fails += matrix_det(sing) != 0;
+
+    Matrix* inv = matrix_create(3, 3);
+    fails += matrix_inv(inv, sing); // warns, returns false
+    fails += !matrix_inv(inv, m3);
+
+    Matrix* id = matrix_create(3, 3);
+    matrix_xply(id, m3, inv);
+    for (u64 i = 0; i < 3; i++) {
+        for (u64 j = 0; j < 3; j++) { fails += fabsf(MATRIX_AT(id, i, j) - (i == j)) > 1e-5f; }
+    }
+
+    // in place inverse
+    fails += !matrix_inv(m3, m3);
+    for (u64 i = 0; i < 9; i++) { fails += fabsf(m3->data[i] - inv->data[i]) > 1e-6f; }
+
+    // sizes around the recursion / block boundaries: residual of A x = b
+    u64 sizes[] = { 1, 5, 16, 17, 33, 100, 257 };
+    for (u32 s = 0; s < 7; s++) {
+        u64     n = sizes[s], r = 3;
+        Matrix* a = matrix_create(n, n);
+        Matrix* b = matrix_create(n, r);
+        Matrix* x = matrix_create(n, r);
+        Matrix* y = matrix_create(n, r);
+
+        for (u64 i = 0; i < n * n; i++) { a->data[i] = rand_unit(); }
+        for (u64 i = 0; i < n * r; i++) { b->data[i] = rand_unit(); }
+
+        fails += !matrix_solve(x, a, b);
+        matrix_xply(y, a, x);
+
+        double err = 0, norm = 0;
+        for (u64 i = 0; i < n * r; i++) {
+            double e = fabs((double)y->data[i] - b->data[i]);
+            double v = fabs((double)x->data[i]);
+            err      = e > err ? e : err;
+            norm     = v > norm ? v : norm;
+        }
+        fails += err > 1e-4 * (1 + norm);
+
+        // the factors reproduce P a
+        Matrix* lu   = matrix_create(n, n);
+        u64*    perm = malloc(sizeof(u64) * n);
+        fails += !matrix_LU(lu, perm, a);
+        for (u64 i = 0; i < n; i++) {
+            for (u64 j = 0; j < n; j++) {
+                double sum = 0;
+                for (u64 p = 0; p <= i && p <= j; p++) {
+                    double l = p == i ? 1 : MATRIX_AT(lu, i, p);
+                    sum += l * MATRIX_AT(lu, p, j);
+                }
+                fails += fabs(sum - MATRIX_AT(a, perm[i], j)) > 1e-4;
+            }
+        }
+
+        printf("n %4lu: residual %.2e fails %lu\n", n, err, fails);
+
+        matrix_destroy(a);
+        matrix_destroy(b);
+        matrix_destroy(x);
+        matrix_destroy(y);
+        matrix_destroy(lu);
+        free(perm);
+    }
+
+    matrix_destroy(swap);
+    matrix_destroy(m3);
+    matrix_destroy(sing);
+    matrix_destroy(inv);
+    matrix_destroy(id);
+
+    return (int)fails;
+}
+
+
+// gemv (plain and transposed) and the batched small gemm at every level
+int matrix_test_14(void)
+{
+    pcg32_rand_seed(42, 14);
+
+    u64 fails = 0;
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        u64 dims[][2] = { { 0, 5 }, { 5, 0 }, { 1, 1 }, { 3, 9 }, { 4, 8 }, { 7, 13 }, { 33, 70 }, { 130, 17 } };
+        for (u32 d = 0; d < 8; d++) {
+            u64 m = dims[d][0], n = dims[d][1];
+
+            Matrix* a  = matrix_create(m, n);
+            float*  x  = malloc(sizeof(float) * (m + n + 1));
+            float*  y  = malloc(sizeof(float) * (m + n + 1));
+            float*  y0 = malloc(sizeof(float) * (m + n + 1));
+            for (u64 i = 0; i < m * n; i++) { a->data[i] = rand_unit(); }
+            for (u64 i = 0; i < m + n + 1; i++) { x[i] = rand_unit(); y0[i] = rand_unit(); }
+
+            for (u32 bi = 0; bi < 2; bi++) {
+                float beta = bi ? 0.5f : 0;
+
+                // y = 2 a x + beta y (beta 0: y starts as NaN)
+                for (u64 i = 0; i < m; i++) { y[i] = bi ? y0[i] : NAN; }
+                matrix_gemv(y, 2, a, x, beta);
+                for (u64 i = 0; i < m; i++) {
+                    double sum = 0;
+                    for (u64 j = 0; j < n; j++) { sum += (double)MATRIX_AT(a, i, j) * x[j]; }
+                    fails += !(fabs(y[i] - ((2 * sum) + (beta * (bi ? y0[i] : 0)))) < 1e-4);
+                }
+
+                // y = 2 a^T x + beta y
+                for (u64 j = 0; j < n; j++) { y[j] = bi ? y0[j] : NAN; }
+                matrix_gemv_T(y, 2, a, x, beta);
+                for (u64 j = 0; j < n; j++) {
+                    double sum = 0;
+                    for (u64 i = 0; i < m; i++) { sum += (double)MATRIX_AT(a, i, j) * x[i]; }
+                    fails += !(fabs(y[j] - ((2 * sum) + (beta * (bi ? y0[j] : 0)))) < 1e-4);
+                }
+            }
+
+            matrix_destroy(a);
+            free(x);
+            free(y);
+            free(y0);
+        }
+
+        // batched: tile edges (odd m, n % 4), lane tails, several chunks
+        u64 shapes[][3] = { { 4, 4, 4 }, { 8, 8, 8 }, { 5, 7, 3 }, { 16, 16, 16 }, { 32, 32, 32 } };
+        u64 batches[]   = { 1, 7, 70, 131 };
+        for (u32 sh = 0; sh < 5; sh++) {
+            for (u32 bi = 0; bi < 4; bi++) {
+                u64 m = shapes[sh][0], n = shapes[sh][1], k = shapes[sh][2], bs = batches[bi];
+
+                float* a   = malloc(sizeof(float) * bs * m * k);
+                float* b   = malloc(sizeof(float) * bs * k * n);
+                float* ai  = malloc(sizeof(float) * gemm_batch_size(bs, m * k));
+                float* bi_ = malloc(sizeof(float) * gemm_batch_size(bs, k * n));
+                float* ci  = malloc(sizeof(float) * gemm_batch_size(bs, m * n));
+                float* c   = malloc(sizeof(float) * bs * m * n);
+                float* ref = malloc(sizeof(float) * m * n);
+
+                for (u64 i = 0; i < bs * m * k; i++) { a[i] = rand_unit(); }
+                for (u64 i = 0; i < bs * k * n; i++) { b[i] = rand_unit(); }
+
+                gemm_batch_interleave(ai, a, bs, m * k);
+                gemm_batch_interleave(bi_, b, bs, k * n);
+                fails += GEMM_BATCH_AT(ai, m * k, m * k - 1, bs - 1) != a[(bs * m * k) - 1];
+
+                gemm_f32_batched(bs, m, n, k, ai, bi_, ci);
+                gemm_batch_deinterleave(c, ci, bs, m * n);
+
+                for (u64 t = 0; t < bs; t++) {
+                    gemm_f32(m, n, k, 1, a + (t * m * k), k, b + (t * k * n), n, 0, ref, n);
+                    for (u64 e = 0; e < m * n; e++) { fails += fabsf(c[(t * m * n) + e] - ref[e]) > 1e-4f; }
+                }
+
+                free(a);
+                free(b);
+                free(ai);
+                free(bi_);
+                free(ci);
+                free(c);
+                free(ref);
+            }
+        }
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    return (int)fails;
+}
+
+
+// transposes: out of place (odd, rectangular, strided), square and
+// rectangular in place, at every level, against a plain loop
+int matrix_test_15(void)
+{
+    pcg32_rand_seed(42, 15);
+
+    u64 fails = 0;
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        u64 dims[][2] = { { 1, 1 }, { 1, 9 }, { 9, 1 }, { 3, 5 }, { 8, 8 }, { 7, 13 },
+                          { 16, 24 }, { 33, 70 }, { 100, 37 }, { 257, 129 } };
+        for (u32 d = 0; d < 10; d++) {
+            u64 m = dims[d][0], n = dims[d][1];
+
+            Matrix* a  = matrix_create(m, n);
+            Matrix* at = matrix_create(n, m);
+            for (u64 i = 0; i < m * n; i++) { a->data[i] = rand_unit(); }
+
+            matrix_T(at, a);
+            for (u64 i = 0; i < m; i++) {
+                for (u64 j = 0; j < n; j++) { fails += MATRIX_AT(at, j, i) != MATRIX_AT(a, i, j); }
+            }
+
+            // raw buffers with padded leading dims, padding left alone
+            u64    lds = n + 3, ldd = m + 5;
+            float* src = malloc(sizeof(float) * m * lds);
+            float* dst = malloc(sizeof(float) * n * ldd);
+            for (u64 i = 0; i < m * lds; i++) { src[i] = rand_unit(); }
+            for (u64 i = 0; i < n * ldd; i++) { dst[i] = -7; }
+            transpose_f32(m, n, src, lds, dst, ldd);
+            for (u64 j = 0; j < n; j++) {
+                for (u64 i = 0; i < ldd; i++) {
+                    float want = i < m ? src[(i * lds) + j] : -7;
+                    fails += dst[(j * ldd) + i] != want;
+                }
+            }
+            free(src);
+            free(dst);
+
+            // in place: m and n swap, data matches matrix_T
+            matrix_T_inplace(a);
+            fails += a->m != n || a->n != m;
+            for (u64 i = 0; i < m * n; i++) { fails += a->data[i] != at->data[i]; }
+
+            matrix_destroy(a);
+            matrix_destroy(at);
+        }
+
+        // past TRANSPOSE_STREAM_MIN: misaligned dst (leading rows peeled),
+        // leftover rows and cols
+        {
+            u64    m = 1037, n = 1029, ldd = 1048;
+            float* src = malloc(sizeof(float) * m * n);
+            float* buf = malloc(sizeof(float) * ((n * ldd) + 8));
+            float* dst = buf + 3;
+            for (u64 i = 0; i < m * n; i++) { src[i] = (float)i; }
+            transpose_f32(m, n, src, n, dst, ldd);
+            for (u64 j = 0; j < n; j++) {
+                for (u64 i = 0; i < m; i++) { fails += dst[(j * ldd) + i] != src[(i * n) + j]; }
+            }
+            free(src);
+            free(buf);
+        }
+
+        // square in place inside a larger matrix: the rest is untouched
+        u64    n = 45, lda = 50;
+        float* a = malloc(sizeof(float) * lda * lda);
+        float* r = malloc(sizeof(float) * lda * lda);
+        for (u64 i = 0; i < lda * lda; i++) { a[i] = r[i] = rand_unit(); }
+        transpose_square_f32(n, a, lda);
+        for (u64 i = 0; i < lda; i++) {
+            for (u64 j = 0; j < lda; j++) {
+                float want = i < n && j < n ? r[(j * lda) + i] : r[(i * lda) + j];
+                fails += a[(i * lda) + j] != want;
+            }
+        }
+        free(a);
+        free(r);
+
+        // a transposed view copied into rows
+        Matrix*    b  = matrix_create(40, 27);
+        Matrix*    bt = matrix_create(27, 40);
+        for (u64 i = 0; i < 40 * 27; i++) { b->data[i] = rand_unit(); }
+        matrix_view_copy(matrix_view(bt), matrix_view_T(matrix_view(b)));
+        for (u64 i = 0; i < 40; i++) {
+            for (u64 j = 0; j < 27; j++) { fails += MATRIX_AT(bt, j, i) != MATRIX_AT(b, i, j); }
+        }
+        matrix_destroy(b);
+        matrix_destroy(bt);
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    return (int)fails;
+}
+
+
+// padding of an aligned matrix that is not 0
+static u64 pad_nonzero(const Matrix* mat)
+{
+    u64 fails = 0;
+    for (u64 i = 0; i < mat->m; i++) {
+        for (u64 j = mat->n; j < mat->ld; j++) { fails += mat->data[(i * mat->ld) + j] != 0; }
+    }
+    return fails;
+}
+
+// aligned, padded matrices (alone and mixed with packed ones) give the
+// same results as packed ones through every op, padding stays 0
+int matrix_test_16(void)
+{
+    pcg32_rand_seed(42, 16);
+
+    u64 fails = 0;
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        u64 dims[][2] = { { 1, 1 }, { 3, 5 }, { 7, 16 }, { 17, 33 }, { 40, 21 } };
+        for (u32 d = 0; d < 5; d++) {
+            u64 m = dims[d][0], n = dims[d][1];
+
+            Matrix* a  = matrix_create(m, n);
+            Matrix* b  = matrix_create(m, n);
+            Matrix* aa = matrix_create_aligned(m, n);
+            Matrix* ba = matrix_create_aligned(m, n);
+            Matrix* r  = matrix_create(m, n);
+            Matrix* ra = matrix_create_aligned(m, n);
+
+            fails += aa->ld != MATRIX_LD_ALIGNED(n) || aa->ld % 16 != 0 || aa->ld < n;
+            fails += (uintptr_t)aa->data % MATRIX_ALIGN != 0;
+            fails += pad_nonzero(aa);
+
+            for (u64 i = 0; i < m * n; i++) { a->data[i] = rand_unit(); b->data[i] = rand_unit(); }
+            matrix_set_val_arr(aa, m * n, a->data);
+            matrix_copy(ba, b);
+            fails += view_diff(matrix_view(aa), matrix_view(a), 0);
+            fails += view_diff(matrix_view(ba), matrix_view(b), 0);
+            fails += MATRIX_AT(aa, m - 1, n - 1) != a->data[(m * n) - 1];
+
+            // element wise: all aligned, then mixed with packed
+            matrix_add(r, a, b);
+            matrix_add(ra, aa, ba);
+            fails += view_diff(matrix_view(ra), matrix_view(r), 0);
+            matrix_add(ra, a, ba);
+            fails += view_diff(matrix_view(ra), matrix_view(r), 0);
+
+            matrix_sub(r, a, b);
+            matrix_sub(ra, aa, b);
+            fails += view_diff(matrix_view(ra), matrix_view(r), 0);
+
+            matrix_axpy(r, 1.5f, a, b);
+            matrix_axpy(ra, 1.5f, aa, ba);
+            fails += view_diff(matrix_view(ra), matrix_view(r), 1e-6f);
+
+            matrix_scale(r, 3);
+            matrix_scale(ra, 3);
+            matrix_div(r, 2);
+            matrix_div(ra, 2);
+            fails += view_diff(matrix_view(ra), matrix_view(r), 1e-6f);
+            fails += pad_nonzero(ra);
+
+            // products
+            Matrix* c   = matrix_create(m, m);
+            Matrix* ca  = matrix_create_aligned(m, m);
+            Matrix* bt  = matrix_create(n, m);
+            Matrix* bta = matrix_create_aligned(n, m);
+
+            matrix_T(bt, b);
+            matrix_T(bta, ba);
+            fails += view_diff(matrix_view(bta), matrix_view(bt), 0);
+            fails += pad_nonzero(bta);
+
+            matrix_xply(c, a, bt);
+            matrix_xply(ca, aa, bta);
+            fails += view_diff(matrix_view(ca), matrix_view(c), 1e-5f);
+            matrix_xply_bt(ca, aa, ba);
+            fails += view_diff(matrix_view(ca), matrix_view(c), 1e-5f);
+            matrix_xply_2(ca, aa, bta);
+            fails += view_diff(matrix_view(ca), matrix_view(c), 1e-5f);
+            fails += pad_nonzero(ca);
+
+            float* x  = malloc(sizeof(float) * (m + n));
+            float* y  = malloc(sizeof(float) * (m + n));
+            float* ya = malloc(sizeof(float) * (m + n));
+            for (u64 i = 0; i < m + n; i++) { x[i] = rand_unit(); }
+            matrix_gemv(y, 1, a, x, 0);
+            matrix_gemv(ya, 1, aa, x, 0);
+            for (u64 i = 0; i < m; i++) { fails += fabsf(y[i] - ya[i]) > 1e-5f; }
+            matrix_gemv_T(y, 1, a, x, 0);
+            matrix_gemv_T(ya, 1, aa, x, 0);
+            for (u64 j = 0; j < n; j++) { fails += fabsf(y[j] - ya[j]) > 1e-5f; }
+            free(x);
+            free(y);
+            free(ya);
+
+            // in place transpose: a rectangular one comes back packed
+            matrix_T_inplace(aa);
+            fails += aa->m != n || aa->n != m || (m != n && aa->ld != m);
+            matrix_T(bt, a);
+            fails += view_diff(matrix_view(aa), matrix_view(bt), 0);
+
+            matrix_destroy(a);
+            matrix_destroy(b);
+            matrix_destroy(aa);
+            matrix_destroy(ba);
+            matrix_destroy(r);
+            matrix_destroy(ra);
+            matrix_destroy(c);
+            matrix_destroy(ca);
+            matrix_destroy(bt);
+            matrix_destroy(bta);
+        }
+
+        // square in place keeps the padding; LU, solve, inverse, det
+        u64     n  = 37;
+        Matrix* a  = matrix_create(n, n);
+        Matrix* aa = matrix_create_aligned(n, n);
+        for (u64 i = 0; i < n * n; i++) { a->data[i] = rand_unit(); }
+        for (u64 i = 0; i < n; i++) { a->data[(i * n) + i] += 4; }
+        matrix_copy(aa, a);
+
+        matrix_T_inplace(aa);
+        fails += aa->ld != MATRIX_LD_ALIGNED(n) || pad_nonzero(aa);
+        matrix_T_inplace(aa);
+        fails += view_diff(matrix_view(aa), matrix_view(a), 0);
+
+        float det = matrix_det(a);
+        fails += fabsf(matrix_det(aa) - det) > 1e-5f * (1 + fabsf(det));
+
+        Matrix* lu  = matrix_create(n, n);
+        Matrix* lua = matrix_create_aligned(n, n);
+        u64*    p   = malloc(sizeof(u64) * n);
+        u64*    pa  = malloc(sizeof(u64) * n);
+        fails += !matrix_LU(lu, p, a) || !matrix_LU(lua, pa, aa);
+        fails += view_diff(matrix_view(lua), matrix_view(lu), 1e-5f);
+        for (u64 i = 0; i < n; i++) { fails += p[i] != pa[i]; }
+
+        Matrix* rhs  = matrix_create(n, 3);
+        Matrix* rhsa = matrix_create_aligned(n, 3);
+        Matrix* sol  = matrix_create(n, 3);
+        Matrix* sola = matrix_create_aligned(n, 3);
+        for (u64 i = 0; i < n * 3; i++) { rhs->data[i] = rand_unit(); }
+        matrix_copy(rhsa, rhs);
+        fails += !matrix_solve(sol, a, rhs) || !matrix_solve(sola, aa, rhsa);
+        fails += view_diff(matrix_view(sola), matrix_view(sol), 1e-4f);
+        matrix_LU_solve(sola, lua, pa, rhs);
+        fails += view_diff(matrix_view(sola), matrix_view(sol), 1e-4f);
+
+        Matrix* inv  = matrix_create(n, n);
+        Matrix* inva = matrix_create_aligned(n, n);
+        fails += !matrix_inv(inv, a) || !matrix_inv(inva, aa);
+        fails += view_diff(matrix_view(inva), matrix_view(inv), 1e-4f);
+        fails += pad_nonzero(inva);
+
+        Matrix* L  = matrix_create_aligned(n, n);
+        Matrix* U  = matrix_create_aligned(n, n);
+        Matrix* lu2 = matrix_create(n, n);
+        fails += !matrix_LU_Decomp(L, U, aa);
+        matrix_xply(lu2, L, U);
+        fails += view_diff(matrix_view(lu2), matrix_view(a), 1e-4f);
+
+        matrix_destroy(a);
+        matrix_destroy(aa);
+        matrix_destroy(lu);
+        matrix_destroy(lua);
+        matrix_destroy(rhs);
+        matrix_destroy(rhsa);
+        matrix_destroy(sol);
+        matrix_destroy(sola);
+        matrix_destroy(inv);
+        matrix_destroy(inva);
+        matrix_destroy(L);
+        matrix_destroy(U);
+        matrix_destroy(lu2);
+        free(p);
+        free(pa);
+
+        // from an arena
+        Arena*  arena = arena_create(nKB(64));
+        Matrix* am    = matrix_arena_alloc_aligned(arena, 5, 3);
+        fails += am->ld != 16 || (uintptr_t)am->data % MATRIX_ALIGN != 0 || pad_nonzero(am);
+        fails += MATRIX_AT(am, 4, 2) != 0;
+        arena_release(arena);
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    return (int)fails;
+}
+
+
 #endif // MATRIX_TEST_H
@@ -0,0 +1,90 @@
+#ifndef RCUMAP_TEST_H
+#define RCUMAP_TEST_H
+
+#include "common.h"
+#include "hashmap.h"
+#include "rcumap.h"
+#include <pthread.h>
+#include <stdio.h>
+
+
+typedef struct {
+    rcumap* map;
+    u32     stop;
+    u64     reads;
+    u64     torn;
+} rcu_test_ctx;
+
+// keys 1 and 2 are always updated together (val2 == 2 * val1)
+// a reader must never see them out of sync within one snapshot
+static void* rcu_reader_thread(void* arg)
+{
+    rcu_test_ctx* ctx    = arg;
+    u32           reader = rcumap_reader_register(ctx->map);
+    u64           reads  = 0;
+    u64           torn   = 0;
+
+    while (!__atomic_load_n(&ctx->stop, __ATOMIC_ACQUIRE)) {
+        const hashmap* snap = rcumap_read_lock(ctx->map, reader);
+
+        int k1 = 1, k2 = 2;
+        int v1 = 0, v2 = 0;
+        hashmap_get(snap, cast(k1), cast(v1));
+        hashmap_get(snap, cast(k2), cast(v2));
+
+        rcumap_read_unlock(ctx->map, reader);
+
+        torn += (v2 != 2 * v1);
+        reads++;
+    }
+
+    rcumap_reader_unregister(ctx->map, reader);
+
+    __atomic_fetch_add(&ctx->reads, reads, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->torn, torn, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+int rcumap_test_1(void)
+{
+    hashmap* init = hashmap_create(sizeof(int), sizeof(int), NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL);
+    int k1 = 1, k2 = 2, zero = 0;
+    hashmap_put(init, cast(k1), cast(zero));
+    hashmap_put(init, cast(k2), cast(zero));
+
+    rcu_test_ctx ctx = { .map = rcumap_create(init) };
+
+    pthread_t readers[3];
+    for (int t = 0; t < 3; t++) {
+        pthread_create(&readers[t], NULL, rcu_reader_thread, &ctx);
+    }
+
+    for (int i = 1; i <= 2000; i++) {
+        hashmap* next = rcumap_write_begin(ctx.map);
+        int      v2   = 2 * i;
+        hashmap_put(next, cast(k1), cast(i));
+        hashmap_put(next, cast(k2), cast(v2));
+        rcumap_write_commit(ctx.map, next);
+    }
+
+    __atomic_store_n(&ctx.stop, 1, __ATOMIC_RELEASE);
+    for (int t = 0; t < 3; t++) {
+        pthread_join(readers[t], NULL);
+    }
+
+    rcumap_synchronize(ctx.map);
+
+    u32 reader = rcumap_reader_register(ctx.map);
+    int v1     = 0;
+    rcumap_get(ctx.map, reader, cast(k1), cast(v1));
+
+    printf("reads: %lu, torn: %lu, final k1: %d, retired left: %lu\n",
+           ctx.reads, ctx.torn, v1, genVec_size(ctx.map->retired));
+
+    rcumap_destroy(ctx.map);
+    return 0;
+}
+
+
+#endif // RCUMAP_TEST_H
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "rope.h"
+#include "string_view.h"
+#include <stdio.h>
+#include <string.h>
+
+
+static void rope_test_print_chunk(StringView chunk, void* ctx)
+{
+    (*(u64*)ctx)++;
+    printf("[%.*s]", (int)chunk.len, chunk.data);
+}
+
+int rope_test_1(void)
+{
+    rope* r = rope_from_view(SV("hello world"));
+
+    rope_insert_cstr(r, 5, ",");
+    rope_insert_cstr(r, rope_len(r), "!");
+    rope_insert_cstr(r, 0, ">> ");
+    rope_remove(r, 9, 1); // the space after the comma
+
+    String* s = rope_to_string(r);
+    printf("%.*s (len %lu)\n", (int)string_len(s), string_data_ptr(s), rope_len(r));
+    string_destroy(s);
+
+    u64 chunks = 0;
+    rope_for_each_chunk(r, rope_test_print_chunk, &chunks);
+    printf(" %lu chunk(s)\n", chunks);
+    rope_destroy(r);
+
+    // random edits against a String doing the same thing
+    r = rope_create();
+    String ref;
+    string_create_stk(&ref, NULL);
+
+    u64 seed  = 7;
+    u64 fails = 0;
+
+    for (int k = 0; k < 20000; k++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        u64 x   = seed >> 33;
+        u64 len = string_len(&ref);
+
+        if (x % 3 != 0 || len == 0) {
+            // mostly small inserts, sometimes bigger than a leaf
+            char buf[600];
+            u64  n = (x >> 8) % 64 == 0 ? 300 + (x >> 16) % 300 : 1 + (x >> 8) % 8;
+            for (u64 j = 0; j < n; j++) {
+                buf[j] = (char)('a' + (x + j) % 26);
+            }
+            buf[n] = '\0';
+
+            u64 at = (x >> 20) % (len + 1);
+            rope_insert_cstr(r, at, buf);
+            string_insert_cstr(&ref, at, buf);
+        } else {
+            u64 at = (x >> 8) % len;
+            u64 n  = (x >> 20) % 16 == 0 ? (x >> 24) % 700 : (x >> 24) % 5;
+            if (n > len - at) {
+                n = len - at;
+            }
+
+            rope_remove(r, at, n);
+            if (n != 0) {
+                string_remove_range(&ref, at, at + n - 1);
+            }
+        }
+
+        if (rope_len(r) != string_len(&ref)) {
+            fails++;
+            break;
+        }
+    }
+
+    String* got = rope_to_string(r);
+    fails += !string_equals(got, &ref);
+    string_destroy(got);
+
+    u64 mid = rope_len(r) / 2;
+    fails += rope_char_at(r, mid) != string_char_at(&ref, mid);
+
+    String* sub = rope_substr(r, mid, 1000);
+    fails += memcmp(string_data_ptr(sub), string_data_ptr(&ref) + mid, string_len(sub)) != 0;
+    string_destroy(sub);
+
+    printf("random edits: len %lu, %lu fails\n", rope_len(r), fails);
+
+    string_destroy_stk(&ref);
+    rope_destroy(r);
+
+    return (int)fails;
+}
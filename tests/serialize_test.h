@@ -0,0 +1,193 @@
+#ifndef SERIALIZE_TEST_H
+#define SERIALIZE_TEST_H
+
+#include "String.h"
+#include "common.h"
+#include "gen_vector.h"
+#include "hashmap.h"
+#include "hashset.h"
+#include "serialize.h"
+#include "helpers.h"
+#include "str_setup.h"
+#include <stdio.h>
+
+
+// genVec round trip: POD (bulk path) and String (callback path)
+int serialize_test_1(void)
+{
+    FILE* f = tmpfile();
+    CHECK_FATAL(!f, "tmpfile failed");
+
+    genVec* ints = genVec_init(0, sizeof(int), NULL, NULL, NULL);
+    for (int i = 0; i < 10; i++) {
+        VEC_PUSH_SIMP(ints, int, i * i);
+    }
+
+    genVec* strs = genVec_init(0, sizeof(String), str_copy, str_move, str_del);
+    VEC_PUSH_CSTR(strs, "hello");
+    VEC_PUSH_CSTR(strs, "");
+    VEC_PUSH_CSTR(strs, "what is up");
+
+    genVec_write(ints, f, NULL);
+    genVec_write(strs, f, string_ser_write);
+    rewind(f);
+
+    genVec ints2;
+    genVec_init_stk(0, sizeof(int), NULL, NULL, NULL, &ints2);
+    genVec strs2;
+    genVec_init_stk(0, sizeof(String), str_copy, str_move, str_del, &strs2);
+
+    printf("read ints: %d\n", genVec_read(&ints2, f, NULL));
+    printf("read strs: %d\n", genVec_read(&strs2, f, string_ser_read));
+
+    genVec_print(&ints2, int_print);
+    printf("\n");
+    genVec_print(&strs2, str_print);
+    printf("\n");
+
+    // wrong kind must fail cleanly
+    rewind(f);
+    String s;
+    string_create_stk(&s, NULL);
+    printf("read as string fails: %d\n", !string_read(&s, f));
+    string_destroy_stk(&s);
+
+    genVec_destroy(ints);
+    genVec_destroy(strs);
+    genVec_destroy_stk(&ints2);
+    genVec_destroy_stk(&strs2);
+    fclose(f);
+    return 0;
+}
+
+
+// hashmap (String -> int) and hashset (int) round trip
+int serialize_test_2(void)
+{
+    FILE* f = tmpfile();
+    CHECK_FATAL(!f, "tmpfile failed");
+
+    hashmap* map = hashmap_create(sizeof(String), sizeof(int), murmurhash3_str, str_cmp,
+                                  str_copy, NULL, str_move, NULL, str_del, NULL);
+    hashset* set = hashset_create(sizeof(int), NULL, NULL, NULL, NULL, NULL);
+
+    const char* words[] = { "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog" };
+    for (int i = 0; i < 8; i++) {
+        String s;
+        string_create_stk(&s, words[i]);
+        hashmap_put(map, cast(s), cast(i));
+        string_destroy_stk(&s);
+    }
+    for (int i = 0; i < 1000; i++) {
+        hashset_insert(set, cast(i));
+    }
+
+    hashmap_write(map, f, string_ser_write, NULL);
+    hashset_write(set, f, NULL);
+    rewind(f);
+
+    hashmap* map2 = hashmap_create(sizeof(String), sizeof(int), murmurhash3_str, str_cmp,
+                                   str_copy, NULL, str_move, NULL, str_del, NULL);
+    hashset* set2 = hashset_create(sizeof(int), NULL, NULL, NULL, NULL, NULL);
+
+    printf("read map: %d\n", hashmap_read(map2, f, string_ser_read, NULL));
+    printf("read set: %d\n", hashset_read(set2, f, NULL));
+
+    hashmap_print(map2, str_print, int_print);
+    printf("set size: %lu / cap: %lu\n", hashset_size(set2), hashset_capacity(set2));
+
+    int x = 999;
+    printf("set has 999: %d\n", hashset_has(set2, cast(x)));
+
+    hashmap_destroy(map);
+    hashmap_destroy(map2);
+    hashset_destroy(set);
+    hashset_destroy(set2);
+    fclose(f);
+    return 0;
+}
+
+
+// a valid header with a huge element count and one element of data:
+// every reader must fail cleanly instead of presizing for the count
+static FILE* corrupt_stream(SER_KIND kind, b8 kv, u64 count)
+{
+    FILE* f = tmpfile();
+    int   x = 7;
+
+    ser_write_header(f, kind);
+    ser_write_u32(f, sizeof(int));
+    if (kv) { ser_write_u32(f, sizeof(int)); }
+    ser_write_u64(f, count);
+    ser_write_bytes(f, cast(x), sizeof(x));
+
+    rewind(f);
+    return f;
+}
+
+// a String header with a corrupt length and 200 bytes of data
+static FILE* corrupt_string_stream(u64 len)
+{
+    FILE* f = tmpfile();
+    char  pad[200] = { 0 };
+
+    ser_write_header(f, SER_STRING);
+    ser_write_u64(f, len);
+    ser_write_bytes(f, (const u8*)pad, sizeof(pad));
+
+    rewind(f);
+    return f;
+}
+
+int serialize_test_3(void)
+{
+    hashmap* map = hashmap_create(sizeof(int), sizeof(int), NULL, NULL, NULL, NULL, NULL, NULL,
+                                  NULL, NULL);
+    hashset* set = hashset_create(sizeof(int), NULL, NULL, NULL, NULL, NULL);
+    genVec*  vec = genVec_init(0, sizeof(int), NULL, NULL, NULL);
+
+    FILE* f = corrupt_stream(SER_HASHMAP, true, 1ULL << 40);
+    b8    map_ok = hashmap_read(map, f, NULL, NULL);
+    fclose(f);
+
+    f         = corrupt_stream(SER_HASHSET, false, 1ULL << 40);
+    b8 set_ok = hashset_read(set, f, NULL);
+    fclose(f);
+
+    f         = corrupt_stream(SER_GENVEC, false, 1ULL << 50);
+    b8 vec_ok = genVec_read(vec, f, NULL);
+    fclose(f);
+
+    // length that wraps old_len + len, and one far past the stream
+    String str;
+    string_create_stk(&str, "abc");
+
+    f          = corrupt_string_stream(~0ULL);
+    b8 wrap_ok = string_read(&str, f);
+    fclose(f);
+
+    f          = corrupt_string_stream(1ULL << 40);
+    b8 long_ok = string_read(&str, f);
+    fclose(f);
+
+    // element callback path (String keys/values in the containers)
+    String elm;
+    f         = corrupt_string_stream(1ULL << 40);
+    b8 ser_ok = ser_read_header(f, SER_STRING) && string_ser_read(f, (u8*)&elm);
+    fclose(f);
+
+    printf("corrupt reads: map %d, set %d, vec %d, str %d %d %d (all 0)\n", map_ok, set_ok,
+           vec_ok, wrap_ok, long_ok, ser_ok);
+    printf("str kept: ");
+    string_print(&str);
+    printf("\n");
+
+    string_destroy_stk(&str);
+    hashmap_destroy(map);
+    hashset_destroy(set);
+    genVec_destroy(vec);
+    return map_ok || set_ok || vec_ok || wrap_ok || long_ok || ser_ok;
+}
+
+
+#endif // SERIALIZE_TEST_H
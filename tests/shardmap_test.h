@@ -0,0 +1,66 @@
+#ifndef SHARDMAP_TEST_H
+#define SHARDMAP_TEST_H
+
+#include "common.h"
+#include "shardmap.h"
+#include <pthread.h>
+#include <stdio.h>
+
+
+static void count_inc(u8* val, void* ctx)
+{
+    (void)ctx;
+    (*(int*)val)++;
+}
+
+static void* count_worker(void* arg)
+{
+    shardmap* map  = arg;
+    int       zero = 0;
+
+    for (int round = 0; round < 100; round++) {
+        for (int k = 0; k < 1000; k++) {
+            shardmap_update(map, cast(k), cast(zero), count_inc, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+// 4 writers bump the same 1000 counters, every counter must end at 400
+int shardmap_test_1(void)
+{
+    shardmap* map = shardmap_create(16, sizeof(int), sizeof(int), NULL, NULL,
+                                    NULL, NULL, NULL, NULL, NULL, NULL);
+
+    pthread_t threads[4];
+    for (int t = 0; t < 4; t++) {
+        pthread_create(&threads[t], NULL, count_worker, map);
+    }
+    for (int t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    int bad = 0;
+    for (int k = 0; k < 1000; k++) {
+        int count = 0;
+        shardmap_get(map, cast(k), cast(count));
+        if (count != 400) {
+            bad++;
+        }
+    }
+
+    printf("size: %lu, wrong counters: %d\n", shardmap_size(map), bad);
+
+    int k = 7;
+    int out;
+    b8 deleted = shardmap_del(map, cast(k), cast(out));
+    printf("del 7: %d (was %d), has 7: %d, size: %lu\n", deleted, out,
+           shardmap_has(map, cast(k)), shardmap_size(map));
+
+    shardmap_destroy(map);
+    return 0;
+}
+
+
+#endif // SHARDMAP_TEST_H
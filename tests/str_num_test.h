@@ -0,0 +1,73 @@
+#pragma once
+
+#include "String.h"
+#include "str_num.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+int str_num_test_1(void)
+{
+    String* s = string_create();
+
+    double vals[] = { 0.0, -0.0, 1.0, 0.1, 0.3, 123.456, 1e-5, 1e16, 1e15, 5e-324,
+                      1.7976931348623157e308, -2.5, 1.0 / 3.0 };
+
+    for (u64 i = 0; i < sizeof(vals) / sizeof(vals[0]); i++) {
+        string_append_f64(s, vals[i]);
+        string_append_char(s, ' ');
+    }
+    string_append_i64(s, -9223372036854775807LL - 1);
+    string_append_char(s, ' ');
+    string_append_u64(s, 18446744073709551615ULL);
+
+    printf("%.*s\n", (int)string_len(s), string_data_ptr(s));
+
+    // parse it back, field by field
+    u64 i     = 0;
+    u64 fails = 0;
+    for (u64 k = 0; k < sizeof(vals) / sizeof(vals[0]); k++) {
+        double d = 0;
+        u64    n = string_parse_f64(s, i, &d);
+        fails += n == 0 || memcmp(&d, &vals[k], sizeof(d)) != 0;
+        i += n + 1;
+    }
+
+    i64 mn;
+    u64 mx;
+    i += string_parse_i64(s, i, &mn) + 1;
+    i += string_parse_u64(s, i, &mx);
+    fails += mn != -9223372036854775807LL - 1 || mx != 18446744073709551615ULL || i != string_len(s);
+
+    string_destroy(s);
+
+    // random bit patterns: shortest output must read back exactly (vs strtod too)
+    u64  seed = 42;
+    char buf[STR_F64_MAX_CHARS + 1];
+
+    for (int k = 0; k < 200000; k++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+        double v;
+        memcpy(&v, &seed, sizeof(v));
+        if (v != v || v - v != 0) { // nan / inf
+            continue;
+        }
+
+        u32 n  = str_fmt_f64(buf, v);
+        buf[n] = '\0';
+
+        double back;
+        fails += str_parse_f64(buf, n, &back) != n || back != v || strtod(buf, NULL) != v;
+    }
+
+    // overflow is "no number"
+    u64 u;
+    i64 x;
+    fails += str_parse_u64("18446744073709551616", 20, &u) != 0;
+    fails += str_parse_i64("9223372036854775808", 19, &x) != 0;
+
+    printf("%lu fails\n", fails);
+    return (int)fails;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "random.h"
+#include "str_search.h"
+#include <stdio.h>
+#include <string.h>
+
+
+static u64 naive_find(const char* s, u64 n, const char* needle, u64 m)
+{
+    for (u64 i = 0; i + m <= n; i++) {
+        if (memcmp(s + i, needle, m) == 0) {
+            return i;
+        }
+    }
+    return STR_NPOS;
+}
+
+
+// every kernel level must agree with the naive loops (small alphabet, many
+// partial matches; lengths around the 16/32 byte block edges)
+int str_search_test_1(void)
+{
+    pcg32_rand_seed(42, 7);
+
+    char hay[300];
+    char needle[20];
+    u64  fails = 0;
+
+    const cpu_features* f = cpu_get_features();
+    printf("cpu: sse2 %d avx2 %d fma %d\n", f->sse2, f->avx2, f->fma);
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        for (int t = 0; t < 2000; t++) {
+            u64 n = pcg32_rand_bounded(sizeof(hay));
+            u64 m = 1 + pcg32_rand_bounded(sizeof(needle));
+
+            for (u64 i = 0; i < n; i++) { hay[i] = (char)('a' + pcg32_rand_bounded(3)); }
+            for (u64 i = 0; i < m; i++) { needle[i] = (char)('a' + pcg32_rand_bounded(3)); }
+
+            char c = needle[0];
+
+            const char* p   = n ? memchr(hay, c, n) : NULL;
+            u64         ref = p ? (u64)(p - hay) : STR_NPOS;
+            fails += str_find_char(hay, n, c) != ref;
+
+            u64 cnt = 0;
+            for (u64 i = 0; i < n; i++) { cnt += hay[i] == c; }
+            fails += str_count_char(hay, n, c) != cnt;
+
+            fails += str_find(hay, n, needle, m) != naive_find(hay, n, needle, m);
+
+            // needle as a set (duplicates allowed), may not occur in hay
+            needle[0] = (char)('a' + pcg32_rand_bounded(4));
+            u64 any = STR_NPOS;
+            for (u64 i = 0; i < n && any == STR_NPOS; i++) {
+                if (memchr(needle, hay[i], m)) { any = i; }
+            }
+            fails += str_find_any(hay, n, needle, m) != any;
+        }
+
+        // find_all, overlapping
+        genVec* out = genVec_init(0, sizeof(u64), NULL, NULL, NULL);
+        u64 k = str_find_all("aaaabaaa", 8, "aa", 2, out); // 0 1 2 5 6
+        fails += k != 5 || *(const u64*)genVec_get_ptr(out, 3) != 5;
+        genVec_destroy(out);
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+
+    cpu_set_max_level(CPU_AVX2);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "random.h"
+#include "str_transform.h"
+#include "String.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+
+// class from <ctype.h> (C locale), independent of the kernels
+static u32 ref_class(u8 c)
+{
+    if (c >= 0x80)  { return STR_CLASS_NON_ASCII; }
+    if (isdigit(c)) { return STR_CLASS_DIGIT; }
+    if (isupper(c)) { return STR_CLASS_UPPER; }
+    if (islower(c)) { return STR_CLASS_LOWER; }
+    if (isspace(c)) { return STR_CLASS_SPACE; }
+    if (ispunct(c)) { return STR_CLASS_PUNCT; }
+    return STR_CLASS_CNTRL;
+}
+
+static u64 ref_normalize(const char* s, u64 n, char* out, u32 keep, b8 lower)
+{
+    u64 o = 0;
+    for (u64 i = 0; i < n; i++) {
+        u8 c = (u8)s[i];
+        if (ref_class(c) & keep) {
+            out[o++] = (char)(lower && c < 0x80 ? tolower(c) : c);
+        }
+    }
+    return o;
+}
+
+// random bytes, biased to ASCII letters so whole blocks are kept too
+int str_transform_test_1(void)
+{
+    pcg32_rand_seed(42, 7);
+
+    char buf[300];
+    char out[300];
+    char ref[300];
+    u64  fails = 0;
+
+    for (u32 c = 0; c < 256; c++) {
+        fails += str_classify((char)c) != ref_class((u8)c);
+    }
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        for (int t = 0; t < 20000; t++) {
+            u64 n       = pcg32_rand_bounded(sizeof(buf));
+            u32 letters = pcg32_rand_bounded(5); // in 4
+            for (u64 i = 0; i < n; i++) {
+                buf[i] = pcg32_rand_bounded(4) < letters ? (char)('A' + pcg32_rand_bounded(58))
+                                                         : (char)pcg32_rand_bounded(256);
+            }
+            u32 keep = pcg32_rand_bounded(STR_CLASS_ALL + 1);
+
+            // normalize, out of place
+            u64 r = ref_normalize(buf, n, ref, STR_CLASS_ALPHA | keep, 1);
+            u64 o = str_normalize(buf, n, out, keep);
+            fails += o != r || memcmp(out, ref, r) != 0;
+
+            // filter, in place
+            r = ref_normalize(buf, n, ref, STR_CLASS_ALL & ~keep, 0);
+            memcpy(out, buf, n);
+            o = str_filter(out, n, keep);
+            fails += o != r || memcmp(out, ref, r) != 0;
+
+            // case
+            memcpy(out, buf, n);
+            str_to_upper(out, n);
+            for (u64 i = 0; i < n; i++) {
+                fails += out[i] != (char)((u8)buf[i] < 0x80 ? toupper((u8)buf[i]) : buf[i]);
+            }
+            str_to_lower(out, n);
+            for (u64 i = 0; i < n; i++) {
+                fails += out[i] != (char)((u8)buf[i] < 0x80 ? tolower((u8)buf[i]) : buf[i]);
+            }
+        }
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    String* s = string_from_cstr("Hello, World 2024! caf\xC3\xA9");
+    string_filter(s, STR_CLASS_DIGIT | STR_CLASS_PUNCT);
+    string_to_upper(s);
+    string_print(s); // HELLO WORLD  CAFé
+    printf("\n");
+
+    char word[32];
+    u64  n = str_normalize("Don't 42x!", 10, word, STR_CLASS_PUNCT);
+    printf("%.*s\n", (int)n, word); // don'tx!
+
+    string_destroy(s);
+    return (int)fails;
+}
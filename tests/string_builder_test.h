@@ -0,0 +1,56 @@
+#pragma once
+
+#include "string_builder.h"
+#include "string_view.h"
+#include <stdio.h>
+
+
+int string_builder_test_1(void)
+{
+    // heap chunks
+    str_builder sb;
+    sb_init(&sb, NULL);
+
+    for (int i = 0; i < 1000; i++) {
+        sb_append_cstr(&sb, "line ");
+        sb_append_char(&sb, (char)('0' + i % 10));
+        sb_append_char(&sb, '\n');
+    }
+
+    String* big = string_from_cstr("[a string longer than one chunk of the builder ... ]");
+    sb_append_string(&sb, big);
+    string_destroy(big);
+
+    String* out = sb_build(&sb);
+    printf("len: %lu / %lu\n", string_len(out), sb_len(&sb));
+    printf("head: %.*s", 14, string_data_ptr(out));
+    printf("tail: %.*s\n", 10, string_data_ptr(out) + string_len(out) - 10);
+    string_destroy(out);
+
+    sb_clear(&sb);
+    sb_append_view(&sb, SV("reused"));
+    char* cstr = sb_to_cstr(&sb);
+    printf("after clear: %s\n", cstr);
+    free(cstr);
+    sb_destroy(&sb);
+
+    // chunks in a stack arena, spills to the heap once it is full
+    Arena arena;
+    ARENA_CREATE_STK_ARR(&arena, 1);
+
+    sb_init(&sb, &arena);
+    for (int i = 0; i < 200; i++) {
+        sb_append_cstr(&sb, "0123456789");
+    }
+
+    String dst;
+    string_create_stk(&dst, "prefix:");
+    sb_build_into(&sb, &dst);
+    printf("arena used: %lu, len: %lu, last: %c\n", arena_used(&arena), string_len(&dst),
+           string_char_at(&dst, string_len(&dst) - 1));
+
+    string_destroy_stk(&dst);
+    sb_destroy(&sb);
+
+    return 0;
+}
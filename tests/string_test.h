@@ -39,3 +39,42 @@ int string_test_1(void)
 }
 
 
+
+
+// small string optimization: inline up to STRING_SSO_CAP, spill beyond
+int string_test_2(void)
+{
+    String s;
+    string_create_stk(&s, "short");
+    printf("len %lu, inline %d\n", string_len(&s), string_is_inline(&s));
+
+    // grow past the inline buffer one char at a time
+    while (string_len(&s) < STRING_SSO_CAP + 5) {
+        string_append_char(&s, 'x');
+    }
+    printf("len %lu, inline %d: ", string_len(&s), string_is_inline(&s));
+    string_print(&s);
+    printf("\n");
+
+    string_append_string(&s, &s); // source aliases dest
+    string_insert_cstr(&s, 5, "__");
+    string_remove_range(&s, 0, 4);
+    string_print(&s);
+    printf("\n");
+
+    // a copy of a short heap string is inline again
+    string_remove_range(&s, 3, string_len(&s) - 1);
+    String c;
+    string_create_stk(&c, NULL);
+    string_copy(&c, &s);
+    printf("src inline %d, copy inline %d, equal %d\n", string_is_inline(&s),
+           string_is_inline(&c), string_equals(&s, &c));
+
+    String* sub = string_substr(&s, 1, 10);
+    printf("substr: %.*s (%lu)\n", (int)string_len(sub), string_data_ptr(sub), string_len(sub));
+
+    string_destroy(sub);
+    string_destroy_stk(&c);
+    string_destroy_stk(&s);
+    return 0;
+}
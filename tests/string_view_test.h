@@ -0,0 +1,45 @@
+#pragma once
+
+#include "string_view.h"
+#include <stdio.h>
+
+
+int string_view_test_1(void)
+{
+    StringView line = sv_trim(SV("  name, age,,city  \n"));
+    printf("[%.*s]\n", SV_ARG(line));
+
+    // exact split keeps the empty field
+    sv_split_iter it = sv_split(line, ',');
+    StringView    field;
+    while (sv_split_next(&it, &field)) {
+        printf("<%.*s> ", SV_ARG(sv_trim(field)));
+    }
+    printf("\n");
+
+    // tokenize skips runs of delimiters
+    it = sv_tokenize(SV("  the quick\t\tbrown  fox \n"), " \t\n");
+    while (sv_split_next(&it, &field)) {
+        printf("<%.*s> ", SV_ARG(field));
+    }
+    printf("\n");
+
+    StringView path = SV("src/string_view.c");
+    printf("starts src/: %d, ends .c: %d, ends .h: %d\n", sv_starts_with(path, SV("src/")),
+           sv_ends_with(path, SV(".c")), sv_ends_with(path, SV(".h")));
+
+    printf("find '_': %lu, find \"view\": %lu, find \"xyz\": %s\n", sv_find_char(path, '_'),
+           sv_find(path, SV("view")), sv_find(path, SV("xyz")) == SV_NPOS ? "npos" : "?");
+
+    StringView base = sv_drop_suffix(sv_drop_prefix(path, 4), 2);
+    printf("base: %.*s, cmp: %d %d\n", SV_ARG(base), sv_compare(base, SV("string_view")),
+           sv_compare(SV("abc"), SV("abd")) < 0);
+
+    // materialize only what has to be stored
+    String* s = string_from_view(base);
+    StringView back = string_substr_view(s, 7, 100);
+    printf("stored: %.*s, tail: %.*s\n", SV_ARG(string_view(s)), SV_ARG(back));
+    string_destroy(s);
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "random.h"
+#include "string_builder.h"
+#include "string_view.h"
+#include "text_reader.h"
+#include <stdio.h>
+
+
+// lines and tokens from a reader must match sv_split / sv_tokenize on the
+// whole text, with blocks much smaller than the lines
+static u64 reader_test_compare(text_reader* r, StringView text, b8 lines)
+{
+    u64 fails = 0;
+    u64 count = 0;
+
+    sv_split_iter it = lines ? sv_split(text, '\n') : sv_tokenize(text, READER_DEFAULT_DELIMS);
+    StringView    want, got;
+
+    while (lines ? reader_next_line(r, &got) : reader_next_token(r, &got)) {
+        // sv_split gives one more (empty) field after a trailing '\n'
+        if (!sv_split_next(&it, &want)) {
+            fails++;
+            break;
+        }
+        if (lines && sv_ends_with(want, SV("\r"))) {
+            want = sv_drop_suffix(want, 1);
+        }
+        fails += !sv_equals(want, got);
+        count++;
+    }
+
+    if (sv_split_next(&it, &want) && !(lines && want.len == 0)) {
+        fails++;
+    }
+
+    printf("  %s: %lu, fails %lu\n", lines ? "lines" : "tokens", count, fails);
+    return fails;
+}
+
+int text_reader_test_1(void)
+{
+    pcg32_rand_seed(42, 7);
+
+    // lines from 0 to ~2000 chars, CRLF now and then, no trailing '\n'
+    str_builder sb;
+    sb_init(&sb, NULL);
+    for (int l = 0; l < 300; l++) {
+        u32 len = pcg32_rand_bounded(4) == 0 ? pcg32_rand_bounded(2000) : pcg32_rand_bounded(60);
+        for (u32 i = 0; i < len; i++) {
+            u32 r = pcg32_rand_bounded(10);
+            sb_append_char(&sb, r == 0 ? ' ' : r == 1 ? '\t' : (char)('a' + r));
+        }
+        sb_append_cstr(&sb, pcg32_rand_bounded(5) == 0 ? "\r\n" : "\n");
+    }
+    sb_append_cstr(&sb, "last line");
+
+    String* text = sb_build(&sb);
+    sb_destroy(&sb);
+    StringView sv = string_view(text);
+
+    const char* path = "text_reader_test.tmp";
+    FILE*       f    = fopen(path, "wb");
+    CHECK_FATAL(!f, "can't create %s", path);
+    fwrite(sv.data, 1, sv.len, f);
+    fclose(f);
+
+    u64 fails = 0;
+    for (int lines = 1; lines >= 0; lines--) {
+        printf("stream, 16 byte blocks\n");
+        text_reader* r = reader_open(path, 16);
+        fails += reader_test_compare(r, sv, (b8)lines);
+        reader_close(r);
+
+        printf("mmap\n");
+        r = reader_open_mmap(path);
+        fails += reader_test_compare(r, sv, (b8)lines);
+        reader_close(r);
+
+        printf("memory\n");
+        r = reader_from_view(sv);
+        fails += reader_test_compare(r, sv, (b8)lines);
+        reader_close(r);
+    }
+
+    remove(path);
+    string_destroy(text);
+
+    // custom delimiters
+    text_reader* r = reader_from_view(SV("a,b;;c,"));
+    reader_set_delims(r, ",;");
+    StringView tok;
+    while (reader_next_token(r, &tok)) {
+        printf("<%.*s> ", SV_ARG(tok));
+    }
+    printf("\n");
+    reader_close(r);
+
+    return (int)fails;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+typedef struct {
+    u32* hits; // per task
+    u64  sum;  // atomic
+} pool_test_ctx;
+
+static void pool_test_task(void* arg, u64 i)
+{
+    pool_test_ctx* ctx = arg;
+    __atomic_fetch_add(&ctx->hits[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->sum, i, __ATOMIC_RELAXED);
+}
+
+// every task runs exactly once, for every pool size, many runs per pool
+int thread_pool_test_1(void)
+{
+    u64 fails = 0;
+
+    u32 sizes[] = { 1, 2, 3, 8 };
+    for (u32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        thread_pool* pool = thread_pool_create(sizes[s]);
+
+        for (u64 n_tasks = 0; n_tasks < 300; n_tasks += 7) {
+            pool_test_ctx ctx = { calloc(n_tasks + 1, sizeof(u32)), 0 };
+
+            thread_pool_run(pool, pool_test_task, &ctx, n_tasks);
+
+            for (u64 i = 0; i < n_tasks; i++) { fails += ctx.hits[i] != 1; }
+            fails += ctx.sum != (n_tasks * (n_tasks - 1)) / 2 * (n_tasks != 0);
+            free(ctx.hits);
+        }
+
+        printf("%u threads: fails %lu\n", thread_pool_size(pool), fails);
+        thread_pool_destroy(pool);
+    }
+
+    thread_pool* all = thread_pool_create(0);
+    printf("default pool: %u threads\n", thread_pool_size(all));
+    thread_pool_destroy(all);
+
+    return (int)fails;
+}
+
+
+typedef struct {
+    thread_pool*  pool;
+    pool_test_ctx inner[16];
+} pool_nested_ctx;
+
+// every outer task runs a whole inner run on the same pool
+static void pool_nested_task(void* arg, u64 i)
+{
+    pool_nested_ctx* ctx = arg;
+    thread_pool_run(ctx->pool, pool_test_task, &ctx->inner[i], 50);
+}
+
+// nested runs on the same pool go inline instead of deadlocking
+int thread_pool_test_2(void)
+{
+    u64 fails = 0;
+
+    u32 sizes[] = { 1, 2, 8 };
+    for (u32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        pool_nested_ctx ctx = { thread_pool_create(sizes[s]), { { 0 } } };
+        for (u32 t = 0; t < 16; t++) { ctx.inner[t].hits = calloc(50, sizeof(u32)); }
+
+        thread_pool_run(ctx.pool, pool_nested_task, &ctx, 16);
+
+        for (u32 t = 0; t < 16; t++) {
+            for (u64 i = 0; i < 50; i++) { fails += ctx.inner[t].hits[i] != 1; }
+            fails += ctx.inner[t].sum != (50 * 49) / 2;
+            free(ctx.inner[t].hits);
+        }
+
+        printf("%u threads nested: fails %lu\n", thread_pool_size(ctx.pool), fails);
+        thread_pool_destroy(ctx.pool);
+    }
+
+    return (int)fails;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "random.h"
+#include "string_view.h"
+#include "utf8.h"
+#include <stdio.h>
+
+
+// straightforward decoder: value + range checks instead of lead byte tables
+static u64 ref_valid_prefix(const u8* s, u64 n)
+{
+    u64 i = 0;
+    while (i < n) {
+        u8  c = s[i];
+        u32 len, cp, min;
+
+        if (c < 0x80)      { i++; continue; }
+        else if (c < 0xC0) { return i; }
+        else if (c < 0xE0) { len = 2; cp = c & 0x1F; min = 0x80; }
+        else if (c < 0xF0) { len = 3; cp = c & 0x0F; min = 0x800; }
+        else if (c < 0xF8) { len = 4; cp = c & 0x07; min = 0x10000; }
+        else               { return i; }
+
+        if (i + len > n) { return i; }
+        for (u32 k = 1; k < len; k++) {
+            if ((s[i + k] & 0xC0) != 0x80) { return i; }
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) { return i; }
+
+        i += len;
+    }
+    return n;
+}
+
+// random valid text (mostly ASCII runs), then a few random byte edits
+int utf8_test_1(void)
+{
+    pcg32_rand_seed(42, 7);
+
+    char buf[400];
+    u64  fails = 0;
+
+    for (int level = CPU_SCALAR; level <= CPU_AVX2; level++) {
+        cpu_set_max_level((cpu_level)level);
+
+        for (int t = 0; t < 20000; t++) {
+            u64 n      = 0;
+            u64 target = pcg32_rand_bounded(300);
+            u32 chars  = 0;
+
+            while (n < target) {
+                u32 kind = pcg32_rand_bounded(8);
+                u32 cp   = kind < 4  ? 0x20 + pcg32_rand_bounded(0x5F)
+                         : kind == 4 ? 0x80 + pcg32_rand_bounded(0x780)
+                         : kind == 5 ? 0x800 + pcg32_rand_bounded(0xF800)
+                                     : 0x10000 + pcg32_rand_bounded(0x100000);
+                if (cp >= 0xD800 && cp <= 0xDFFF) {
+                    cp = 'x';
+                }
+                n += utf8_encode(cp, buf + n);
+                chars++;
+            }
+
+            fails += !utf8_valid(buf, n);
+            fails += utf8_count(buf, n) != chars;
+
+            for (u32 e = pcg32_rand_bounded(3); e > 0 && n > 0; e--) {
+                buf[pcg32_rand_bounded((u32)n)] = (char)pcg32_rand_bounded(256);
+            }
+            if (pcg32_rand_bounded(4) == 0 && n > 0) {
+                n -= pcg32_rand_bounded(4) % (n + 1); // cut a sequence at the end
+            }
+
+            fails += utf8_valid_prefix(buf, n) != ref_valid_prefix((const u8*)buf, n);
+        }
+
+        printf("%-6s fails: %lu\n", cpu_level_name((cpu_level)level), fails);
+    }
+    cpu_set_max_level(CPU_AVX2);
+
+    // decoding: "aé€😀" + a stray continuation byte
+    StringView sv = SV("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\x80");
+    printf("valid %d, prefix %lu, code points %lu:", sv_is_utf8(sv),
+           utf8_valid_prefix(sv.data, sv.len), sv_utf8_len(sv_prefix(sv, 10)));
+
+    utf8_iter it = utf8_iter_begin(sv);
+    u32       cp;
+    while (utf8_iter_next(&it, &cp)) {
+        printf(" U+%04X@%lu", cp, it.offset);
+    }
+    printf("\n");
+
+    String* s = string_create();
+    string_append_utf8(s, 0x1F600);
+    string_append_utf8(s, 0xD800); // surrogate -> U+FFFD
+    printf("encoded %lu bytes, %lu code points, utf8 %d\n", string_len(s), string_utf8_len(s),
+           string_is_utf8(s));
+    string_destroy(s);
+
+    return (int)fails;
+}